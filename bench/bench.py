@@ -0,0 +1,268 @@
+#!/usr/bin/env python
+
+"""
+Run the SPARTA benchmark decks in this directory and write a JSON report.
+
+Syntax: bench.py [options]
+
+  -e exe        SPARTA executable (default ../src/spa_mpi)
+  -m launcher   MPI launch template, {n} = # of procs
+                  (default "mpirun -np {n}")
+  -p 1,2,4      proc counts to run on (default 1)
+  -d free,...   decks to run, suffix of in.* (default all in.* files)
+  -s size       problem size per deck, see each deck (default 1)
+  -n steps      timesteps per run (default 100)
+  -w            weak scaling: size is multiplied by # of procs,
+                  else strong scaling with fixed size
+  -r repeat     run each case this many times, keep the fastest (default 1)
+  -o file       JSON report to write (default bench.json)
+  -c file       compare to a baseline JSON report and flag regressions
+  -t tol        fractional slowdown that counts as a regression (default 0.05)
+  -l dir        directory for log files (default logs)
+
+Exit status is 1 if a comparison finds a regression, else 0.
+"""
+
+from __future__ import print_function
+
+import getopt
+import glob
+import json
+import os
+import re
+import shlex
+import socket
+import subprocess
+import sys
+import time
+
+PHASES = ["Move", "Coll", "Sort", "Comm", "Modfy", "Outpt", "Other"]
+
+# ----------------------------------------------------------------------
+
+def error(msg):
+  print("ERROR:", msg)
+  sys.exit(2)
+
+# ----------------------------------------------------------------------
+# extract results of the last run in a SPARTA log file
+
+def parse_log(path):
+  text = open(path).read()
+
+  loops = re.findall(r"Loop time of (\S+) on (\d+) procs for (\d+) steps "
+                     r"with (\d+) particles", text)
+  if not loops: return None
+  loop = loops[-1]
+  result = {"loop_time": float(loop[0]), "procs": int(loop[1]),
+            "steps": int(loop[2]), "particles": int(loop[3])}
+
+  # summary of last run starts at its "Loop time" line
+
+  last = text[text.rfind("Loop time of"):]
+
+  def count(label):
+    m = re.search(r"^%s\s*=\s*(\d+)" % re.escape(label), last, re.M)
+    return int(m.group(1)) if m else 0
+
+  result["moves"] = count("Particle moves")
+  result["collisions"] = count("Collide occurs")
+  result["surf_collisions"] = count("SurfColl occurs")
+  result["reactions"] = count("Reactions") or count("Gas reactions")
+
+  t = result["loop_time"]
+  result["moves_per_sec"] = result["moves"]/t if t > 0 else 0.0
+  result["moves_per_sec_per_proc"] = result["moves_per_sec"]/result["procs"]
+  result["collisions_per_sec"] = result["collisions"]/t if t > 0 else 0.0
+
+  phases = {}
+  for name in PHASES:
+    m = re.search(r"^%s\s+time \(%%\) = (\S+) \((\S+)\)" % name, last, re.M)
+    if m: phases[name.lower()] = {"time": float(m.group(1)),
+                                  "percent": float(m.group(2))}
+  result["phases"] = phases
+
+  m = re.search(r"peak\s+\(ave,min,max\) = (\S+) (\S+) (\S+), "
+                r"imbalance = (\S+)%", last)
+  if m:
+    result["memory_peak_mb"] = {"ave": float(m.group(1)),
+                                "min": float(m.group(2)),
+                                "max": float(m.group(3)),
+                                "imbalance": float(m.group(4))}
+  return result
+
+# ----------------------------------------------------------------------
+# run one deck on nprocs, return parsed results of fastest repeat
+
+def run_case(exe, launcher, deck, nprocs, size, steps, repeat, logdir):
+  best = None
+  for irep in range(repeat):
+    log = os.path.join(logdir, "log.%s.%d.%d" % (deck, nprocs, irep))
+    cmd = shlex.split(launcher.format(n=nprocs))
+    cmd += [exe, "-in", "in." + deck, "-log", log, "-screen", "none",
+            "-var", "size", str(size), "-var", "steps", str(steps)]
+    print("  running:", " ".join(cmd))
+    status = subprocess.call(cmd)
+    result = parse_log(log) if os.path.exists(log) else None
+    if status or result is None:
+      print("  FAILED: see", log)
+      return None
+    if best is None or result["loop_time"] < best["loop_time"]:
+      best = result
+
+  best["deck"] = deck
+  best["size"] = size
+  return best
+
+# ----------------------------------------------------------------------
+# parallel efficiency of each run relative to fewest procs for same deck
+# strong: fixed problem, ideal time scales as 1/P
+# weak: problem grows with P, ideal rate per proc is constant
+
+def efficiency(runs, weak):
+  for deck in set(r["deck"] for r in runs):
+    mine = sorted([r for r in runs if r["deck"] == deck],
+                  key=lambda r: r["procs"])
+    ref = mine[0]
+    for r in mine:
+      if weak:
+        eff = r["moves_per_sec_per_proc"]/ref["moves_per_sec_per_proc"] \
+            if ref["moves_per_sec_per_proc"] > 0 else 0.0
+      else:
+        eff = (ref["loop_time"]*ref["procs"])/(r["loop_time"]*r["procs"]) \
+            if r["loop_time"] > 0 else 0.0
+      r["efficiency"] = eff
+
+# ----------------------------------------------------------------------
+# compare rates to a baseline report, return # of regressions
+
+def compare(runs, baseline, tol):
+  base = dict(((r["deck"], r["procs"]), r) for r in baseline["runs"])
+  nregress = 0
+  print()
+  print("%-10s %5s %14s %14s %8s" %
+        ("deck", "procs", "base moves/s", "moves/s", "change"))
+  for r in sorted(runs, key=lambda r: (r["deck"], r["procs"])):
+    b = base.get((r["deck"], r["procs"]))
+    if b is None or b["moves_per_sec"] <= 0:
+      print("%-10s %5d %14s %14.4g %8s" %
+            (r["deck"], r["procs"], "n/a", r["moves_per_sec"], ""))
+      continue
+    if b.get("size") != r["size"] or b.get("steps") != r["steps"]:
+      print("WARNING: %s on %d procs has different size/steps than baseline"
+            % (r["deck"], r["procs"]))
+    change = r["moves_per_sec"]/b["moves_per_sec"] - 1.0
+    flag = ""
+    if change < -tol:
+      flag = "REGRESSION"
+      nregress += 1
+    r["baseline_change"] = change
+    print("%-10s %5d %14.4g %14.4g %+7.1f%% %s" %
+          (r["deck"], r["procs"], b["moves_per_sec"], r["moves_per_sec"],
+           100.0*change, flag))
+  return nregress
+
+# ----------------------------------------------------------------------
+
+def git_commit():
+  try:
+    out = subprocess.check_output(["git", "rev-parse", "HEAD"],
+                                  stderr=open(os.devnull, "w"))
+    return out.decode().strip()
+  except Exception:
+    return None
+
+# ----------------------------------------------------------------------
+
+def main():
+  here = os.path.dirname(os.path.abspath(__file__))
+  exe = os.path.join(here, "..", "src", "spa_mpi")
+  launcher = "mpirun -np {n}"
+  procs = [1]
+  decks = None
+  size = 1
+  steps = 100
+  weak = False
+  repeat = 1
+  outfile = "bench.json"
+  basefile = None
+  tol = 0.05
+  logdir = "logs"
+
+  try:
+    opts, args = getopt.getopt(sys.argv[1:], "e:m:p:d:s:n:wr:o:c:t:l:h")
+  except getopt.GetoptError as e:
+    error(str(e))
+  for opt, val in opts:
+    if opt == "-e": exe = val
+    elif opt == "-m": launcher = val
+    elif opt == "-p": procs = [int(p) for p in val.split(",")]
+    elif opt == "-d": decks = val.split(",")
+    elif opt == "-s": size = int(val)
+    elif opt == "-n": steps = int(val)
+    elif opt == "-w": weak = True
+    elif opt == "-r": repeat = int(val)
+    elif opt == "-o": outfile = val
+    elif opt == "-c": basefile = val
+    elif opt == "-t": tol = float(val)
+    elif opt == "-l": logdir = val
+    elif opt == "-h":
+      print(__doc__)
+      sys.exit(0)
+  if args: error("unknown argument %s" % args[0])
+
+  exe = os.path.abspath(exe)
+  outfile = os.path.abspath(outfile)
+  logdir = os.path.abspath(logdir)
+  if basefile: basefile = os.path.abspath(basefile)
+  if not os.path.exists(exe): error("executable %s does not exist" % exe)
+  if not os.path.isdir(logdir): os.makedirs(logdir)
+
+  # decks read their data files from this directory
+
+  os.chdir(here)
+  if decks is None:
+    decks = sorted(f[3:] for f in glob.glob("in.*"))
+  for deck in decks:
+    if not os.path.exists("in." + deck): error("no deck in.%s" % deck)
+
+  runs = []
+  for deck in decks:
+    print("deck", deck)
+    for n in procs:
+      nsize = size*n if weak else size
+      r = run_case(exe, launcher, deck, n, nsize, steps, repeat, logdir)
+      if r:
+        r["steps"] = steps
+        runs.append(r)
+        print("  %d procs: %g moves/s, %g s" %
+              (n, r["moves_per_sec"], r["loop_time"]))
+
+  efficiency(runs, weak)
+
+  report = {"date": time.strftime("%Y-%m-%d %H:%M:%S"),
+            "host": socket.gethostname(),
+            "executable": exe,
+            "commit": git_commit(),
+            "launcher": launcher,
+            "scaling": "weak" if weak else "strong",
+            "size": size, "steps": steps, "repeat": repeat,
+            "runs": runs}
+
+  nregress = 0
+  if basefile:
+    baseline = json.load(open(basefile))
+    nregress = compare(runs, baseline, tol)
+    report["baseline"] = basefile
+    report["regressions"] = nregress
+
+  with open(outfile, "w") as f:
+    json.dump(report, f, indent=2, sort_keys=True)
+  print("wrote", outfile)
+
+  if nregress:
+    print("%d regression(s) beyond %g%%" % (nregress, 100.0*tol))
+    sys.exit(1)
+
+if __name__ == "__main__":
+  main()
@@ -12,6 +12,7 @@
    See the README file in the top-level SPARTA directory.
 ------------------------------------------------------------------------- */
 
+#include "math.h"
 #include "string.h"
 #include "stdlib.h"
 #include "compute_fft_grid.h"
@@ -28,14 +29,6 @@
 #include "memory.h"
 #include "error.h"
 
-#ifdef SPARTA_MAP
-#include <map>
-#elif defined SPARTA_UNORDERED_MAP
-#include <unordered_map>
-#else
-#include <tr1/unordered_map>
-#endif
-
 using namespace SPARTA_NS;
 
 enum{COMPUTE,FIX,VARIABLE};
@@ -247,17 +240,21 @@ ComputeFFTGrid::ComputeFFTGrid(SPARTA *sparta, int narg, char **arg) :
 
   fft_create();
 
-  memory->create(fft,2*nfft,"fft/grid:fft");
+  memory->create(fftreal,nfft,"fft/grid:fftreal");
+  memory->create(fft,2*nhfft,"fft/grid:fft");
   memory->create(fftwork,nfft,"fft/grid:fftwork");
 
   irregular1 = irregular2 = NULL;
-  map1 = map2 = NULL;
+  map1 = map2 = flip2 = sendmap = NULL;
+  fftsend = NULL;
   ingrid = gridwork = NULL;
   gridworkcomplex = NULL;
   vector_grid = NULL;
   array_grid = NULL;
 
   nglocal = 0;
+  ngcache = -1;
+  gcache = NULL;
   reallocate();
 }
 
@@ -274,8 +271,10 @@ ComputeFFTGrid::~ComputeFFTGrid()
   if (dimension == 3) delete fft3d;
   else delete fft2d;
 
+  memory->destroy(fftreal);
   memory->destroy(fft);
   memory->destroy(fftwork);
+  memory->destroy(fftsend);
 
   memory->destroy(ingrid);
   memory->destroy(gridwork);
@@ -288,6 +287,9 @@ ComputeFFTGrid::~ComputeFFTGrid()
   delete irregular2;
   memory->destroy(map1);
   memory->destroy(map2);
+  memory->destroy(flip2);
+  memory->destroy(sendmap);
+  memory->destroy(gcache);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -304,7 +306,8 @@ void ComputeFFTGrid::init()
 
   // create two irregular comm patterns for moving data
   //   from/to SPARTA grid to/from FFT grid
-  // do this at each init in case grid partitioning has changed
+  // check at each init in case grid partitioning has changed,
+  //   patterns are only re-created if it has
   // also reallocate grid-based memory if needed
 
   reallocate();
@@ -428,21 +431,21 @@ void ComputeFFTGrid::compute_per_grid()
     irregular1->exchange_uniform((char *) ingridptr,sizeof(double),
                                  (char *) fftwork);
 
-    // convert SPARTA grid value to FFT complex
-    // use map1 to morph recvbuf to local FFT layout
+    // use map1 to morph recvbuf to local FFT layout of real values
 
-    for (i = 0; i < nfft; i++) {
-      n = 2*map1[i];
-      fft[n] = fftwork[i];
-      fft[n+1] = ZEROF;
-    }
+    for (i = 0; i < nfft; i++)
+      fftreal[map1[i]] = fftwork[i];
 
-    // perform FFT
+    // perform real-to-complex FFT
+    // result is non-redundant half of complex FFT grid, kx = 0 to nx/2
 
-    if (dimension == 3) fft3d->compute(fft,fft,1);
-    else fft2d->compute(fft,fft,1);
+    if (dimension == 3) fft3d->compute_r2c(fftreal,fft,1);
+    else fft2d->compute_r2c(fftreal,fft,1);
 
-    // reverse irregular comm to move results from FFT grid -> SPARTA grid
+    // irregular comm to move results from FFT grid -> SPARTA grid
+    // each grid cell receives its half-complex value via sendmap,
+    //   cells with kx > nx/2 receive the value at -k which is
+    //   the complex conjugate of their value, flagged by flip2
     // if conjugate set:
     //   convert complex FFT datums back to real via c times c*
     //   comm single floating point value per grid cell
@@ -450,15 +453,14 @@ void ComputeFFTGrid::compute_per_grid()
     // copy or sum received values into output vec or array via map2
 
     if (conjugate) {
-      n = 0;
-      for (i = 0; i < nfft; i++) {
+      for (i = 0; i < nsend2; i++) {
+        n = 2*sendmap[i];
         real = fft[n];
         imag = fft[n+1];
-        fftwork[i] = real*real + imag*imag;
-        n += 2;
+        fftsend[i] = real*real + imag*imag;
       }
 
-      irregular2->exchange_uniform((char *) fftwork,sizeof(double),
+      irregular2->exchange_uniform((char *) fftsend,sizeof(double),
                                    (char *) gridwork);
 
       if (sumflag) {
@@ -486,7 +488,14 @@ void ComputeFFTGrid::compute_per_grid()
       }
 
     } else {
-      irregular2->exchange_uniform((char *) fft,2*sizeof(FFT_SCALAR),
+      j = 0;
+      for (i = 0; i < nsend2; i++) {
+        n = 2*sendmap[i];
+        fftsend[j++] = fft[n];
+        fftsend[j++] = fft[n+1];
+      }
+
+      irregular2->exchange_uniform((char *) fftsend,2*sizeof(double),
                                    (char *) gridworkcomplex);
 
       if (sumflag) {
@@ -494,8 +503,10 @@ void ComputeFFTGrid::compute_per_grid()
         int n = grid->nlocal;
         j = 0;
         for (i = 0; i < n; i++) {
+          imag = gridworkcomplex[j+1];
+          if (flip2[i]) imag = -imag;
           array_grid[map2[i]][icol] += gridworkcomplex[j];
-          array_grid[map2[i]][icol+1] += gridworkcomplex[j+1];
+          array_grid[map2[i]][icol+1] += imag;
           j += 2;
         }
       } else {
@@ -503,8 +514,10 @@ void ComputeFFTGrid::compute_per_grid()
         int n = grid->nlocal;
         j = 0;
         for (i = 0; i < n; i++) {
+          imag = gridworkcomplex[j+1];
+          if (flip2[i]) imag = -imag;
           array_grid[map2[i]][icol] = gridworkcomplex[j];
-          array_grid[map2[i]][icol+1] = gridworkcomplex[j+1];
+          array_grid[map2[i]][icol+1] = imag;
           j += 2;
         }
       }
@@ -528,51 +541,100 @@ void ComputeFFTGrid::compute_per_grid()
 /* ----------------------------------------------------------------------
    reallocate irregular comm patterns if local grid storage changes
    called by init() and whenever grid is rebalanced
+   patterns are cached and only re-created if owned cells have changed
 ------------------------------------------------------------------------- */
 
 void ComputeFFTGrid::reallocate()
 {
-  delete irregular1;
-  delete irregular2;
-  memory->destroy(map1);
-  memory->destroy(map2);
+  int changed = grid_changed();
+
+  if (changed) {
+    delete irregular1;
+    delete irregular2;
+    memory->destroy(map1);
+    memory->destroy(map2);
+    memory->destroy(flip2);
+    memory->destroy(sendmap);
+    memory->destroy(fftsend);
+
+    irregular_create();
+  }
 
-  irregular_create();
+  if (grid->nlocal != nglocal) {
+    memory->destroy(ingrid);
+    memory->destroy(gridwork);
+    memory->destroy(gridworkcomplex);
+    memory->destroy(vector_grid);
+    memory->destroy(array_grid);
 
-  if (grid->nlocal == nglocal) return;
+    nglocal = grid->nlocal;
 
-  memory->destroy(ingrid);
-  memory->destroy(gridwork);
-  memory->destroy(gridworkcomplex);
-  memory->destroy(vector_grid);
-  memory->destroy(array_grid);
+    memory->create(ingrid,nglocal,"fft/grid:ingrid");
+    gridwork = NULL;
+    gridworkcomplex = NULL;
 
-  nglocal = grid->nlocal;
+    if (conjugate) memory->create(gridwork,nglocal,"fft/grid:gridwork");
+    else memory->create(gridworkcomplex,2*nglocal,
+                        "fft/grid:gridworkcomplex");
 
-  memory->create(ingrid,nglocal,"fft/grid:ingrid");
-  gridwork = NULL;
-  gridworkcomplex = NULL;
+    if (ncol == 1) memory->create(vector_grid,nglocal,"fft/grid:vector_grid");
+    else memory->create(array_grid,nglocal,ncol,"fft/grid:array_grid");
+  }
+
+  if (changed && startcol) kspace();
+}
 
-  if (startcol || conjugate) 
-    memory->create(gridwork,nglocal,"fft/grid:gridwork");
-  if (!conjugate) memory->create(gridworkcomplex,2*nglocal,
-                                 "fft/grid:gridworkcomplex");
+/* ----------------------------------------------------------------------
+   check if owned grid cells have changed since comm patterns were created
+   compare IDs of owned cells in order to cached IDs, then update cache
+   return 1 if any proc's cells have changed, 0 if not
+------------------------------------------------------------------------- */
+
+int ComputeFFTGrid::grid_changed()
+{
+  Grid::ChildCell *cells = grid->cells;
+  int n = grid->nlocal;
+
+  int flag = 0;
+  if (n != ngcache) flag = 1;
+  else {
+    for (int i = 0; i < n; i++)
+      if (cells[i].id != gcache[i]) {
+        flag = 1;
+        break;
+      }
+  }
 
-  if (ncol == 1) memory->create(vector_grid,nglocal,"fft/grid:vector_grid");
-  else memory->create(array_grid,nglocal,ncol,"fft/grid:array_grid");
+  if (flag) {
+    if (n != ngcache) {
+      memory->destroy(gcache);
+      memory->create(gcache,n,"fft/grid:gcache");
+    }
+    for (int i = 0; i < n; i++) gcache[i] = cells[i].id;
+    ngcache = n;
+  }
 
-  // one-time setup of vector of K-space vector magnitudes if requested
-  // compute values in K-space, irregular comm to grid decomposition
-  // kx,ky,kz = indices of FFT grid cell in K-space
-  // convert to distance from (0,0,0) cell using PBC
-  // klen = length of K-space vector
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  return flagall;
+}
 
-  if (!startcol) return;
+/* ----------------------------------------------------------------------
+   set columns of K-space vector components and magnitudes if requested
+   kx,ky,kz = indices of owned grid cell in K-space
+   convert to distance from (0,0,0) cell using PBC
+   klen = length of K-space vector
+------------------------------------------------------------------------- */
 
-  int i,j,k;
+void ComputeFFTGrid::kspace()
+{
+  int ix,iy,iz;
+  cellint gid;
   double ikx,iky,ikz;
   double klen;
 
+  Grid::ChildCell *cells = grid->cells;
+
   int nxhalf = nx/2;
   int nyhalf = ny/2;
   int nzhalf = nz/2;
@@ -586,33 +648,27 @@ void ComputeFFTGrid::reallocate()
     if (m == 2 && !kz) continue;
     if (m == 3 && !kmag) continue;
 
-    int n = 0;
-    for (k = nzlo; k <= nzhi; k++) {
-      if (k < nzhalf) ikz = k;
-      else ikz = nz - k;
-      for (j = nylo; j <= nyhi; j++) {
-        if (j < nyhalf) iky = j;
-        else iky = ny - j;
-        for (i = nxlo; i <= nxhi; i++) {
-          if (i < nxhalf) ikx = i;
-          else ikx = nx - i;
-
-          if (m == 0) klen = ikx;
-          else if (m == 1) klen = iky;
-          else if (m == 2) klen = ikz;
-          else if (m == 3) klen = sqrt(ikx*ikx + iky*iky + ikz*ikz);
-
-          fftwork[n++] = klen;
-        }
-      }
+    for (int i = 0; i < nglocal; i++) {
+      gid = cells[i].id;
+      ix = (gid-1) % nx;
+      iy = ((gid-1) / nx) % ny;
+      iz = (gid-1) / (nx*ny);
+
+      if (ix < nxhalf) ikx = ix;
+      else ikx = nx - ix;
+      if (iy < nyhalf) iky = iy;
+      else iky = ny - iy;
+      if (iz < nzhalf) ikz = iz;
+      else ikz = nz - iz;
+
+      if (m == 0) klen = ikx;
+      else if (m == 1) klen = iky;
+      else if (m == 2) klen = ikz;
+      else klen = sqrt(ikx*ikx + iky*iky + ikz*ikz);
+
+      array_grid[i][icol] = klen;
     }
 
-    irregular2->exchange_uniform((char *) fftwork,sizeof(double),
-                                 (char *) gridwork);
-    
-    for (i = 0; i < nglocal; i++)
-      array_grid[map2[i]][icol] = gridwork[i];
-
     icol++;
   }
 }
@@ -624,13 +680,20 @@ void ComputeFFTGrid::reallocate()
 bigint ComputeFFTGrid::memory_usage()
 {
   bigint bytes = 0;
-  bytes += 2*nfft * sizeof(FFT_SCALAR);       // fft
+  bytes += nfft * sizeof(FFT_SCALAR);         // fftreal
+  bytes += 2*nhfft * sizeof(FFT_SCALAR);      // fft
   bytes += nfft * sizeof(double);             // fftwork
   bytes += nglocal * sizeof(double);          // ingrid
-  if (conjugate) bytes += nglocal * sizeof(double);       // gridwork
-  else bytes += 2*nglocal * sizeof(FFT_SCALAR);           // gridworkcomplex
+  if (conjugate) {
+    bytes += nsend2 * sizeof(double);                     // fftsend
+    bytes += nglocal * sizeof(double);                    // gridwork
+  } else {
+    bytes += 2*nsend2 * sizeof(double);                   // fftsend
+    bytes += 2*nglocal * sizeof(double);                  // gridworkcomplex
+  }
   bytes += ncol*nglocal * sizeof(double);     // vector/array grid
-  bytes += (nfft+nglocal) * sizeof(int);      // map1,map2
+  bytes += (nfft+2*nglocal+nsend2) * sizeof(int);  // map1,map2,flip2,sendmap
+  bytes += ngcache * sizeof(cellint);         // gcache
   return bytes;
 }
 
@@ -688,7 +751,13 @@ void ComputeFFTGrid::fft_create()
   nzfft = nzhi - nzlo + 1;
 
   nfft = nxfft * nyfft * nzfft;
-  
+
+  // real-to-complex FFT output is non-redundant half of FFT grid
+  // x extent is 0 to nx/2 inclusive, same y,z bounds as real FFT grid
+
+  nhalf = nx/2 + 1;
+  nhfft = nhalf * nyfft * nzfft;
+
   //printf("FFT %d: nxyz %d %d %d np xyz %d %d %d: "
   //       "x %d %d y %d %d z %d %d: %d\n",
   //       me,nx,ny,nz,npx,npy,npz,nxlo,nxhi,nylo,nyhi,nzlo,nzhi,nfft);
@@ -698,7 +767,7 @@ void ComputeFFTGrid::fft_create()
   if (nfft2 > MAXSMALLINT) 
     error->all(FLERR,"Compute fft/grid FFT is too large per-processor");
 
-  // create FFT plan
+  // create real-to-complex FFT plan
 
   int collective_flag;
 #ifdef __bg__
@@ -711,12 +780,12 @@ void ComputeFFTGrid::fft_create()
   if (dimension == 3) {
     fft3d = new FFT3D(sparta,world,nx,ny,nz,
                       nxlo,nxhi,nylo,nyhi,nzlo,nzhi,
-                      nxlo,nxhi,nylo,nyhi,nzlo,nzhi,
-                      0,0,&tmp,collective_flag);
+                      0,nhalf-1,nylo,nyhi,nzlo,nzhi,
+                      0,0,&tmp,collective_flag,1);
   } else {
     fft2d = new FFT2D(sparta,world,nx,ny,
-                      nxlo,nxhi,nylo,nyhi,nxlo,nxhi,nylo,nyhi,
-                      0,0,&tmp,collective_flag);
+                      nxlo,nxhi,nylo,nyhi,0,nhalf-1,nylo,nyhi,
+                      0,0,&tmp,collective_flag,1);
   }
 }
 
@@ -796,59 +865,105 @@ void ComputeFFTGrid::irregular_create()
     map1[i] = (iz-nzlo)*nxfft*nyfft + (iy-nylo)*nxfft + (ix-nxlo);
   }
 
-  // plan for moving data from FFT grid -> SPARTA grid
-  // send my cell IDs in FFT grid order
-  //   back to proc who owns each in SPARTA grid->cells
-  // proclist3 generated from irregular1->reverse()
-  //   must permute proclist3 -> proclist2 via map1
-  //   same way that received grid data will be permuted by map1 to FFT data
-  // create map2 = how to reorder received FFT data on SPARTA grid proc
+  // plan for moving data from half-complex FFT grid -> SPARTA grid
+  // each SPARTA grid cell (ix,iy,iz) needs half-complex value (hx,hy,hz)
+  //   hx,hy,hz = ix,iy,iz if ix <= nx/2, else the -k point
+  //   (nx-ix,ny-iy,nz-iz) with PBC whose value is the conjugate
+  // send a request for each value to proc who owns it in FFT partition
+  //   request = offset into that proc's half-complex grid + local cell index
+  // irregular2 = reverse of request comm, so each FFT proc sends the
+  //   requested values in the order it received the requests
+  // requesting cell indices are sent back to create map2 and flip2
 
-  irregular2 = new Irregular(sparta);
+  Irregular *irequest = new Irregular(sparta);
 
-  memory->create(proclist3,nfft,"fft/grid:proclist2");
-  irregular1->reverse(nrecv,proclist3);
+  int *flip;
+  memory->create(proclist2,nglocal,"fft/grid:proclist2");
+  memory->create(flip,nglocal,"fft/grid:flip");
+  memory->create(sbuf2,nglocal*2*sizeof(int),"fft/grid:sbuf2");
+  int *request = (int *) sbuf2;
 
-  memory->create(proclist2,nfft,"fft/grid:proclist2");
-  for (i = 0; i < nfft; i++) proclist2[map1[i]] = proclist3[i];
+  int hx,hy,hz,ylo,zlo,nyproc;
 
-  nrecv = irregular2->create_data_uniform(nfft,proclist2);
-  if (nrecv != nglocal) 
-    error->one(FLERR,"Compute fft/grid FFT mapping is inconsistent");
+  for (i = 0; i < nglocal; i++) {
+    gid = cells[i].id;
+    ix = (gid-1) % nx;
+    iy = ((gid-1) / nx) % ny;
+    iz = (gid-1) / (nx*ny);
+
+    if (ix <= nx/2) {
+      hx = ix;
+      hy = iy;
+      hz = iz;
+      flip[i] = 0;
+    } else {
+      hx = nx - ix;
+      hy = (ny - iy) % ny;
+      hz = (nz - iz) % nz;
+      flip[i] = 1;
+    }
 
-  memory->create(sbuf2,nfft*sizeof(cellint),"fft/grid:sbuf2");
-  memory->create(rbuf2,nglocal*sizeof(cellint),"fft/grid:rbuf2");
+    ipy = static_cast<int> (1.0*hy/ny * npy);
+    while (1) {
+      if (hy >= ipy*ny/npy && hy < (ipy+1)*ny/npy) break;
+      ipy++;
+    }
+    ipz = static_cast<int> (1.0*hz/nz * npz);
+    while (1) {
+      if (hz >= ipz*nz/npz && hz < (ipz+1)*nz/npz) break;
+      ipz++;
+    }
 
-  idsend = (cellint *) sbuf2;
-  for (i = 0; i < nfft; i++) idsend[map1[i]] = idrecv[i];
+    proclist2[i] = ipz*npy + ipy;
 
-  irregular2->exchange_uniform(sbuf2,sizeof(cellint),rbuf2);
+    ylo = ipy*ny/npy;
+    zlo = ipz*nz/npz;
+    nyproc = (ipy+1)*ny/npy - ylo;
+    request[2*i] = (hz-zlo)*nhalf*nyproc + (hy-ylo)*nhalf + hx;
+    request[2*i+1] = i;
+  }
 
-  // insure grid cell IDs are hashed, so can use them to build map2
+  nsend2 = irequest->create_data_uniform(nglocal,proclist2);
 
-  if (!grid->hashfilled) grid->rehash();
+  memory->create(rbuf2,nsend2*2*sizeof(int),"fft/grid:rbuf2");
+  irequest->exchange_uniform(sbuf2,2*sizeof(int),rbuf2);
 
-#ifdef SPARTA_MAP
-  std::map<cellint,int> *hash = grid->hash;
-#elif defined SPARTA_UNORDERED_MAP
-  std::unordered_map<cellint,int> *hash = grid->hash;
-#else
-  std::tr1::unordered_map<cellint,int> *hash = grid->hash;
-#endif
+  memory->create(proclist3,nsend2,"fft/grid:proclist3");
+  irequest->reverse(nsend2,proclist3);
+  delete irequest;
 
-  idrecv = (cellint *) rbuf2;
+  irregular2 = new Irregular(sparta);
 
-  memory->create(map2,nglocal,"fft/grid:map1");
-  for (i = 0; i < nglocal; i++) {
-    gid = idrecv[i];
-    map2[i] = (*hash)[gid] - 1;
+  nrecv = irregular2->create_data_uniform(nsend2,proclist3);
+  if (nrecv != nglocal) 
+    error->one(FLERR,"Compute fft/grid FFT mapping is inconsistent");
+
+  memory->create(sendmap,nsend2,"fft/grid:sendmap");
+  int *cellsend;
+  memory->create(cellsend,nsend2,"fft/grid:cellsend");
+
+  request = (int *) rbuf2;
+  for (i = 0; i < nsend2; i++) {
+    sendmap[i] = request[2*i];
+    cellsend[i] = request[2*i+1];
   }
 
+  memory->create(map2,nglocal,"fft/grid:map2");
+  memory->create(flip2,nglocal,"fft/grid:flip2");
+
+  irregular2->exchange_uniform((char *) cellsend,sizeof(int),(char *) map2);
+  for (i = 0; i < nglocal; i++) flip2[i] = flip[map2[i]];
+
+  if (conjugate) memory->create(fftsend,nsend2,"fft/grid:fftsend");
+  else memory->create(fftsend,2*nsend2,"fft/grid:fftsend");
+
   // clean up
 
   memory->destroy(proclist1);
   memory->destroy(proclist2);
   memory->destroy(proclist3);
+  memory->destroy(flip);
+  memory->destroy(cellsend);
   memory->destroy(sbuf1);
   memory->destroy(rbuf1);
   memory->destroy(sbuf2);
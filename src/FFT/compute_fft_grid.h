@@ -59,14 +59,18 @@ class ComputeFFTGrid : public Compute {
   int nxlo,nxhi,nylo,nyhi,nzlo,nzhi;   // bounds of FFT grid on this proc
   int nxfft,nyfft,nzfft;               // extent of FFT grid on this proc
   int nfft;                            // # of owned FFT decomp values
+  int nhalf;                           // nx/2+1 = extent of half-complex grid
+  int nhfft;                           // # of owned half-complex FFT values
 
   double *ingrid;      // input grid values from compute,fix,variable
                        // may be NULL if ingridptr just points to c/f/v
   double *fftwork;     // work buf in FFT decomp, length = nfft
   double *gridwork;    // work buf in grid decomp, length = nglocal
 
-  FFT_SCALAR *fft;     // complex buf for performing FFT, length = nfft
-  FFT_SCALAR *gridworkcomplex;  // work buf in grid decomp, length = nglocal
+  FFT_SCALAR *fftreal; // real input buf for r2c FFT, length = nfft
+  FFT_SCALAR *fft;     // half-complex output buf of r2c FFT, length = nhfft
+  double *fftsend;     // values sent from FFT decomp, length = nsend2
+  double *gridworkcomplex;      // work buf in grid decomp, length = nglocal
 
   int *map1;            // mapping of received SPARTA grid values to FFT grid
                         // map1[i] = index into ordered FFT grid of 
@@ -76,6 +80,15 @@ class ComputeFFTGrid : public Compute {
                         // map2[i] = index into SPARTA grid of Ith value
                         //           in buffer received from FFT decomp via
                         //           irregular comm
+  int *flip2;           // flip2[i] = 1 if Ith received value is the
+                        //            complex conjugate of the half-complex
+                        //            value sent, else 0
+  int nsend2;           // # of half-complex values this proc sends
+  int *sendmap;         // sendmap[i] = index into half-complex FFT grid of
+                        //              Ith value sent to SPARTA decomp
+
+  int ngcache;          // # of cell IDs in gcache, -1 if never set
+  cellint *gcache;      // owned cell IDs when comm patterns were created
 
   class FFT3D *fft3d;
   class FFT2D *fft2d;
@@ -83,6 +96,8 @@ class ComputeFFTGrid : public Compute {
 
   void fft_create();
   void irregular_create();
+  int grid_changed();
+  void kspace();
   void procs2grid2d(int, int, int, int &, int &);
   int factorable(int);
   void debug(const char *, int, double *, int *, cellint *, int stride=1);
@@ -15,6 +15,7 @@
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include "fft2d.h"
 #include "remap2d.h"
 
@@ -27,6 +28,28 @@
 #define MIN(A,B) ((A) < (B)) ? (A) : (B)
 #define MAX(A,B) ((A) > (B)) ? (A) : (B)
 
+/* ----------------------------------------------------------------------
+   use threaded FFTW3 plans if FFTW3 threads library is linked
+   # of threads is set by OMP_NUM_THREADS environment variable, default 1
+------------------------------------------------------------------------- */
+
+#if defined(FFT_FFTW3) && defined(FFT_FFTW_THREADS)
+static void fft_2d_threads()
+{
+  static int initflag = 0;
+  if (!initflag) {
+    FFTW_API(init_threads)();
+    initflag = 1;
+  }
+
+  int nthreads = 1;
+  char *str = getenv("OMP_NUM_THREADS");
+  if (str) nthreads = atoi(str);
+  if (nthreads < 1) nthreads = 1;
+  FFTW_API(plan_with_nthreads)(nthreads);
+}
+#endif
+
 /* ----------------------------------------------------------------------
    Data layout for 2d FFTs:
 
@@ -86,34 +109,37 @@ void fft_2d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_2d *plan)
   } else data = in;
 
   // 1d FFTs along fast axis
+  // skipped if done by a real-to-complex plan
 
-  total = plan->total1;
-  length = plan->length1;
+  if (!plan->skipfast) {
+    total = plan->total1;
+    length = plan->length1;
 
 #if defined(FFT_MKL)
-  if (flag == -1)
-    DftiComputeForward(plan->handle_fast,data);
-  else
-    DftiComputeBackward(plan->handle_fast,data);
+    if (flag == -1)
+      DftiComputeForward(plan->handle_fast,data);
+    else
+      DftiComputeBackward(plan->handle_fast,data);
 #elif defined(FFT_FFTW2)
-  if (flag == -1)
-    fftw(plan->plan_fast_forward,total/length,data,1,length,NULL,0,0);
-  else
-    fftw(plan->plan_fast_backward,total/length,data,1,length,NULL,0,0);
+    if (flag == -1)
+      fftw(plan->plan_fast_forward,total/length,data,1,length,NULL,0,0);
+    else
+      fftw(plan->plan_fast_backward,total/length,data,1,length,NULL,0,0);
 #elif defined(FFT_FFTW3)
-  if (flag == -1)
-    theplan=plan->plan_fast_forward;
-  else
-    theplan=plan->plan_fast_backward;
-  FFTW_API(execute_dft)(theplan,data,data);
+    if (flag == -1)
+      theplan=plan->plan_fast_forward;
+    else
+      theplan=plan->plan_fast_backward;
+    FFTW_API(execute_dft)(theplan,data,data);
 #else
-  if (flag == -1)
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_fast_forward,&data[offset],&data[offset]);
-  else
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_fast_backward,&data[offset],&data[offset]);
+    if (flag == -1)
+      for (offset = 0; offset < total; offset += length)
+        kiss_fft(plan->cfg_fast_forward,&data[offset],&data[offset]);
+    else
+      for (offset = 0; offset < total; offset += length)
+        kiss_fft(plan->cfg_fast_backward,&data[offset],&data[offset]);
 #endif
+  }
 
   // mid-remap to prepare for 2nd FFTs
   // copy = loc for remap result
@@ -224,6 +250,7 @@ struct fft_plan_2d *fft_2d_create_plan(
 
   plan = (struct fft_plan_2d *) malloc(sizeof(struct fft_plan_2d));
   if (plan == NULL) return NULL;
+  plan->skipfast = 0;
 
   // remap from initial distribution to layout needed for 1st set of 1d FFTs
   // not needed if all procs own entire fast axis initially
@@ -419,6 +446,9 @@ struct fft_plan_2d *fft_2d_create_plan(
   }
 
 #elif defined(FFT_FFTW3)
+#if defined(FFT_FFTW_THREADS)
+  fft_2d_threads();
+#endif
   plan->plan_fast_forward =
     FFTW_API(plan_many_dft)(1, &nfast,plan->total1/plan->length1,
                             NULL,&nfast,1,plan->length1,
@@ -513,6 +543,409 @@ void fft_2d_destroy_plan(struct fft_plan_2d *plan)
   free(plan);
 }
 
+/* ----------------------------------------------------------------------
+   1d real-to-complex FFTs along all fast pencils of an r2c plan
+   real -> half with exp(-2 pi i) convention
+   FFTW2 and KISS FFT transform each real pencil of length N = 2M
+     as a complex pencil z of length M = even + i*odd values, then
+     X(k) = E(k) + exp(-2 pi i k/N) O(k), k = 0 to M, where
+     E(k) = (Z(k) + conj(Z(M-k)))/2, O(k) = (Z(k) - conj(Z(M-k)))/2i
+------------------------------------------------------------------------- */
+
+static void fft_2d_r2c_pencils(struct fft_plan_2d_r2c *plan)
+{
+  if (plan->npencil == 0) return;
+
+#if defined(FFT_MKL)
+  DftiComputeForward(plan->handle_r2c,plan->real,plan->half);
+#elif defined(FFT_FFTW3)
+  FFTW_API(execute)(plan->plan_r2c);
+#else
+  int p,k,kz,mkz;
+  FFT_SCALAR er,ei,odr,odi;
+  int nfast = plan->nfast;
+  int nhalf = plan->nhalf;
+  int m = nfast/2;
+  FFT_SCALAR *z = plan->work;
+  FFT_SCALAR *w = plan->twiddle;
+
+  for (p = 0; p < plan->npencil; p++) {
+    FFT_SCALAR *x = &plan->real[p*nfast];
+    FFT_SCALAR *h = (FFT_SCALAR *) &plan->half[p*nhalf];
+
+#if defined(FFT_FFTW2)
+    fftw_one(plan->plan_half_forward,(FFTW_COMPLEX *) x,(FFTW_COMPLEX *) z);
+#else
+    kiss_fft(plan->cfg_half_forward,(FFT_DATA *) x,(FFT_DATA *) z);
+#endif
+
+    for (k = 0; k <= m; k++) {
+      kz = 2*(k % m);
+      mkz = 2*((m-k) % m);
+      er = 0.5*(z[kz] + z[mkz]);
+      ei = 0.5*(z[kz+1] - z[mkz+1]);
+      odr = 0.5*(z[kz+1] + z[mkz+1]);
+      odi = -0.5*(z[kz] - z[mkz]);
+      h[2*k] = er + w[2*k]*odr - w[2*k+1]*odi;
+      h[2*k+1] = ei + w[2*k]*odi + w[2*k+1]*odr;
+    }
+  }
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   1d complex-to-real FFTs along all fast pencils of an r2c plan
+   half -> real with exp(+2 pi i) convention, unnormalized
+   inverse of the FFTW2 and KISS FFT packing in fft_2d_r2c_pencils(),
+     Z(k) = E(k) + i O(k) is recovered from X(k) and X(M-k) and
+     transformed back to the even + i*odd values, times 2M = N
+   input half values are overwritten
+------------------------------------------------------------------------- */
+
+static void fft_2d_c2r_pencils(struct fft_plan_2d_r2c *plan)
+{
+  if (plan->npencil == 0) return;
+
+#if defined(FFT_MKL)
+  DftiComputeBackward(plan->handle_c2r,plan->half,plan->real);
+#elif defined(FFT_FFTW3)
+  FFTW_API(execute)(plan->plan_c2r);
+#else
+  int p,k;
+  FFT_SCALAR ar,ai,dr,di,br,bi;
+  int nfast = plan->nfast;
+  int nhalf = plan->nhalf;
+  int m = nfast/2;
+  FFT_SCALAR *z = plan->work;
+  FFT_SCALAR *w = plan->twiddle;
+
+  for (p = 0; p < plan->npencil; p++) {
+    FFT_SCALAR *x = &plan->real[p*nfast];
+    FFT_SCALAR *h = (FFT_SCALAR *) &plan->half[p*nhalf];
+
+    for (k = 0; k < m; k++) {
+      ar = h[2*k] + h[2*(m-k)];
+      ai = h[2*k+1] - h[2*(m-k)+1];
+      dr = h[2*k] - h[2*(m-k)];
+      di = h[2*k+1] + h[2*(m-k)+1];
+      br = dr*w[2*k] + di*w[2*k+1];
+      bi = di*w[2*k] - dr*w[2*k+1];
+      z[2*k] = ar - bi;
+      z[2*k+1] = ai + br;
+    }
+
+#if defined(FFT_FFTW2)
+    fftw_one(plan->plan_half_backward,(FFTW_COMPLEX *) z,(FFTW_COMPLEX *) x);
+#else
+    kiss_fft(plan->cfg_half_backward,(FFT_DATA *) z,(FFT_DATA *) x);
+#endif
+  }
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   Perform real-to-complex 2d FFT
+
+   Arguments:
+   in           starting address of real input data on this proc
+   out          starting address of where half-complex output data
+                  for this proc will be placed, cannot be same as in
+   flag         1 for exp(+2 pi i) FFT, -1 for exp(-2 pi i) FFT,
+                  same sign convention as fft_2d()
+   plan         plan returned by previous call to fft_2d_r2c_create_plan
+------------------------------------------------------------------------- */
+
+void fft_2d_r2c(FFT_SCALAR *in, FFT_DATA *out, int flag,
+                struct fft_plan_2d_r2c *plan)
+{
+  int i;
+
+  // remap real input to fast pencils, or copy if already in pencils
+
+  if (plan->pre_plan)
+    remap_2d(in,plan->real,NULL,plan->pre_plan);
+  else
+    for (i = 0; i < plan->nin; i++) plan->real[i] = in[i];
+
+  // 1d r2c FFTs along fast axis
+  // FFT of real data with exp(+2 pi i) is conjugate of exp(-2 pi i)
+
+  fft_2d_r2c_pencils(plan);
+
+  if (flag == 1) {
+    FFT_SCALAR *h = (FFT_SCALAR *) plan->half;
+    int n = plan->npencil * plan->nhalf;
+    for (i = 0; i < n; i++) h[2*i+1] = -h[2*i+1];
+  }
+
+  // slow FFTs of half-complex data and remap to output
+
+  fft_2d(plan->half,out,flag,plan->forward);
+
+  if (flag == 1 && plan->scaled) {
+    FFT_SCALAR norm = plan->norm;
+    FFT_SCALAR *o = (FFT_SCALAR *) out;
+    int n = 2*plan->nout;
+    for (i = 0; i < n; i++) o[i] *= norm;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   Perform complex-to-real 2d FFT, inverse of fft_2d_r2c()
+
+   Arguments:
+   in           starting address of half-complex input data on this proc
+   out          starting address of where real output data for this proc
+                  will be placed, cannot be same as in
+   flag         1 for exp(+2 pi i) FFT, -1 for exp(-2 pi i) FFT
+   plan         plan returned by previous call to fft_2d_r2c_create_plan
+------------------------------------------------------------------------- */
+
+void fft_2d_c2r(FFT_DATA *in, FFT_SCALAR *out, int flag,
+                struct fft_plan_2d_r2c *plan)
+{
+  int i;
+
+  // remap input to half-complex fast pencils with slow FFTs
+
+  fft_2d(in,plan->half,flag,plan->backward);
+
+  // 1d c2r FFTs along fast axis
+  // c2r with exp(-2 pi i) is c2r with exp(+2 pi i) of conjugate
+
+  if (flag == -1) {
+    FFT_SCALAR *h = (FFT_SCALAR *) plan->half;
+    int n = plan->npencil * plan->nhalf;
+    for (i = 0; i < n; i++) h[2*i+1] = -h[2*i+1];
+  }
+
+  fft_2d_c2r_pencils(plan);
+
+  // remap real fast pencils to output, or copy if already in pencils
+
+  if (plan->post_plan)
+    remap_2d(plan->real,out,NULL,plan->post_plan);
+  else
+    for (i = 0; i < plan->nin; i++) out[i] = plan->real[i];
+
+  if (flag == 1 && plan->scaled) {
+    FFT_SCALAR norm = plan->norm;
+    for (i = 0; i < plan->nin; i++) out[i] *= norm;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   Create plan for performing a real-to-complex 2d FFT and its inverse
+
+   Arguments:
+   comm                 MPI communicator for the P procs which own the data
+   nfast,nslow          size of global 2d real matrix, nfast must be even
+   in_ilo,in_ihi        bounds of real data I own in fast index
+   in_jlo,in_jhi        bounds of real data I own in slow index
+   out_ilo,out_ihi      bounds of half-complex data I own in fast index,
+                          from 0 to nfast/2 inclusive
+   out_jlo,out_jhi      bounds of half-complex data I own in slow index
+   scaled               0 = no scaling of result, 1 = scaling
+   nbuf                 returns size of internal storage buffers used by FFT
+   usecollective        use collective MPI operations for remapping data
+------------------------------------------------------------------------- */
+
+struct fft_plan_2d_r2c *fft_2d_r2c_create_plan(
+       MPI_Comm comm, int nfast, int nslow,
+       int in_ilo, int in_ihi, int in_jlo, int in_jhi,
+       int out_ilo, int out_ihi, int out_jlo, int out_jhi,
+       int scaled, int *nbuf, int usecollective)
+{
+  struct fft_plan_2d_r2c *plan;
+  int me,nprocs;
+  int flag,remapflag,nbuf1,nbuf2,nreal,nhalf;
+  int first_jlo,first_jhi;
+
+  if (nfast % 2) return NULL;
+
+  MPI_Comm_rank(comm,&me);
+  MPI_Comm_size(comm,&nprocs);
+
+  plan = (struct fft_plan_2d_r2c *) malloc(sizeof(struct fft_plan_2d_r2c));
+  if (plan == NULL) return NULL;
+
+  plan->nfast = nfast;
+  plan->nhalf = nfast/2 + 1;
+  plan->nin = (in_ihi-in_ilo+1) * (in_jhi-in_jlo+1);
+  plan->nout = (out_ihi-out_ilo+1) * (out_jhi-out_jlo+1);
+
+  // real data must be in pencils along entire fast axis for 1d r2c FFTs
+  // remap real data to and from pencils unless all procs own entire axis
+
+  if (in_ilo == 0 && in_ihi == nfast-1) flag = 0;
+  else flag = 1;
+
+  MPI_Allreduce(&flag,&remapflag,1,MPI_INT,MPI_MAX,comm);
+
+  if (remapflag == 0) {
+    first_jlo = in_jlo;
+    first_jhi = in_jhi;
+    plan->pre_plan = plan->post_plan = NULL;
+  } else {
+    first_jlo = me*nslow/nprocs;
+    first_jhi = (me+1)*nslow/nprocs - 1;
+    plan->pre_plan =
+      remap_2d_create_plan(comm,in_ilo,in_ihi,in_jlo,in_jhi,
+                           0,nfast-1,first_jlo,first_jhi,
+                           1,0,1,FFT_PRECISION);
+    if (plan->pre_plan == NULL) return NULL;
+    plan->post_plan =
+      remap_2d_create_plan(comm,0,nfast-1,first_jlo,first_jhi,
+                           in_ilo,in_ihi,in_jlo,in_jhi,
+                           1,0,1,FFT_PRECISION);
+    if (plan->post_plan == NULL) return NULL;
+  }
+
+  plan->npencil = first_jhi-first_jlo+1;
+
+  // complex plans for slow FFTs of the half-complex data
+  // fast axis of these plans is done by 1d r2c and c2r FFTs
+
+  plan->forward =
+    fft_2d_create_plan(comm,plan->nhalf,nslow,
+                       0,plan->nhalf-1,first_jlo,first_jhi,
+                       out_ilo,out_ihi,out_jlo,out_jhi,
+                       0,0,&nbuf1,usecollective);
+  if (plan->forward == NULL) return NULL;
+  plan->forward->skipfast = 1;
+
+  plan->backward =
+    fft_2d_create_plan(comm,plan->nhalf,nslow,
+                       out_ilo,out_ihi,out_jlo,out_jhi,
+                       0,plan->nhalf-1,first_jlo,first_jhi,
+                       0,0,&nbuf2,usecollective);
+  if (plan->backward == NULL) return NULL;
+  plan->backward->skipfast = 1;
+
+  // real and half-complex fast pencils
+
+  nreal = plan->npencil*nfast;
+  if (nreal == 0) nreal = 1;
+  nhalf = plan->npencil*plan->nhalf;
+  if (nhalf == 0) nhalf = 1;
+
+  plan->real = (FFT_SCALAR *) malloc(nreal*sizeof(FFT_SCALAR));
+  plan->half = (FFT_DATA *) malloc(nhalf*sizeof(FFT_DATA));
+  if (plan->real == NULL || plan->half == NULL) return NULL;
+
+  *nbuf = nbuf1 + nbuf2 + plan->npencil*plan->nhalf +
+    (plan->npencil*nfast+1)/2;
+
+  if (scaled == 0) plan->scaled = 0;
+  else {
+    plan->scaled = 1;
+    plan->norm = 1.0/((double) nfast*nslow);
+  }
+
+  // system specific pre-computation of 1d real FFTs
+
+#if defined(FFT_MKL)
+  plan->handle_r2c = plan->handle_c2r = NULL;
+  if (plan->npencil) {
+    DftiCreateDescriptor(&(plan->handle_r2c),FFT_MKL_PREC,DFTI_REAL,1,
+                         (MKL_LONG)nfast);
+    DftiSetValue(plan->handle_r2c,DFTI_NUMBER_OF_TRANSFORMS,
+                 (MKL_LONG)plan->npencil);
+    DftiSetValue(plan->handle_r2c,DFTI_PLACEMENT,DFTI_NOT_INPLACE);
+    DftiSetValue(plan->handle_r2c,DFTI_CONJUGATE_EVEN_STORAGE,
+                 DFTI_COMPLEX_COMPLEX);
+    DftiSetValue(plan->handle_r2c,DFTI_INPUT_DISTANCE,(MKL_LONG)nfast);
+    DftiSetValue(plan->handle_r2c,DFTI_OUTPUT_DISTANCE,(MKL_LONG)plan->nhalf);
+    DftiCommitDescriptor(plan->handle_r2c);
+
+    DftiCreateDescriptor(&(plan->handle_c2r),FFT_MKL_PREC,DFTI_REAL,1,
+                         (MKL_LONG)nfast);
+    DftiSetValue(plan->handle_c2r,DFTI_NUMBER_OF_TRANSFORMS,
+                 (MKL_LONG)plan->npencil);
+    DftiSetValue(plan->handle_c2r,DFTI_PLACEMENT,DFTI_NOT_INPLACE);
+    DftiSetValue(plan->handle_c2r,DFTI_CONJUGATE_EVEN_STORAGE,
+                 DFTI_COMPLEX_COMPLEX);
+    DftiSetValue(plan->handle_c2r,DFTI_INPUT_DISTANCE,(MKL_LONG)plan->nhalf);
+    DftiSetValue(plan->handle_c2r,DFTI_OUTPUT_DISTANCE,(MKL_LONG)nfast);
+    DftiCommitDescriptor(plan->handle_c2r);
+  }
+
+#elif defined(FFT_FFTW3)
+#if defined(FFT_FFTW_THREADS)
+  fft_2d_threads();
+#endif
+  plan->plan_r2c = plan->plan_c2r = NULL;
+  if (plan->npencil) {
+    plan->plan_r2c =
+      FFTW_API(plan_many_dft_r2c)(1,&nfast,plan->npencil,
+                                  plan->real,NULL,1,nfast,
+                                  plan->half,NULL,1,plan->nhalf,
+                                  FFTW_ESTIMATE);
+    plan->plan_c2r =
+      FFTW_API(plan_many_dft_c2r)(1,&nfast,plan->npencil,
+                                  plan->half,NULL,1,plan->nhalf,
+                                  plan->real,NULL,1,nfast,
+                                  FFTW_ESTIMATE);
+  }
+
+#else
+  int m = nfast/2;
+#if defined(FFT_FFTW2)
+  plan->plan_half_forward = fftw_create_plan(m,FFTW_FORWARD,FFTW_ESTIMATE);
+  plan->plan_half_backward = fftw_create_plan(m,FFTW_BACKWARD,FFTW_ESTIMATE);
+#else
+  plan->cfg_half_forward = kiss_fft_alloc(m,0,NULL,NULL);
+  plan->cfg_half_backward = kiss_fft_alloc(m,1,NULL,NULL);
+#endif
+  plan->work = (FFT_SCALAR *) malloc(2*m*sizeof(FFT_SCALAR));
+  plan->twiddle = (FFT_SCALAR *) malloc(2*(m+1)*sizeof(FFT_SCALAR));
+  if (plan->work == NULL || plan->twiddle == NULL) return NULL;
+
+  double pi = 4.0*atan(1.0);
+  for (int k = 0; k <= m; k++) {
+    plan->twiddle[2*k] = cos(2.0*pi*k/nfast);
+    plan->twiddle[2*k+1] = -sin(2.0*pi*k/nfast);
+  }
+#endif
+
+  return plan;
+}
+
+/* ----------------------------------------------------------------------
+   Destroy a real-to-complex 2d fft plan
+------------------------------------------------------------------------- */
+
+void fft_2d_r2c_destroy_plan(struct fft_plan_2d_r2c *plan)
+{
+  if (plan->pre_plan) remap_2d_destroy_plan(plan->pre_plan);
+  if (plan->post_plan) remap_2d_destroy_plan(plan->post_plan);
+  fft_2d_destroy_plan(plan->forward);
+  fft_2d_destroy_plan(plan->backward);
+
+  free(plan->real);
+  free(plan->half);
+
+#if defined(FFT_MKL)
+  if (plan->handle_r2c) DftiFreeDescriptor(&(plan->handle_r2c));
+  if (plan->handle_c2r) DftiFreeDescriptor(&(plan->handle_c2r));
+#elif defined(FFT_FFTW3)
+  if (plan->plan_r2c) FFTW_API(destroy_plan)(plan->plan_r2c);
+  if (plan->plan_c2r) FFTW_API(destroy_plan)(plan->plan_c2r);
+#else
+#if defined(FFT_FFTW2)
+  fftw_destroy_plan(plan->plan_half_forward);
+  fftw_destroy_plan(plan->plan_half_backward);
+#else
+  free(plan->cfg_half_forward);
+  free(plan->cfg_half_backward);
+#endif
+  free(plan->work);
+  free(plan->twiddle);
+#endif
+
+  free(plan);
+}
+
 /* ----------------------------------------------------------------------
    recursively divide n into small factors, return them in list
 ------------------------------------------------------------------------- */
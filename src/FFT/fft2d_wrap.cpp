@@ -23,9 +23,26 @@ using namespace SPARTA_NS;
 FFT2D::FFT2D(SPARTA *spa, MPI_Comm comm, int nfast, int nslow,
              int in_ilo, int in_ihi, int in_jlo, int in_jhi,
              int out_ilo, int out_ihi, int out_jlo, int out_jhi,
-             int scaled, int permute, int *nbuf, int usecollective) : 
+             int scaled, int permute, int *nbuf, int usecollective,
+             int r2c) : 
   Pointers(spa)
 {
+  plan = NULL;
+  rplan = NULL;
+
+  // real-to-complex plan: input is real, output is half-complex
+  //   with out_ilo,out_ihi in 0 to nfast/2 and no permutation
+
+  if (r2c) {
+    rplan = fft_2d_r2c_create_plan(comm,nfast,nslow,
+                                   in_ilo,in_ihi,in_jlo,in_jhi,
+                                   out_ilo,out_ihi,out_jlo,out_jhi,
+                                   scaled,nbuf,usecollective);
+    if (rplan == NULL)
+      error->one(FLERR,"Could not create 2d real-to-complex FFT plan");
+    return;
+  }
+
   plan = fft_2d_create_plan(comm,nfast,nslow,
                             in_ilo,in_ihi,in_jlo,in_jhi,
                             out_ilo,out_ihi,out_jlo,out_jhi,
@@ -37,7 +54,8 @@ FFT2D::FFT2D(SPARTA *spa, MPI_Comm comm, int nfast, int nslow,
 
 FFT2D::~FFT2D()
 {
-  fft_2d_destroy_plan(plan);
+  if (plan) fft_2d_destroy_plan(plan);
+  if (rplan) fft_2d_r2c_destroy_plan(rplan);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -47,9 +65,28 @@ void FFT2D::compute(FFT_SCALAR *in, FFT_SCALAR *out, int flag)
   fft_2d((FFT_DATA *) in,(FFT_DATA *) out,flag,plan);
 }
 
+/* ----------------------------------------------------------------------
+   forward transform of real in to half-complex out with a real-to-complex plan
+------------------------------------------------------------------------- */
+
+void FFT2D::compute_r2c(FFT_SCALAR *in, FFT_SCALAR *out, int flag)
+{
+  fft_2d_r2c(in,(FFT_DATA *) out,flag,rplan);
+}
+
+/* ----------------------------------------------------------------------
+   inverse transform of half-complex in to real out with a real-to-complex plan
+------------------------------------------------------------------------- */
+
+void FFT2D::compute_c2r(FFT_SCALAR *in, FFT_SCALAR *out, int flag)
+{
+  fft_2d_c2r((FFT_DATA *) in,out,flag,rplan);
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FFT2D::timing1d(FFT_SCALAR *in, int nsize, int flag)
 {
-  fft_2d_1d_only((FFT_DATA *) in,nsize,flag,plan);
+  if (plan) fft_2d_1d_only((FFT_DATA *) in,nsize,flag,plan);
+  else fft_2d_1d_only((FFT_DATA *) in,nsize,flag,rplan->forward);
 }
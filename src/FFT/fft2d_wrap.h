@@ -23,13 +23,17 @@ namespace SPARTA_NS {
 class FFT2D : protected Pointers {
  public:
   FFT2D(class SPARTA *, MPI_Comm,
-        int,int,int,int,int,int,int,int,int,int,int,int,int *,int);
+        int,int,int,int,int,int,int,int,int,int,int,int,int *,int,
+        int r2c = 0);
   ~FFT2D();
   void compute(FFT_SCALAR *, FFT_SCALAR *, int);
+  void compute_r2c(FFT_SCALAR *, FFT_SCALAR *, int);
+  void compute_c2r(FFT_SCALAR *, FFT_SCALAR *, int);
   void timing1d(FFT_SCALAR *, int, int);
 
  private:
-  struct fft_plan_2d *plan;
+  struct fft_plan_2d *plan;          // complex-to-complex plan
+  struct fft_plan_2d_r2c *rplan;     // real-to-complex plan
 };
 
 }
@@ -44,4 +48,9 @@ The FFT setup for the PPPM solver failed, typically due
 to lack of memory.  This is an unusual error.  Check the
 size of the FFT grid you are requesting.
 
+E: Could not create 2d real-to-complex FFT plan
+
+The FFT setup for a real-to-complex transform failed, either due
+to lack of memory or because the fast FFT dimension is not even.
+
 */
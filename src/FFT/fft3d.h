@@ -49,6 +49,7 @@ struct fft_plan_3d {
   int scaled;                       // whether to scale FFT results
   int normnum;                      // # of values to rescale
   double norm;                      // normalization factor for rescaling
+  int skipfast;                     // 1 if fast axis is done by r2c/c2r plan
 
                                     // system specific 1d FFT info
 #if defined(FFT_MKL)
@@ -79,6 +80,46 @@ struct fft_plan_3d {
 #endif
 };
 
+// details of how to do a real-to-complex 3d FFT and its complex-to-real inverse
+// real data is Nfast x Nmid x Nslow, Nfast must be even
+// complex data is the non-redundant half, Nfast/2+1 x Nmid x Nslow
+
+struct fft_plan_3d_r2c {
+  struct remap_plan_3d *pre_plan;   // real remap from input -> fast pencils
+  struct remap_plan_3d *post_plan;  // real remap from fast pencils -> input
+  struct fft_plan_3d *forward;      // half-complex mid/slow FFTs -> output
+  struct fft_plan_3d *backward;     // half-complex mid/slow FFTs <- output
+  FFT_SCALAR *real;                 // real values in fast pencils
+  FFT_DATA *half;                   // half-complex values in fast pencils
+  int nfast,nhalf;                  // length of real and half-complex pencils
+  int npencil;                      // # of fast pencils I own
+  int nin;                          // # of real values I own on input
+  int nout;                         // # of complex values I own on output
+  int scaled;                       // whether to scale FFT results
+  double norm;                      // normalization factor for rescaling
+
+                                    // system specific 1d real FFT info
+#if defined(FFT_MKL)
+  DFTI_DESCRIPTOR *handle_r2c;
+  DFTI_DESCRIPTOR *handle_c2r;
+#elif defined(FFT_FFTW3)
+  FFTW_API(plan) plan_r2c;
+  FFTW_API(plan) plan_c2r;
+#else
+                                    // FFTW2 and KISS FFT pack a real pencil
+                                    // into a half-length complex pencil
+#if defined(FFT_FFTW2)
+  fftw_plan plan_half_forward;
+  fftw_plan plan_half_backward;
+#else
+  kiss_fft_cfg cfg_half_forward;
+  kiss_fft_cfg cfg_half_backward;
+#endif
+  FFT_SCALAR *work;                 // one half-length complex pencil
+  FFT_SCALAR *twiddle;              // exp(-2 pi i k/Nfast) for k <= Nfast/2
+#endif
+};
+
 // function prototypes
 
 extern "C" {
@@ -91,6 +132,13 @@ extern "C" {
   void factor(int, int *, int *);
   void bifactor(int, int *, int *);
   void fft_3d_1d_only(FFT_DATA *, int, int, struct fft_plan_3d *);
+  void fft_3d_r2c(FFT_SCALAR *, FFT_DATA *, int, struct fft_plan_3d_r2c *);
+  void fft_3d_c2r(FFT_DATA *, FFT_SCALAR *, int, struct fft_plan_3d_r2c *);
+  struct fft_plan_3d_r2c *fft_3d_r2c_create_plan(MPI_Comm, int, int, int,
+                                                 int, int, int, int, int, int,
+                                                 int, int, int, int, int, int,
+                                                 int, int *, int);
+  void fft_3d_r2c_destroy_plan(struct fft_plan_3d_r2c *);
 }
 
 /* ERROR/WARNING messages:
@@ -25,9 +25,27 @@ FFT3D::FFT3D(SPARTA *spa, MPI_Comm comm, int nfast, int nmid, int nslow,
              int in_klo, int in_khi,
              int out_ilo, int out_ihi, int out_jlo, int out_jhi,
              int out_klo, int out_khi,
-             int scaled, int permute, int *nbuf, int usecollective) : 
+             int scaled, int permute, int *nbuf, int usecollective,
+             int r2c) : 
   Pointers(spa)
 {
+  plan = NULL;
+  rplan = NULL;
+
+  // real-to-complex plan: input is real, output is half-complex
+  //   with out_ilo,out_ihi in 0 to nfast/2 and no permutation
+
+  if (r2c) {
+    rplan = fft_3d_r2c_create_plan(comm,nfast,nmid,nslow,
+                                   in_ilo,in_ihi,in_jlo,in_jhi,in_klo,in_khi,
+                                   out_ilo,out_ihi,out_jlo,out_jhi,
+                                   out_klo,out_khi,
+                                   scaled,nbuf,usecollective);
+    if (rplan == NULL)
+      error->one(FLERR,"Could not create 3d real-to-complex FFT plan");
+    return;
+  }
+
   plan = fft_3d_create_plan(comm,nfast,nmid,nslow,
                             in_ilo,in_ihi,in_jlo,in_jhi,in_klo,in_khi,
                             out_ilo,out_ihi,out_jlo,out_jhi,out_klo,out_khi,
@@ -39,7 +57,8 @@ FFT3D::FFT3D(SPARTA *spa, MPI_Comm comm, int nfast, int nmid, int nslow,
 
 FFT3D::~FFT3D()
 {
-  fft_3d_destroy_plan(plan);
+  if (plan) fft_3d_destroy_plan(plan);
+  if (rplan) fft_3d_r2c_destroy_plan(rplan);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -49,9 +68,28 @@ void FFT3D::compute(FFT_SCALAR *in, FFT_SCALAR *out, int flag)
   fft_3d((FFT_DATA *) in,(FFT_DATA *) out,flag,plan);
 }
 
+/* ----------------------------------------------------------------------
+   forward transform of real in to half-complex out with a real-to-complex plan
+------------------------------------------------------------------------- */
+
+void FFT3D::compute_r2c(FFT_SCALAR *in, FFT_SCALAR *out, int flag)
+{
+  fft_3d_r2c(in,(FFT_DATA *) out,flag,rplan);
+}
+
+/* ----------------------------------------------------------------------
+   inverse transform of half-complex in to real out with a real-to-complex plan
+------------------------------------------------------------------------- */
+
+void FFT3D::compute_c2r(FFT_SCALAR *in, FFT_SCALAR *out, int flag)
+{
+  fft_3d_c2r((FFT_DATA *) in,out,flag,rplan);
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FFT3D::timing1d(FFT_SCALAR *in, int nsize, int flag)
 {
-  fft_3d_1d_only((FFT_DATA *) in,nsize,flag,plan);
+  if (plan) fft_3d_1d_only((FFT_DATA *) in,nsize,flag,plan);
+  else fft_3d_1d_only((FFT_DATA *) in,nsize,flag,rplan->forward);
 }
@@ -24,13 +24,17 @@ class FFT3D : protected Pointers {
  public:
   FFT3D(class SPARTA *, MPI_Comm,
         int,int,int,int,int,int,int,int,int,int,int,int,int,int,int,
-        int,int,int *,int);
+        int,int,int *,int,
+        int r2c = 0);
   ~FFT3D();
   void compute(FFT_SCALAR *, FFT_SCALAR *, int);
+  void compute_r2c(FFT_SCALAR *, FFT_SCALAR *, int);
+  void compute_c2r(FFT_SCALAR *, FFT_SCALAR *, int);
   void timing1d(FFT_SCALAR *, int, int);
 
  private:
-  struct fft_plan_3d *plan;
+  struct fft_plan_3d *plan;          // complex-to-complex plan
+  struct fft_plan_3d_r2c *rplan;     // real-to-complex plan
 };
 
 }
@@ -45,4 +49,9 @@ The FFT setup for the PPPM solver failed, typically due
 to lack of memory.  This is an unusual error.  Check the
 size of the FFT grid you are requesting.
 
+E: Could not create 3d real-to-complex FFT plan
+
+The FFT setup for a real-to-complex transform failed, either due
+to lack of memory or because the fast FFT dimension is not even.
+
 */
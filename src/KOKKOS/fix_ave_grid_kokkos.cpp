@@ -48,6 +48,15 @@ FixAveGridKokkos::FixAveGridKokkos(SPARTA *sparta, int narg, char **arg) :
   datamask_read = EMPTY_MASK;
   datamask_modify = EMPTY_MASK;
 
+  // end_of_step() here only accumulates and normalizes a double tally
+
+  if (ave != ONE && ave != RUNNING)
+    error->all(FLERR,"Fix ave/grid/kk does not support ave ema");
+  if (statflag)
+    error->all(FLERR,"Fix ave/grid/kk does not support stats or converge");
+  if (ftally)
+    error->all(FLERR,"Fix ave/grid/kk does not support precision single");
+
   nglocal = nglocalmax = grid->nlocal;
 
   // allocate per-grid cell data storage
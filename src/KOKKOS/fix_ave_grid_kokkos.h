@@ -124,6 +124,20 @@ Self-explanatory.  Check the input script syntax and compare to the
 documentation for the command.  You can use -echo screen as a
 command-line option when running SPARTA to see the offending line.
 
+E: Fix ave/grid/kk does not support ave ema
+
+The Kokkos version only accumulates ave one or ave running tallies.
+
+E: Fix ave/grid/kk does not support stats or converge
+
+The Kokkos version does not tally per-sample statistics, so it cannot
+output std errors or halt a run on convergence.
+
+E: Fix ave/grid/kk does not support precision single
+
+The Kokkos version stores its tally in a double precision device
+array.
+
 E: Compute ID for fix ave/grid does not exist
 
 Self-explanatory.
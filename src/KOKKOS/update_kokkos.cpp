@@ -265,6 +265,8 @@ void UpdateKokkos::run(int nsteps)
   int cellweightflag = 0;
   if (grid->cellweightflag) cellweightflag = 1;
 
+  halt = 0;
+
   // loop over timesteps
 
   for (int i = 0; i < nsteps; i++) {
@@ -320,6 +322,15 @@ void UpdateKokkos::run(int nsteps)
       timer->stamp(TIME_MODIFY);
     }
 
+    // a fix may halt the run early, e.g. fix ave/grid on convergence
+    // make this the last step of the run so stats are output on it
+
+    if (halt) {
+      laststep = endstep = ntimestep;
+      this->nsteps = ntimestep - firststep;
+      output->next = output->next_stats = ntimestep;
+    }
+
     // all output
 
     if (ntimestep == output->next) {
@@ -327,6 +338,8 @@ void UpdateKokkos::run(int nsteps)
       output->write(ntimestep);
       timer->stamp(TIME_OUTPUT);
     }
+
+    if (halt) break;
   }
   particle_kk->sync(Host,ALL_MASK);
 
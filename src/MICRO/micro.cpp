@@ -0,0 +1,655 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+// microbenchmarks of individual SPARTA kernels on synthetic data
+// built by "make mode=micro machine" in src, which copies this file
+//   into the Obj_machine dir, so headers are included as "../name.h"
+// each kernel is timed over repeated batches and reported in ns/op
+//   with a 95% confidence interval over the batches
+
+#include "../spatype.h"
+#include "mpi.h"
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "unistd.h"
+#include <map>
+#include <vector>
+#include "../sparta.h"
+#include "../input.h"
+#include "../update.h"
+#include "../grid.h"
+#include "../surf.h"
+#include "../particle.h"
+#include "../collide_vss.h"
+#include "../cut2d.h"
+#include "../cut3d.h"
+#include "../geometry.h"
+#include "../math_extra.h"
+#include "../math_const.h"
+#include "../random_park.h"
+#include "../memory.h"
+
+using namespace SPARTA_NS;
+using namespace MathConst;
+
+enum{XLO,XHI,YLO,YHI,ZLO,ZHI,INTERIOR};         // same as Update
+
+#define NCASE 4096          // # of synthetic inputs cycled through
+#define MAXCPATH 64         // max clipped pts from Cut3d::clip_external()
+
+static int nrep = 10;       // # of timed batches per kernel
+static double mintime = 0.05;   // min seconds per batch
+static double sink = 0.0;   // consumes kernel results so they are not elided
+
+/* ----------------------------------------------------------------------
+   CollideVSS with access to its collision state,
+     so one collision can be performed without a cell loop
+------------------------------------------------------------------------- */
+
+class MicroVSS : public CollideVSS {
+ public:
+  MicroVSS(SPARTA *sparta, int narg, char **arg) :
+    CollideVSS(sparta,narg,arg) {}
+
+  void collide_pair(Particle::OnePart *ip, Particle::OnePart *jp) {
+    double du = ip->v[0] - jp->v[0];
+    double dv = ip->v[1] - jp->v[1];
+    double dw = ip->v[2] - jp->v[2];
+    precoln.vr2 = du*du + dv*dv + dw*dw;
+    setup_collision(ip,jp);
+    Particle::OnePart *kp = NULL;
+    perform_collision(ip,jp,kp);
+  }
+};
+
+/* ----------------------------------------------------------------------
+   a kernel runs its operation on NCASE-cycled inputs N times
+   returns # of operations that "hit", e.g. intersections or collisions
+------------------------------------------------------------------------- */
+
+class Kernel {
+ public:
+  const char *name;
+  const char *hitname;
+  Kernel(const char *n, const char *h) : name(n), hitname(h) {}
+  virtual ~Kernel() {}
+  virtual bigint run(bigint) = 0;
+  virtual void reset() {}
+};
+
+/* ----------------------------------------------------------------------
+   Student t value for two-sided 95% confidence with df degrees of freedom
+------------------------------------------------------------------------- */
+
+static double tvalue(int df)
+{
+  static const double t[] = {12.71,4.303,3.182,2.776,2.571,2.447,2.365,
+                             2.306,2.262,2.228,2.201,2.179,2.160,2.145,
+                             2.131,2.120,2.110,2.101,2.093,2.086};
+  if (df < 1) return 0.0;
+  if (df <= 20) return t[df-1];
+  if (df <= 30) return 2.06;
+  if (df <= 60) return 2.02;
+  return 1.96;
+}
+
+/* ----------------------------------------------------------------------
+   calibrate # of ops so a batch takes mintime, then time nrep batches
+------------------------------------------------------------------------- */
+
+static void benchmark(Kernel *k)
+{
+  bigint nops = NCASE;
+  while (1) {
+    k->reset();
+    double t0 = MPI_Wtime();
+    k->run(nops);
+    double t = MPI_Wtime() - t0;
+    if (t >= mintime || nops > MAXBIGINT/4) break;
+    if (t <= 0.0) nops *= 16;
+    else nops = MIN(16*nops,(bigint) (1.2*nops*mintime/t) + 1);
+  }
+
+  std::vector<double> ns(nrep);
+  bigint nhit = 0;
+  for (int i = 0; i < nrep; i++) {
+    k->reset();
+    double t0 = MPI_Wtime();
+    nhit += k->run(nops);
+    ns[i] = 1.0e9 * (MPI_Wtime() - t0) / nops;
+  }
+
+  double ave = 0.0, min = ns[0];
+  for (int i = 0; i < nrep; i++) {
+    ave += ns[i];
+    if (ns[i] < min) min = ns[i];
+  }
+  ave /= nrep;
+  double var = 0.0;
+  for (int i = 0; i < nrep; i++) var += (ns[i]-ave)*(ns[i]-ave);
+  double ci = 0.0;
+  if (nrep > 1) ci = tvalue(nrep-1) * sqrt(var/(nrep-1)/nrep);
+
+  printf("%-14s %10.4g %10.3g %10.4g %12ld  %s %.1f%%\n",
+         k->name,ave,ci,min,(long) nops,k->hitname,
+         100.0*nhit/((double) nops*nrep));
+  fflush(stdout);
+}
+
+/* ----------------------------------------------------------------------
+   random line segments vs random triangles in a unit cube
+   segments start near the triangle, so a few percent intersect
+------------------------------------------------------------------------- */
+
+class LineTri : public Kernel {
+ public:
+  double x[NCASE][3],xnew[NCASE][3];
+  double p1[NCASE][3],p2[NCASE][3],p3[NCASE][3],norm[NCASE][3];
+
+  LineTri(RanPark *random) : Kernel("line_tri","hit") {
+    for (int m = 0; m < NCASE; m++) {
+      double c[3];
+      for (int d = 0; d < 3; d++) {
+        c[d] = random->uniform();
+        p1[m][d] = c[d] + 0.1*(random->uniform()-0.5);
+        p2[m][d] = c[d] + 0.1*(random->uniform()-0.5);
+        p3[m][d] = c[d] + 0.1*(random->uniform()-0.5);
+        x[m][d] = c[d] + 0.1*(random->uniform()-0.5);
+        xnew[m][d] = x[m][d] + 0.1*(random->uniform()-0.5);
+      }
+      double a[3],b[3];
+      MathExtra::sub3(p2[m],p1[m],a);
+      MathExtra::sub3(p3[m],p1[m],b);
+      MathExtra::cross3(a,b,norm[m]);
+      MathExtra::norm3(norm[m]);
+    }
+  }
+
+  bigint run(bigint n) {
+    double xc[3],param;
+    int side;
+    bigint nhit = 0;
+    int m = 0;
+    for (bigint i = 0; i < n; i++) {
+      if (Geometry::line_tri_intersect(x[m],xnew[m],p1[m],p2[m],p3[m],
+                                       norm[m],xc,param,side)) nhit++;
+      if (++m == NCASE) m = 0;
+    }
+    sink += nhit;
+    return nhit;
+  }
+};
+
+/* ----------------------------------------------------------------------
+   axisymmetric moves vs random line segments in random cells
+------------------------------------------------------------------------- */
+
+class AxiLine : public Kernel {
+ public:
+  double x[NCASE][3],v[NCASE][3],lo[NCASE][3],hi[NCASE][3];
+  double v1[NCASE][3],v2[NCASE][3],norm[NCASE][3];
+
+  AxiLine(RanPark *random) : Kernel("axi_line","hit") {
+    for (int m = 0; m < NCASE; m++) {
+      lo[m][0] = random->uniform();
+      lo[m][1] = 0.1 + random->uniform();
+      lo[m][2] = hi[m][2] = 0.0;
+      hi[m][0] = lo[m][0] + 0.1;
+      hi[m][1] = lo[m][1] + 0.1;
+      for (int d = 0; d < 2; d++) {
+        x[m][d] = lo[m][d] + 0.1*random->uniform();
+        v1[m][d] = lo[m][d] + 0.1*random->uniform();
+        v2[m][d] = lo[m][d] + 0.1*random->uniform();
+      }
+      x[m][2] = v1[m][2] = v2[m][2] = 0.0;
+      for (int d = 0; d < 3; d++) v[m][d] = random->gaussian();
+      norm[m][0] = v1[m][1] - v2[m][1];
+      norm[m][1] = v2[m][0] - v1[m][0];
+      norm[m][2] = 0.0;
+      MathExtra::norm3(norm[m]);
+    }
+  }
+
+  bigint run(bigint n) {
+    double xc[3],vc[3],param;
+    int side;
+    bigint nhit = 0;
+    int m = 0;
+    for (bigint i = 0; i < n; i++) {
+      if (Geometry::axi_line_intersect(0.1,x[m],v[m],INTERIOR,lo[m],hi[m],
+                                       v1[m],v2[m],norm[m],0,
+                                       xc,vc,param,side)) nhit++;
+      if (++m == NCASE) m = 0;
+    }
+    sink += nhit;
+    return nhit;
+  }
+};
+
+/* ----------------------------------------------------------------------
+   Sutherland-Hodgman clip of random triangles against a unit cell
+------------------------------------------------------------------------- */
+
+class Clip3d : public Kernel {
+ public:
+  Cut3d *cut;
+  double lo[3],hi[3];
+  double p0[NCASE][3],p1[NCASE][3],p2[NCASE][3];
+
+  Clip3d(Cut3d *c, RanPark *random) : Kernel("cut3d_clip","clipped") {
+    cut = c;
+    lo[0] = lo[1] = lo[2] = 0.0;
+    hi[0] = hi[1] = hi[2] = 1.0;
+    for (int m = 0; m < NCASE; m++)
+      for (int d = 0; d < 3; d++) {
+        double c = random->uniform();
+        p0[m][d] = c + random->uniform() - 0.5;
+        p1[m][d] = c + random->uniform() - 0.5;
+        p2[m][d] = c + random->uniform() - 0.5;
+      }
+  }
+
+  bigint run(bigint n) {
+    double cpath[3*MAXCPATH];
+    bigint nhit = 0;
+    int m = 0;
+    for (bigint i = 0; i < n; i++) {
+      if (cut->clip_external(p0[m],p1[m],p2[m],lo,hi,cpath)) nhit++;
+      if (++m == NCASE) m = 0;
+    }
+    sink += nhit;
+    return nhit;
+  }
+};
+
+/* ----------------------------------------------------------------------
+   split of every grid cell cut by the surface of a 2d or 3d body
+------------------------------------------------------------------------- */
+
+class Split : public Kernel {
+ public:
+  Grid *grid;
+  Cut2d *cut2d;
+  Cut3d *cut3d;
+  std::vector<int> cells;
+  int *surfmap;
+
+  Split(const char *name, Grid *g, Cut2d *c2, Cut3d *c3) :
+    Kernel(name,"multi-split") {
+    grid = g;
+    cut2d = c2;
+    cut3d = c3;
+    int maxsurf = 1;
+    for (int icell = 0; icell < grid->nlocal; icell++) {
+      if (grid->cells[icell].nsurf <= 0) continue;
+      if (grid->cells[icell].nsplit <= 0) continue;
+      cells.push_back(icell);
+      maxsurf = MAX(maxsurf,grid->cells[icell].nsurf);
+    }
+    surfmap = new int[maxsurf];
+  }
+  ~Split() {delete [] surfmap;}
+
+  bigint run(bigint n) {
+    double *vols,xsplit[3];
+    int corners[8],xsub;
+    bigint nhit = 0;
+    int m = 0;
+    int ncell = cells.size();
+    for (bigint i = 0; i < n; i++) {
+      Grid::ChildCell *c = &grid->cells[cells[m]];
+      int nsplit;
+      if (cut3d)
+        nsplit = cut3d->split(c->id,c->lo,c->hi,c->nsurf,c->csurfs,
+                              vols,surfmap,corners,xsub,xsplit);
+      else
+        nsplit = cut2d->split(c->id,c->lo,c->hi,c->nsurf,c->csurfs,
+                              vols,surfmap,corners,xsub,xsplit);
+      if (nsplit > 1) nhit++;
+      sink += vols[0];
+      if (++m == ncell) m = 0;
+    }
+    return nhit;
+  }
+};
+
+/* ----------------------------------------------------------------------
+   VSS collision acceptance test and collision on Maxwellian pairs
+------------------------------------------------------------------------- */
+
+class VSS : public Kernel {
+ public:
+  MicroVSS *vss;
+  int perform;
+  Particle::OnePart *ip,*jp;
+  std::vector<Particle::OnePart> parts;
+
+  VSS(const char *name, MicroVSS *c, Particle *particle, RanPark *random,
+      int flag) : Kernel(name,"accepted") {
+    vss = c;
+    perform = flag;
+    parts.resize(2*NCASE);
+
+    // N2 and O2 at 1000K, including rotational/vibrational energy
+
+    double kT = 1.380658e-23 * 1000.0;
+    for (int m = 0; m < 2*NCASE; m++) {
+      Particle::OnePart *p = &parts[m];
+      memset(p,0,sizeof(Particle::OnePart));
+      p->ispecies = random->uniform() < 0.8 ? 0 : 1;
+      double vscale = sqrt(kT/particle->species[p->ispecies].mass);
+      for (int d = 0; d < 3; d++) p->v[d] = vscale*random->gaussian();
+      p->erot = -kT*log(random->uniform());
+      p->evib = 0.0;
+      p->weight = 1.0;
+    }
+  }
+
+  bigint run(bigint n) {
+    bigint nhit = 0;
+    int m = 0;
+    for (bigint i = 0; i < n; i++) {
+      ip = &parts[2*m];
+      jp = &parts[2*m+1];
+      if (perform) {
+        vss->collide_pair(ip,jp);
+        nhit++;
+      } else if (vss->test_collision(0,0,0,ip,jp)) nhit++;
+      if (++m == NCASE) m = 0;
+    }
+    sink += nhit;
+    return nhit;
+  }
+};
+
+/* ----------------------------------------------------------------------
+   Particle::sort() of particles assigned to random grid cells
+   one op = sort of one particle
+------------------------------------------------------------------------- */
+
+class Sort : public Kernel {
+ public:
+  Particle *particle;
+
+  Sort(Particle *p) : Kernel("particle_sort","") {particle = p;}
+
+  bigint run(bigint n) {
+    bigint nsort = MAX(n/particle->nlocal,1);
+    for (bigint i = 0; i < nsort; i++) particle->sort();
+    sink += particle->next[0];
+    return 0;
+  }
+};
+
+/* ----------------------------------------------------------------------
+   write a closed sphere of radius R at C as SPARTA surf file
+   octahedron subdivided nlevel times, triangle normals point outward
+------------------------------------------------------------------------- */
+
+static void write_sphere(const char *file, double *c, double r, int nlevel)
+{
+  std::vector<double> pts;
+  std::vector<int> tris;
+  double oct[6][3] = {{1,0,0},{-1,0,0},{0,1,0},{0,-1,0},{0,0,1},{0,0,-1}};
+  for (int i = 0; i < 6; i++)
+    for (int d = 0; d < 3; d++) pts.push_back(oct[i][d]);
+  for (int sx = 0; sx < 2; sx++)
+    for (int sy = 0; sy < 2; sy++)
+      for (int sz = 0; sz < 2; sz++) {
+        int a = sx, b = 2+sy, e = 4+sz;
+        tris.push_back(a);
+        if ((sx+sy+sz) % 2 == 0) {tris.push_back(b); tris.push_back(e);}
+        else {tris.push_back(e); tris.push_back(b);}
+      }
+
+  for (int level = 0; level < nlevel; level++) {
+    std::map<std::pair<int,int>,int> mid;
+    std::vector<int> newtris;
+    for (size_t t = 0; t < tris.size(); t += 3) {
+      int v[3],m[3];
+      for (int k = 0; k < 3; k++) v[k] = tris[t+k];
+      for (int k = 0; k < 3; k++) {
+        std::pair<int,int> edge(MIN(v[k],v[(k+1)%3]),MAX(v[k],v[(k+1)%3]));
+        if (mid.count(edge) == 0) {
+          double p[3];
+          for (int d = 0; d < 3; d++)
+            p[d] = 0.5*(pts[3*edge.first+d] + pts[3*edge.second+d]);
+          MathExtra::norm3(p);
+          mid[edge] = pts.size()/3;
+          for (int d = 0; d < 3; d++) pts.push_back(p[d]);
+        }
+        m[k] = mid[edge];
+      }
+      int sub[12] = {v[0],m[0],m[2], m[0],v[1],m[1],
+                     m[2],m[1],v[2], m[0],m[1],m[2]};
+      newtris.insert(newtris.end(),sub,sub+12);
+    }
+    tris.swap(newtris);
+  }
+
+  FILE *fp = fopen(file,"w");
+  fprintf(fp,"synthetic sphere\n\n%d points\n%d triangles\n\nPoints\n\n",
+          (int) pts.size()/3,(int) tris.size()/3);
+  for (size_t i = 0; i < pts.size()/3; i++)
+    fprintf(fp,"%d %.15g %.15g %.15g\n",(int) i+1,c[0]+r*pts[3*i],
+            c[1]+r*pts[3*i+1],c[2]+r*pts[3*i+2]);
+  fprintf(fp,"\nTriangles\n\n");
+  for (size_t t = 0; t < tris.size()/3; t++)
+    fprintf(fp,"%d %d %d %d\n",(int) t+1,
+            tris[3*t]+1,tris[3*t+1]+1,tris[3*t+2]+1);
+  fclose(fp);
+}
+
+/* ----------------------------------------------------------------------
+   write a closed circle of radius R at C with N lines as SPARTA surf file
+------------------------------------------------------------------------- */
+
+static void write_circle(const char *file, double *c, double r, int n)
+{
+  FILE *fp = fopen(file,"w");
+  fprintf(fp,"synthetic circle\n\n%d points\n%d lines\n\nPoints\n\n",n,n);
+  for (int i = 0; i < n; i++)
+    fprintf(fp,"%d %.15g %.15g\n",i+1,c[0]+r*cos(2.0*MY_PI*i/n),
+            c[1]+r*sin(2.0*MY_PI*i/n));
+  fprintf(fp,"\nLines\n\n");
+  for (int i = 0; i < n; i++) fprintf(fp,"%d %d %d\n",i+1,(i+1)%n+1,i+1);
+  fclose(fp);
+}
+
+/* ----------------------------------------------------------------------
+   create a SPARTA instance that writes nothing, run commands in it
+------------------------------------------------------------------------- */
+
+static SPARTA *instance(const char **commands)
+{
+  const char *args[] = {"micro","-screen","none","-log","none"};
+  SPARTA *sparta = new SPARTA(5,(char **) args,MPI_COMM_SELF);
+  for (int i = 0; commands[i]; i++) sparta->input->one(commands[i]);
+  return sparta;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static int selected(const char *list, const char *name)
+{
+  if (list == NULL) return 1;
+  char *copy = new char[strlen(list)+1];
+  strcpy(copy,list);
+  int flag = 0;
+  for (char *word = strtok(copy,","); word; word = strtok(NULL,","))
+    if (strcmp(word,name) == 0) flag = 1;
+  delete [] copy;
+  return flag;
+}
+
+/* ----------------------------------------------------------------------
+   micro [-r nrep] [-t mintime] [-k kernel,kernel,...] [-s seed]
+------------------------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc,&argv);
+
+  const char *klist = NULL;
+  int seed = 12345;
+  for (int iarg = 1; iarg < argc; iarg++) {
+    if (strcmp(argv[iarg],"-r") == 0 && iarg+1 < argc)
+      nrep = atoi(argv[++iarg]);
+    else if (strcmp(argv[iarg],"-t") == 0 && iarg+1 < argc)
+      mintime = atof(argv[++iarg]);
+    else if (strcmp(argv[iarg],"-k") == 0 && iarg+1 < argc)
+      klist = argv[++iarg];
+    else if (strcmp(argv[iarg],"-s") == 0 && iarg+1 < argc)
+      seed = atoi(argv[++iarg]);
+    else {
+      printf("Syntax: micro [-r nrep] [-t mintime] [-k kernel,...] [-s seed]\n"
+             "kernels: line_tri axi_line cut3d_clip cut3d_split "
+             "cut2d_split\n"
+             "         vss_test vss_perform particle_sort\n");
+      MPI_Finalize();
+      return 1;
+    }
+  }
+  if (nrep < 1 || mintime <= 0.0) {
+    printf("Invalid -r or -t value\n");
+    MPI_Finalize();
+    return 1;
+  }
+
+  // species and surf files for the SPARTA instances
+
+  FILE *fp = fopen("tmp.micro.species","w");
+  fprintf(fp,"O2  32.00    5.31E-26  2    0.2   2    5.58659E-5    "
+          "2256.0    1.0      0.0\n"
+          "N2  28.016   4.65E-26  2    0.2   2    1.90114E-5    "
+          "3371.0    1.0      0.0\n");
+  fclose(fp);
+
+  double center[3] = {0.5,0.5,0.5};
+  write_sphere("tmp.micro.sphere",center,0.3,4);
+  write_circle("tmp.micro.circle",center,0.3,400);
+
+  char seedcmd[32];
+  sprintf(seedcmd,"seed %d",seed);
+
+  const char *cmd3d[] =
+    {seedcmd,"dimension 3","boundary r r r",
+     "global gridcut 0.0 comm/sort yes",
+     "create_box 0 1 0 1 0 1","create_grid 32 32 32",
+     "species tmp.micro.species N2 O2",
+     "mixture air N2 O2 vstream 0.0 0.0 0.0 temp 1000.0",
+     "mixture air N2 frac 0.8","mixture air O2 frac 0.2",
+     "global nrho 1.0 fnum 1.0",
+     "read_surf tmp.micro.sphere",NULL};
+  const char *cmd2d[] =
+    {seedcmd,"dimension 2","boundary r r p",
+     "global gridcut 0.0 comm/sort yes",
+     "create_box 0 1 0 1 -0.5 0.5","create_grid 64 64 1",
+     "read_surf tmp.micro.circle",NULL};
+
+  SPARTA *sparta3d = instance(cmd3d);
+  SPARTA *sparta2d = instance(cmd2d);
+
+  unlink("tmp.micro.species");
+  unlink("tmp.micro.sphere");
+  unlink("tmp.micro.circle");
+
+  RanPark *random = new RanPark(seed);
+  Cut3d *cut3d = new Cut3d(sparta3d);
+  Cut2d *cut2d = new Cut2d(sparta2d,0);
+
+  const char *vssargs[] = {"vss","air","tmp.micro.vss"};
+  fp = fopen("tmp.micro.vss","w");
+  fprintf(fp,"O2   3.96E-10    0.77  273.15  1.4\n"
+          "N2   4.07E-10    0.74  273.15  1.6\n");
+  fclose(fp);
+  MicroVSS *vss = new MicroVSS(sparta3d,3,(char **) vssargs);
+  unlink("tmp.micro.vss");
+  sparta3d->update->dt = 1.0e-6;
+  vss->init();
+
+  // 20 particles per grid cell, each in a random cell
+
+  Particle *particle = sparta3d->particle;
+  int nglocal = sparta3d->grid->nlocal;
+  double x[3] = {0.0,0.0,0.0};
+  double v[3] = {0.0,0.0,0.0};
+  for (int i = 0; i < 20*nglocal; i++)
+    particle->add_particle(i+1,0,(int) (nglocal*random->uniform()),
+                           x,v,0.0,0.0);
+
+  std::vector<Kernel *> kernels;
+  kernels.push_back(new LineTri(random));
+  kernels.push_back(new AxiLine(random));
+  kernels.push_back(new Clip3d(cut3d,random));
+  kernels.push_back(new Split("cut3d_split",sparta3d->grid,NULL,cut3d));
+  kernels.push_back(new Split("cut2d_split",sparta2d->grid,cut2d,NULL));
+  kernels.push_back(new VSS("vss_test",vss,particle,random,0));
+  kernels.push_back(new VSS("vss_perform",vss,particle,random,1));
+  kernels.push_back(new Sort(particle));
+
+  printf("SPARTA kernel microbenchmarks: %d batches of >= %g sec each\n",
+         nrep,mintime);
+  printf("%-14s %10s %10s %10s %12s\n","kernel","ns/op","+/-95%",
+         "min","ops/batch");
+
+  for (size_t k = 0; k < kernels.size(); k++) {
+    if (!selected(klist,kernels[k]->name)) continue;
+    if (strcmp(kernels[k]->name,"particle_sort") == 0) {
+
+      // time per particle sorted, calibrate on whole sorts
+
+      Kernel *s = kernels[k];
+      int nsort = 1;
+      double t;
+      while (1) {
+        double t0 = MPI_Wtime();
+        for (int i = 0; i < nsort; i++) particle->sort();
+        t = MPI_Wtime() - t0;
+        if (t >= mintime) break;
+        nsort *= 2;
+      }
+      std::vector<double> ns(nrep);
+      double ave = 0.0, min = 0.0, var = 0.0;
+      for (int i = 0; i < nrep; i++) {
+        double t0 = MPI_Wtime();
+        s->run((bigint) nsort*particle->nlocal);
+        ns[i] = 1.0e9*(MPI_Wtime()-t0) / ((double) nsort*particle->nlocal);
+        ave += ns[i];
+        if (i == 0 || ns[i] < min) min = ns[i];
+      }
+      ave /= nrep;
+      for (int i = 0; i < nrep; i++) var += (ns[i]-ave)*(ns[i]-ave);
+      double ci = 0.0;
+      if (nrep > 1) ci = tvalue(nrep-1) * sqrt(var/(nrep-1)/nrep);
+      printf("%-14s %10.4g %10.3g %10.4g %12ld  %d particles in %d cells\n",
+             s->name,ave,ci,min,(long) nsort*particle->nlocal,
+             particle->nlocal,nglocal);
+    } else benchmark(kernels[k]);
+  }
+
+  if (sink == 12345.6789) printf("%g\n",sink);
+
+  for (size_t k = 0; k < kernels.size(); k++) delete kernels[k];
+  delete vss;
+  delete cut2d;
+  delete cut3d;
+  delete random;
+  delete sparta2d;
+  delete sparta3d;
+
+  MPI_Finalize();
+}
@@ -41,6 +41,13 @@ int size_datatype[MAXEXTRA_DATATYPE];
 
 static int _mpi_is_initialized=0;
 
+/* memory exposed by MPI_Win_create, MPI_Win = index into list */
+
+#define MAXWIN 16
+
+static char *win_base[MAXWIN];
+static int win_disp[MAXWIN];
+
 /* ---------------------------------------------------------------------- */
 /* MPI Functions */
 /* ---------------------------------------------------------------------- */
@@ -617,3 +624,63 @@ int MPI_Alltoallv(void *sendbuf, int *sendcounts, int *sdispls,
 }
 
 /* ---------------------------------------------------------------------- */
+
+/* expose base as window, only rank 0 exists */
+
+int MPI_Win_create(void *base, MPI_Aint size, int disp_unit, MPI_Info info,
+                   MPI_Comm comm, MPI_Win *win)
+{
+  int i;
+  for (i = 0; i < MAXWIN; i++)
+    if (win_base[i] == NULL) break;
+  if (i == MAXWIN) {
+    printf("MPI Stub WARNING: too many windows\n");
+    return 1;
+  }
+  win_base[i] = (char *) base;
+  win_disp[i] = disp_unit;
+  *win = i;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Win_free(MPI_Win *win)
+{
+  win_base[*win] = NULL;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Win_lock(int lock_type, int rank, int assert, MPI_Win win)
+{
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Win_unlock(int rank, MPI_Win win)
+{
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+/* return value in window, then add origin to it for MPI_SUM, else replace */
+
+int MPI_Fetch_and_op(const void *origin, void *result, MPI_Datatype datatype,
+                     int target_rank, MPI_Aint target_disp, MPI_Op op,
+                     MPI_Win win)
+{
+  int n = stubtypesize(datatype);
+  char *target = win_base[win] + target_disp*win_disp[win];
+
+  memcpy(result,target,n);
+  if (op != MPI_SUM) memcpy(target,origin,n);
+  else if (datatype == MPI_INT) *(int *) target += *(int *) origin;
+  else if (datatype == MPI_DOUBLE) *(double *) target += *(double *) origin;
+  else if (datatype == MPI_LONG_LONG)
+    *(uint64_t *) target += *(uint64_t *) origin;
+  return 0;
+}
@@ -60,6 +60,13 @@ extern "C" {
 #define MPI_Fint int
 #define MPI_Group int
 #define MPI_Offset long
+#define MPI_Aint long
+#define MPI_Info int
+#define MPI_Win int
+
+#define MPI_INFO_NULL 0
+#define MPI_LOCK_EXCLUSIVE 1
+#define MPI_LOCK_SHARED 2
 
 #define MPI_IN_PLACE NULL
 
@@ -172,6 +179,15 @@ int MPI_Alltoallv(void *sendbuf, int *sendcounts, int *sdispls,
                   MPI_Datatype sendtype,
                   void *recvbuf, int *recvcounts, int *rdispls,
                   MPI_Datatype recvtype, MPI_Comm comm);
+
+int MPI_Win_create(void *base, MPI_Aint size, int disp_unit, MPI_Info info,
+                   MPI_Comm comm, MPI_Win *win);
+int MPI_Win_free(MPI_Win *win);
+int MPI_Win_lock(int lock_type, int rank, int assert, MPI_Win win);
+int MPI_Win_unlock(int rank, MPI_Win win);
+int MPI_Fetch_and_op(const void *origin, void *result, MPI_Datatype datatype,
+                     int target_rank, MPI_Aint target_disp, MPI_Op op,
+                     MPI_Win win);
 /* ---------------------------------------------------------------------- */
 
 #ifdef __cplusplus
@@ -49,7 +49,7 @@ enum{REGION_ALL,REGION_ONE,REGION_CENTER};
 enum{UNKNOWN,OUTSIDE,INSIDE,OVERLAP};   // several files
 enum{LESS,MORE};
 enum{SUM,MINIMUM,MAXIMUM};
-enum{ONE,RUNNING};                      // also in FixAveGrid
+enum{ONE,RUNNING,EMA};                  // also in FixAveGrid
 
 #define INVOKED_PER_GRID 16
 #define DELTA_NEW 1024
@@ -521,7 +521,7 @@ void AdaptGrid::check_args(int nevery)
 {
   // for every fix ave/grid defined, require that:
   // (1) fix adapt Nevery is multiple of fix ave Nfreq
-  // (2) fix ave/grid is not a running ave
+  // (2) fix ave/grid is not a running or exponential moving ave
   // (3) fix ave/grid is defined before this fix (checked in fix adapt)
   // this insures fix ave/grid values will be up-to-date before
   //   this adaptation changes the grid
@@ -530,9 +530,10 @@ void AdaptGrid::check_args(int nevery)
 
   for (int i = 0; i < modify->nfix; i++) {
     if (strcmp(modify->fix[i]->style,"ave/grid") == 0) {
-      if (((FixAveGrid *) modify->fix[i])->ave == RUNNING)
+      int ave = ((FixAveGrid *) modify->fix[i])->ave;
+      if (ave == RUNNING || ave == EMA)
         error->all(FLERR,"Adapt command does not yet allow use of "
-                   "fix ave/grid ave running");
+                   "fix ave/grid ave running or ema");
     }
   }
 
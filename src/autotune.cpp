@@ -0,0 +1,550 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "stdlib.h"
+#include "string.h"
+#include "autotune.h"
+#include "update.h"
+#include "grid.h"
+#include "particle.h"
+#include "comm.h"
+#include "modify.h"
+#include "compute.h"
+#include "output.h"
+#include "dump.h"
+#include "input.h"
+#include "timer.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace SPARTA_NS;
+
+enum{DESCENT,EXHAUSTIVE};
+
+#define DELTA 16
+
+AutoTune *AutoTune::aptr;
+
+/* ---------------------------------------------------------------------- */
+
+AutoTune::AutoTune(SPARTA *sparta) : Pointers(sparta)
+{
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  nknob = 0;
+  knob = NULL;
+  nchoice = NULL;
+  choice = NULL;
+
+  ntrial = maxtrial = 0;
+  trials = NULL;
+  rates = NULL;
+
+  ncell_snap = npart_snap = 0;
+  cellid_snap = NULL;
+  part_snap = NULL;
+  slot_snap = sub_snap = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+AutoTune::~AutoTune()
+{
+  for (int i = 0; i < nknob; i++) {
+    delete [] knob[i];
+    for (int j = 0; j < nchoice[i]; j++) delete [] choice[i][j];
+    delete [] choice[i];
+  }
+  delete [] knob;
+  delete [] nchoice;
+  delete [] choice;
+
+  memory->destroy(trials);
+  memory->destroy(rates);
+
+  memory->destroy(cellid_snap);
+  memory->destroy(part_snap);
+  memory->destroy(slot_snap);
+  memory->destroy(sub_snap);
+}
+
+/* ----------------------------------------------------------------------
+   autotune N knob "template" v1 v2 ... knob ... search style repeat M
+   run short trials of N steps over combinations of knob values
+   each trial starts from the same particles, decomposition, and timestep,
+     then issues each knob's template command with * replaced by a value
+   the fastest combination in particle moves/sec is applied when done
+------------------------------------------------------------------------- */
+
+void AutoTune::command(int narg, char **arg)
+{
+  if (!grid->exist)
+    error->all(FLERR,"Cannot use autotune before grid is defined");
+  if (narg < 3) error->all(FLERR,"Illegal autotune command");
+
+  nsteps = input->inumeric(FLERR,arg[0]);
+  if (nsteps <= 0) error->all(FLERR,"Illegal autotune command");
+
+  nrepeat = 1;
+  searchstyle = DESCENT;
+
+  // copy args, since running trials overwrites them
+
+  knob = new char*[narg];
+  nchoice = new int[narg];
+  choice = new char**[narg];
+
+  int n;
+  int iarg = 1;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"knob") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal autotune command");
+      char *ptr = strchr(arg[iarg+1],'*');
+      if (!ptr || strchr(ptr+1,'*'))
+        error->all(FLERR,"Autotune knob must contain one * character");
+      n = strlen(arg[iarg+1]) + 1;
+      knob[nknob] = new char[n];
+      strcpy(knob[nknob],arg[iarg+1]);
+      iarg += 2;
+
+      int first = iarg;
+      while (iarg < narg && strcmp(arg[iarg],"knob") != 0 &&
+             strcmp(arg[iarg],"search") != 0 &&
+             strcmp(arg[iarg],"repeat") != 0) iarg++;
+      nchoice[nknob] = iarg - first;
+      choice[nknob] = new char*[nchoice[nknob]];
+      for (int i = 0; i < nchoice[nknob]; i++) {
+        n = strlen(arg[first+i]) + 1;
+        choice[nknob][i] = new char[n];
+        strcpy(choice[nknob][i],arg[first+i]);
+      }
+      nknob++;
+      if (nchoice[nknob-1] == 0)
+        error->all(FLERR,"Autotune knob has no values");
+
+    } else if (strcmp(arg[iarg],"search") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal autotune command");
+      if (strcmp(arg[iarg+1],"descent") == 0) searchstyle = DESCENT;
+      else if (strcmp(arg[iarg+1],"all") == 0) searchstyle = EXHAUSTIVE;
+      else error->all(FLERR,"Illegal autotune command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"repeat") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal autotune command");
+      nrepeat = input->inumeric(FLERR,arg[iarg+1]);
+      if (nrepeat <= 0) error->all(FLERR,"Illegal autotune command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal autotune command");
+  }
+
+  if (nknob == 0) error->all(FLERR,"Illegal autotune command");
+
+  MPI_Barrier(world);
+  double time1 = MPI_Wtime();
+
+  snapshot();
+
+  int *config = new int[nknob];
+  int *best = new int[nknob];
+  for (int i = 0; i < nknob; i++) best[i] = config[i] = 0;
+  double rate;
+  double bestrate = -1.0;
+
+  // descent = vary one knob at a time, starting from 1st value of each,
+  //   keeping the best value of each knob before moving to the next
+  // all = try every combination of knob values
+
+  if (searchstyle == DESCENT) {
+    bestrate = trial(best);
+    for (int k = 0; k < nknob; k++)
+      for (int j = 0; j < nchoice[k]; j++) {
+        for (int i = 0; i < nknob; i++) config[i] = best[i];
+        config[k] = j;
+        if (find_trial(config) >= 0) continue;
+        rate = trial(config);
+        if (rate > bestrate) {
+          bestrate = rate;
+          best[k] = j;
+        }
+      }
+
+  } else {
+    while (1) {
+      rate = trial(config);
+      if (rate > bestrate) {
+        bestrate = rate;
+        for (int i = 0; i < nknob; i++) best[i] = config[i];
+      }
+      int k;
+      for (k = 0; k < nknob; k++) {
+        if (++config[k] < nchoice[k]) break;
+        config[k] = 0;
+      }
+      if (k == nknob) break;
+    }
+  }
+
+  // leave system in snapshot state with best knob values
+
+  restore();
+  apply(best);
+
+  MPI_Barrier(world);
+  double time2 = MPI_Wtime();
+
+  if (bestrate == 0.0 && me == 0)
+    error->warning(FLERR,"Autotune found no particles to move");
+
+  // print best settings as commands to paste into an input script
+
+  if (me == 0) {
+    double speedup = rates[0] > 0.0 ? bestrate/rates[0] : 1.0;
+    if (screen) {
+      fprintf(screen,"Autotune best = %g moves/sec, %g x 1st trial\n",
+              bestrate,speedup);
+      fprintf(screen,"  %d trials in %g secs\n",ntrial,time2-time1);
+      fprintf(screen,"  best settings:\n");
+    }
+    if (logfile) {
+      fprintf(logfile,"Autotune best = %g moves/sec, %g x 1st trial\n",
+              bestrate,speedup);
+      fprintf(logfile,"  %d trials in %g secs\n",ntrial,time2-time1);
+      fprintf(logfile,"  best settings:\n");
+    }
+    for (int k = 0; k < nknob; k++) {
+      char *ptr = strchr(knob[k],'*');
+      *ptr = '\0';
+      if (screen)
+        fprintf(screen,"%s%s%s\n",knob[k],choice[k][best[k]],ptr+1);
+      if (logfile)
+        fprintf(logfile,"%s%s%s\n",knob[k],choice[k][best[k]],ptr+1);
+      *ptr = '*';
+    }
+  }
+
+  delete [] config;
+  delete [] best;
+}
+
+/* ----------------------------------------------------------------------
+   run one trial with knob values in config, nrepeat times
+   return fastest rate in particle moves/sec
+------------------------------------------------------------------------- */
+
+double AutoTune::trial(int *config)
+{
+  char str[64];
+  sprintf(str,"run %d post no",nsteps);
+
+  double rate,time;
+  bigint nme,nmove;
+  double bestrate = 0.0;
+
+  for (int irepeat = 0; irepeat < nrepeat; irepeat++) {
+    restore();
+    apply(config);
+    input->one(str);
+
+    MPI_Allreduce(&timer->array[TIME_LOOP],&time,1,MPI_DOUBLE,MPI_MAX,world);
+    nme = update->nmove_running;
+    MPI_Allreduce(&nme,&nmove,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+    if (time > 0.0) rate = nmove/time;
+    else rate = 0.0;
+    if (rate > bestrate) bestrate = rate;
+  }
+
+  if (ntrial == maxtrial) {
+    maxtrial += DELTA;
+    memory->grow(trials,maxtrial*nknob,"autotune:trials");
+    memory->grow(rates,maxtrial,"autotune:rates");
+  }
+  for (int i = 0; i < nknob; i++) trials[ntrial*nknob+i] = config[i];
+  rates[ntrial] = bestrate;
+  ntrial++;
+
+  print_trial(ntrial-1);
+  return bestrate;
+}
+
+/* ----------------------------------------------------------------------
+   return index of previous trial with knob values in config, -1 if none
+------------------------------------------------------------------------- */
+
+int AutoTune::find_trial(int *config)
+{
+  int i;
+  for (int m = 0; m < ntrial; m++) {
+    for (i = 0; i < nknob; i++)
+      if (trials[m*nknob+i] != config[i]) break;
+    if (i == nknob) return m;
+  }
+  return -1;
+}
+
+/* ----------------------------------------------------------------------
+   print knob values and rate of one trial
+------------------------------------------------------------------------- */
+
+void AutoTune::print_trial(int m)
+{
+  if (me) return;
+
+  if (screen) {
+    fprintf(screen,"Autotune trial %d: %g moves/sec with",m+1,rates[m]);
+    for (int k = 0; k < nknob; k++)
+      fprintf(screen," %s",choice[k][trials[m*nknob+k]]);
+    fprintf(screen,"\n");
+  }
+  if (logfile) {
+    fprintf(logfile,"Autotune trial %d: %g moves/sec with",m+1,rates[m]);
+    for (int k = 0; k < nknob; k++)
+      fprintf(logfile," %s",choice[k][trials[m*nknob+k]]);
+    fprintf(logfile,"\n");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   issue each knob's command with its value in config substituted for *
+   a knob such as global gridcut removes ghost cells, so re-acquire them
+------------------------------------------------------------------------- */
+
+void AutoTune::apply(int *config)
+{
+  for (int k = 0; k < nknob; k++) {
+    char *value = choice[k][config[k]];
+    char *cmd = new char[strlen(knob[k]) + strlen(value) + 1];
+    char *ptr = strchr(knob[k],'*');
+    *ptr = '\0';
+    sprintf(cmd,"%s%s%s",knob[k],value,ptr+1);
+    *ptr = '*';
+    input->one(cmd);
+    delete [] cmd;
+  }
+
+  if (!grid->exist_ghost) {
+    grid->acquire_ghosts();
+    grid->find_neighbors();
+    comm->reset_neighbors();
+  }
+}
+
+/* ----------------------------------------------------------------------
+   store current timestep, grid decomposition, and particles
+   particles store the ID of their cell, and sub cell index if any,
+     so they can be restored after trials move grid cells between procs
+------------------------------------------------------------------------- */
+
+void AutoTune::snapshot()
+{
+  Grid::ChildCell *cells = grid->cells;
+  Grid::SplitInfo *sinfo = grid->sinfo;
+  int nglocal = grid->nlocal;
+
+  step_snap = update->ntimestep;
+  clumped_snap = grid->clumped;
+
+  int *cell2slot;
+  memory->create(cell2slot,nglocal,"autotune:cell2slot");
+
+  ncell_snap = 0;
+  for (int icell = 0; icell < nglocal; icell++)
+    if (cells[icell].nsplit > 0) ncell_snap++;
+  memory->create(cellid_snap,ncell_snap,"autotune:cellid_snap");
+
+  ncell_snap = 0;
+  for (int icell = 0; icell < nglocal; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    cell2slot[icell] = ncell_snap;
+    cellid_snap[ncell_snap++] = cells[icell].id;
+  }
+
+  Particle::OnePart *particles = particle->particles;
+  int nbytes_particle = sizeof(Particle::OnePart);
+  int ncustom = particle->ncustom;
+
+  npart_snap = particle->nlocal;
+  nbytes_snap = nbytes_particle + particle->sizeof_custom();
+  memory->create(part_snap,(bigint) npart_snap*nbytes_snap,
+                 "autotune:part_snap");
+  memory->create(slot_snap,npart_snap,"autotune:slot_snap");
+  memory->create(sub_snap,npart_snap,"autotune:sub_snap");
+
+  int icell;
+  char *ptr = part_snap;
+  for (int i = 0; i < npart_snap; i++) {
+    icell = particles[i].icell;
+    if (cells[icell].nsplit <= 0) {
+      sub_snap[i] = -cells[icell].nsplit;
+      icell = sinfo[cells[icell].isplit].icell;
+    } else sub_snap[i] = -1;
+    slot_snap[i] = cell2slot[icell];
+    memcpy(ptr,&particles[i],nbytes_particle);
+    if (ncustom) particle->pack_custom(i,ptr+nbytes_particle);
+    ptr += nbytes_snap;
+  }
+
+  memory->destroy(cell2slot);
+}
+
+/* ----------------------------------------------------------------------
+   restore timestep, grid decomposition, and particles from snapshot
+------------------------------------------------------------------------- */
+
+void AutoTune::restore()
+{
+  // discard current particles
+
+  particle->nlocal = 0;
+  particle->sorted = 0;
+
+  // move grid cells back to their snapshot owners if any have moved
+
+  Grid::ChildCell *cells = grid->cells;
+  int nglocal = grid->nlocal;
+
+  int n = 0;
+  int flag = 0;
+  for (int icell = 0; icell < nglocal; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    if (n == ncell_snap || cells[icell].id != cellid_snap[n]) flag = 1;
+    n++;
+  }
+  if (n != ncell_snap) flag = 1;
+
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall) restore_cells();
+
+  // local index of each snapshot cell, via hash of cell IDs
+
+  grid->rehash();
+
+  cells = grid->cells;
+  Grid::SplitInfo *sinfo = grid->sinfo;
+
+  int *slot2cell;
+  memory->create(slot2cell,ncell_snap,"autotune:slot2cell");
+  for (int i = 0; i < ncell_snap; i++)
+    slot2cell[i] = (*grid->hash)[cellid_snap[i]] - 1;
+
+  // copy particles from snapshot, resetting their cell index
+
+  particle->grow(npart_snap);
+  Particle::OnePart *particles = particle->particles;
+  int nbytes_particle = sizeof(Particle::OnePart);
+  int ncustom = particle->ncustom;
+
+  int icell;
+  char *ptr = part_snap;
+  for (int i = 0; i < npart_snap; i++) {
+    icell = slot2cell[slot_snap[i]];
+    if (sub_snap[i] >= 0)
+      icell = sinfo[cells[icell].isplit].csubs[sub_snap[i]];
+    memcpy(&particles[i],ptr,nbytes_particle);
+    particles[i].icell = icell;
+    if (ncustom) particle->unpack_custom(ptr+nbytes_particle,i);
+    ptr += nbytes_snap;
+  }
+  particle->nlocal = npart_snap;
+
+  memory->destroy(slot2cell);
+
+  // restore timestep
+
+  char str[32];
+  char *args[1];
+  sprintf(str,BIGINT_FORMAT,step_snap);
+  args[0] = str;
+  update->reset_timestep(1,args);
+}
+
+/* ----------------------------------------------------------------------
+   migrate grid cells back to procs that owned them in snapshot
+   each proc's list of snapshot cell IDs is passed around a ring,
+     so each proc learns the snapshot owner of every cell it now owns
+   same steps to complete grid setup as in FixBalance
+------------------------------------------------------------------------- */
+
+void AutoTune::restore_cells()
+{
+  Grid::ChildCell *cells = grid->cells;
+  int nglocal = grid->nlocal;
+
+  grid->rehash();
+
+  cellint *buf;
+  memory->create(buf,ncell_snap+1,"autotune:buf");
+  buf[0] = me;
+  for (int i = 0; i < ncell_snap; i++) buf[i+1] = cellid_snap[i];
+
+  aptr = this;
+  comm->ring(ncell_snap+1,sizeof(cellint),buf,3,owner_callback,NULL,1);
+  memory->destroy(buf);
+
+  int nmigrate = 0;
+  for (int icell = 0; icell < nglocal; icell++) {
+    if (cells[icell].nsplit <= 0) continue;
+    if (cells[icell].proc != me) nmigrate++;
+  }
+
+  grid->clumped = clumped_snap;
+
+  particle->sort();
+
+  grid->unset_neighbors();
+  grid->remove_ghosts();
+  comm->migrate_cells(nmigrate);
+
+  grid->setup_owned();
+  grid->acquire_ghosts();
+
+  grid->reset_neighbors();
+  comm->reset_neighbors();
+
+  // reallocate per grid cell arrays in per grid computes
+
+  Compute **compute = modify->compute;
+  for (int i = 0; i < modify->ncompute; i++)
+    if (compute[i]->per_grid_flag) compute[i]->reallocate();
+
+  // reallocate per grid arrays in per grid dumps
+
+  for (int i = 0; i < output->ndump; i++)
+    output->dump[i]->reset_grid();
+}
+
+/* ----------------------------------------------------------------------
+   callback from ring communication in restore_cells()
+   1st value in buf is proc that owned the remaining cell IDs in snapshot
+   set proc of each of those cells I now own to that proc
+------------------------------------------------------------------------- */
+
+void AutoTune::owner_callback(int n, char *cbuf)
+{
+  Grid *grid = aptr->grid;
+  Grid::ChildCell *cells = grid->cells;
+  int nglocal = grid->nlocal;
+
+  cellint *list = (cellint *) cbuf;
+  int proc = list[0];
+
+  int icell;
+  for (int i = 1; i < n; i++) {
+    if (grid->hash->find(list[i]) == grid->hash->end()) continue;
+    icell = (*grid->hash)[list[i]] - 1;
+    if (icell < 0 || icell >= nglocal) continue;
+    cells[icell].proc = proc;
+  }
+}
@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMMAND_CLASS
+
+CommandStyle(autotune,AutoTune)
+
+#else
+
+#ifndef SPARTA_AUTOTUNE_H
+#define SPARTA_AUTOTUNE_H
+
+#include "pointers.h"
+
+namespace SPARTA_NS {
+
+class AutoTune : protected Pointers {
+ public:
+  AutoTune(class SPARTA *);
+  ~AutoTune();
+  void command(int, char **);
+
+ private:
+  int me,nprocs;
+  int nsteps;                 // # of timesteps in each trial
+  int nrepeat;                // # of times each trial is run, fastest kept
+  int searchstyle;            // DESCENT or EXHAUSTIVE
+
+  int nknob;                  // # of knobs
+  char **knob;                // command template for each knob, with a *
+  int *nchoice;               // # of candidate values for each knob
+  char ***choice;             // choice[i][j] = value J of knob I
+
+  int ntrial,maxtrial;        // trials run so far
+  int *trials;                // choice index of each knob for each trial
+  double *rates;              // moves/sec of each trial
+
+  // snapshot of state restored before each trial
+
+  bigint step_snap;           // timestep
+  int clumped_snap;           // clumped setting of grid decomposition
+  int ncell_snap;             // # of unsplit and split cells I owned
+  cellint *cellid_snap;       // their IDs
+  int npart_snap;             // # of particles I owned
+  int nbytes_snap;            // bytes per particle, including custom data
+  char *part_snap;            // particles I owned, packed
+  int *slot_snap;             // index into cellid_snap of each particle's cell
+  int *sub_snap;              // sub cell index of each particle, -1 if none
+
+  void snapshot();
+  void restore();
+  void restore_cells();
+  void apply(int *);
+  double trial(int *);
+  int find_trial(int *);
+  void print_trial(int);
+
+  // callback from ring communication
+
+  static AutoTune *aptr;
+  static void owner_callback(int, char *);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Cannot use autotune before grid is defined
+
+Self-explanatory.
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running SPARTA to see the offending line.
+
+E: Autotune knob must contain one * character
+
+The * in the command template of each knob is replaced by each of its
+candidate values in turn.
+
+E: Autotune knob has no values
+
+Each knob must list at least one candidate value.
+
+W: Autotune found no particles to move
+
+The trials moved no particles, so their rates cannot be compared.
+Autotune should be used after particles exist, e.g. after an initial
+equilibration run.
+
+*/
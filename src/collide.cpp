@@ -26,6 +26,7 @@
 #include "fix_ambipolar.h"
 #include "random_mars.h"
 #include "random_park.h"
+#include "random_philox.h"
 #include "memory.h"
 #include "error.h"
 
@@ -82,6 +83,10 @@ Collide::Collide(SPARTA *sparta, int, char **arg) : Pointers(sparta)
   vibstyle = NONE;
   nearcp = 0;
   nearlimit = 10;
+  rngcell = 0;
+  rstream = NULL;
+  tableflag = 0;
+  tabletol = 1.0e-4;
 
   recomb_ijflag = NULL;
 
@@ -113,6 +118,7 @@ Collide::~Collide()
   delete [] style;
   delete [] mixID;
   delete random;
+  delete rstream;
 
   memory->destroy(plist);
   if (ngroups > 1) {
@@ -253,6 +259,12 @@ void Collide::init()
     ions = afix->ions;
   }
 
+  // for multiple groups, have Particle::sort() bucket particles by group
+  // so collisions_group() can use contiguous per-group lists
+
+  if (ngroups > 1 && !ambiflag)
+    particle->sort_groups(ngroups,mixture->species2group);
+
   // vre_next = next timestep to zero vremax & remain, based on vre_every
 
   if (vre_every) vre_next = (update->ntimestep/vre_every)*vre_every + vre_every;
@@ -323,6 +335,30 @@ void Collide::modify_params(int narg, char **arg)
       if (nearcp && nearlimit <= 0) 
         error->all(FLERR,"Illegal collide_modify command");
       iarg += 3;
+    } else if (strcmp(arg[iarg],"rng") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal collide_modify command");
+      if (strcmp(arg[iarg+1],"proc") == 0) rngcell = 0;
+      else if (strcmp(arg[iarg+1],"cell") == 0) rngcell = 1;
+      else error->all(FLERR,"Illegal collide_modify command");
+      if (rngcell && !rstream) {
+        int seed = static_cast<int> (update->ranmaster->uniform()*MAXSMALLINT);
+        rstream = new RanPhilox(seed,0);
+      }
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"table") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal collide_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) {
+        if (iarg+3 > narg)
+          error->all(FLERR,"Illegal collide_modify command");
+        tableflag = 1;
+        tabletol = atof(arg[iarg+2]);
+        if (tabletol <= 0.0 || tabletol >= 1.0) 
+          error->all(FLERR,"Illegal collide_modify command");
+        iarg += 3;
+      } else if (strcmp(arg[iarg+1],"no") == 0) {
+        tableflag = 0;
+        iarg += 2;
+      } else error->all(FLERR,"Illegal collide_modify command");
 
     } else error->all(FLERR,"Illegal collide_modify command");
   }
@@ -343,6 +379,22 @@ void Collide::reset_vremax()
       }
 }
 
+/* ----------------------------------------------------------------------
+   re-derive collision RNGs from master RNG after it is re-seeded
+------------------------------------------------------------------------- */
+
+void Collide::reseed()
+{
+  double seed = update->ranmaster->uniform();
+  random->reset(seed,comm->me,100);
+
+  if (rstream) {
+    delete rstream;
+    int rseed = static_cast<int> (update->ranmaster->uniform()*MAXSMALLINT);
+    rstream = new RanPhilox(rseed,0);
+  }
+}
+
 /* ----------------------------------------------------------------------
   NTC algorithm
 ------------------------------------------------------------------------- */
@@ -391,6 +443,23 @@ void Collide::collisions()
   nreact_running += nreact_one;
 }
 
+/* ----------------------------------------------------------------------
+   reseed collision and reaction RNGs for one grid cell
+   seeds come from counter-based RNG keyed by timestep and cell ID,
+     so RNs used in a cell are independent of proc count and cell order
+   sub cells share the ID of their split cell, so sub cell index is
+     also part of the key, else sibling sub cells would use the same RNs
+------------------------------------------------------------------------- */
+
+void Collide::stream_rng(int icell)
+{
+  Grid::ChildCell *cells = grid->cells;
+  int isub = cells[icell].nsplit <= 0 ? -cells[icell].nsplit : 0;
+  rstream->reset(update->ntimestep,cells[icell].id,isub);
+  random->reset(rstream->uniform(),0,0);
+  if (react) react->reset_random(rstream->uniform());
+}
+
 /* ----------------------------------------------------------------------
    NTC algorithm for a single group
 ------------------------------------------------------------------------- */
@@ -412,6 +481,7 @@ template < int NEARCP > void Collide::collisions_one()
   for (int icell = 0; icell < nglocal; icell++) {
     np = cinfo[icell].count;
     if (np <= 1) continue;
+    if (rngcell) stream_rng(icell);
 
     if (NEARCP) {
       if (np > max_nn) realloc_nn(np,nn_last_partner);
@@ -540,6 +610,7 @@ template < int NEARCP > void Collide::collisions_group()
   int nattempt,reactflag;
   int *ni,*nj,*ilist,*jlist;
   int *nn_igroup,*nn_jgroup;
+  int *gfirst,*cplist;
   double attempt,volume;
   Particle::OnePart *ipart,*jpart,*kpart;
 
@@ -551,44 +622,73 @@ template < int NEARCP > void Collide::collisions_group()
   int *next = particle->next;
   int *species2group = mixture->species2group;
 
+  int gsortflag = 0;
+  if (particle->ngsort == ngroups) gsortflag = 1;
+  int *gsortfirst = particle->gsortfirst;
+  int *gsortlist = particle->gsortlist;
+
   for (int icell = 0; icell < nglocal; icell++) {
     np = cinfo[icell].count;
     if (np <= 1) continue;
+    if (rngcell) stream_rng(icell);
     ip = cinfo[icell].first;
     volume = cinfo[icell].volume / cinfo[icell].weight;
     if (volume == 0.0) error->one(FLERR,"Collision cell volume is zero");
 
-    // if recombination is possible, setup particle list for entire cell
-    // used to pick 3rd particle from entire cell, not just from IJgroups
-
-    if (recombflag) {
-      if (np > npmax) {
-        npmax = np + DELTAPART;
-        memory->destroy(plist);
-        memory->create(plist,npmax,"collide:plist");
+    // if particles are bucketed by group in Particle::sort(),
+    //   copy contiguous per-group ranges, no walk of linked list needed
+    // cell list used to pick 3rd particle for recombination
+    //   is then entire range of cell
+
+    if (gsortflag) {
+      gfirst = &gsortfirst[icell*ngroups];
+      for (i = 0; i < ngroups; i++) {
+        n = gfirst[i+1] - gfirst[i];
+        if (n > maxgroup[i]) {
+          maxgroup[i] = n + DELTAPART;
+          memory->destroy(glist[i]);
+          memory->create(glist[i],maxgroup[i],"collide:grouplist");
+        }
+        memcpy(glist[i],&gsortlist[gfirst[i]],n*sizeof(int));
+        ngroup[i] = n;
       }
+      cplist = &gsortlist[gfirst[0]];
 
-      n = 0;
-      while (ip >= 0) {
-        plist[n++] = ip;
-        ip = next[ip];
+    } else {
+
+      // if recombination is possible, setup particle list for entire cell
+      // used to pick 3rd particle from entire cell, not just from IJgroups
+
+      if (recombflag) {
+        if (np > npmax) {
+          npmax = np + DELTAPART;
+          memory->destroy(plist);
+          memory->create(plist,npmax,"collide:plist");
+        }
+
+        n = 0;
+        while (ip >= 0) {
+          plist[n++] = ip;
+          ip = next[ip];
+        }
+        ip = cinfo[icell].first;         // reset ip to 1st particle in cell
       }
-      ip = cinfo[icell].first;         // reset ip to 1st particle in cell
-    }
+      cplist = plist;
 
-    // setup per-group particle lists for this cell
+      // setup per-group particle lists for this cell
 
-    for (i = 0; i < ngroups; i++) ngroup[i] = 0;
+      for (i = 0; i < ngroups; i++) ngroup[i] = 0;
 
-    while (ip >= 0) {
-      isp = particles[ip].ispecies;
-      igroup = species2group[isp];
-      if (ngroup[igroup] == maxgroup[igroup]) {
-	maxgroup[igroup] += DELTAPART;
-	memory->grow(glist[igroup],maxgroup[igroup],"collide:grouplist");
+      while (ip >= 0) {
+        isp = particles[ip].ispecies;
+        igroup = species2group[isp];
+        if (ngroup[igroup] == maxgroup[igroup]) {
+          maxgroup[igroup] += DELTAPART;
+          memory->grow(glist[igroup],maxgroup[igroup],"collide:grouplist");
+        }
+        glist[igroup][ngroup[igroup]++] = ip;
+        ip = next[ip];
       }
-      glist[igroup][ngroup[igroup]++] = ip;
-      ip = next[ip];
     }
 
     if (NEARCP) {
@@ -691,12 +791,12 @@ template < int NEARCP > void Collide::collisions_group()
             ii = ilist[i];
             jj = jlist[j];
             k = np * random->uniform();
-            kk = plist[k];
+            kk = cplist[k];
             while (kk == ii || kk == jj) {
               k = np * random->uniform();
-              kk = plist[k];
+              kk = cplist[k];
             }
-            react->recomb_part3 = &particles[plist[k]];
+            react->recomb_part3 = &particles[cplist[k]];
             react->recomb_species = react->recomb_part3->ispecies;
             react->recomb_density = np * update->fnum / volume;
           }
@@ -832,6 +932,7 @@ void Collide::collisions_one_ambipolar()
   for (int icell = 0; icell < nglocal; icell++) {
     np = cinfo[icell].count;
     if (np <= 1) continue;
+    if (rngcell) stream_rng(icell);
     ip = cinfo[icell].first;
     volume = cinfo[icell].volume / cinfo[icell].weight;
     if (volume == 0.0) error->one(FLERR,"Collision cell volume is zero");
@@ -1090,6 +1191,7 @@ void Collide::collisions_group_ambipolar()
   for (int icell = 0; icell < nglocal; icell++) {
     np = cinfo[icell].count;
     if (np <= 1) continue;
+    if (rngcell) stream_rng(icell);
     ip = cinfo[icell].first;
     volume = cinfo[icell].volume / cinfo[icell].weight;
     if (volume == 0.0) error->one(FLERR,"Collision cell volume is zero");
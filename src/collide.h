@@ -30,6 +30,9 @@ class Collide : protected Pointers {
   int vibstyle;       // none/discrete/smooth vibrational modes
   int nearcp;         // 1 for near neighbor collisions
   int nearlimit;      // limit on neighbor serach for near neigh collisions
+  int rngcell;        // 1 if RNGs are reseeded per cell from counter-based RNG
+  int tableflag;      // 1 if child class evaluates collision terms from tables
+  double tabletol;    // max relative interpolation error of tables
 
   int ncollide_one,nattempt_one,nreact_one;
   bigint ncollide_running,nattempt_running,nreact_running;
@@ -39,6 +42,7 @@ class Collide : protected Pointers {
   virtual void init();
   void modify_params(int, char **);
   void reset_vremax();
+  void reseed();
   virtual void collisions();
 
   virtual double vremax_init(int, int) = 0;
@@ -85,6 +89,7 @@ class Collide : protected Pointers {
   char *mixID;               // ID of mixture to use for groups
   class Mixture *mixture;    // ptr to mixture
   class RanPark *random;     // RNG for collision generation
+  class RanPhilox *rstream;  // counter-based RNG for per-cell seeds
 
   int vre_first;      // 1 for first run after collision style is defined
   int vre_start;      // 1 if reset vre params at start of each run
@@ -136,6 +141,7 @@ class Collide : protected Pointers {
   void ambi_reset(int, int, int, int, Particle::OnePart *, Particle::OnePart *, 
                   Particle::OnePart *, int *);
   void ambi_check();
+  void stream_rng(int);
   void grow_percell(int);
 
   int find_nn(int, int);
@@ -24,6 +24,7 @@
 #include "react.h"
 #include "comm.h"
 #include "random_park.h"
+#include "math_random.h"
 #include "math_const.h"
 #include "memory.h"
 #include "error.h"
@@ -35,6 +36,10 @@ enum{NONE,DISCRETE,SMOOTH};            // several files
 enum{CONSTANT,VARIABLE};
 
 #define MAXLINE 1024
+#define NTABLEMIN 64          // min # of intervals in a collision table
+#define NTABLEMAX 65536       // max # of intervals in a collision table
+#define VRSCALE 10.0          // table range in units of thermal speed
+#define NEXACTFRAC 16         // max 1/NEXACTFRAC of table evaluated exactly
 
 /* ---------------------------------------------------------------------- */
 
@@ -82,6 +87,8 @@ CollideVSS::CollideVSS(SPARTA *sparta, int narg, char **arg) :
   // allocate per-species prefactor array
 
   memory->create(prefactor,nparams,nparams,"collide:prefactor");
+
+  for (int k = 0; k < NTABLE; k++) tables[k] = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -92,6 +99,7 @@ CollideVSS::~CollideVSS()
 
   delete [] params;
   memory->destroy(prefactor);
+  destroy_tables();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -104,6 +112,11 @@ void CollideVSS::init()
     error->all(FLERR,"VSS parameters do not match current species");
 
   Collide::init();
+
+  // tables use prefactor set by vremax_init() and mixture vscale
+
+  destroy_tables();
+  if (tableflag) build_tables();
 }
 
 /* ----------------------------------------------------------------------
@@ -211,15 +224,20 @@ int CollideVSS::test_collision(int icell, int igroup, int jgroup,
   double dv  = vi[1] - vj[1];
   double dw  = vi[2] - vj[2];
   double vr2 = du*du + dv*dv + dw*dw;
-  double omega1 = params[ispecies].omega;
-  double omega2 = params[jspecies].omega;
-  double omega = 0.5 * (omega1+omega2);
-  double vro  = pow(vr2,1.0-omega);
 
   // although the vremax is calcualted for the group,
   // the individual collisions calculated species dependent vre
 
-  double vre = vro*prefactor[ispecies][jspecies];
+  double vre;
+  if (tableflag) vre = lookup(TRATE,ispecies,jspecies,vr2);
+  else {
+    double omega1 = params[ispecies].omega;
+    double omega2 = params[jspecies].omega;
+    double omega = 0.5 * (omega1+omega2);
+    double vro  = pow(vr2,1.0-omega);
+    vre = vro*prefactor[ispecies][jspecies];
+  }
+
   vremax[icell][igroup][jgroup] = MAX(vre,vremax[icell][igroup][jgroup]);
   if (vre/vremax[icell][igroup][jgroup] < random->uniform()) return 0;
   precoln.vr2 = vr2;
@@ -448,15 +466,17 @@ void CollideVSS::EEXCHANGE_NonReactingEDisposal(Particle::OnePart *ip,
       double rotn_phi = species[sp].rotrel; 
 
       if (rotdof) {
-        if (relaxflag == VARIABLE) rotn_phi = rotrel(sp,E_Dispose);
+        if (relaxflag == VARIABLE) {
+          if (tableflag) rotn_phi = lookup(TROT,sp,sp,E_Dispose);
+          else rotn_phi = rotrel(sp,E_Dispose);
+        }
         if (rotn_phi >= random->uniform()) {
           if (rotstyle == NONE) {
             p->erot = 0.0 ; 
 
           } else if (rotstyle != NONE && rotdof == 2) {
             E_Dispose += p->erot;
-            Fraction_Rot = 
-              1- pow(random->uniform(),(1/(2.5-params[sp].omega)));
+            Fraction_Rot = frac_2dof(sp);
             p->erot = Fraction_Rot * E_Dispose;
             E_Dispose -= p->erot;
           } else {
@@ -474,7 +494,10 @@ void CollideVSS::EEXCHANGE_NonReactingEDisposal(Particle::OnePart *ip,
       double vibn_phi = species[sp].vibrel; 
 
       if (vibdof) {
-        if (relaxflag == VARIABLE) vibn_phi = vibrel(sp,E_Dispose+p->evib);
+        if (relaxflag == VARIABLE) {
+          if (tableflag) vibn_phi = lookup(TVIB,sp,sp,E_Dispose+p->evib);
+          else vibn_phi = vibrel(sp,E_Dispose+p->evib);
+        }
         if (vibn_phi >= random->uniform()) {
           if (vibstyle == NONE) {
             p->evib = 0.0; 
@@ -487,15 +510,13 @@ void CollideVSS::EEXCHANGE_NonReactingEDisposal(Particle::OnePart *ip,
               ivib = static_cast<int> 
                 (random->uniform()*(max_level+AdjustFactor));
               p->evib = ivib * update->boltz * species[sp].vibtemp;
-              State_prob = pow((1.0 - p->evib / E_Dispose),
-                             (1.5 - params[sp].omega));
+              State_prob = discrete_prob(sp,1.0 - p->evib / E_Dispose);
             } while (State_prob < random->uniform());
             E_Dispose -= p->evib;
 
           } else if (vibdof == 2 && vibstyle == SMOOTH) {
             E_Dispose += p->evib;
-            Fraction_Vib = 
-              1.0 - pow(random->uniform(),(1.0/(2.5-params[sp].omega)));
+            Fraction_Vib = frac_2dof(sp);
             p->evib= Fraction_Vib * E_Dispose;
             E_Dispose -= p->evib;
 
@@ -632,8 +653,7 @@ void CollideVSS::EEXCHANGE_ReactingEDisposal(Particle::OnePart *ip,
       if (rotstyle == NONE) {
         p->erot = 0.0 ;
       } else if (rotdof == 2) {
-        Fraction_Rot =
-          1- pow(random->uniform(),(1/(2.5-params[sp].omega)));
+        Fraction_Rot = frac_2dof(sp);
         p->erot = Fraction_Rot * E_Dispose;
         E_Dispose -= p->erot;
         
@@ -658,14 +678,12 @@ void CollideVSS::EEXCHANGE_ReactingEDisposal(Particle::OnePart *ip,
             (random->uniform()*(max_level+AdjustFactor));
           p->evib = (double)
             (ivib * update->boltz * species[sp].vibtemp);
-          State_prob = pow((1.0 - p->evib / E_Dispose),
-                           (1.5 - params[sp].omega));
+          State_prob = discrete_prob(sp,1.0 - p->evib / E_Dispose);
         } while (State_prob < random->uniform());
         E_Dispose -= p->evib;
         
       } else if (vibdof == 2 && vibstyle == SMOOTH) {
-        Fraction_Vib =
-          1.0 - pow(random->uniform(),(1.0 / (2.5-params[sp].omega)));
+        Fraction_Vib = frac_2dof(sp);
         p->evib = Fraction_Vib * E_Dispose;
         E_Dispose -= p->evib;
         
@@ -694,17 +712,14 @@ void CollideVSS::EEXCHANGE_ReactingEDisposal(Particle::OnePart *ip,
   postcoln.etrans = E_Dispose;
 }
 
-/* ---------------------------------------------------------------------- */
+/* ----------------------------------------------------------------------
+   sample Larsen-Borgnakke energy fraction x from x^Exp_1 (1-x)^Exp_2
+   this is a beta distribution, sampled directly without rejection
+------------------------------------------------------------------------- */
 
 double CollideVSS::sample_bl(RanPark *random, double Exp_1, double Exp_2)
 {
-  double Exp_s = Exp_1 + Exp_2;
-  double x,y;
-  do {
-    x = random->uniform();
-    y = pow(x*Exp_s/Exp_1, Exp_1)*pow((1.0-x)*Exp_s/Exp_2, Exp_2);
-  } while (y < random->uniform());
-  return x;
+  return MathRandom::beta(random,Exp_1+1.0,Exp_2+1.0);
 }
 
 /* ----------------------------------------------------------------------
@@ -732,6 +747,188 @@ double CollideVSS::vibrel(int isp, double Ec)
   return vibphi;
 }
 
+/* ----------------------------------------------------------------------
+   sample Larsen-Borgnakke energy fraction for a 2-dof internal mode
+------------------------------------------------------------------------- */
+
+double CollideVSS::frac_2dof(int isp)
+{
+  if (tableflag) return lookup(TFRAC,isp,isp,random->uniform());
+  return 1.0 - pow(random->uniform(),(1.0/(2.5-params[isp].omega)));
+}
+
+/* ----------------------------------------------------------------------
+   acceptance probability of a discrete vib level
+   x = fraction of disposable energy left after the level is populated
+------------------------------------------------------------------------- */
+
+double CollideVSS::discrete_prob(int isp, double x)
+{
+  if (tableflag) return lookup(TDISCRETE,isp,isp,x);
+  return pow(x,(1.5 - params[isp].omega));
+}
+
+/* ----------------------------------------------------------------------
+   exact value of a tabulated term for species isp,jsp at x
+------------------------------------------------------------------------- */
+
+double CollideVSS::exact(int kind, int isp, int jsp, double x)
+{
+  if (kind == TRATE) {
+    double omega = 0.5 * (params[isp].omega + params[jsp].omega);
+    return pow(x,1.0-omega)*prefactor[isp][jsp];
+  } 
+  if (kind == TROT) return rotrel(isp,x);
+  if (kind == TVIB) return vibrel(isp,x);
+  if (kind == TFRAC) return 1.0 - pow(x,(1.0/(2.5-params[isp].omega)));
+  return pow(x,(1.5 - params[isp].omega));
+}
+
+/* ----------------------------------------------------------------------
+   build tables for collision terms, used if collide_modify table is set
+   collision rate and relaxation tables span VRSCALE thermal speeds
+     plus twice the stream speed of the collision mixture
+   mixture vscale is indexed by mixture species, so map via s2s
+   terms beyond the end of a table are evaluated exactly by lookup()
+   report max interpolation error and fraction of range evaluated exactly
+     for each kind of table
+------------------------------------------------------------------------- */
+
+void CollideVSS::build_tables()
+{
+  Particle::Species *species = particle->species;
+  double *vscale = mixture->vscale;
+  double *vstream = mixture->vstream;
+  int *s2s = mixture->species2species;
+  int nspecies = particle->nspecies;
+
+  double vsmax = 2.0*sqrt(vstream[0]*vstream[0] + vstream[1]*vstream[1] + 
+                          vstream[2]*vstream[2]);
+
+  for (int k = 0; k < NTABLE; k++) {
+    int n = nspecies;
+    if (k == TRATE) n = nspecies*nspecies;
+    tables[k] = new Table[n];
+    for (int i = 0; i < n; i++) {
+      tables[k][i].n = tables[k][i].nlo = 0;
+      tables[k][i].invdelta = 0.0;
+      tables[k][i].f = NULL;
+    }
+    tablen[k] = 0;
+    tablerr[k] = 0.0;
+    tablexact[k] = 0.0;
+  }
+
+  double vrmax;
+
+  for (int isp = 0; isp < nspecies; isp++) {
+    for (int jsp = 0; jsp < nspecies; jsp++) {
+      vrmax = vsmax + VRSCALE*MAX(vscale[s2s[isp]],vscale[s2s[jsp]]);
+      build_table(tables[TRATE][isp*nspecies+jsp],TRATE,isp,jsp,vrmax*vrmax);
+    }
+
+    vrmax = vsmax + VRSCALE*vscale[s2s[isp]];
+    double emax = species[isp].mass*vrmax*vrmax;
+
+    if (relaxflag == VARIABLE && species[isp].rotdof)
+      build_table(tables[TROT][isp],TROT,isp,isp,emax);
+    if (relaxflag == VARIABLE && species[isp].vibdof)
+      build_table(tables[TVIB][isp],TVIB,isp,isp,emax);
+
+    build_table(tables[TFRAC][isp],TFRAC,isp,isp,1.0);
+    build_table(tables[TDISCRETE][isp],TDISCRETE,isp,isp,1.0);
+  }
+
+  // all procs build identical tables, proc 0 reports their accuracy
+
+  if (comm->me) return;
+
+  const char *names[NTABLE] = {"collision rate","rotational relax",
+                               "vibrational relax","LB fraction",
+                               "discrete vib prob"};
+  int flag = 0;
+  for (int k = 0; k < NTABLE; k++) {
+    if (tablen[k] == 0) continue;
+    if (tablexact[k]*NEXACTFRAC > 1.0) flag = 1;
+    if (screen) 
+      fprintf(screen,"  collision table %s: %d intervals, "
+              "max error %g, exact fraction %g\n",
+              names[k],tablen[k],tablerr[k],tablexact[k]);
+    if (logfile) 
+      fprintf(logfile,"  collision table %s: %d intervals, "
+              "max error %g, exact fraction %g\n",
+              names[k],tablen[k],tablerr[k],tablexact[k]);
+  }
+  if (flag) error->warning(FLERR,"Collision tables are evaluated exactly "
+                           "over a large part of their range");
+}
+
+/* ----------------------------------------------------------------------
+   tabulate one term on (0,xmax] with equal intervals
+   intervals whose midpoint relative error exceeds tabletol are
+     evaluated exactly, e.g. near singular x = 0 for power laws
+   nlo = # of leading intervals evaluated exactly
+   double # of intervals until nlo is a small fraction of them
+     or NTABLEMAX is reached
+------------------------------------------------------------------------- */
+
+void CollideVSS::build_table(Table &t, int kind, int isp, int jsp, 
+                             double xmax)
+{
+  int nlo;
+  double delta,x,value,err,errone;
+
+  int n = NTABLEMIN;
+  double *f = NULL;
+
+  while (1) {
+    memory->grow(f,n+1,"collide:table");
+    delta = xmax/n;
+    f[0] = 0.0;
+    for (int i = 1; i <= n; i++) f[i] = exact(kind,isp,jsp,i*delta);
+
+    nlo = 1;
+    err = 0.0;
+    for (int i = 1; i < n; i++) {
+      x = (i+0.5)*delta;
+      value = exact(kind,isp,jsp,x);
+      if (value == 0.0) continue;
+      errone = fabs(0.5*(f[i]+f[i+1]) - value) / fabs(value);
+      if (errone > tabletol) {
+        nlo = i+1;
+        err = 0.0;
+      } else err = MAX(err,errone);
+    }
+    if (nlo*NEXACTFRAC <= n || n >= NTABLEMAX) break;
+    n *= 2;
+  }
+
+  t.n = n;
+  t.nlo = nlo;
+  t.invdelta = 1.0/delta;
+  t.f = f;
+
+  tablen[kind] = MAX(tablen[kind],n);
+  tablerr[kind] = MAX(tablerr[kind],err);
+  tablexact[kind] = MAX(tablexact[kind],(double) nlo/n);
+}
+
+/* ----------------------------------------------------------------------
+   free all collision tables
+------------------------------------------------------------------------- */
+
+void CollideVSS::destroy_tables()
+{
+  for (int k = 0; k < NTABLE; k++) {
+    if (!tables[k]) continue;
+    int n = nparams;
+    if (k == TRATE) n = nparams*nparams;
+    for (int i = 0; i < n; i++) memory->destroy(tables[k][i].f);
+    delete [] tables[k];
+    tables[k] = NULL;
+  }
+}
+
 /* ----------------------------------------------------------------------
    read list of species defined in species file
    store info in filespecies and nfilespecies
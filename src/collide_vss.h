@@ -83,6 +83,31 @@ class CollideVSS : public Collide {
   Params *params;             // VSS params for each species
   int nparams;                // # of per-species params read in
 
+  // optional tables for transcendental collision terms
+  // TRATE = per species pair collision rate vs vr^2
+  // TROT,TVIB = per species variable relaxation number vs collision energy
+  // TFRAC = per species 2-dof LB energy fraction vs uniform RN
+  // TDISCRETE = per species discrete vib level probability vs energy fraction
+
+  enum{TRATE,TROT,TVIB,TFRAC,TDISCRETE,NTABLE};
+
+  struct Table {
+    int n;                    // # of intervals, 0 if table not used
+    int nlo;                  // # of leading intervals evaluated exactly
+    double invdelta;          // inverse of interval width
+    double *f;                // n+1 values at x = i*delta
+  };
+
+  Table *tables[NTABLE];      // per-pair or per-species tables of each kind
+  int tablen[NTABLE];         // max # of intervals for each kind
+  double tablerr[NTABLE];     // max relative error for each kind
+  double tablexact[NTABLE];   // max fraction of range evaluated exactly
+
+  void build_tables();
+  void build_table(Table &, int, int, int, double);
+  void destroy_tables();
+  double exact(int, int, int, double);
+
   void SCATTER_TwoBodyScattering(Particle::OnePart *, 
 				 Particle::OnePart *);
   void EEXCHANGE_NonReactingEDisposal(Particle::OnePart *, 
@@ -97,6 +122,25 @@ class CollideVSS : public Collide {
   double sample_bl(RanPark *, double, double);
   double rotrel (int, double);  
   double vibrel (int, double);  
+  double frac_2dof(int);
+  double discrete_prob(int, double);
+
+  /* ----------------------------------------------------------------------
+     linear interpolation in a table, exact evaluation outside its range
+     leading intervals are evaluated exactly where terms can be singular
+  ------------------------------------------------------------------------- */
+
+  inline double lookup(int kind, int isp, int jsp, double x)
+  {
+    Table *t;
+    if (kind == TRATE) t = &tables[kind][isp*nparams+jsp];
+    else t = &tables[kind][isp];
+    double r = x*t->invdelta;
+    if (r < t->nlo || r >= t->n) return exact(kind,isp,jsp,x);
+    int i = static_cast<int> (r);
+    double *f = t->f;
+    return f[i] + (r-i)*(f[i+1]-f[i]);
+  }
 
   void read_param_file(char *);
   int wordcount(char *);
@@ -136,4 +180,11 @@ E: Request for unknown parameter from collide
 
 VSS model does not have the parameter being requested.
 
+W: Collision tables are evaluated exactly over a large part of their range
+
+The max table size was reached before the interpolation error dropped
+below the tolerance set by the collide_modify table keyword over most
+of the table range.  Results are still accurate, but the table gives
+less speed-up.  Use a larger tolerance.
+
 */
@@ -21,6 +21,7 @@
 #include "grid.h"
 #include "update.h"
 #include "adapt_grid.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -146,6 +147,8 @@ int Comm::migrate_particles(int nmigrate, int *plist)
   // if no custom attributes, pack particles directly via memcpy()
   // else pack_custom() performs packing into sbuf
 
+  timer->start(timer->comm_pack);
+
   int nsend = 0;
   int offset = 0;
 
@@ -176,6 +179,9 @@ int Comm::migrate_particles(int nmigrate, int *plist)
   particle->compress_migrate(nmigrate,plist);
   int ncompress = particle->nlocal;
 
+  timer->stop(timer->comm_pack);
+  timer->start(timer->comm_exchange);
+
   // create or augment irregular communication plan
   // nrecv = # of incoming particles
   
@@ -193,12 +199,13 @@ int Comm::migrate_particles(int nmigrate, int *plist)
   // if no custom attributes, append recv particles directly to particle list
   // else receive into rbuf, unpack particles one by one via unpack_custom()
 
-  if (!ncustom)
+  if (!ncustom) {
     iparticle->
       exchange_uniform(sbuf,nbytes,
                        (char *) &particle->particles[particle->nlocal]);
+    timer->stop(timer->comm_exchange);
 
-  else {
+  } else {
     if (nrecv*nbytes > maxrecvbuf) {
       maxrecvbuf = nrecv*nbytes;
       memory->destroy(rbuf);
@@ -206,6 +213,8 @@ int Comm::migrate_particles(int nmigrate, int *plist)
     }
 
     iparticle->exchange_uniform(sbuf,nbytes,rbuf);
+    timer->stop(timer->comm_exchange);
+    timer->start(timer->comm_unpack);
 
     offset = 0;
     int nlocal = particle->nlocal;
@@ -216,6 +225,7 @@ int Comm::migrate_particles(int nmigrate, int *plist)
       offset += nbytes_custom;
       nlocal++;
     }
+    timer->stop(timer->comm_unpack);
   }
 
   particle->nlocal += nrecv;
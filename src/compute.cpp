@@ -132,6 +132,32 @@ void Compute::clearstep()
   ntime = 0;
 }
 
+/* ----------------------------------------------------------------------
+   MPI user op that merges packed Reduce slots element by element
+   sum slots add values, min/max slots keep key and payload of the winner
+   ties are won by the lower proc, same as MPI_MINLOC and MPI_MAXLOC
+------------------------------------------------------------------------- */
+
+void Compute::reduce_merge(void *in, void *inout, int *len, MPI_Datatype *)
+{
+  Reduce *a = (Reduce *) in;
+  Reduce *b = (Reduce *) inout;
+
+  // MPI_Type_contiguous of sizeof(Reduce) chars gives len = # of slots
+
+  int n = *len;
+  for (int i = 0; i < n; i++) {
+    if (b[i].op == REDUCE_SUM) b[i].value += a[i].value;
+    else if (b[i].op == REDUCE_MIN) {
+      if (a[i].value < b[i].value ||
+          (a[i].value == b[i].value && a[i].proc < b[i].proc)) b[i] = a[i];
+    } else if (b[i].op == REDUCE_MAX) {
+      if (a[i].value > b[i].value ||
+          (a[i].value == b[i].value && a[i].proc < b[i].proc)) b[i] = a[i];
+    }
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 bigint Compute::memory_usage()
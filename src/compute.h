@@ -99,6 +99,25 @@ class Compute : protected Pointers {
   virtual void boundary_tally(int, int, Particle::OnePart *,
                               Particle::OnePart *, Particle::OnePart *) {}
 
+  // packed global reductions
+  // computes that reduce local values to a global scalar or vector can
+  //   expose their local contributions as Reduce slots, so a caller can
+  //   batch several computes into one MPI_Allreduce with reduce_merge()
+
+  enum{REDUCE_SUM,REDUCE_MIN,REDUCE_MAX};
+
+  struct Reduce {
+    double value;           // summed value or min/max key
+    double payload;         // value carried along with min/max winner
+    int op;                 // REDUCE_SUM, REDUCE_MIN, REDUCE_MAX
+    int proc;               // proc owning min/max winner
+  };
+
+  virtual int reduce_size() {return 0;}
+  virtual void reduce_pack(Reduce *) {}
+  virtual void reduce_unpack(Reduce *) {}
+  static void reduce_merge(void *, void *, int *, MPI_Datatype *);
+
   virtual int query_tally_grid(int, double **&, int *&) {return 0;}
   virtual double post_process_grid(int, int, int, double **, int *, 
                                    double *, int) {return 0.0;}
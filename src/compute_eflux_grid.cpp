@@ -19,6 +19,7 @@
 #include "grid.h"
 #include "update.h"
 #include "modify.h"
+#include "tally_grid.h"
 #include "memory.h"
 #include "error.h"
 
@@ -38,6 +39,18 @@ enum{MASSSUM,mVx,mVy,mVz,mVxVx,mVyVy,mVzVz,mVxVy,mVyVz,mVxVz,
 
 #define MAXACCUMULATE 12
 
+// shared moment in TallyGrid for each internal accumulator
+
+static const int TMOMENT[] = {TallyGrid::MASS,
+                              TallyGrid::MVX,TallyGrid::MVY,TallyGrid::MVZ,
+                              TallyGrid::MVXX,TallyGrid::MVYY,TallyGrid::MVZZ,
+                              TallyGrid::MVXY,TallyGrid::MVYZ,TallyGrid::MVXZ,
+                              TallyGrid::MVXXX,TallyGrid::MVYYY,
+                              TallyGrid::MVZZZ,TallyGrid::MVXYY,
+                              TallyGrid::MVXZZ,TallyGrid::MVYXX,
+                              TallyGrid::MVYZZ,TallyGrid::MVZXX,
+                              TallyGrid::MVZYY};
+
 /* ---------------------------------------------------------------------- */
 
 ComputeEFluxGrid::ComputeEFluxGrid(SPARTA *sparta, int narg, char **arg) :
@@ -126,6 +139,15 @@ ComputeEFluxGrid::ComputeEFluxGrid(SPARTA *sparta, int narg, char **arg) :
   size_per_grid_cols = ngroup*nvalue;
   post_process_grid_flag = 1;
 
+  // group and shared moment for each tally column
+
+  tbin = new int[ntotal];
+  tmoment = new int[ntotal];
+  for (int i = 0; i < ntotal; i++) {
+    tbin[i] = i / npergroup;
+    tmoment[i] = TMOMENT[unique[i % npergroup]];
+  }
+
   nglocal = 0;
   vector_grid = NULL;
   tally = NULL;
@@ -142,6 +164,8 @@ ComputeEFluxGrid::~ComputeEFluxGrid()
   memory->destroy(map);
 
   memory->destroy(vector_grid);
+  delete [] tbin;
+  delete [] tmoment;
   memory->destroy(tally);
 }
 
@@ -153,6 +177,8 @@ void ComputeEFluxGrid::init()
     error->all(FLERR,"Number of groups in compute eflux/grid mixture "
                "has changed");
 
+  tset = modify->tallygrid->request(imix,groupbit,0,ntotal,tmoment);
+
   reallocate();
 }
 
@@ -162,106 +188,10 @@ void ComputeEFluxGrid::compute_per_grid()
 {
   invoked_per_grid = update->ntimestep;
 
-  Grid::ChildInfo *cinfo = grid->cinfo;
-  Particle::Species *species = particle->species;
-  Particle::OnePart *particles = particle->particles;
-  int *s2g = particle->mixture[imix]->species2group;
-  int nlocal = particle->nlocal;
-
-  int i,j,k,m,ispecies,igroup,icell;
-  double mass;
-  double *v,*vec;
-
-  // zero all accumulators - could do this with memset()
-
-  for (i = 0; i < nglocal; i++)
-    for (j = 0; j < ntotal; j++)
-      tally[i][j] = 0.0;
-
-  // loop over all particles, skip species not in mixture group
-  // perform all tallies needed for each particle
-  // depends on its species group and the user-requested values
-
-  for (i = 0; i < nlocal; i++) {
-    ispecies = particles[i].ispecies;
-    igroup = s2g[ispecies];
-    if (igroup < 0) continue;
-    icell = particles[i].icell;
-    if (!(cinfo[icell].mask & groupbit)) continue;
-
-    mass = species[ispecies].mass;
-    v = particles[i].v;
-
-    vec = tally[icell];
-
-    // loop has all possible values particle needs to accumulate
-    // subset defined by user values are indexed by accumulate vector
-    // NOTE: at some point may need prefactors v,v^2,v^3 converted to p,eng
-
-    k = igroup*npergroup;
-
-    for (m = 0; m < npergroup; m++) {
-      switch (unique[m]) {
-      case MASSSUM:
-        vec[k++] += mass;
-        break;
-      case mVx:
-        vec[k++] += mass*v[0];
-        break;
-      case mVy:
-        vec[k++] += mass*v[1];
-        break;
-      case mVz:
-        vec[k++] += mass*v[2];
-        break;
-      case mVxVx:
-        vec[k++] += mass*v[0]*v[0];
-        break;
-      case mVyVy:
-        vec[k++] += mass*v[1]*v[1];
-        break;
-      case mVzVz:
-        vec[k++] += mass*v[2]*v[2];
-        break;
-      case mVxVy:
-        vec[k++] += mass*v[0]*v[1];
-        break;
-      case mVyVz:
-        vec[k++] += mass*v[1]*v[2];
-        break;
-      case mVxVz:
-        vec[k++] += mass*v[0]*v[2];
-        break;
-      case mVxVxVx:
-        vec[k++] += mass*v[0]*v[0]*v[0];
-        break;
-      case mVyVyVy:
-        vec[k++] += mass*v[1]*v[1]*v[1];
-        break;
-      case mVzVzVz:
-        vec[k++] += mass*v[2]*v[2]*v[2];
-        break;
-      case mVxVyVy:
-        vec[k++] += mass*v[0]*v[1]*v[1];
-        break;
-      case mVxVzVz:
-        vec[k++] += mass*v[0]*v[2]*v[2];
-	break;
-      case mVyVxVx:
-        vec[k++] += mass*v[1]*v[0]*v[0];
-	break;
-      case mVyVzVz:
-        vec[k++] += mass*v[1]*v[2]*v[2];
-	break;
-      case mVzVxVx:
-        vec[k++] += mass*v[2]*v[0]*v[0];
-	break;
-      case mVzVyVy:
-        vec[k++] += mass*v[2]*v[1]*v[1];
-	break;
-      }
-    }
-  }
+  // copy per-group tallies from moments shared with other grid computes
+  // moments are tallied by a single particle pass if not yet current
+
+  modify->tallygrid->gather(tset,ntotal,tbin,tmoment,tally);
 }
 
 /* ----------------------------------------------------------------------
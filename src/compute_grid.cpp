@@ -19,6 +19,7 @@
 #include "grid.h"
 #include "update.h"
 #include "modify.h"
+#include "tally_grid.h"
 #include "memory.h"
 #include "error.h"
 
@@ -35,6 +36,14 @@ enum{NUM,NRHO,NFRAC,MASS,MASSRHO,MASSFRAC,
 enum{COUNT,MASSSUM,MVX,MVY,MVZ,MVXSQ,MVYSQ,MVZSQ,MVSQ,
      ENGROT,ENGVIB,DOFROT,DOFVIB,CELLCOUNT,CELLMASS,LASTSIZE};
 
+// shared moment in TallyGrid for each internal accumulator
+
+static const int TMOMENT[] = {TallyGrid::COUNT,TallyGrid::MASS,
+                              TallyGrid::MVX,TallyGrid::MVY,TallyGrid::MVZ,
+                              TallyGrid::MVXX,TallyGrid::MVYY,TallyGrid::MVZZ,
+                              TallyGrid::MVSQ,TallyGrid::EROT,TallyGrid::EVIB,
+                              TallyGrid::DOFROT,TallyGrid::DOFVIB};
+
 // max # of quantities to accumulate for any user value
 
 #define MAXACCUMULATE 2
@@ -162,6 +171,16 @@ ComputeGrid::ComputeGrid(SPARTA *sparta, int narg, char **arg) :
   ntotal = ngroup*npergroup;
   reset_map();
 
+  // group and shared moment for each per-group tally column
+
+  tbin = new int[ngroup*npergroup];
+  tmoment = new int[ngroup*npergroup];
+  for (int igroup = 0; igroup < ngroup; igroup++)
+    for (int m = 0; m < npergroup; m++) {
+      tbin[igroup*npergroup+m] = igroup;
+      tmoment[igroup*npergroup+m] = TMOMENT[unique[m]];
+    }
+
   per_grid_flag = 1;
   size_per_grid_cols = ngroup*nvalue;
   post_process_grid_flag = 1;
@@ -182,6 +201,8 @@ ComputeGrid::~ComputeGrid()
 
   delete [] nmap;
   memory->destroy(map);
+  delete [] tbin;
+  delete [] tmoment;
 
   memory->destroy(vector_grid);
   memory->destroy(tally);
@@ -198,6 +219,8 @@ void ComputeGrid::init()
   tprefactor = update->mvv2e / (3.0*update->boltz);
   rvprefactor = 2.0*update->mvv2e / update->boltz;
 
+  tset = modify->tallygrid->request(imix,groupbit,0,ngroup*npergroup,tmoment);
+
   reallocate();
 }
 
@@ -207,88 +230,34 @@ void ComputeGrid::compute_per_grid()
 {
   invoked_per_grid = update->ntimestep;
 
-  Grid::ChildInfo *cinfo = grid->cinfo;
-  Particle::Species *species = particle->species;
-  Particle::OnePart *particles = particle->particles;
-  int *s2g = particle->mixture[imix]->species2group;
-  int nlocal = particle->nlocal;
-
-  int i,j,k,m,ispecies,igroup,icell;
-  double mass;
-  double *v,*vec;
-
-  // zero all accumulators - could do this with memset()
-
-  for (i = 0; i < nglocal; i++)
-    for (j = 0; j < ntotal; j++)
-      tally[i][j] = 0.0;
-
-  // loop over all particles, skip species not in mixture group
-  // skip cells not in grid group
-  // perform all tallies needed for each particle
-  // depends on its species group and the user-requested values
-
-  for (i = 0; i < nlocal; i++) {
-    ispecies = particles[i].ispecies;
-    igroup = s2g[ispecies];
-    if (igroup < 0) continue;
-    icell = particles[i].icell;
-    if (!(cinfo[icell].mask & groupbit)) continue;
-
-    mass = species[ispecies].mass;
-    v = particles[i].v;
-
-    vec = tally[icell];
-    if (cellmass) vec[cellmass] += mass;
-    if (cellcount) vec[cellcount] += 1.0;
-
-    // loop has all possible values particle needs to accumulate
-    // subset defined by user values are indexed by accumulate vector
-
-    k = igroup*npergroup;
-
-    for (m = 0; m < npergroup; m++) {
-      switch (unique[m]) {
-      case COUNT:
-        vec[k++] += 1.0;
-        break;
-      case MASSSUM:
-        vec[k++] += mass;
-        break;
-      case MVX:
-        vec[k++] += mass*v[0];
-        break;
-      case MVY:
-        vec[k++] += mass*v[1];
-        break;
-      case MVZ:
-        vec[k++] += mass*v[2];
-        break;
-      case MVXSQ:
-        vec[k++] += mass*v[0]*v[0];
-        break;
-      case MVYSQ:
-        vec[k++] += mass*v[1]*v[1];
-        break;
-      case MVZSQ:
-        vec[k++] += mass*v[2]*v[2];
-        break;
-      case MVSQ:
-        vec[k++] += mass * (v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
-        break;
-      case ENGROT:
-        vec[k++] += particles[i].erot;
-        break;
-      case ENGVIB:
-        vec[k++] += particles[i].evib;
-        break;
-      case DOFROT:
-        vec[k++] += species[ispecies].rotdof;
-        break;
-      case DOFVIB:
-        vec[k++] += species[ispecies].vibdof;
-        break;
-      }
+  // copy per-group moments from tally shared with other grid computes
+  // moments are tallied by a single particle pass if not yet current
+
+  int ncol = ngroup*npergroup;
+  modify->tallygrid->gather(tset,ncol,tbin,tmoment,tally);
+
+  // CELLCOUNT/CELLMASS = sum of COUNT/MASSSUM over all groups
+
+  if (!cellcount && !cellmass) return;
+
+  int icount = -1;
+  int imass = -1;
+  for (int m = 0; m < npergroup; m++) {
+    if (unique[m] == COUNT) icount = m;
+    if (unique[m] == MASSSUM) imass = m;
+  }
+
+  double *vec;
+
+  for (int i = 0; i < nglocal; i++) {
+    vec = tally[i];
+    if (cellcount) {
+      vec[cellcount] = 0.0;
+      for (int k = icount; k < ncol; k += npergroup) vec[cellcount] += vec[k];
+    }
+    if (cellmass) {
+      vec[cellmass] = 0.0;
+      for (int k = imass; k < ncol; k += npergroup) vec[cellmass] += vec[k];
     }
   }
 }
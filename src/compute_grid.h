@@ -50,6 +50,9 @@ class ComputeGrid : public Compute {
   int **map;                 // which tally columns each output value uses
   double **tally;            // array of tally quantities, cells by ntotal
 
+  int tset;                  // set of shared moments in modify->tallygrid
+  int *tbin,*tmoment;        // group and shared moment for each group column
+
   double eprefactor;         // conversion from velocity^2 to energy
   double tprefactor;         // conversion from KE to temperature
   double rvprefactor;        // conversion from rot/vib E to temperature
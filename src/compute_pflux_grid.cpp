@@ -19,6 +19,7 @@
 #include "grid.h"
 #include "update.h"
 #include "modify.h"
+#include "tally_grid.h"
 #include "memory.h"
 #include "error.h"
 
@@ -36,6 +37,13 @@ enum{MASSSUM,MVX,MVY,MVZ,MVXSQ,MVYSQ,MVZSQ,MVXVY,MVYVZ,MVXVZ,LASTSIZE};
 
 #define MAXACCUMULATE 4
 
+// shared moment in TallyGrid for each internal accumulator
+
+static const int TMOMENT[] = {TallyGrid::MASS,
+                              TallyGrid::MVX,TallyGrid::MVY,TallyGrid::MVZ,
+                              TallyGrid::MVXX,TallyGrid::MVYY,TallyGrid::MVZZ,
+                              TallyGrid::MVXY,TallyGrid::MVYZ,TallyGrid::MVXZ};
+
 /* ---------------------------------------------------------------------- */
 
 ComputePFluxGrid::ComputePFluxGrid(SPARTA *sparta, int narg, char **arg) :
@@ -115,6 +123,15 @@ ComputePFluxGrid::ComputePFluxGrid(SPARTA *sparta, int narg, char **arg) :
   size_per_grid_cols = ngroup*nvalue;
   post_process_grid_flag = 1;
 
+  // group and shared moment for each tally column
+
+  tbin = new int[ntotal];
+  tmoment = new int[ntotal];
+  for (int i = 0; i < ntotal; i++) {
+    tbin[i] = i / npergroup;
+    tmoment[i] = TMOMENT[unique[i % npergroup]];
+  }
+
   nglocal = 0;
   vector_grid = NULL;
   tally = NULL;
@@ -131,6 +148,8 @@ ComputePFluxGrid::~ComputePFluxGrid()
   memory->destroy(map);
 
   memory->destroy(vector_grid);
+  delete [] tbin;
+  delete [] tmoment;
   memory->destroy(tally);
 }
 
@@ -142,6 +161,8 @@ void ComputePFluxGrid::init()
     error->all(FLERR,"Number of groups in compute pflux/grid mixture "
                "has changed");
 
+  tset = modify->tallygrid->request(imix,groupbit,0,ntotal,tmoment);
+
   reallocate();
 }
 
@@ -151,79 +172,10 @@ void ComputePFluxGrid::compute_per_grid()
 {
   invoked_per_grid = update->ntimestep;
 
-  Grid::ChildInfo *cinfo = grid->cinfo;
-  Particle::Species *species = particle->species;
-  Particle::OnePart *particles = particle->particles;
-  int *s2g = particle->mixture[imix]->species2group;
-  int nlocal = particle->nlocal;
-
-  int i,j,k,m,ispecies,igroup,icell;
-  double mass;
-  double *v,*vec;
-
-  // zero all accumulators - could do this with memset()
-
-  for (i = 0; i < nglocal; i++)
-    for (j = 0; j < ntotal; j++)
-      tally[i][j] = 0.0;
-
-  // loop over all particles, skip species not in mixture group
-  // perform all tallies needed for each particle
-  // depends on its species group and the user-requested values
-
-  for (i = 0; i < nlocal; i++) {
-    ispecies = particles[i].ispecies;
-    igroup = s2g[ispecies];
-    if (igroup < 0) continue;
-    icell = particles[i].icell;
-    if (!(cinfo[icell].mask & groupbit)) continue;
-
-    mass = species[ispecies].mass;
-    v = particles[i].v;
-
-    vec = tally[icell];
-
-    // loop has all possible values particle needs to accumulate
-    // subset defined by user values are indexed by accumulate vector
-    // NOTE: at some point may need prefactors v,v^2 converted to p,eng
-
-    k = igroup*npergroup;
-
-    for (m = 0; m < npergroup; m++) {
-      switch (unique[m]) {
-      case MASSSUM:
-        vec[k++] += mass;
-        break;
-      case MVX:
-        vec[k++] += mass*v[0];
-        break;
-      case MVY:
-        vec[k++] += mass*v[1];
-        break;
-      case MVZ:
-        vec[k++] += mass*v[2];
-        break;
-      case MVXSQ:
-        vec[k++] += mass*v[0]*v[0];
-        break;
-      case MVYSQ:
-        vec[k++] += mass*v[1]*v[1];
-        break;
-      case MVZSQ:
-        vec[k++] += mass*v[2]*v[2];
-        break;
-      case MVXVY:
-        vec[k++] += mass*v[0]*v[1];
-        break;
-      case MVYVZ:
-        vec[k++] += mass*v[1]*v[2];
-        break;
-      case MVXVZ:
-        vec[k++] += mass*v[0]*v[2];
-        break;
-      }
-    }
-  }
+  // copy per-group tallies from moments shared with other grid computes
+  // moments are tallied by a single particle pass if not yet current
+
+  modify->tallygrid->gather(tset,ntotal,tbin,tmoment,tally);
 }
 
 /* ----------------------------------------------------------------------
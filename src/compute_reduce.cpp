@@ -180,7 +180,8 @@ ComputeReduce::ComputeReduce(SPARTA *spa, int narg, char **arg) :
   // cannot use per-surf compute since data not yet summed across surfs
 
   for (int i = 0; i < nvalues; i++) {
-    if (which[i] == X || which[i] == V) flavor[i] = PARTICLE;
+    if (which[i] == X || which[i] == V || which[i] == KE ||
+        which[i] == EROT || which[i] == EVIB) flavor[i] = PARTICLE;
 
     else if (which[i] == COMPUTE) {
       int icompute = modify->find_compute(ids[i]);
@@ -274,17 +275,40 @@ ComputeReduce::ComputeReduce(SPARTA *spa, int narg, char **arg) :
 
   if (nvalues == 1) {
     scalar_flag = 1;
-    vector = onevec = NULL;
-    indices = owner = NULL;
+    vector = NULL;
   } else {
     vector_flag = 1;
     size_vector = nvalues;
     vector = new double[size_vector];
-    onevec = new double[size_vector];
-    indices = new int[size_vector];
-    owner = new int[size_vector];
   }
 
+  one = new double[nvalues];
+  indices = new int[nvalues];
+  sources = new Source[nvalues];
+  varrow = new int[nvalues];
+
+  // lists of values reduced in fused pass over particles, grid cells, surfs
+
+  for (int k = 0; k < 3; k++) {
+    nlist[k] = 0;
+    valuelist[k] = new int[nvalues];
+  }
+  for (int i = 0; i < nvalues; i++)
+    valuelist[flavor[i]][nlist[flavor[i]]++] = i;
+
+  // packed slots = one per value, plus one count per value for averages
+  // create MPI data and function types for packed Reduce slots
+
+  if (mode == AVE || mode == AVESQ) nslot = 2*nvalues;
+  else nslot = nvalues;
+  slots = new Reduce[nslot];
+  slotsall = new Reduce[nslot];
+
+  MPI_Type_contiguous(sizeof(Reduce),MPI_CHAR,&reduce_type);
+  MPI_Type_commit(&reduce_type);
+  MPI_Op_create(reduce_merge,1,&reduce_op);
+
+  nvarparticle = nvargrid = 0;
   maxparticle = maxgrid = 0;
   varparticle = vargrid = NULL;
 }
@@ -302,9 +326,16 @@ ComputeReduce::~ComputeReduce()
   delete [] replace;
 
   delete [] vector;
-  delete [] onevec;
+  delete [] one;
   delete [] indices;
-  delete [] owner;
+  delete [] sources;
+  delete [] varrow;
+  for (int k = 0; k < 3; k++) delete [] valuelist[k];
+  delete [] slots;
+  delete [] slotsall;
+
+  MPI_Type_free(&reduce_type);
+  MPI_Op_free(&reduce_op);
 
   memory->destroy(varparticle);
   memory->destroy(vargrid);
@@ -337,6 +368,26 @@ void ComputeReduce::init()
 
     } else value2index[m] = -1;
   }
+
+  // assign a row of varparticle or vargrid to each value that needs a copy
+  // variables are evaluated into their own row
+  // post-processed grid computes overwrite vector_grid on each invocation,
+  //   so their values are copied into their own row before the fused pass
+
+  nvarparticle = nvargrid = 0;
+  for (int m = 0; m < nvalues; m++) {
+    varrow[m] = -1;
+    if (which[m] == VARIABLE) {
+      if (flavor[m] == PARTICLE) varrow[m] = nvarparticle++;
+      else varrow[m] = nvargrid++;
+    } else if (which[m] == COMPUTE && flavor[m] == GRID &&
+               modify->compute[value2index[m]]->post_process_grid_flag)
+      varrow[m] = nvargrid++;
+  }
+
+  memory->destroy(varparticle);
+  memory->destroy(vargrid);
+  maxparticle = maxgrid = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -345,19 +396,9 @@ double ComputeReduce::compute_scalar()
 {
   invoked_scalar = update->ntimestep;
 
-  double one = compute_one(0,-1);
-
-  if (mode == SUM || mode == SUMSQ) {
-    MPI_Allreduce(&one,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
-  } else if (mode == MINN) {
-    MPI_Allreduce(&one,&scalar,1,MPI_DOUBLE,MPI_MIN,world);
-  } else if (mode == MAXX) {
-    MPI_Allreduce(&one,&scalar,1,MPI_DOUBLE,MPI_MAX,world);
-  } else if (mode == AVE || mode == AVESQ) {
-    MPI_Allreduce(&one,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
-    bigint n = count(0);
-    if (n) scalar /= n;
-  }
+  reduce_pack(slots);
+  MPI_Allreduce(slots,slotsall,nslot,reduce_type,reduce_op,world);
+  reduce_unpack(slotsall);
 
   return scalar;
 }
@@ -368,337 +409,240 @@ void ComputeReduce::compute_vector()
 {
   invoked_vector = update->ntimestep;
 
-  for (int m = 0; m < nvalues; m++)
-    if (!replace || replace[m] < 0) {
-      onevec[m] = compute_one(m,-1);
-      indices[m] = index;
-    }
+  reduce_pack(slots);
+  MPI_Allreduce(slots,slotsall,nslot,reduce_type,reduce_op,world);
+  reduce_unpack(slotsall);
+}
 
-  if (mode == SUM || mode == SUMSQ) {
-    for (int m = 0; m < nvalues; m++)
-      MPI_Allreduce(&onevec[m],&vector[m],1,MPI_DOUBLE,MPI_SUM,world);
-
-  } else if (mode == MINN) {
-    if (!replace) {
-      for (int m = 0; m < nvalues; m++)
-        MPI_Allreduce(&onevec[m],&vector[m],1,MPI_DOUBLE,MPI_MIN,world);
-
-    } else {
-      for (int m = 0; m < nvalues; m++)
-        if (replace[m] < 0) {
-          pairme.value = onevec[m];
-          pairme.proc = me;
-          MPI_Allreduce(&pairme,&pairall,1,MPI_DOUBLE_INT,MPI_MINLOC,world);
-          vector[m] = pairall.value;
-          owner[m] = pairall.proc;
-        }
-      for (int m = 0; m < nvalues; m++)
-        if (replace[m] >= 0) {
-          if (me == owner[replace[m]])
-            vector[m] = compute_one(m,indices[replace[m]]);
-          MPI_Bcast(&vector[m],1,MPI_DOUBLE,owner[replace[m]],world);
-        }
-    }
+/* ---------------------------------------------------------------------- */
 
-  } else if (mode == MAXX) {
-    if (!replace) {
-      for (int m = 0; m < nvalues; m++)
-        MPI_Allreduce(&onevec[m],&vector[m],1,MPI_DOUBLE,MPI_MAX,world);
-
-    } else {
-      for (int m = 0; m < nvalues; m++)
-        if (replace[m] < 0) {
-          pairme.value = onevec[m];
-          pairme.proc = me;
-          MPI_Allreduce(&pairme,&pairall,1,MPI_DOUBLE_INT,MPI_MAXLOC,world);
-          vector[m] = pairall.value;
-          owner[m] = pairall.proc;
-        }
-      for (int m = 0; m < nvalues; m++)
-        if (replace[m] >= 0) {
-          if (me == owner[replace[m]])
-            vector[m] = compute_one(m,indices[replace[m]]);
-          MPI_Bcast(&vector[m],1,MPI_DOUBLE,owner[replace[m]],world);
-        }
-    }
+int ComputeReduce::reduce_size()
+{
+  return nslot;
+}
+
+/* ----------------------------------------------------------------------
+   reduce all values over owned particles, grid cells, surfs
+   pack local result of each value into a slot
+   for replace, slot of replaced value is keyed by the value it is
+     replaced from, and carries the replaced value at the local winner
+------------------------------------------------------------------------- */
 
-  } else if (mode == AVE || mode == AVESQ) {
-    for (int m = 0; m < nvalues; m++) {
-      MPI_Allreduce(&onevec[m],&vector[m],1,MPI_DOUBLE,MPI_SUM,world);
-      bigint n = count(m);
-      if (n) vector[m] /= n;
+void ComputeReduce::reduce_pack(Reduce *buf)
+{
+  int m;
+
+  setup_sources();
+  reduce_local();
+
+  int op = REDUCE_SUM;
+  if (mode == MINN) op = REDUCE_MIN;
+  else if (mode == MAXX) op = REDUCE_MAX;
+
+  for (m = 0; m < nvalues; m++) {
+    buf[m].op = op;
+    buf[m].proc = me;
+    if (replace && replace[m] >= 0) {
+      int r = replace[m];
+      buf[m].value = one[r];
+      if (indices[r] >= 0) buf[m].payload = value_one(m,indices[r]);
+      else buf[m].payload = one[m];
+    } else buf[m].value = buf[m].payload = one[m];
+  }
+
+  if (mode == AVE || mode == AVESQ) {
+    for (m = 0; m < nvalues; m++) {
+      buf[nvalues+m].op = REDUCE_SUM;
+      buf[nvalues+m].proc = me;
+      if (flavor[m] == PARTICLE) buf[nvalues+m].value = particle->nlocal;
+      else if (flavor[m] == GRID) buf[nvalues+m].value = grid->nlocal;
+      else buf[nvalues+m].value = surf->nlocal;
+      buf[nvalues+m].payload = 0.0;
     }
   }
 }
 
 /* ----------------------------------------------------------------------
-   calculate reduced value for one input M and return it
-   if flag = -1:
-     sum/min/max/ave all values in vector
-     if mode = MIN or MAX, also set index to which vector value wins
-   if flag >= 0: simply return vector[flag]
+   set scalar or vector from globally merged slots
 ------------------------------------------------------------------------- */
 
-double ComputeReduce::compute_one(int m, int flag)
+void ComputeReduce::reduce_unpack(Reduce *buf)
 {
-  int i;
-
-  // invoke the appropriate attribute,compute,fix,variable
-  // for flag = -1, compute scalar quantity by scanning over atom properties
-  // only include atoms in group for atom properties and per-atom quantities
-
-  index = -1;
-  int vidx = value2index[m];
-  int aidx = argindex[m];
-
-  double one;
-  if (mode == SUM) one = 0.0;
-  else if (mode == MINN) one = BIG;
-  else if (mode == MAXX) one = -BIG;
-  else if (mode == AVE) one = 0.0;
-
-  if (which[m] == X) {
-    Particle::OnePart *particles = particle->particles;
-    int n = particle->nlocal;
-    if (flag < 0) {
-      for (i = 0; i < n; i++)
-        combine(one,particles[i].x[aidx],i);
-    } else one = particles[flag].x[aidx];
-
-  } else if (which[m] == V) {
-    Particle::OnePart *particles = particle->particles;
-    int n = particle->nlocal;
-    if (flag < 0) {
-      for (i = 0; i < n; i++)
-        combine(one,particles[i].v[aidx],i);
-    } else one = particles[flag].v[aidx];
-
-  } else if (which[m] == KE) {
-    Particle::OnePart *particles = particle->particles;
-    Particle::Species *species = particle->species;
-    double mvv2e = update->mvv2e;
-    int n = particle->nlocal;
-    Particle::OnePart *p;
-    double *v;
-    double ke;
-
-    if (flag < 0) {
-      for (i = 0; i < n; i++) {
-        p = &particles[i];
-        v = p->v;
-        ke = mvv2e * 0.5 * species[p->ispecies].mass *
-          (v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
-        combine(one,ke,i);
-      }
-    } else {
-      p = &particles[flag];
-      v = p->v;
-      one = mvv2e * 0.5 * species[p->ispecies].mass *
-        (v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+  double *values = vector;
+  if (scalar_flag) values = &scalar;
+
+  for (int m = 0; m < nvalues; m++) {
+    if (replace && replace[m] >= 0) values[m] = buf[m].payload;
+    else values[m] = buf[m].value;
+    if (mode == AVE || mode == AVESQ) {
+      bigint n = static_cast<bigint> (buf[nvalues+m].value);
+      if (n) values[m] /= n;
     }
+  }
 
-  } else if (which[m] == EROT) {
-    Particle::OnePart *particles = particle->particles;
-    int n = particle->nlocal;
-    if (flag < 0) {
-      for (i = 0; i < n; i++)
-        combine(one,particles[i].erot,i);
-    } else one = particles[flag].erot;
-
-  } else if (which[m] == EVIB) {
-    Particle::OnePart *particles = particle->particles;
-    int n = particle->nlocal;
-    if (flag < 0) {
-      for (i = 0; i < n; i++)
-        combine(one,particles[i].evib,i);
-    } else one = particles[flag].evib;
-
-  // invoke compute if not previously invoked
-  // for per-grid compute, invoke post_process_grid() if necessary
-
-  } else if (which[m] == COMPUTE) {
-    Compute *c = modify->compute[vidx];
-
-    if (flavor[m] == PARTICLE) {
-      if (!(c->invoked_flag & INVOKED_PER_PARTICLE)) {
-        c->compute_per_particle();
-        c->invoked_flag |= INVOKED_PER_PARTICLE;
-      }
+  if (scalar_flag) invoked_scalar = update->ntimestep;
+  else invoked_vector = update->ntimestep;
+}
 
-      if (aidx == 0) {
-        double *cvec = c->vector_particle;
-        int n = particle->nlocal;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,cvec[i],i);
-        } else one = cvec[flag];
-      } else {
-        double **carray = c->array_particle;
-        int n = particle->nlocal;
-        int aidxm1 = aidx - 1;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,carray[i][aidxm1],i);
-        } else one = carray[flag][aidxm1];
-      }
+/* ----------------------------------------------------------------------
+   invoke the appropriate compute,fix,variable for each value
+   and set the per-particle, per-grid, per-surf data each value reads
+------------------------------------------------------------------------- */
 
-    } else if (flavor[m] == GRID) {
-      if (!(c->invoked_flag & INVOKED_PER_GRID)) {
-        c->compute_per_grid();
-        c->invoked_flag |= INVOKED_PER_GRID;
-      }
+void ComputeReduce::setup_sources()
+{
+  int m;
 
-      if (c->post_process_grid_flag) 
-        c->post_process_grid(aidx,-1,1,NULL,NULL,NULL,1);
-      
-      if (aidx == 0 || c->post_process_grid_flag) {
-        double *cvec = c->vector_grid;
-        int n = grid->nlocal;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,cvec[i],i);
-        } else one = cvec[flag];
-      } else {
-        double **carray = c->array_grid;
-        int n = grid->nlocal;
-        int aidxm1 = aidx - 1;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,carray[i][aidxm1],i);
-        } else one = carray[flag][aidxm1];
-      }
-    }
+  // grow variable and copy buffers
+  // allocate them even if no particles or grid cells are owned
+
+  if (nvarparticle && (particle->nlocal > maxparticle || !varparticle)) {
+    maxparticle = MAX(particle->maxlocal,1);
+    memory->destroy(varparticle);
+    memory->create(varparticle,nvarparticle,maxparticle,"reduce:varparticle");
+  }
+  if (nvargrid && (grid->nlocal > maxgrid || !vargrid)) {
+    maxgrid = MAX(grid->maxlocal,1);
+    memory->destroy(vargrid);
+    memory->create(vargrid,nvargrid,maxgrid,"reduce:vargrid");
+  }
+
+  for (m = 0; m < nvalues; m++) {
+    int vidx = value2index[m];
+    int aidx = argindex[m];
+    Source *src = &sources[m];
+    src->vec = NULL;
+    src->array = NULL;
+    src->col = aidx - 1;
+
+    // invoke compute if not previously invoked
+    // for per-grid compute, invoke post_process_grid() if necessary
+
+    if (which[m] == COMPUTE) {
+      Compute *c = modify->compute[vidx];
+
+      if (flavor[m] == PARTICLE) {
+        if (!(c->invoked_flag & INVOKED_PER_PARTICLE)) {
+          c->compute_per_particle();
+          c->invoked_flag |= INVOKED_PER_PARTICLE;
+        }
+        if (aidx == 0) src->vec = c->vector_particle;
+        else src->array = c->array_particle;
 
-  // access fix fields, check if fix frequency is a match
-
-  } else if (which[m] == FIX) {
-    Fix *fix = modify->fix[vidx];
-
-    if (flavor[m] == PARTICLE) {
-      if (update->ntimestep % modify->fix[vidx]->per_particle_freq)
-        error->all(FLERR,"Fix used in compute reduce not "
-                   "computed at compatible time");
-      if (aidx == 0) {
-        double *fvec = fix->vector_particle;
-        int n = particle->nlocal;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,fvec[i],i);
-        } else one = fvec[flag];
-      } else {
-        double **farray = fix->array_particle;
-        int n = particle->nlocal;
-        int aidxm1 = aidx - 1;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,farray[i][aidxm1],i);
-        } else one = farray[flag][aidxm1];
+      } else if (flavor[m] == GRID) {
+        if (!(c->invoked_flag & INVOKED_PER_GRID)) {
+          c->compute_per_grid();
+          c->invoked_flag |= INVOKED_PER_GRID;
+        }
+
+        if (c->post_process_grid_flag) {
+          c->post_process_grid(aidx,-1,1,NULL,NULL,NULL,1);
+          int n = grid->nlocal;
+          if (n) memcpy(vargrid[varrow[m]],c->vector_grid,n*sizeof(double));
+          src->vec = vargrid[varrow[m]];
+        } else if (aidx == 0) src->vec = c->vector_grid;
+        else src->array = c->array_grid;
       }
 
-    } else if (flavor[m] == GRID) {
-      if (update->ntimestep % modify->fix[vidx]->per_grid_freq)
-        error->all(FLERR,"Fix used in compute reduce not "
-                   "computed at compatible time");
-      if (aidx == 0) {
-        double *fvec = fix->vector_grid;
-        int n = grid->nlocal;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,fvec[i],i);
-        } else one = fvec[flag];
-      } else {
-        double **farray = fix->array_grid;
-        int n = grid->nlocal;
-        int aidxm1 = aidx - 1;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,farray[i][aidxm1],i);
-        } else one = farray[flag][aidxm1];
+    // access fix fields, check if fix frequency is a match
+
+    } else if (which[m] == FIX) {
+      Fix *fix = modify->fix[vidx];
+
+      if (flavor[m] == PARTICLE) {
+        if (update->ntimestep % fix->per_particle_freq)
+          error->all(FLERR,"Fix used in compute reduce not "
+                     "computed at compatible time");
+        if (aidx == 0) src->vec = fix->vector_particle;
+        else src->array = fix->array_particle;
+
+      } else if (flavor[m] == GRID) {
+        if (update->ntimestep % fix->per_grid_freq)
+          error->all(FLERR,"Fix used in compute reduce not "
+                     "computed at compatible time");
+        if (aidx == 0) src->vec = fix->vector_grid;
+        else src->array = fix->array_grid;
+
+      } else if (flavor[m] == SURF) {
+        if (update->ntimestep % fix->per_surf_freq)
+          error->all(FLERR,"Fix used in compute reduce not "
+                     "computed at compatible time");
+        if (aidx == 0) src->vec = fix->vector_surf;
+        else src->array = fix->array_surf;
       }
 
-    } else if (flavor[m] == SURF) {
-      if (update->ntimestep % modify->fix[vidx]->per_surf_freq)
-        error->all(FLERR,"Fix used in compute reduce not "
-                   "computed at compatible time");
-      if (aidx == 0) {
-        double *fvec = fix->vector_surf;
-        int n = surf->nlocal;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,fvec[i],i);
-        } else one = fvec[flag];
-      } else {
-        double **farray = fix->array_surf;
-        int n = surf->nlocal;
-        int aidxm1 = aidx - 1;
-        if (flag < 0) {
-          for (i = 0; i < n; i++)
-            combine(one,farray[i][aidxm1],i);
-        } else one = farray[flag][aidxm1];
+    // evaluate particle-style or grid-style variable
+
+    } else if (which[m] == VARIABLE) {
+      if (flavor[m] == PARTICLE) {
+        src->vec = varparticle[varrow[m]];
+        input->variable->compute_particle(vidx,src->vec,1,0);
+      } else if (flavor[m] == GRID) {
+        src->vec = vargrid[varrow[m]];
+        input->variable->compute_grid(vidx,src->vec,1,0);
       }
     }
+  }
+}
 
-  // evaluate particle-style or grid-style variable
+/* ----------------------------------------------------------------------
+   reduce all values with one pass over each of particles, grid cells, surfs
+   if mode = MIN or MAX, also set indices to which local value wins
+------------------------------------------------------------------------- */
 
-  } else if (which[m] == VARIABLE) {
-    if (flavor[m] == PARTICLE) {
-      int n = particle->nlocal;
-      if (n > maxparticle) {
-        maxparticle = particle->maxlocal;
-        memory->destroy(varparticle);
-        memory->create(varparticle,maxparticle,"reduce:varparticle");
-      }
+void ComputeReduce::reduce_local()
+{
+  int i,k,m,n,nl;
+  int *list;
 
-      input->variable->compute_particle(vidx,varparticle,1,0);
-      if (flag < 0) {
-        for (i = 0; i < n; i++)
-          combine(one,varparticle[i],i);
-      } else one = varparticle[flag];
-
-    } else if (flavor[m] == GRID) {
-      int n = grid->nlocal;
-      if (n > maxgrid) {
-        maxgrid = grid->maxlocal;
-        memory->destroy(vargrid);
-        memory->create(vargrid,maxgrid,"reduce:vargrid");
-      }
+  double init = 0.0;
+  if (mode == MINN) init = BIG;
+  else if (mode == MAXX) init = -BIG;
 
-      input->variable->compute_grid(vidx,vargrid,1,0);
-      if (flag < 0) {
-        for (i = 0; i < n; i++)
-          combine(one,vargrid[i],i);
-      } else one = vargrid[flag];
-    }
+  for (m = 0; m < nvalues; m++) {
+    one[m] = init;
+    indices[m] = -1;
   }
 
-  return one;
+  int nentity[3];
+  nentity[PARTICLE] = particle->nlocal;
+  nentity[GRID] = grid->nlocal;
+  nentity[SURF] = surf->nlocal;
+
+  for (int iflavor = PARTICLE; iflavor <= SURF; iflavor++) {
+    nl = nlist[iflavor];
+    if (!nl) continue;
+    list = valuelist[iflavor];
+    n = nentity[iflavor];
+    for (i = 0; i < n; i++)
+      for (k = 0; k < nl; k++) {
+        m = list[k];
+        combine(one[m],value_one(m,i),i,indices[m]);
+      }
+  }
 }
 
-/* ---------------------------------------------------------------------- */
+/* ----------------------------------------------------------------------
+   return value M of local particle, grid cell, or surf I
+   setup_sources() must have been called on this step
+------------------------------------------------------------------------- */
 
-bigint ComputeReduce::count(int m)
+double ComputeReduce::value_one(int m, int i)
 {
-  bigint ncount,ncountall;
-
-  if (which[m] == X || which[m] == V) {
-    ncount = particle->nlocal;
-  } else if (which[m] == KE || which[m] == EROT || which[m] == EVIB) {
-    ncount = particle->nlocal;
-  } else if (which[m] == COMPUTE) {
-    if (flavor[m] == PARTICLE) ncount = particle->nlocal;
-    else if (flavor[m] == GRID) ncount = grid->nlocal;
-  } else if (which[m] == FIX) {
-    if (flavor[m] == PARTICLE) ncount = particle->nlocal;
-    else if (flavor[m] == GRID) ncount = grid->nlocal;
-    else if (flavor[m] == SURF) ncount = surf->nlocal;
-  } else if (which[m] == VARIABLE) {
-    if (flavor[m] == PARTICLE) ncount = particle->nlocal;
-    else if (flavor[m] == GRID) ncount = grid->nlocal;
+  if (which[m] == X) return particle->particles[i].x[argindex[m]];
+  if (which[m] == V) return particle->particles[i].v[argindex[m]];
+  if (which[m] == KE) {
+    Particle::OnePart *p = &particle->particles[i];
+    double *v = p->v;
+    return update->mvv2e * 0.5 * particle->species[p->ispecies].mass *
+      (v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
   }
+  if (which[m] == EROT) return particle->particles[i].erot;
+  if (which[m] == EVIB) return particle->particles[i].evib;
 
-  MPI_Allreduce(&ncount,&ncountall,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
-
-  return ncountall;
+  Source *src = &sources[m];
+  if (src->vec) return src->vec[i];
+  return src->array[i][src->col];
 }
 
 /* ----------------------------------------------------------------------
@@ -706,7 +650,7 @@ bigint ComputeReduce::count(int m)
    for MIN/MAX, also update index with winner
 ------------------------------------------------------------------------- */
 
-void ComputeReduce::combine(double &one, double two, int i)
+void ComputeReduce::combine(double &one, double two, int i, int &index)
 {
   if (mode == SUM || mode == AVE) one += two;
   else if (mode == SUMSQ || mode == AVESQ) one += two*two;
@@ -724,12 +668,13 @@ void ComputeReduce::combine(double &one, double two, int i)
 }
 
 /* ----------------------------------------------------------------------
-   memory usage of varatom
+   memory usage of variable and copy buffers
 ------------------------------------------------------------------------- */
 
 bigint ComputeReduce::memory_usage()
 {
-  bigint bytes = maxparticle * sizeof(double);
-  bytes += maxgrid * sizeof(double);
+  bigint bytes = (bigint) nvarparticle * maxparticle * sizeof(double);
+  bytes += (bigint) nvargrid * maxgrid * sizeof(double);
+  bytes += 2 * nslot * sizeof(Reduce);
   return bytes;
 }
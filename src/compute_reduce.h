@@ -32,6 +32,9 @@ class ComputeReduce : public Compute {
   void init();
   double compute_scalar();
   void compute_vector();
+  int reduce_size();
+  void reduce_pack(Reduce *);
+  void reduce_unpack(Reduce *);
   bigint memory_usage();
 
  protected:
@@ -39,23 +42,36 @@ class ComputeReduce : public Compute {
   int mode,nvalues,iregion;
   int *which,*argindex,*flavor,*value2index;
   char **ids;
-  double *onevec;
-  int *replace,*indices,*owner;
-  int index;
+  int *replace;
   char *idregion;
 
-  int maxparticle,maxgrid;
-  double *varparticle,*vargrid;
+  double *one;            // local reduction of each value
+  int *indices;           // local index of min/max winner of each value
 
-  struct Pair {
-    double value;
-    int proc;
+  struct Source {
+    double *vec;          // per-entity vector the value reads, NULL if array
+    double **array;       // per-entity array the value reads
+    int col;              // column of array
   };
-  Pair pairme,pairall;
+  Source *sources;        // data source of each compute,fix,variable value
+
+  int nlist[3];           // # of particle,grid,surf values
+  int *valuelist[3];      // values reduced in each fused pass
+
+  int nslot;              // # of packed Reduce slots
+  Reduce *slots,*slotsall;
+  MPI_Datatype reduce_type;
+  MPI_Op reduce_op;
+
+  int *varrow;            // row of each value in varparticle/vargrid, -1 if none
+  int nvarparticle,nvargrid;
+  int maxparticle,maxgrid;
+  double **varparticle,**vargrid;
 
-  double compute_one(int, int);
-  bigint count(int);
-  void combine(double &, double, int);
+  void setup_sources();
+  void reduce_local();
+  double value_one(int, int);
+  void combine(double &, double, int, int &);
 };
 
 }
@@ -21,6 +21,7 @@
 #include "grid.h"
 #include "update.h"
 #include "modify.h"
+#include "tally_grid.h"
 #include "comm.h"
 #include "memory.h"
 #include "error.h"
@@ -145,6 +146,10 @@ void ComputeSonineGrid::init()
     error->all(FLERR,"Number of groups in compute sonine/grid "
                "mixture has changed");
 
+  int moments[4] = {TallyGrid::MVX,TallyGrid::MVY,TallyGrid::MVZ,
+                    TallyGrid::MASS};
+  tset = modify->tallygrid->request(imix,groupbit,0,4,moments);
+
   reallocate();
 }
 
@@ -166,32 +171,24 @@ void ComputeSonineGrid::compute_per_grid()
   double vthermal[3];
 
   // compute COM velocity on this timestep for each cell and group
-
-  for (i = 0; i < nglocal; i++) {
-    for (j = 0; j < ngroup; j++) {
-      vcom[i][j][0] = 0.0;
-      vcom[i][j][1] = 0.0;
-      vcom[i][j][2] = 0.0;
-      vcom[i][j][3] = 0.0;
+  // from mass and momentum moments shared with other grid computes
+
+  TallyGrid *tallygrid = modify->tallygrid;
+  double **moments = tallygrid->compute(tset);
+  int imvx,imass;
+
+  for (j = 0; j < ngroup; j++) {
+    imvx = tallygrid->column(tset,j,TallyGrid::MVX);
+    imass = tallygrid->column(tset,j,TallyGrid::MASS);
+    for (i = 0; i < nglocal; i++) {
+      vec = moments[i];
+      vcom[i][j][0] = vec[imvx];
+      vcom[i][j][1] = vec[imvx+1];
+      vcom[i][j][2] = vec[imvx+2];
+      vcom[i][j][3] = vec[imass];
     }
   }
 
-  for (i = 0; i < nlocal; i++) {
-    ispecies = particles[i].ispecies;
-    igroup = s2g[ispecies];
-    if (igroup < 0) continue;
-    icell = particles[i].icell;
-    if (!(cinfo[icell].mask & groupbit)) continue;
-
-    mass = species[ispecies].mass;
-    v = particles[i].v;
-
-    vcom[icell][igroup][0] += mass * v[0];
-    vcom[icell][igroup][1] += mass * v[1];
-    vcom[icell][igroup][2] += mass * v[2];
-    vcom[icell][igroup][3] += mass;
-  }
-
   for (i = 0; i < nglocal; i++)
     for (j = 0; j < ngroup; j++) {
       norm = vcom[i][j][3];
@@ -56,6 +56,7 @@ class ComputeSonineGrid : public Compute {
   double **tally;            // array of tally quantities, cells by ntotal
 
   double ***vcom;            // COM velocity and mass per group and per cell
+  int tset;                  // set of shared moments in modify->tallygrid
 };
 
 }
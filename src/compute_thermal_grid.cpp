@@ -21,6 +21,7 @@
 #include "grid.h"
 #include "update.h"
 #include "modify.h"
+#include "tally_grid.h"
 #include "comm.h"
 #include "memory.h"
 #include "error.h"
@@ -31,6 +32,13 @@ using namespace SPARTA_NS;
 
 enum{TEMP,PRESS};
 
+// shared moments in TallyGrid for the 6 tally quantities per group
+// N, Mass, mVx, mVy, mVz, mV^2
+
+static const int TMOMENT[] = {TallyGrid::COUNT,TallyGrid::MASS,
+                              TallyGrid::MVX,TallyGrid::MVY,TallyGrid::MVZ,
+                              TallyGrid::MVSQ};
+
 /* ---------------------------------------------------------------------- */
 
 ComputeThermalGrid::ComputeThermalGrid(SPARTA *sparta, int narg, char **arg) :
@@ -79,6 +87,13 @@ ComputeThermalGrid::ComputeThermalGrid(SPARTA *sparta, int narg, char **arg) :
     for (int j = 0; j < npergroup; j++)
       map[i][j] = (i/nvalue)*npergroup + j;
 
+  tbin = new int[ntotal];
+  tmoment = new int[ntotal];
+  for (int i = 0; i < ntotal; i++) {
+    tbin[i] = i / npergroup;
+    tmoment[i] = TMOMENT[i % npergroup];
+  }
+
   nglocal = 0;
   vector_grid = NULL;
   tally = NULL;
@@ -96,6 +111,8 @@ ComputeThermalGrid::~ComputeThermalGrid()
   memory->destroy(map);
 
   memory->destroy(vector_grid);
+  delete [] tbin;
+  delete [] tmoment;
   memory->destroy(tally);
 }
 
@@ -110,6 +127,8 @@ void ComputeThermalGrid::init()
   tprefactor = update->mvv2e / (3.0*update->boltz);
   pprefactor = update->fnum * update->mvv2e / 3.0;
 
+  tset = modify->tallygrid->request(imix,groupbit,0,ntotal,tmoment);
+
   reallocate();
 }
 
@@ -119,46 +138,10 @@ void ComputeThermalGrid::compute_per_grid()
 {
   invoked_per_grid = update->ntimestep;
 
-  Grid::ChildInfo *cinfo = grid->cinfo;
-  Particle::Species *species = particle->species;
-  Particle::OnePart *particles = particle->particles;
-  int *s2g = particle->mixture[imix]->species2group;
-  int nlocal = particle->nlocal;
-
-  int i,j,k,ispecies,igroup,icell;
-  double mass;
-  double *v,*vec;
-
-  // zero all accumulators - could do this with memset()
-
-  for (i = 0; i < nglocal; i++)
-    for (j = 0; j < ntotal; j++)
-      tally[i][j] = 0.0;
-
-  // loop over all particles, skip species not in mixture group
-
-  for (i = 0; i < nlocal; i++) {
-    ispecies = particles[i].ispecies;
-    igroup = s2g[ispecies];
-    if (igroup < 0) continue;
-    icell = particles[i].icell;
-    if (!(cinfo[icell].mask & groupbit)) continue;
-
-    mass = species[ispecies].mass;
-    v = particles[i].v;
-
-    // 6 tallies per particle: N, Mass, mVx, mVy, mVz, mV^2
-
-    vec = tally[icell];
-    k = igroup*npergroup;
-    
-    vec[k++] += 1.0;
-    vec[k++] += mass;
-    vec[k++] += mass*v[0];
-    vec[k++] += mass*v[1];
-    vec[k++] += mass*v[2];
-    vec[k++] += mass * (v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
-  }
+  // copy 6 tallies per group from moments shared with other grid computes
+  // moments are tallied by a single particle pass if not yet current
+
+  modify->tallygrid->gather(tset,ntotal,tbin,tmoment,tally);
 }
 
 /* ----------------------------------------------------------------------
@@ -49,6 +49,9 @@ class ComputeThermalGrid : public Compute {
   int **map;                 // which tally columns each output value uses
   double **tally;            // array of tally quantities, cells by ntotal
 
+  int tset;                  // set of shared moments in modify->tallygrid
+  int *tbin,*tmoment;        // group and shared moment for each tally column
+
   double tprefactor;         // conversion from KE to temperature
   double pprefactor;         // conversion from KE to pressure
 };
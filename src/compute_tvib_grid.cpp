@@ -19,6 +19,7 @@
 #include "grid.h"
 #include "update.h"
 #include "modify.h"
+#include "tally_grid.h"
 #include "memory.h"
 #include "error.h"
 
@@ -84,6 +85,17 @@ ComputeTvibGrid::ComputeTvibGrid(SPARTA *sparta, int narg, char **arg) :
     }
   }
 
+  // species and shared moment for each tally column
+  // 2 columns per species = vibrational energy and particle count
+
+  tbin = new int[ntotal];
+  tmoment = new int[ntotal];
+  for (int i = 0; i < ntotal; i += 2) {
+    tbin[i] = tbin[i+1] = t2s[i];
+    tmoment[i] = TallyGrid::EVIB;
+    tmoment[i+1] = TallyGrid::COUNT;
+  }
+
   nglocal = 0;
   vector_grid = NULL;
   tally = NULL;
@@ -101,6 +113,8 @@ ComputeTvibGrid::~ComputeTvibGrid()
   delete [] t2s;
 
   memory->destroy(vector_grid);
+  delete [] tbin;
+  delete [] tmoment;
   memory->destroy(tally);
 }
 
@@ -124,6 +138,8 @@ void ComputeTvibGrid::init()
       error->all(FLERR,"Number of species in compute tvib/grid "
                  "group has changed");
 
+  tset = modify->tallygrid->request(imix,groupbit,1,ntotal,tmoment);
+
   reallocate();
 }
 
@@ -133,33 +149,11 @@ void ComputeTvibGrid::compute_per_grid()
 {
   invoked_per_grid = update->ntimestep;
 
-  Grid::ChildInfo *cinfo = grid->cinfo;
-  Particle::OnePart *particles = particle->particles;
-  int *s2g = particle->mixture[imix]->species2group;
-  int nlocal = particle->nlocal;
-
-  int i,j,ispecies,igroup,icell;
+  // copy vibrational energy and particle count for each species
+  //   from per-species moments shared with other grid computes
+  // moments are tallied by a single particle pass if not yet current
 
-  // zero all accumulators - could do this with memset()
-
-  for (i = 0; i < nglocal; i++)
-    for (j = 0; j < ntotal; j++)
-      tally[i][j] = 0.0;
-
-  // loop over all particles, skip species not in mixture group
-  // tally vibrational energy and particle count for each species
-
-  for (i = 0; i < nlocal; i++) {
-    ispecies = particles[i].ispecies;
-    igroup = s2g[ispecies];
-    if (igroup < 0) continue;
-    icell = particles[i].icell;
-    if (!(cinfo[icell].mask & groupbit)) continue;
-
-    j = s2t[ispecies];
-    tally[icell][j] += particles[i].evib;
-    tally[icell][j+1] += 1.0;
-  }
+  modify->tallygrid->gather(tset,ntotal,tbin,tmoment,tally);
 }
 
 /* ----------------------------------------------------------------------
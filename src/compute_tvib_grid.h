@@ -46,6 +46,9 @@ class ComputeTvibGrid : public Compute {
   int **map;                 // which tally columns each group value uses
   double **tally;            // array of tally quantities, cells by ntotal
 
+  int tset;                  // set of shared moments in modify->tallygrid
+  int *tbin,*tmoment;        // species and shared moment for each tally column
+
   double *tspecies;          // per-species vibrational temperature
   int *s2t;                  // convert particle species to tally column
   int *t2s;                  // convert tally column to particle species
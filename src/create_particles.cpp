@@ -28,6 +28,7 @@
 #include "variable.h"
 #include "random_mars.h"
 #include "random_park.h"
+#include "math_random.h"
 #include "math_const.h"
 #include "memory.h"
 #include "error.h"
@@ -337,6 +338,10 @@ void CreateParticles::command(int narg, char **arg)
     else create_local(np);
   } //else create_global(np);
 
+  // added particles are not in per-cell lists
+
+  particle->sorted = 0;
+
   MPI_Barrier(world);
   double time2 = MPI_Wtime();
 
@@ -532,11 +537,14 @@ void CreateParticles::create_local(bigint np)
 
   int npercell,ncreate,isp,ispecies,id;
   double x[3],v[3],vstream_variable[3];
-  double ntarget,scale,rn,vn,vr,theta1,theta2,erot,evib;
+  double ntarget,scale,rn,vthermal,erot,evib;
 
   double tempscale = 1.0;
   double sqrttempscale = 1.0;
 
+  int maxvblock = 0;
+  double *vblock = NULL;
+
   double volsum = 0.0;
   bigint nprev = 0;
 
@@ -565,6 +573,14 @@ void CreateParticles::create_local(bigint np)
       if (random->uniform() < ntarget-ncreate) ncreate++;
     }
 
+    // thermal velocity RNs for all particles in cell as one block
+
+    if (3*ncreate > maxvblock) {
+      maxvblock = 3*ncreate;
+      memory->destroy(vblock);
+      memory->create(vblock,maxvblock,"create_particles:vblock");
+    }
+    MathRandom::gaussian(random,3*ncreate,vblock);
 
     for (int m = 0; m < ncreate; m++) {
       rn = random->uniform();
@@ -589,20 +605,17 @@ void CreateParticles::create_local(bigint np)
         sqrttempscale = sqrt(tempscale);
       }
 
-      vn = vscale[isp] * sqrttempscale * sqrt(-log(random->uniform()));
-      vr = vscale[isp] * sqrttempscale * sqrt(-log(random->uniform()));
-      theta1 = MY_2PI * random->uniform();
-      theta2 = MY_2PI * random->uniform();
+      vthermal = MY_ISQRT2 * vscale[isp] * sqrttempscale;
 
       if (velflag) {
         velocity_variable(x,vstream,vstream_variable);
-        v[0] = vstream_variable[0] + vn*cos(theta1);
-        v[1] = vstream_variable[1] + vr*cos(theta2);
-        v[2] = vstream_variable[2] + vr*sin(theta2);
+        v[0] = vstream_variable[0] + vthermal*vblock[3*m];
+        v[1] = vstream_variable[1] + vthermal*vblock[3*m+1];
+        v[2] = vstream_variable[2] + vthermal*vblock[3*m+2];
       } else {
-        v[0] = vstream[0] + vn*cos(theta1);
-        v[1] = vstream[1] + vr*cos(theta2);
-        v[2] = vstream[2] + vr*sin(theta2);
+        v[0] = vstream[0] + vthermal*vblock[3*m];
+        v[1] = vstream[1] + vthermal*vblock[3*m+1];
+        v[2] = vstream[2] + vthermal*vblock[3*m+2];
       }
 
       erot = particle->erot(ispecies,temp_rot*tempscale,random);
@@ -624,6 +637,7 @@ void CreateParticles::create_local(bigint np)
   }
 
   delete random;
+  memory->destroy(vblock);
 }
 
 /* ----------------------------------------------------------------------
@@ -23,6 +23,7 @@
 #include "input.h"
 #include "grid.h"
 #include "output.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -54,6 +55,14 @@ Dump::Dump(SPARTA *sparta, int, char **arg) : Pointers(sparta)
   style = new char[n];
   strcpy(style,arg[1]);
 
+  // timer region for this dump, within Output phase
+
+  char *name = new char[strlen(id)+8];
+  strcpy(name,"dump ");
+  strcat(name,id);
+  itimer = timer->add_region(name,TIME_OUTPUT,TIMER_NORMAL);
+  delete [] name;
+
   n = strlen(arg[4]) + 1;
   filename = new char[n];
   strcpy(filename,arg[4]);
@@ -23,6 +23,7 @@ namespace SPARTA_NS {
 class Dump : protected Pointers {
  public:
   char *id;                  // user-defined name of Dump
+  int itimer;                // index of Timer region for this dump
   char *style;               // style of Dump
 
   int first_flag;            // 0 if no initial dump, 1 if yes initial dump
@@ -37,6 +37,10 @@
 #include "jpeglib.h"
 #endif
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 //#define RCB_DEBUG 1     // un-comment to include RCB proc boxes in image
 
 using namespace SPARTA_NS;
@@ -993,10 +997,33 @@ void DumpImage::write()
     if (flag) error->all(FLERR,"Invalid color map min/max values");
   }
 
+  // invoke computes that color grid cells or surfs
+  // must be done before rendering, since threads cannot invoke them
+
+  if (gridflag && gcolor == ATTRIBUTE && gridwhich == COMPUTE)
+    invoke_grid(gridindex);
+  if (gridxflag && gxcolor == ATTRIBUTE && gridxwhich == COMPUTE)
+    invoke_grid(gridxindex);
+  if (gridyflag && gycolor == ATTRIBUTE && gridywhich == COMPUTE)
+    invoke_grid(gridyindex);
+  if (gridzflag && gzcolor == ATTRIBUTE && gridzwhich == COMPUTE)
+    invoke_grid(gridzindex);
+  if (surfflag && scolor == ATTRIBUTE && surfwhich == COMPUTE) {
+    Compute *compute = modify->compute[surfindex];
+    if (!(compute->invoked_flag & INVOKED_PER_SURF)) {
+      compute->compute_per_surf();
+      compute->invoked_flag |= INVOKED_PER_SURF;
+    }
+  }
+
   // create my portion of image for my particles, grid cells, surfs
-  // then merge per-proc images
+  // each thread renders a static chunk of each loop into its own raster
+  // then merge per-thread and per-proc images
 
   image->clear();
+#if defined(_OPENMP)
+#pragma omp parallel num_threads(image->nthreads)
+#endif
   create_image();
   image->merge();
 
@@ -1013,6 +1040,19 @@ void DumpImage::write()
   }
 }
 
+/* ----------------------------------------------------------------------
+   invoke a per-grid compute if not already invoked on this step
+------------------------------------------------------------------------- */
+
+void DumpImage::invoke_grid(int index)
+{
+  Compute *c = modify->compute[index];
+  if (!(c->invoked_flag & INVOKED_PER_GRID)) {
+    c->compute_per_grid();
+    c->invoked_flag |= INVOKED_PER_GRID;
+  }
+}
+
 /* ----------------------------------------------------------------------
    simulation box bounds
 ------------------------------------------------------------------------- */
@@ -1095,6 +1135,9 @@ void DumpImage::view_params()
 /* ----------------------------------------------------------------------
    create image for particles on this proc
    every pixel has depth 
+   called by each thread, loops over particles, cells, surfs are split
+   static chunks keep the serial drawing order across threads,
+     so last thread draws the box and axes
 ------------------------------------------------------------------------- */
 
 void DumpImage::create_image()
@@ -1103,15 +1146,23 @@ void DumpImage::create_image()
   double diameter;
   double *color;
 
+  int lastthread = 1;
+#if defined(_OPENMP)
+  lastthread = (omp_get_thread_num() == omp_get_num_threads()-1);
+#endif
+
   // render my partiless
   // region is used as constraint by parent class
 
   if (particleflag) {
     Particle::OnePart *particles = particle->particles;
 
-    m = 0;
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
     for (i = 0; i < nchoose; i++) {
       j = clist[i];
+      m = i*size_one;
       
       if (pcolor == TYPE) {
 	itype = static_cast<int> (buf[m]);
@@ -1132,7 +1183,6 @@ void DumpImage::create_image()
       }
 
       image->draw_sphere(particles[j].x,color,diameter);
-      m += size_one;
     }
   }
 
@@ -1153,6 +1203,9 @@ void DumpImage::create_image()
     Grid::ChildCell *cells = grid->cells;
     int nglocal = grid->nlocal;
 
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
     for (int icell = 0; icell < nglocal; icell++) {
       if (cells[icell].nsplit <= 0) continue;
 
@@ -1208,6 +1261,9 @@ void DumpImage::create_image()
     Grid::ChildCell *cells = grid->cells;
     int nglocal = grid->nlocal;
 
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
     for (int icell = 0; icell < nglocal; icell++) {
       if (cells[icell].nsplit <= 0) continue;
 
@@ -1333,6 +1389,9 @@ void DumpImage::create_image()
 
     double box[8][3];
 
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
     for (int icell = 0; icell < nglocal; icell++) {
       if (cells[icell].nsplit <= 0) continue;
       lo = cells[icell].lo;
@@ -1402,6 +1461,9 @@ void DumpImage::create_image()
 
     double box[8][3];
 
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
     for (int icell = 0; icell < nglocal; icell++) {
       if (cells[icell].nsplit <= 0) continue;
       lo = cells[icell].lo;
@@ -1440,6 +1502,9 @@ void DumpImage::create_image()
     int *mysurfs = surf->mysurfs;
     int nslocal = surf->nlocal;
 
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
     for (int isurf = 0; isurf < nslocal; isurf++) {
       m = mysurfs[isurf];
       
@@ -1488,12 +1553,18 @@ void DumpImage::create_image()
     int nslocal = surf->nlocal;
 
     if (domain->dimension == 2) {
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
       for (int isurf = 0; isurf < nslocal; isurf++) {
         m = mysurfs[isurf];
         image->draw_line(pts[lines[m].p1].x,pts[lines[m].p2].x,
                          slinecolor,diameter);
       }
     } else {
+#if defined(_OPENMP)
+#pragma omp for schedule(static)
+#endif
       for (int isurf = 0; isurf < nslocal; isurf++) {
         m = mysurfs[isurf];
         image->draw_line(pts[tris[m].p1].x,pts[tris[m].p2].x,
@@ -1508,7 +1579,7 @@ void DumpImage::create_image()
 
   // render outline of simulation box, orthogonal or triclinic
 
-  if (boxflag) {
+  if (boxflag && lastthread) {
     diameter = MIN(boxxhi-boxxlo,boxyhi-boxylo);
     if (domain->dimension == 3) diameter = MIN(diameter,boxzhi-boxzlo);
     diameter *= boxdiam;
@@ -1529,7 +1600,7 @@ void DumpImage::create_image()
   // render XYZ axes in red/green/blue
   // offset by 10% of box size and scale by axeslen
 
-  if (axesflag) {
+  if (axesflag && lastthread) {
     diameter = MIN(boxxhi-boxxlo,boxyhi-boxylo);
     if (domain->dimension == 3) diameter = MIN(diameter,boxzhi-boxzlo);
     diameter *= axesdiam;
@@ -1566,6 +1637,8 @@ void DumpImage::create_image()
 
 #ifdef RCB_DEBUG
 
+  if (!lastthread) return;
+
   diameter = MIN(boxxhi-boxxlo,boxyhi-boxylo);
   if (domain->dimension == 3) diameter = MIN(diameter,boxzhi-boxzlo);
   diameter *= 0.5*boxdiam;
@@ -120,6 +120,7 @@ class DumpImage : public DumpParticle {
   void box_center();
   void view_params();
   void box_bounds();
+  void invoke_grid(int);
 
   void create_image();
 };
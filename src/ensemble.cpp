@@ -0,0 +1,440 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#include "spatype.h"
+#include "mpi.h"
+#include "stdlib.h"
+#include "string.h"
+#include "ensemble.h"
+#include "universe.h"
+#include "input.h"
+#include "variable.h"
+#include "update.h"
+#include "random_mars.h"
+#include "collide.h"
+#include "react.h"
+#include "surf.h"
+#include "surf_collide.h"
+#include "surf_react.h"
+#include "particle.h"
+#include "modify.h"
+#include "fix.h"
+#include "compute.h"
+#include "output.h"
+#include "dump.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace SPARTA_NS;
+
+#define DELTA 16
+
+static int active = 0;      // 1 while an ensemble command is running
+
+/* ---------------------------------------------------------------------- */
+
+Ensemble::Ensemble(SPARTA *sparta) : Pointers(sparta)
+{
+  MPI_Comm_rank(world,&me);
+  casefile = outfile = NULL;
+  nparam = ncase = nvalue = 0;
+  pname = vname = NULL;
+  pvalue = NULL;
+  nrow = maxrow = 0;
+  warm = 0;
+  rows = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+Ensemble::~Ensemble()
+{
+  delete [] casefile;
+  delete [] outfile;
+  for (int i = 0; i < nparam; i++) delete [] pname[i];
+  delete [] pname;
+  for (int i = 0; i < ncase; i++) {
+    for (int j = 0; j < nparam; j++) delete [] pvalue[i][j];
+    delete [] pvalue[i];
+  }
+  memory->sfree(pvalue);
+  for (int i = 0; i < nvalue; i++) delete [] vname[i];
+  delete [] vname;
+  memory->destroy(rows);
+}
+
+/* ----------------------------------------------------------------------
+   ensemble table casefile outfile v_name1 v_name2 ... keyword value
+   run one case per row of table on whichever world (partition) is free
+   cases are handed out in table order from a counter on universe proc 0,
+     which each world increments via a one-sided MPI atomic operation
+     when it finishes its previous case, so no world waits on another
+   warm yes keeps particles between cases of a world, so which cases
+     follow each other, and thus their results, vary from run to run
+------------------------------------------------------------------------- */
+
+void Ensemble::command(int narg, char **arg)
+{
+  if (active)
+    error->all(FLERR,"Cannot use ensemble command within an ensemble case");
+  if (narg < 3) error->all(FLERR,"Illegal ensemble command");
+
+  // copy args, since running cases overwrites them
+
+  int n = strlen(arg[1]) + 1;
+  casefile = new char[n];
+  strcpy(casefile,arg[1]);
+  n = strlen(arg[2]) + 1;
+  outfile = new char[n];
+  strcpy(outfile,arg[2]);
+
+  nvalue = 0;
+  vname = new char*[narg-3];
+  warm = 0;
+
+  int iarg = 3;
+  while (iarg < narg) {
+    if (strncmp(arg[iarg],"v_",2) == 0) {
+      n = strlen(&arg[iarg][2]) + 1;
+      vname[nvalue] = new char[n];
+      strcpy(vname[nvalue],&arg[iarg][2]);
+      nvalue++;
+      iarg++;
+    } else if (strcmp(arg[iarg],"warm") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal ensemble command");
+      if (strcmp(arg[iarg+1],"yes") == 0) warm = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) warm = 0;
+      else error->all(FLERR,"Illegal ensemble command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal ensemble command");
+  }
+
+  if (warm && universe->nworlds > 1 && me == 0)
+    error->warning(FLERR,"Ensemble warm start results depend on "
+                   "which cases each partition runs");
+
+  read_table(arg[0]);
+
+  // base seed for cases, same on all worlds
+
+  seed = 1 + static_cast<int> (update->ranmaster->uniform()*900000000);
+
+  // counter of next case to run, exposed by universe proc 0
+  // only needed if there are multiple worlds
+
+  int next = 0;
+  int multi = (universe->nworlds > 1);
+  MPI_Win win;
+  if (multi)
+    MPI_Win_create(&next,universe->me == 0 ? sizeof(int) : 0,sizeof(int),
+                   MPI_INFO_NULL,universe->uworld,&win);
+
+  MPI_Barrier(universe->uworld);
+  double time_start = MPI_Wtime();
+
+  active = 1;
+  int one = 1;
+  int icase;
+
+  while (1) {
+    if (me == 0) {
+      if (multi) {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE,0,0,win);
+        MPI_Fetch_and_op(&one,&icase,MPI_INT,0,0,MPI_SUM,win);
+        MPI_Win_unlock(0,win);
+      } else icase = next++;
+    }
+    MPI_Bcast(&icase,1,MPI_INT,0,world);
+    if (icase >= ncase) break;
+    run_case(icase);
+  }
+
+  active = 0;
+  if (multi) MPI_Win_free(&win);
+
+  write_results(MPI_Wtime() - time_start);
+}
+
+/* ----------------------------------------------------------------------
+   read table of parameter names and one row of values per case
+   proc 0 of each world reads the file and broadcasts it
+------------------------------------------------------------------------- */
+
+void Ensemble::read_table(char *file)
+{
+  int n = 0;
+  char *text = NULL;
+
+  if (me == 0) {
+    FILE *fp = fopen(file,"r");
+    if (fp == NULL) {
+      char str[128];
+      sprintf(str,"Cannot open ensemble table %s",file);
+      error->one(FLERR,str);
+    }
+    fseek(fp,0,SEEK_END);
+    n = ftell(fp) + 1;
+    fseek(fp,0,SEEK_SET);
+    text = new char[n];
+    n = fread(text,1,n-1,fp) + 1;
+    text[n-1] = '\0';
+    fclose(fp);
+  }
+  MPI_Bcast(&n,1,MPI_INT,0,world);
+  if (me) text = new char[n];
+  MPI_Bcast(text,n,MPI_CHAR,0,world);
+
+  // 1st line with words = parameter names, others = one case each
+  // skip blank lines and comments starting with #
+
+  char *next;
+  for (char *line = text; line; line = next) {
+    next = strchr(line,'\n');
+    if (next) *next++ = '\0';
+    char *ptr = strchr(line,'#');
+    if (ptr) *ptr = '\0';
+
+    int nwords = input->count_words(line);
+    if (nwords == 0) continue;
+
+    char **words = new char*[nwords];
+    words[0] = strtok(line," \t\r\f");
+    for (int i = 1; i < nwords; i++) words[i] = strtok(NULL," \t\r\f");
+
+    char **list;
+    if (pname == NULL) {
+      nparam = nwords;
+      list = pname = new char*[nparam];
+    } else {
+      if (nwords != nparam)
+        error->all(FLERR,"Ensemble table line has wrong number of values");
+      pvalue = (char ***)
+        memory->srealloc(pvalue,(ncase+1)*sizeof(char **),"ensemble:pvalue");
+      list = pvalue[ncase++] = new char*[nparam];
+    }
+
+    for (int i = 0; i < nwords; i++) {
+      list[i] = new char[strlen(words[i])+1];
+      strcpy(list[i],words[i]);
+    }
+    delete [] words;
+  }
+
+  delete [] text;
+  if (pname == NULL) error->all(FLERR,"Ensemble table has no parameter names");
+}
+
+/* ----------------------------------------------------------------------
+   run one case on my world
+   set each parameter as a string-style variable, plus "case" = case #
+   every case starts at timestep 0 with no particles, unless warm is set,
+     in which case particles of the previous case on this world are kept
+     and the case script can remap them via the retarget command
+   fixes, computes and dumps defined by the case script are deleted after
+     its values are evaluated
+   RNGs are re-seeded from case #, so without warm the result of a case
+     does not depend on which world ran it or what that world ran before
+   with warm, a case starts from the particles of whichever case its
+     world ran before, so its result depends on the case schedule
+------------------------------------------------------------------------- */
+
+void Ensemble::run_case(int icase)
+{
+  char *args[3];
+  char str[32];
+  args[1] = (char *) "string";
+
+  sprintf(str,"%d",icase+1);
+  args[0] = (char *) "case";
+  args[2] = str;
+  input->variable->set(3,args);
+  for (int i = 0; i < nparam; i++) {
+    args[0] = pname[i];
+    args[2] = pvalue[icase][i];
+    input->variable->set(3,args);
+  }
+
+  if (!warm) {
+    particle->nlocal = 0;
+    particle->nglobal = 0;
+  }
+  args[0] = (char *) "0";
+  update->reset_timestep(1,args);
+
+  // re-seed master RNG and RNGs of styles defined before the ensemble
+  // fixes defined by the case script are created after and derive from it
+
+  update->ranmaster->init(seed+icase);
+  if (collide) collide->reseed();
+  particle->reseed();
+  if (react) react->reseed();
+  for (int i = 0; i < surf->nsc; i++) surf->sc[i]->reseed();
+  for (int i = 0; i < surf->nsr; i++) surf->sr[i]->reseed();
+  for (int i = 0; i < modify->nfix; i++) modify->fix[i]->reseed();
+
+  int nfix = modify->nfix;
+  int ncompute = modify->ncompute;
+  int ndump = output->ndump;
+
+  if (me == 0) {
+    if (screen) fprintf(screen,"Ensemble case %d of %d\n",icase+1,ncase);
+    if (logfile) fprintf(logfile,"Ensemble case %d of %d\n",icase+1,ncase);
+  }
+
+  double time_case = MPI_Wtime();
+  input->file_nested(casefile);
+  time_case = MPI_Wtime() - time_case;
+  MPI_Bcast(&time_case,1,MPI_DOUBLE,0,world);
+
+  // store case index, world, time, and values of variables
+
+  if (nrow == maxrow) {
+    maxrow += DELTA;
+    memory->grow(rows,maxrow*(3+nvalue),"ensemble:rows");
+  }
+  double *row = &rows[nrow*(3+nvalue)];
+  row[0] = icase;
+  row[1] = universe->iworld;
+  row[2] = time_case;
+
+  for (int i = 0; i < nvalue; i++) {
+    int ivar = input->variable->find(vname[i]);
+    if (ivar < 0) error->all(FLERR,"Ensemble variable name does not exist");
+    if (!input->variable->equal_style(ivar))
+      error->all(FLERR,"Ensemble variable is not equal-style variable");
+    row[3+i] = input->variable->compute_equal(ivar);
+  }
+  nrow++;
+
+  // delete what the case script added, newest first
+
+  while (output->ndump > ndump) {
+    Dump *dump = output->dump[output->ndump-1];
+    char *id = new char[strlen(dump->id)+1];
+    strcpy(id,dump->id);
+    output->delete_dump(id);
+    delete [] id;
+  }
+  while (modify->nfix > nfix) {
+    Fix *fix = modify->fix[modify->nfix-1];
+    char *id = new char[strlen(fix->id)+1];
+    strcpy(id,fix->id);
+    modify->delete_fix(id);
+    delete [] id;
+  }
+  while (modify->ncompute > ncompute) {
+    Compute *compute = modify->compute[modify->ncompute-1];
+    char *id = new char[strlen(compute->id)+1];
+    strcpy(id,compute->id);
+    modify->delete_compute(id);
+    delete [] id;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   gather rows from proc 0 of each world to universe proc 0
+   write them in case order, with parameter values, to outfile
+   print per-world busy time and overall utilization of all procs
+------------------------------------------------------------------------- */
+
+void Ensemble::write_results(double time_all)
+{
+  int nworlds = universe->nworlds;
+  int size = 3 + nvalue;
+
+  int nsend = (me == 0) ? nrow*size : 0;
+  int *recvcounts = NULL;
+  int *displs = NULL;
+  double *all = NULL;
+  if (universe->me == 0) {
+    recvcounts = new int[universe->nprocs];
+    displs = new int[universe->nprocs];
+  }
+  MPI_Gather(&nsend,1,MPI_INT,recvcounts,1,MPI_INT,0,universe->uworld);
+  if (universe->me == 0) {
+    displs[0] = 0;
+    for (int iproc = 1; iproc < universe->nprocs; iproc++)
+      displs[iproc] = displs[iproc-1] + recvcounts[iproc-1];
+    all = new double[ncase*size];
+  }
+  MPI_Gatherv(rows,nsend,MPI_DOUBLE,all,recvcounts,displs,MPI_DOUBLE,
+              0,universe->uworld);
+  delete [] recvcounts;
+  delete [] displs;
+
+  if (universe->me) return;
+
+  // order[i] = row of case I
+
+  int *order = new int[ncase];
+  for (int i = 0; i < ncase; i++) order[i] = (int) all[i*size];
+  int *byrow = new int[ncase];
+  for (int i = 0; i < ncase; i++) byrow[order[i]] = i;
+
+  FILE *fp = fopen(outfile,"w");
+  if (fp == NULL) {
+    char str[128];
+    sprintf(str,"Cannot open ensemble output file %s",outfile);
+    error->one(FLERR,str);
+  }
+  fprintf(fp,"# %d ensemble cases on %d partitions\n",ncase,nworlds);
+  fprintf(fp,"# case partition time");
+  for (int j = 0; j < nparam; j++) fprintf(fp," %s",pname[j]);
+  for (int j = 0; j < nvalue; j++) fprintf(fp," v_%s",vname[j]);
+  fprintf(fp,"\n");
+  for (int i = 0; i < ncase; i++) {
+    double *row = &all[byrow[i]*size];
+    fprintf(fp,"%d %d %g",i+1,(int) row[1]+1,row[2]);
+    for (int j = 0; j < nparam; j++) fprintf(fp," %s",pvalue[i][j]);
+    for (int j = 0; j < nvalue; j++) fprintf(fp," %.15g",row[3+j]);
+    fprintf(fp,"\n");
+  }
+  fclose(fp);
+
+  // busy time of each world, utilization weighted by its # of procs
+
+  double *busy = new double[nworlds];
+  int *count = new int[nworlds];
+  for (int i = 0; i < nworlds; i++) {
+    busy[i] = 0.0;
+    count[i] = 0;
+  }
+  for (int i = 0; i < ncase; i++) {
+    int iworld = (int) all[i*size+1];
+    busy[iworld] += all[i*size+2];
+    count[iworld]++;
+  }
+  double used = 0.0;
+  for (int i = 0; i < nworlds; i++)
+    used += busy[i] * universe->procs_per_world[i];
+  double util = 0.0;
+  if (time_all > 0.0) util = 100.0 * used / (universe->nprocs*time_all);
+
+  FILE *out[2] = {universe->uscreen,universe->ulogfile};
+  for (int m = 0; m < 2; m++) {
+    if (!out[m]) continue;
+    fprintf(out[m],"Ensemble of %d cases on %d partitions in %g secs, "
+            "utilization = %g%%\n",ncase,nworlds,time_all,util);
+    for (int i = 0; i < nworlds; i++)
+      fprintf(out[m],"  partition %d: %d cases, %g secs busy (%g%%)\n",
+              i+1,count[i],busy[i],
+              time_all > 0.0 ? 100.0*busy[i]/time_all : 0.0);
+  }
+
+  delete [] busy;
+  delete [] count;
+  delete [] order;
+  delete [] byrow;
+  delete [] all;
+}
@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMMAND_CLASS
+
+CommandStyle(ensemble,Ensemble)
+
+#else
+
+#ifndef SPARTA_ENSEMBLE_H
+#define SPARTA_ENSEMBLE_H
+
+#include "pointers.h"
+
+namespace SPARTA_NS {
+
+class Ensemble : protected Pointers {
+ public:
+  Ensemble(class SPARTA *);
+  ~Ensemble();
+  void command(int, char **);
+
+ private:
+  int me;
+  char *casefile;           // input script run for each case
+  char *outfile;            // output table, written by universe proc 0
+
+  int nparam;               // # of parameters = columns of table
+  char **pname;             // name of each parameter
+  int ncase;                // # of cases = rows of table
+  char ***pvalue;           // pvalue[i][j] = value of param J for case I
+
+  int nvalue;               // # of equal-style variables output per case
+  char **vname;             // name of each, without v_ prefix
+  int warm;                 // 1 if particles carry over from previous case
+  int seed;                 // case I re-seeds master RNG with seed+I
+
+  int nrow;                 // # of cases run by my world
+  int maxrow;
+  double *rows;             // per case: index, world, time, values
+
+  void read_table(char *);
+  void run_case(int);
+  void write_results(double);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running SPARTA to see the offending line.
+
+E: Cannot use ensemble command within an ensemble case
+
+The input script run for each case cannot itself use the ensemble
+command.
+
+E: Cannot open ensemble table %s
+
+The specified file cannot be opened.  Check that the path and name are
+correct.
+
+W: Ensemble warm start results depend on which cases each partition runs
+
+With warm yes, a case starts from the particles of the previous case
+run by the same partition.  Which case that is varies from run to run
+when there are multiple partitions, so results are not reproducible.
+
+E: Ensemble table has no parameter names
+
+The first non-blank, non-comment line of the table must list the
+names of the parameters.
+
+E: Ensemble table line has wrong number of values
+
+Each case in the table must have one value per parameter name.
+
+E: Ensemble variable name does not exist
+
+A value listed in the ensemble command must be an equal-style variable
+defined by the time the 1st case finishes.
+
+E: Ensemble variable is not equal-style variable
+
+Only equal-style variables can be output per case.
+
+E: Cannot open ensemble output file %s
+
+The specified file cannot be opened.  Check that the path and name are
+correct.
+
+*/
@@ -26,10 +26,13 @@
 #include "comm.h"
 #include "math_extra.h"
 #include "timer.h"
+#include "perf_counter.h"
 #include "memory.h"
 
 using namespace SPARTA_NS;
 
+#define MIN(A,B) ((A) < (B) ? (A) : (B))
+
 /* ---------------------------------------------------------------------- */
 
 Finish::Finish(SPARTA *sparta) : Pointers(sparta) {}
@@ -334,6 +337,40 @@ void Finish::end(int flag, double time_multiple_runs)
 	fprintf(logfile,"Other time (%%) = %g (%g)\n",
 		time,time/time_loop*100.0);
     }
+
+    // breakdown of phases into nested timer regions
+    // only regions timed at least once on some proc are listed
+
+    if (timer->level > TIMER_OFF) {
+      int n = timer->nregion;
+      double *rmin = new double[n];
+      double *rmax = new double[n];
+      double *rave = new double[n];
+      bigint *rcount = new bigint[n];
+      MPI_Allreduce(timer->array,rmin,n,MPI_DOUBLE,MPI_MIN,world);
+      MPI_Allreduce(timer->array,rmax,n,MPI_DOUBLE,MPI_MAX,world);
+      MPI_Allreduce(timer->array,rave,n,MPI_DOUBLE,MPI_SUM,world);
+      MPI_Allreduce(timer->rcount,rcount,n,MPI_SPARTA_BIGINT,MPI_SUM,world);
+      for (i = 0; i < n; i++) rave[i] /= nprocs;
+
+      if (me == 0) {
+        const char *hdr = "\nSection            |  min time  |  avg time  |"
+          "  max time  |  %imbal  |  %total\n"
+          "--------------------------------------------------"
+          "-----------------------------\n";
+        if (screen) fprintf(screen,"%s",hdr);
+        if (logfile) fprintf(logfile,"%s",hdr);
+        for (i = 1; i < TIME_N; i++)
+          region_table(i,0,time_loop,rmin,rave,rmax,rcount);
+      }
+
+      delete [] rmin;
+      delete [] rmax;
+      delete [] rave;
+      delete [] rcount;
+    }
+
+    if (timer->perf) perf_table();
   }
        
   // histograms
@@ -411,11 +448,138 @@ void Finish::end(int flag, double time_multiple_runs)
 	fprintf(logfile,"\n");
       }
     }
+
+    // largest allocations, to attribute memory growth
+
+    if (me == 0) {
+      if (screen) fprintf(screen,"\n");
+      if (logfile) fprintf(logfile,"\n");
+    }
+    memory->report(10);
   }
     
   if (logfile) fflush(logfile);
 }
 
+/* ----------------------------------------------------------------------
+   print one row of timer region table, then its sub-regions indented
+------------------------------------------------------------------------- */
+
+void Finish::region_table(int iregion, int depth, double time_loop,
+                          double *rmin, double *rave, double *rmax,
+                          bigint *rcount)
+{
+  if (rcount[iregion] == 0) return;
+
+  char name[64];
+  int indent = MIN(2*depth,32);
+  for (int i = 0; i < indent; i++) name[i] = ' ';
+  strncpy(&name[indent],timer->rname[iregion],63-indent);
+  name[63] = '\0';
+
+  double imbalance = 0.0;
+  if (rave[iregion] > 0.0) 
+    imbalance = (rmax[iregion]/rave[iregion] - 1.0) * 100.0;
+  double total = 0.0;
+  if (time_loop > 0.0) total = rave[iregion]/time_loop * 100.0;
+
+  if (screen)
+    fprintf(screen,"%-20s| %10.4g | %10.4g | %10.4g | %8.2f | %8.2f\n",
+            name,rmin[iregion],rave[iregion],rmax[iregion],imbalance,total);
+  if (logfile)
+    fprintf(logfile,"%-20s| %10.4g | %10.4g | %10.4g | %8.2f | %8.2f\n",
+            name,rmin[iregion],rave[iregion],rmax[iregion],imbalance,total);
+
+  for (int i = TIME_N; i < timer->nregion; i++)
+    if (timer->rparent[i] == iregion)
+      region_table(i,depth+1,time_loop,rmin,rave,rmax,rcount);
+}
+
+/* ----------------------------------------------------------------------
+   print hardware counters per phase summed over procs
+   plus derived metrics for the move and collide phases
+   LLC bytes assume one 64-byte cache line is loaded per LLC miss
+------------------------------------------------------------------------- */
+
+void Finish::perf_table()
+{
+  int me;
+  MPI_Comm_rank(world,&me);
+
+  PerfCounter *perf = timer->perf;
+  bigint count[TIME_N][PERF_N];
+  MPI_Allreduce(&perf->count[0][0],&count[0][0],TIME_N*PERF_N,
+                MPI_SPARTA_BIGINT,MPI_SUM,world);
+  for (int i = 0; i < PERF_N; i++) {
+    count[TIME_LOOP][i] = 0;
+    for (int iphase = 1; iphase < TIME_N; iphase++)
+      count[TIME_LOOP][i] += count[iphase][i];
+  }
+
+  bigint nmove,ncollide;
+  MPI_Allreduce(&update->nmove_running,&nmove,1,
+                MPI_SPARTA_BIGINT,MPI_SUM,world);
+  bigint one = 0;
+  if (collide) one = collide->ncollide_running;
+  MPI_Allreduce(&one,&ncollide,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+
+  if (me) return;
+
+  char line[256],field[32];
+  const char *names[TIME_N] = {"Total","Move","Coll","Sort",
+                               "Comm","Modfy","Outpt"};
+  const char *hdr = "\nPhase  |    cycles    |  IPC  |   LLC miss   |"
+    "  branch miss | %stalled\n"
+    "--------------------------------------------------"
+    "---------------------------\n";
+  if (screen) fprintf(screen,"%s",hdr);
+  if (logfile) fprintf(logfile,"%s",hdr);
+
+  for (int k = 1; k <= TIME_N; k++) {
+    int iphase = k % TIME_N;
+    bigint *c = count[iphase];
+    if (c[PERF_CYCLES] == 0) continue;
+
+    sprintf(line,"%-6s | %12.6g |",names[iphase],(double) c[PERF_CYCLES]);
+    if (perf->active[PERF_INSTRUCTIONS])
+      sprintf(field," %5.2f |",(double) c[PERF_INSTRUCTIONS]/c[PERF_CYCLES]);
+    else sprintf(field,"  n/a  |");
+    strcat(line,field);
+    if (perf->active[PERF_LLC_MISSES])
+      sprintf(field," %12.6g |",(double) c[PERF_LLC_MISSES]);
+    else sprintf(field,"          n/a |");
+    strcat(line,field);
+    if (perf->active[PERF_BRANCH_MISSES])
+      sprintf(field," %12.6g |",(double) c[PERF_BRANCH_MISSES]);
+    else sprintf(field,"          n/a |");
+    strcat(line,field);
+    if (perf->active[PERF_STALLED])
+      sprintf(field," %8.2f\n",100.0*c[PERF_STALLED]/c[PERF_CYCLES]);
+    else sprintf(field,"      n/a\n");
+    strcat(line,field);
+
+    if (screen) fprintf(screen,"%s",line);
+    if (logfile) fprintf(logfile,"%s",line);
+  }
+
+  if (!perf->active[PERF_LLC_MISSES]) return;
+
+  double missmove = 0.0;
+  if (nmove) missmove = (double) count[TIME_MOVE][PERF_LLC_MISSES] / nmove;
+  double bytescoll = 0.0;
+  if (ncollide) 
+    bytescoll = 64.0 * count[TIME_COLLIDE][PERF_LLC_MISSES] / ncollide;
+
+  if (screen) {
+    fprintf(screen,"LLC misses/particle-move in Move = %g\n",missmove);
+    fprintf(screen,"LLC bytes/collision in Coll = %g\n",bytescoll);
+  }
+  if (logfile) {
+    fprintf(logfile,"LLC misses/particle-move in Move = %g\n",missmove);
+    fprintf(logfile,"LLC bytes/collision in Coll = %g\n",bytescoll);
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void Finish::stats(int n, double *data, 
@@ -26,6 +26,8 @@ class Finish : protected Pointers {
 
  private:
   void stats(int, double *, double *, double *, double *, int, int *);
+  void perf_table();
+  void region_table(int, int, double, double *, double *, double *, bigint *);
 };
 
 }
@@ -15,6 +15,7 @@
 #include "string.h"
 #include "ctype.h"
 #include "fix.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 #include "sparta_masks.h"
@@ -42,6 +43,14 @@ Fix::Fix(SPARTA *sparta, int, char **arg) : Pointers(sparta)
   style = new char[n];
   strcpy(style,arg[1]);
 
+  // timer region for this fix, within Modify phase
+
+  char *name = new char[strlen(id)+8];
+  strcpy(name,"fix ");
+  strcat(name,id);
+  itimer = timer->add_region(name,TIME_MODIFY,TIMER_NORMAL);
+  delete [] name;
+
   // set child class defaults
 
   time_depend = 0;
@@ -73,3 +82,18 @@ Fix::~Fix()
   delete [] id;
   delete [] style;
 }
+
+/* ----------------------------------------------------------------------
+   timer region for a compute invoked by this fix, nested in fix region
+   so compute time is not counted twice in the Modify breakdown
+------------------------------------------------------------------------- */
+
+int Fix::compute_region(const char *cid)
+{
+  char *name = new char[strlen(cid)+12];
+  strcpy(name,"compute ");
+  strcat(name,cid);
+  int iregion = timer->add_region(name,itimer,TIMER_NORMAL);
+  delete [] name;
+  return iregion;
+}
@@ -25,6 +25,7 @@ class Fix : protected Pointers {
   char *id,*style;
 
   int nevery;                    // how often to call an end_of_step fix
+  int itimer;                    // index of Timer region for this fix
   int time_depend;               // 1 if requires continuous timestepping
   int gridmigrate;               // 0/1 if per grid cell info must migrate
   int flag_add_particle;         // 0/1 if has add_particle() method
@@ -79,6 +80,7 @@ class Fix : protected Pointers {
   virtual void add_particle(int, double, double, double, double *) {}
   virtual void gas_react(int) {}
   virtual void surf_react(Particle::OnePart *, int &, int &) {}
+  virtual void reseed() {}
 
   virtual void add_grid_one(int, int) {}
   virtual int pack_grid_one(int, char *, int) {return 0;}
@@ -91,6 +93,9 @@ class Fix : protected Pointers {
   virtual double compute_array(int,int) {return 0.0;}
 
   virtual double memory_usage() {return 0.0;}
+
+ protected:
+  int compute_region(const char *);
 };
 
 }
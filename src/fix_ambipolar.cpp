@@ -180,3 +180,13 @@ void FixAmbipolar::surf_react(Particle::OnePart *iorig, int &i, int &j)
     j = -1;
   }
 }
+
+/* ----------------------------------------------------------------------
+   re-derive electron velocity RNG from re-seeded master RNG
+------------------------------------------------------------------------- */
+
+void FixAmbipolar::reseed()
+{
+  double seed = update->ranmaster->uniform();
+  random->reset(seed,comm->me,100);
+}
@@ -37,6 +37,7 @@ class FixAmbipolar : public Fix {
   void init();
   void add_particle(int, double, double, double, double *);
   void surf_react(Particle::OnePart *, int &, int &);
+  void reseed();
 
  private:
   int maxion;                 // length of ions vector
@@ -13,6 +13,8 @@
 ------------------------------------------------------------------------- */
 
 #include "spatype.h"
+#include "mpi.h"
+#include "math.h"
 #include "stdlib.h"
 #include "string.h"
 #include "fix_ave_grid.h"
@@ -24,13 +26,15 @@
 #include "compute.h"
 #include "input.h"
 #include "variable.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
 using namespace SPARTA_NS;
 
 enum{COMPUTE,FIX,VARIABLE};
-enum{ONE,RUNNING};                // multiple files
+enum{ONE,RUNNING,EMA};            // multiple files
+enum{DOUBLE,FLOAT};
 
 #define INVOKED_PER_GRID 16
 #define DELTAGRID 1024            // must be bigger than split cells per cell
@@ -71,6 +75,9 @@ FixAveGrid::FixAveGrid(SPARTA *sparta, int narg, char **arg) :
 
   options(iarg,narg,arg);
 
+  if (statflag && ave == EMA)
+    error->all(FLERR,"Fix ave/grid stats cannot be used with ave ema");
+
   // expand args if any have wildcard character "*"
   // this can reset nvalues
 
@@ -86,6 +93,7 @@ FixAveGrid::FixAveGrid(SPARTA *sparta, int narg, char **arg) :
   which = new int[nvalues];
   argindex = new int[nvalues];
   value2index = new int[nvalues];
+  ctimer = new int[nvalues];
   post_process = new int[nvalues];
   ids = new char*[nvalues];
 
@@ -184,9 +192,11 @@ FixAveGrid::FixAveGrid(SPARTA *sparta, int narg, char **arg) :
   }
 
   // this fix produces either a per-grid vector or array
+  // if stats, array has extra column with std error of each value
 
   per_grid_flag = 1;
-  if (nvalues == 1) size_per_grid_cols = 0;
+  if (statflag) size_per_grid_cols = 2*nvalues;
+  else if (nvalues == 1) size_per_grid_cols = 0;
   else size_per_grid_cols = nvalues;
 
   nglocal = nglocalmax = grid->nlocal;
@@ -197,13 +207,14 @@ FixAveGrid::FixAveGrid(SPARTA *sparta, int narg, char **arg) :
   vector_grid = NULL;
   array_grid = NULL;
 
-  if (nvalues == 1) {
+  if (size_per_grid_cols == 0) {
     memory->grow(vector_grid,nglocal,"ave/grid:vector_grid");
     for (int i = 0; i < nglocal; i++) vector_grid[i] = 0.0;
   } else {
-    memory->grow(array_grid,nglocal,nvalues,"ave/grid:array_grid");
+    int ncols = size_per_grid_cols;
+    memory->grow(array_grid,nglocal,ncols,"ave/grid:array_grid");
     for (int i = 0; i < nglocal; i++)
-      for (int m = 0; m < nvalues; m++) array_grid[i][m] = 0.0;
+      for (int m = 0; m < ncols; m++) array_grid[i][m] = 0.0;
   }
 
   // nvalid = next step on which end_of_step does something
@@ -303,13 +314,40 @@ FixAveGrid::FixAveGrid(SPARTA *sparta, int narg, char **arg) :
     }
   }
 
-  // allocate tally array
+  // allocate tally array, in single precision if requested
   // zero in case used by ave = RUNNING or accessed for immediate output
+  // wmap = identity map for a single precision tally widened to double
 
-  memory->create(tally,nglocal,ntotal,"ave/grid:tally");
-  for (int i = 0; i < nglocal; i++)
-    for (int j = 0; j < ntotal; j++)
-      tally[i][j] = 0.0;
+  tally = NULL;
+  ftally = NULL;
+  if (precision == DOUBLE) {
+    memory->create(tally,nglocal,ntotal,"ave/grid:tally");
+    for (int i = 0; i < nglocal; i++)
+      for (int j = 0; j < ntotal; j++)
+        tally[i][j] = 0.0;
+  } else {
+    memory->create(ftally,nglocal,ntotal,"ave/grid:ftally");
+    for (int i = 0; i < nglocal; i++)
+      for (int j = 0; j < ntotal; j++)
+        ftally[i][j] = 0.0;
+  }
+
+  wmap = new int[tmax];
+  for (int k = 0; k < tmax; k++) wmap[k] = k;
+
+  // allocate per-sample statistics, mean and M2 for each value
+  // first sample of a window initializes them
+
+  nstat = 0;
+  dstats = NULL;
+  fstats = NULL;
+  if (statflag && precision == DOUBLE)
+    memory->create(dstats,nglocal,2*nvalues,"ave/grid:dstats");
+  else if (statflag)
+    memory->create(fstats,nglocal,2*nvalues,"ave/grid:fstats");
+
+  nvsample = 0;
+  vsample = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -321,6 +359,7 @@ FixAveGrid::~FixAveGrid()
   delete [] which;
   delete [] argindex;
   delete [] value2index;
+  delete [] ctimer;
   delete [] post_process;
   for (int i = 0; i < nvalues; i++) delete [] ids[i];
   delete [] ids;
@@ -331,9 +370,14 @@ FixAveGrid::~FixAveGrid()
   memory->destroy(umap);
   memory->destroy(uomap);
 
-  if (nvalues == 1) memory->destroy(vector_grid);
+  if (size_per_grid_cols == 0) memory->destroy(vector_grid);
   else memory->destroy(array_grid);
   memory->destroy(tally);
+  memory->destroy(ftally);
+  delete [] wmap;
+  memory->destroy(dstats);
+  memory->destroy(fstats);
+  memory->destroy(vsample);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -357,6 +401,7 @@ void FixAveGrid::init()
       if (icompute < 0)
 	error->all(FLERR,"Compute ID for fix ave/grid does not exist");
       value2index[m] = icompute;
+      ctimer[m] = compute_region(ids[m]);
       
     } else if (which[m] == FIX) {
       int ifix = modify->find_fix(ids[m]);
@@ -387,26 +432,101 @@ void FixAveGrid::setup()
 
 void FixAveGrid::end_of_step()
 {
-  int i,j,k,m,n,itally;
-  int ntally,kk;
-  int *itmp;
-  double **ctally;
+  int i,m;
 
   // skip if not step which requires doing something
 
   bigint ntimestep = update->ntimestep;
   if (ntimestep != nvalid) return;
 
+  // accumulate results of computes,fixes,variables
+  // tally is in single precision if precision = FLOAT
+
+  if (ftally) accumulate(ftally);
+  else accumulate(tally);
+
+  // done if irepeat < nrepeat
+  // else reset irepeat and nvalid
+
+  nsample++;
+  irepeat++;
+  if (irepeat < nrepeat) {
+    nvalid += nevery;
+    modify->addstep_compute(nvalid);
+    return;
+  }
+
+  irepeat = 0;
+  nvalid = ntimestep+per_grid_freq - (nrepeat-1)*nevery;
+  modify->addstep_compute(nvalid);
+
+  // normalize the accumulators for output on Nfreq timestep
+
+  if (ftally) normalize(ftally);
+  else normalize(tally);
+
+  if (statflag) stats_output();
+  
+  // set values for grid cells not in group to zero
+
+  int ncols = size_per_grid_cols;
+
+  if (groupbit != 1) {
+    Grid::ChildInfo *cinfo = grid->cinfo;
+    if (ncols == 0) {
+      for (i = 0; i < nglocal; i++)
+        if (!(cinfo[i].mask & groupbit)) vector_grid[i] = 0.0;
+    } else {
+      for (i = 0; i < nglocal; i++)
+        if (!(cinfo[i].mask & groupbit))
+          for (m = 0; m < ncols; m++) array_grid[i][m] = 0.0;
+    }
+  }
+
+  // halt run if all values in all cells are converged
+
+  if (convtol > 0.0) convergence();
+
+  // reset nsample if ave = ONE
+
+  if (ave == ONE) nsample = 0;
+}
+
+/* ----------------------------------------------------------------------
+   accumulate one sample of all values into tally array T
+   also update per-sample statistics
+------------------------------------------------------------------------- */
+
+template <class T>
+void FixAveGrid::accumulate(T **t)
+{
+  int i,j,k,m,n,itally;
+  int ntally,kk,stride;
+  int *itmp;
+  double wt;
+  double *sample;
+  double **ctally;
+
   // zero tally if ave = ONE and first sample
   // could do this with memset()
+  // if ave = EMA, decay tally and weight new sample by alpha
+  //   1st sample has weight 1, so tally is always a normalized average
+
+  wt = 1.0;
 
   if (ave == ONE && irepeat == 0) {
     for (i = 0; i < nglocal; i++)
       for (j = 0; j < ntotal; j++)
-        tally[i][j] = 0.0;
+        t[i][j] = 0.0;
+    nstat = 0;
+  } else if (ave == EMA && nsample) {
+    double decay = 1.0 - alpha;
+    for (i = 0; i < nglocal; i++)
+      for (j = 0; j < ntotal; j++)
+        t[i][j] *= decay;
+    wt = alpha;
   }
 
-  // accumulate results of computes,fixes,variables
   // compute/fix/variable may invoke computes so wrap with clear/add
 
   modify->clearstep_compute();
@@ -420,7 +540,9 @@ void FixAveGrid::end_of_step()
     if (which[m] == COMPUTE) {
       Compute *compute = modify->compute[n];
       if (!(compute->invoked_flag & INVOKED_PER_GRID)) {
+        timer->start(ctimer[m]);
         compute->compute_per_grid();
+        timer->stop(ctimer[m]);
         compute->invoked_flag |= INVOKED_PER_GRID;
       }
 
@@ -435,19 +557,19 @@ void FixAveGrid::end_of_step()
           for (itally = 0; itally < ntally; itally++) {
             k = umap[m][itally];
             kk = uomap[m][itally];
-	    tally[i][k] += ctally[i][kk];
+	    t[i][k] += wt*ctally[i][kk];
 	}
       } else {
         k = umap[m][0];
         if (j == 0) {
           double *compute_vector = compute->vector_grid;
 	  for (i = 0; i < nglocal; i++)
-	    tally[i][k] += compute_vector[i];
+	    t[i][k] += wt*compute_vector[i];
         } else {
           int jm1 = j - 1;
           double **compute_array = compute->array_grid;
 	  for (i = 0; i < nglocal; i++)
-	    tally[i][k] += compute_array[i][jm1];
+	    t[i][k] += wt*compute_array[i][jm1];
         }
       }
   
@@ -458,50 +580,71 @@ void FixAveGrid::end_of_step()
       if (j == 0) {
         double *fix_vector = modify->fix[n]->vector_grid;
 	for (i = 0; i < nglocal; i++)
-	  tally[i][k] += fix_vector[i];
+	  t[i][k] += wt*fix_vector[i];
       } else {
         int jm1 = j - 1;
         double **fix_array = modify->fix[n]->array_grid;
 	for (i = 0; i < nglocal; i++)
-	  tally[i][k] += fix_array[i][jm1];
+	  t[i][k] += wt*fix_array[i][jm1];
       }
       
-    // evaluate grid-style variable, sum values to Kth column of tally array
+    // evaluate grid-style variable into vsample
+    // sum values to Kth column of tally array
       
     } else if (which[m] == VARIABLE) {
       k = umap[m][0];
-      input->variable->compute_grid(n,&tally[0][k],ntotal,1);
+      if (nglocal > nvsample) {
+        nvsample = nglocalmax;
+        memory->destroy(vsample);
+        memory->create(vsample,nvsample,"ave/grid:vsample");
+      }
+      input->variable->compute_grid(n,vsample,1,0);
+      for (i = 0; i < nglocal; i++)
+        t[i][k] += wt*vsample[i];
     }
-  }
 
-  // done if irepeat < nrepeat
-  // else reset irepeat and nvalid
+    // update per-sample statistics with this sample of value
 
-  nsample++;
-  irepeat++;
-  if (irepeat < nrepeat) {
-    nvalid += nevery;
-    modify->addstep_compute(nvalid);
-    return;
+    if (statflag) {
+      sample = sample_values(m,stride);
+      if (precision == DOUBLE) welford(dstats,m,sample,stride);
+      else welford(fstats,m,sample,stride);
+    }
   }
 
-  irepeat = 0;
-  nvalid = ntimestep+per_grid_freq - (nrepeat-1)*nevery;
-  modify->addstep_compute(nvalid);
+  if (statflag) nstat++;
+}
 
-  // normalize the accumulators for output on Nfreq timestep
-  // if post_process flag set, compute performs normalization via pp_grid()
-  // else just divide by nsample
+/* ----------------------------------------------------------------------
+   normalize tally array T into output vector or array
+   if post_process flag set, compute performs normalization via pp_grid()
+   else just divide by nsample
+   an EMA tally is already normalized, so norm = 1
+------------------------------------------------------------------------- */
+
+template <class T>
+void FixAveGrid::normalize(T **t)
+{
+  int i,j,k,m,n,norm;
+  int *cols;
+  double **ptally;
+
+  if (ave == EMA) norm = 1;
+  else norm = nsample;
+
+  int ncols = size_per_grid_cols;
 
-  if (nvalues == 1) {
+  if (ncols == 0) {
     if (post_process[0]) {
       n = value2index[0];
       j = argindex[0];
       Compute *c = modify->compute[n];
-      c->post_process_grid(j,-1,nsample,tally,map[0],vector_grid,1);
+      ptally = post_tally(t,0,cols);
+      c->post_process_grid(j,-1,norm,ptally,cols,vector_grid,1);
+      if ((void *) ptally != (void *) t) memory->destroy(ptally);
     } else {
       k = map[0][0];
-      for (i = 0; i < nglocal; i++) vector_grid[i] = tally[i][k] / nsample;
+      for (i = 0; i < nglocal; i++) vector_grid[i] = t[i][k] / norm;
     }
 
   } else {
@@ -510,32 +653,47 @@ void FixAveGrid::end_of_step()
 	n = value2index[m];
 	j = argindex[m];
 	Compute *c = modify->compute[n];
-        c->post_process_grid(j,-1,nsample,tally,map[m],
-                             &array_grid[0][m],nvalues);
+        ptally = post_tally(t,m,cols);
+        c->post_process_grid(j,-1,norm,ptally,cols,
+                             &array_grid[0][m],ncols);
+        if ((void *) ptally != (void *) t) memory->destroy(ptally);
       } else {
         k = map[m][0];
-	for (i = 0; i < nglocal; i++) array_grid[i][m] = tally[i][k] / nsample;
+	for (i = 0; i < nglocal; i++) array_grid[i][m] = t[i][k] / norm;
       }
     }
   }
-  
-  // set values for grid cells not in group to zero
+}
 
-  if (groupbit != 1) {
-    Grid::ChildInfo *cinfo = grid->cinfo;
-    if (nvalues == 1) {
-      for (i = 0; i < nglocal; i++)
-        if (!(cinfo[i].mask & groupbit)) vector_grid[i] = 0.0;
-    } else {
-      for (i = 0; i < nglocal; i++)
-        if (!(cinfo[i].mask & groupbit))
-          for (m = 0; m < nvalues; m++) array_grid[i][m] = 0.0;
-    }
-  }
+/* ----------------------------------------------------------------------
+   return double tally and its columns for post-processing value M
+   a double tally is used as is
+------------------------------------------------------------------------- */
 
-  // reset nsample if ave = ONE
+double **FixAveGrid::post_tally(double **t, int m, int *&cols)
+{
+  cols = map[m];
+  return t;
+}
 
-  if (ave == ONE) nsample = 0;
+/* ----------------------------------------------------------------------
+   single precision tally is widened to a temporary double array
+     holding only the columns of value M, caller must destroy it
+------------------------------------------------------------------------- */
+
+double **FixAveGrid::post_tally(float **t, int m, int *&cols)
+{
+  int ncount = nmap[m];
+  int *mcols = map[m];
+
+  double **wide;
+  memory->create(wide,nglocal,ncount,"ave/grid:wide");
+  for (int i = 0; i < nglocal; i++)
+    for (int k = 0; k < ncount; k++)
+      wide[i][k] = t[i][mcols[k]];
+
+  cols = wmap;
+  return wide;
 }
 
 /* ----------------------------------------------------------------------
@@ -573,13 +731,27 @@ int FixAveGrid::pack_one(int icell, char *buf, int memflag)
   char *ptr = buf;
 
   if (memflag) {
-    if (nvalues == 1) *((double *) ptr) = vector_grid[icell];
-    else memcpy(ptr,array_grid[icell],nvalues*sizeof(double));
+    if (size_per_grid_cols == 0) *((double *) ptr) = vector_grid[icell];
+    else memcpy(ptr,array_grid[icell],size_per_grid_cols*sizeof(double));
   }
-  ptr += nvalues*sizeof(double);
+  ptr += MAX(size_per_grid_cols,1)*sizeof(double);
 
-  if (memflag) memcpy(ptr,tally[icell],ntotal*sizeof(double));
-  ptr += ntotal*sizeof(double);
+  if (ftally) {
+    if (memflag) memcpy(ptr,ftally[icell],ntotal*sizeof(float));
+    ptr += ntotal*sizeof(float);
+  } else {
+    if (memflag) memcpy(ptr,tally[icell],ntotal*sizeof(double));
+    ptr += ntotal*sizeof(double);
+  }
+
+  if (dstats) {
+    if (memflag) memcpy(ptr,dstats[icell],2*nvalues*sizeof(double));
+    ptr += 2*nvalues*sizeof(double);
+  } else if (fstats) {
+    if (memflag) memcpy(ptr,fstats[icell],2*nvalues*sizeof(float));
+    ptr += 2*nvalues*sizeof(float);
+  }
+  ptr = ROUNDUP(ptr);
 
   return ptr-buf;
 }
@@ -597,11 +769,19 @@ void FixAveGrid::add_grid_one(int, int flag)
 
   grow_percell(1);
 
-  if (nvalues == 1) vector_grid[nglocal] = 0.0;
+  if (size_per_grid_cols == 0) vector_grid[nglocal] = 0.0;
   else 
-    for (int i = 0; i < nvalues; i++) array_grid[nglocal][i] = 0.0;
+    for (int i = 0; i < size_per_grid_cols; i++) array_grid[nglocal][i] = 0.0;
+
+  if (ftally)
+    for (int i = 0; i < ntotal; i++) ftally[nglocal][i] = 0.0;
+  else
+    for (int i = 0; i < ntotal; i++) tally[nglocal][i] = 0.0;
 
-  for (int i = 0; i < ntotal; i++) tally[nglocal][i] = 0.0;
+  if (dstats)
+    for (int i = 0; i < 2*nvalues; i++) dstats[nglocal][i] = 0.0;
+  else if (fstats)
+    for (int i = 0; i < 2*nvalues; i++) fstats[nglocal][i] = 0.0;
 
   nglocal++;
 }
@@ -644,12 +824,26 @@ int FixAveGrid::unpack_one(char *buf, int icell)
 {
   char *ptr = buf;
 
-  if (nvalues == 1) vector_grid[icell] = *((double *) ptr);
-  else memcpy(array_grid[icell],ptr,nvalues*sizeof(double));
-  ptr += nvalues*sizeof(double);
+  if (size_per_grid_cols == 0) vector_grid[icell] = *((double *) ptr);
+  else memcpy(array_grid[icell],ptr,size_per_grid_cols*sizeof(double));
+  ptr += MAX(size_per_grid_cols,1)*sizeof(double);
 
-  memcpy(tally[icell],ptr,ntotal*sizeof(double));
-  ptr += ntotal*sizeof(double);
+  if (ftally) {
+    memcpy(ftally[icell],ptr,ntotal*sizeof(float));
+    ptr += ntotal*sizeof(float);
+  } else {
+    memcpy(tally[icell],ptr,ntotal*sizeof(double));
+    ptr += ntotal*sizeof(double);
+  }
+
+  if (dstats) {
+    memcpy(dstats[icell],ptr,2*nvalues*sizeof(double));
+    ptr += 2*nvalues*sizeof(double);
+  } else if (fstats) {
+    memcpy(fstats[icell],ptr,2*nvalues*sizeof(float));
+    ptr += 2*nvalues*sizeof(float);
+  }
+  ptr = ROUNDUP(ptr);
 
   return ptr-buf;
 }
@@ -679,9 +873,16 @@ void FixAveGrid::compress_grid()
     }
 
     if (nglocal != icell)  {
-      if (nvalues == 1) vector_grid[nglocal] = vector_grid[icell];
-      else memcpy(array_grid[nglocal],array_grid[icell],nvalues*sizeof(double));
-      memcpy(tally[nglocal],tally[icell],ntotal*sizeof(double));
+      if (size_per_grid_cols == 0) vector_grid[nglocal] = vector_grid[icell];
+      else memcpy(array_grid[nglocal],array_grid[icell],
+                  size_per_grid_cols*sizeof(double));
+      if (ftally)
+        memcpy(ftally[nglocal],ftally[icell],ntotal*sizeof(float));
+      else memcpy(tally[nglocal],tally[icell],ntotal*sizeof(double));
+      if (dstats)
+        memcpy(dstats[nglocal],dstats[icell],2*nvalues*sizeof(double));
+      else if (fstats)
+        memcpy(fstats[nglocal],fstats[icell],2*nvalues*sizeof(float));
     }
 
     nglocal++;
@@ -695,8 +896,12 @@ void FixAveGrid::compress_grid()
 double FixAveGrid::memory_usage()
 {
   double bytes = 0.0;
-  bytes += nglocalmax*nvalues * sizeof(double);
-  if (ave == RUNNING) bytes += nglocalmax*nvalues * sizeof(double);
+  bytes += nglocalmax*MAX(size_per_grid_cols,1) * sizeof(double);
+  if (ftally) bytes += nglocalmax*ntotal * sizeof(float);
+  else bytes += nglocalmax*ntotal * sizeof(double);
+  if (dstats) bytes += nglocalmax*2*nvalues * sizeof(double);
+  if (fstats) bytes += nglocalmax*2*nvalues * sizeof(float);
+  bytes += nvsample * sizeof(double);
   return bytes;
 }
 
@@ -709,6 +914,12 @@ void FixAveGrid::options(int iarg, int narg, char **arg)
   // option defaults
 
   ave = ONE;
+  alpha = 0.0;
+  statflag = 0;
+  precision = DOUBLE;
+  convtol = 0.0;
+  convabs = 0.0;
+  convmin = 2;
 
   // optional args
 
@@ -717,8 +928,40 @@ void FixAveGrid::options(int iarg, int narg, char **arg)
       if (iarg+2 > narg) error->all(FLERR,"Illegal fix ave/grid command");
       if (strcmp(arg[iarg+1],"one") == 0) ave = ONE;
       else if (strcmp(arg[iarg+1],"running") == 0) ave = RUNNING;
+      else if (strcmp(arg[iarg+1],"ema") == 0) {
+        if (iarg+3 > narg) error->all(FLERR,"Illegal fix ave/grid command");
+        ave = EMA;
+        alpha = atof(arg[iarg+2]);
+        if (alpha <= 0.0 || alpha > 1.0)
+          error->all(FLERR,"Illegal fix ave/grid command");
+        iarg++;
+      } else error->all(FLERR,"Illegal fix ave/grid command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"stats") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix ave/grid command");
+      if (strcmp(arg[iarg+1],"yes") == 0) statflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) statflag = 0;
       else error->all(FLERR,"Illegal fix ave/grid command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"precision") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix ave/grid command");
+      if (strcmp(arg[iarg+1],"double") == 0) precision = DOUBLE;
+      else if (strcmp(arg[iarg+1],"single") == 0) precision = FLOAT;
+      else error->all(FLERR,"Illegal fix ave/grid command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"converge") == 0) {
+      if (iarg+3 > narg) error->all(FLERR,"Illegal fix ave/grid command");
+      convtol = atof(arg[iarg+1]);
+      convmin = atoi(arg[iarg+2]);
+      if (convtol <= 0.0 || convmin < 2)
+        error->all(FLERR,"Illegal fix ave/grid command");
+      statflag = 1;
+      iarg += 3;
+    } else if (strcmp(arg[iarg],"convabs") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix ave/grid command");
+      convabs = atof(arg[iarg+1]);
+      if (convabs < 0.0) error->all(FLERR,"Illegal fix ave/grid command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal fix ave/grid command");
   }
 }
@@ -751,7 +994,139 @@ void FixAveGrid::grow_percell(int nnew)
   nglocalmax += DELTAGRID;
   int n = nglocalmax;
 
-  if (nvalues == 1) memory->grow(vector_grid,n,"ave/grid:vector_grid");
-  else memory->grow(array_grid,n,nvalues,"ave/grid:array_grid");
-  memory->grow(tally,n,ntotal,"ave/grid:tally");
+  if (size_per_grid_cols == 0)
+    memory->grow(vector_grid,n,"ave/grid:vector_grid");
+  else memory->grow(array_grid,n,size_per_grid_cols,"ave/grid:array_grid");
+  if (ftally) memory->grow(ftally,n,ntotal,"ave/grid:ftally");
+  else memory->grow(tally,n,ntotal,"ave/grid:tally");
+  if (dstats) memory->grow(dstats,n,2*nvalues,"ave/grid:dstats");
+  if (fstats) memory->grow(fstats,n,2*nvalues,"ave/grid:fstats");
+}
+
+/* ----------------------------------------------------------------------
+   return per-cell values of value M sampled on this step
+   stride = distance between values of consecutive cells
+   post-processed compute values are normalized for a single sample
+------------------------------------------------------------------------- */
+
+double *FixAveGrid::sample_values(int m, int &stride)
+{
+  stride = 1;
+  if (nglocal == 0) return NULL;
+
+  int n = value2index[m];
+  int j = argindex[m];
+
+  if (which[m] == COMPUTE) {
+    Compute *compute = modify->compute[n];
+    if (post_process[m]) {
+      compute->post_process_grid(j,-1,1,NULL,NULL,NULL,1);
+      return compute->vector_grid;
+    }
+    if (j == 0) return compute->vector_grid;
+    stride = compute->size_per_grid_cols;
+    return &compute->array_grid[0][j-1];
+
+  } else if (which[m] == FIX) {
+    Fix *fix = modify->fix[n];
+    if (j == 0) return fix->vector_grid;
+    stride = fix->size_per_grid_cols;
+    return &fix->array_grid[0][j-1];
+  }
+
+  return vsample;
+}
+
+/* ----------------------------------------------------------------------
+   Welford update of running mean and M2 of value M with one more sample
+   M2 = sum of squared deviations from mean, variance = M2/(nsample-1)
+   1st sample of a window initializes mean and M2
+------------------------------------------------------------------------- */
+
+template <class T>
+void FixAveGrid::welford(T **stats, int m, double *sample, int stride)
+{
+  int n = nstat + 1;
+  int im = 2*m;
+  double value,mean,delta;
+
+  if (n == 1) {
+    for (int i = 0; i < nglocal; i++) {
+      stats[i][im] = sample[i*stride];
+      stats[i][im+1] = 0.0;
+    }
+    return;
+  }
+
+  double ninv = 1.0/n;
+  for (int i = 0; i < nglocal; i++) {
+    value = sample[i*stride];
+    mean = stats[i][im];
+    delta = value - mean;
+    mean += delta*ninv;
+    stats[i][im] = mean;
+    stats[i][im+1] += delta*(value-mean);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   set extra output columns to std error of the mean of each value
+   std error = sqrt(variance/nsample) of per-sample values in the window
+   a 95% confidence interval is the average +/- 1.96 std errors
+------------------------------------------------------------------------- */
+
+void FixAveGrid::stats_output()
+{
+  double norm = 0.0;
+  if (nstat > 1) norm = 1.0 / ((double) nstat*(nstat-1));
+
+  double m2;
+
+  for (int i = 0; i < nglocal; i++)
+    for (int m = 0; m < nvalues; m++) {
+      if (dstats) m2 = dstats[i][2*m+1];
+      else m2 = fstats[i][2*m+1];
+      array_grid[i][nvalues+m] = sqrt(m2*norm);
+    }
+}
+
+/* ----------------------------------------------------------------------
+   request run halt if std error of every value in every cell of group
+     is <= convtol times its mean, after at least convmin samples
+   convabs is an absolute floor on the allowed std error, so a value whose
+     mean is zero, e.g. transverse velocity in a symmetric flow, can converge
+------------------------------------------------------------------------- */
+
+void FixAveGrid::convergence()
+{
+  if (nstat < convmin) return;
+
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  double mean;
+
+  int nflag = 0;
+  for (int i = 0; i < nglocal; i++) {
+    if (!(cinfo[i].mask & groupbit)) continue;
+    for (int m = 0; m < nvalues; m++) {
+      if (dstats) mean = dstats[i][2*m];
+      else mean = fstats[i][2*m];
+      if (array_grid[i][nvalues+m] > MAX(convtol*fabs(mean),convabs))
+        nflag++;
+    }
+  }
+
+  int nflagall;
+  MPI_Allreduce(&nflag,&nflagall,1,MPI_INT,MPI_SUM,world);
+  if (nflagall) return;
+
+  if (comm->me == 0) {
+    if (screen)
+      fprintf(screen,"Fix ave/grid %s converged on step " BIGINT_FORMAT
+              " after %d samples\n",id,update->ntimestep,nstat);
+    if (logfile)
+      fprintf(logfile,"Fix ave/grid %s converged on step " BIGINT_FORMAT
+              " after %d samples\n",id,update->ntimestep,nstat);
+  }
+
+  update->halt = 1;
 }
@@ -52,11 +52,14 @@ class FixAveGrid : public Fix {
   int *which;                // COMPUTE or FIX or VARIABLE
   int *argindex;             // which column from compute or fix to access
   int *value2index;          // index of compute,fix,variable
+  int *ctimer;               // Timer region of each compute within this fix
   int *post_process;         // 1 if need compute->post_process() on value
 
   int ntotal;                // total # of columns in tally array
   double **tally;            // array of tally quantities, cells by ntotal
                              // can be multiple tally quants per value
+  float **ftally;            // tally if precision single, else NULL
+  int *wmap;                 // identity map for ftally widened to double
 
                              // used when normalizing tallies
   int *nmap;                 // # of tally quantities for each value
@@ -73,12 +76,36 @@ class FixAveGrid : public Fix {
   int nglocal;               // # of owned grid cells
   int nglocalmax;            // max size of per-cell vectors/arrays
 
+  double alpha;              // weight of newest sample for ave = EMA
+
+                             // used for per-sample statistics
+  int statflag;              // 1 if per-sample mean/variance is tallied
+  int precision;             // DOUBLE or FLOAT storage of tally and stats
+  int nstat;                 // # of samples in statistics
+  double **dstats;           // Welford mean and M2 for each value, per cell
+  float **fstats;            //   in double or single precision
+  double convtol;            // rel error to halt run at, 0.0 if not used
+  double convabs;            // abs error always accepted, for zero means
+  int convmin;               // min # of samples before convergence check
+
+  int nvsample;              // length of vsample
+  double *vsample;           // per-cell sample of a variable
+
   int pack_one(int, char *, int);
   int unpack_one(char *, int);
   void options(int, int, char **);
   void grow();
   bigint nextvalid();
   virtual void grow_percell(int);
+
+  template <class T> void accumulate(T **);
+  template <class T> void normalize(T **);
+  double **post_tally(double **, int, int *&);
+  double **post_tally(float **, int, int *&);
+  double *sample_values(int, int &);
+  template <class T> void welford(T **, int, double *, int);
+  void stats_output();
+  void convergence();
 };
 
 }
@@ -139,6 +166,11 @@ E: Fix for fix ave/grid not computed at compatible time
 Fixes generate values on specific timesteps.  Fix ave/grid is
 requesting a value on a non-allowed timestep.
 
+E: Fix ave/grid stats cannot be used with ave ema
+
+Per-sample statistics are tallied over the samples of an averaging
+window, which an exponential moving average does not have.
+
 E: Variable name for fix ave/grid does not exist
 
 Self-explanatory.
@@ -26,6 +26,7 @@
 #include "compute.h"
 #include "input.h"
 #include "variable.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -35,7 +36,6 @@ enum{X,V,F,COMPUTE,FIX,VARIABLE};
 enum{ONE,RUNNING};
 enum{SCALAR,VECTOR,WINDOW};
 enum{GLOBAL,PERPARTICLE,PERGRID};
-enum{IGNORE,END,EXTRA};
 
 #define INVOKED_SCALAR 1
 #define INVOKED_VECTOR 2
@@ -54,6 +54,9 @@ FixAveHisto::FixAveHisto(SPARTA *spa, int narg, char **arg) :
 
   MPI_Comm_rank(world,&me);
   weightflag = 0;
+  weight = 1.0;
+  weights = NULL;
+  stridewt = 0;
 
   nevery = input->inumeric(FLERR,arg[2]);
   nrepeat = input->inumeric(FLERR,arg[3]);
@@ -110,6 +113,7 @@ FixAveHisto::FixAveHisto(SPARTA *spa, int narg, char **arg) :
   which = new int[nvalues];
   argindex = new int[nvalues];
   value2index = new int[nvalues];
+  ctimer = new int[nvalues];
   ids = new char*[nvalues];
 
   for (int i = 0; i < nvalues; i++) {
@@ -189,14 +193,14 @@ FixAveHisto::FixAveHisto(SPARTA *spa, int narg, char **arg) :
   for (int i = 0; i < nvalues; i++) {
     if (which[i] == X || which[i] == V) kindflag = PERPARTICLE;
     else if (which[i] == COMPUTE) {
-      Compute *compute = modify->compute[modify->find_compute(ids[0])];
+      Compute *compute = modify->compute[modify->find_compute(ids[i])];
       if (compute->scalar_flag || compute->vector_flag || compute->array_flag)
         kindflag = GLOBAL;
       else if (compute->per_particle_flag) kindflag = PERPARTICLE;
       else if (compute->per_grid_flag) kindflag = PERGRID;
       else error->all(FLERR,"Fix ave/histo input is invalid compute");
     } else if (which[i] == FIX) {
-      Fix *fix = modify->fix[modify->find_fix(ids[0])];
+      Fix *fix = modify->fix[modify->find_fix(ids[i])];
       if (fix->scalar_flag || fix->vector_flag || fix->array_flag)
         kindflag = GLOBAL;
       else if (fix->per_particle_flag) kindflag = PERPARTICLE;
@@ -436,6 +440,12 @@ FixAveHisto::FixAveHisto(SPARTA *spa, int narg, char **arg) :
   vector = NULL;
   maxvector = 0;
 
+  ninput = 0;
+  inwhich = new int[nvalues];
+  inindex = new int[nvalues];
+  invalues = new double*[nvalues];
+  instride = new int[nvalues];
+
   if (ave == WINDOW) {
     memory->create(stats_list,nwindow,4,"ave/histo:stats_list");
     memory->create(bin_list,nwindow,nbins,"ave/histo:bin_list");
@@ -484,6 +494,7 @@ FixAveHisto::~FixAveHisto()
   delete [] which;
   delete [] argindex;
   delete [] value2index;
+  delete [] ctimer;
   for (int i = 0; i < nvalues; i++) delete [] ids[i];
   delete [] ids;
 
@@ -496,6 +507,10 @@ FixAveHisto::~FixAveHisto()
   memory->destroy(stats_list);
   memory->destroy(bin_list);
   memory->destroy(vector);
+  delete [] inwhich;
+  delete [] inindex;
+  delete [] invalues;
+  delete [] instride;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -519,6 +534,7 @@ void FixAveHisto::init()
       if (icompute < 0)
         error->all(FLERR,"Compute ID for fix ave/histo does not exist");
       value2index[i] = icompute;
+      ctimer[i] = compute_region(ids[i]);
 
     } else if (which[i] == FIX) {
       int ifix = modify->find_fix(ids[i]);
@@ -598,13 +614,17 @@ void FixAveHisto::end_of_step()
       if (kind == GLOBAL && mode == SCALAR) {
         if (j == 0) {
           if (!(compute->invoked_flag & INVOKED_SCALAR)) {
+            timer->start(ctimer[i]);
             compute->compute_scalar();
+            timer->stop(ctimer[i]);
             compute->invoked_flag |= INVOKED_SCALAR;
           }
           bin_one(compute->scalar);
         } else {
           if (!(compute->invoked_flag & INVOKED_VECTOR)) {
+            timer->start(ctimer[i]);
             compute->compute_vector();
+            timer->stop(ctimer[i]);
             compute->invoked_flag |= INVOKED_VECTOR;
           }
           bin_one(compute->vector[j-1]);
@@ -612,13 +632,17 @@ void FixAveHisto::end_of_step()
       } else if (kind == GLOBAL && mode == VECTOR) {
         if (j == 0) {
           if (!(compute->invoked_flag & INVOKED_VECTOR)) {
+            timer->start(ctimer[i]);
             compute->compute_vector();
+            timer->stop(ctimer[i]);
             compute->invoked_flag |= INVOKED_VECTOR;
           }
           bin_vector(compute->size_vector,compute->vector,1);
         } else {
           if (!(compute->invoked_flag & INVOKED_ARRAY)) {
+            timer->start(ctimer[i]);
             compute->compute_array();
+            timer->stop(ctimer[i]);
             compute->invoked_flag |= INVOKED_ARRAY;
           }
           if (compute->array)
@@ -628,27 +652,31 @@ void FixAveHisto::end_of_step()
 
       } else if (kind == PERPARTICLE) {
         if (!(compute->invoked_flag & INVOKED_PER_PARTICLE)) {
+          timer->start(ctimer[i]);
           compute->compute_per_particle();
+          timer->stop(ctimer[i]);
           compute->invoked_flag |= INVOKED_PER_PARTICLE;
         }
         if (j == 0)
-          bin_particles(compute->vector_particle,1);
+          add_input(COMPUTE,0,compute->vector_particle,1);
         else if (compute->array_particle)
-          bin_particles(&compute->array_particle[0][j-1],
-                        compute->size_per_particle_cols);
+          add_input(COMPUTE,0,&compute->array_particle[0][j-1],
+                    compute->size_per_particle_cols);
 
       } else if (kind == PERGRID) {
         if (!(compute->invoked_flag & INVOKED_PER_GRID)) {
+          timer->start(ctimer[i]);
           compute->compute_per_grid();
+          timer->stop(ctimer[i]);
           compute->invoked_flag |= INVOKED_PER_GRID;
           if (compute->post_process_grid_flag) 
             compute->post_process_grid(j,-1,1,NULL,NULL,NULL,1);
         }
         if (j == 0 || compute->post_process_grid_flag)
-          bin_grid_cells(compute->vector_grid,1);
+          add_input(COMPUTE,0,compute->vector_grid,1);
         else if (compute->array_grid)
-          bin_grid_cells(&compute->array_grid[0][j-1],
-                         compute->size_per_grid_cols);
+          add_input(COMPUTE,0,&compute->array_grid[0][j-1],
+                    compute->size_per_grid_cols);
       }
 
     // access fix fields, guaranteed to be ready
@@ -671,14 +699,15 @@ void FixAveHisto::end_of_step()
         }
 
       } else if (kind == PERPARTICLE) {
-        if (j == 0) bin_particles(fix->vector_particle,1);
+        if (j == 0) add_input(FIX,0,fix->vector_particle,1);
         else if (fix->array_particle)
-          bin_particles(&fix->array_particle[0][j-1],fix->size_per_particle_cols);
+          add_input(FIX,0,&fix->array_particle[0][j-1],
+                    fix->size_per_particle_cols);
 
       } else if (kind == PERGRID) {
-        if (j == 0) bin_grid_cells(fix->vector_grid,1);
+        if (j == 0) add_input(FIX,0,fix->vector_grid,1);
         else if (fix->array_grid)
-          bin_grid_cells(&fix->array_grid[0][j-1],fix->size_per_grid_cols);
+          add_input(FIX,0,&fix->array_grid[0][j-1],fix->size_per_grid_cols);
       }
 
     // evaluate equal-style or particle-style or grid-style variable
@@ -688,29 +717,34 @@ void FixAveHisto::end_of_step()
         bin_one(input->variable->compute_equal(m));
 
       } else if (which[i] == VARIABLE && kind == PERPARTICLE) {
-        if (particle->maxlocal > maxvector) {
+        if (vector == NULL || particle->maxlocal > maxvector) {
           memory->destroy(vector);
-          maxvector = particle->maxlocal;
-          memory->create(vector,maxvector,"ave/histo:vector");
+          maxvector = MAX(particle->maxlocal,1);
+          memory->create(vector,nvalues,maxvector,"ave/histo:vector");
         }
-        input->variable->compute_particle(m,vector,1,0);
-        bin_particles(vector,1);
+        input->variable->compute_particle(m,vector[i],1,0);
+        add_input(VARIABLE,0,vector[i],1);
 
       } else if (which[i] == VARIABLE && kind == PERGRID) {
-        if (grid->maxlocal > maxvector) {
+        if (vector == NULL || grid->maxlocal > maxvector) {
           memory->destroy(vector);
-          maxvector = grid->maxlocal;
-          memory->create(vector,maxvector,"ave/histo:vector");
+          maxvector = MAX(grid->maxlocal,1);
+          memory->create(vector,nvalues,maxvector,"ave/histo:vector");
         }
-        input->variable->compute_grid(m,vector,1,0);
-        bin_grid_cells(vector,1);
+        input->variable->compute_grid(m,vector[i],1,0);
+        add_input(VARIABLE,0,vector[i],1);
       }
 
     // explicit per-particle attributes
 
-    } else bin_particles(which[i],j);
+    } else add_input(which[i],j,NULL,0);
   }
 
+  // bin all per-particle or per-grid inputs in one pass
+
+  if (kind == PERPARTICLE) bin_particles();
+  else if (kind == PERGRID) bin_grid_cells();
+
   // done if irepeat < nrepeat
   // else reset irepeat and nvalid
 
@@ -840,165 +874,107 @@ double FixAveHisto::compute_array(int i, int j)
 
 /* ----------------------------------------------------------------------
    bin a single value
+   weight = 1.0 for ave/histo, set by calculate_weights() for ave/histo/weight
 ------------------------------------------------------------------------- */
 
 void FixAveHisto::bin_one(double value)
 {
-  stats[2] = MIN(stats[2],value);
-  stats[3] = MAX(stats[3],value);
-
-  if (value < lo) {
-    if (beyond == IGNORE) {
-      stats[1] += 1.0;
-      return;
-    } else bin[0] += 1.0;
-  } else if (value > hi) {
-    if (beyond == IGNORE) {
-      stats[1] += 1.0;
-      return;
-    } else bin[nbins-1] += 1.0;
-  } else {
-    int ibin = static_cast<int> ((value-lo)*bininv);
-    ibin = MIN(ibin,nbins-1);
-    if (beyond == EXTRA) ibin++;
-    bin[ibin] += 1.0;
-  }
-
-  stats[0] += 1.0;
+  bin_add(value,weight);
 }
 
 /* ----------------------------------------------------------------------
    bin a vector of values with stride
+   weights, if set, have stridewt
 ------------------------------------------------------------------------- */
 
 void FixAveHisto::bin_vector(int n, double *values, int stride)
 {
   int m = 0;
+  int mwt = 0;
   for (int i = 0; i < n; i++) {
-    bin_one(values[m]);
+    if (weights) bin_add(values[m],weights[mwt]);
+    else bin_add(values[m],weight);
     m += stride;
+    mwt += stridewt;
   }
 }
 
 /* ----------------------------------------------------------------------
-   bin a per-particle attribute
-   index is 0,1,2 if attribute is X or V
+   add a per-particle or per-grid input to bin in next pass
+   flag = X or V for a particle attribute with index = 0,1,2
+   else values with stride
 ------------------------------------------------------------------------- */
 
-void FixAveHisto::bin_particles(int attribute, int index)
+void FixAveHisto::add_input(int flag, int index, double *values, int stride)
 {
-  Particle::OnePart *particles = particle->particles;
-  int nlocal = particle->nlocal;
-
-  Region *region;
-  if (regionflag) region = domain->regions[iregion];
-
-  if (attribute == X) {
-    if (regionflag && mixflag) {
-      int *s2g = particle->mixture[imix]->species2group;
-      for (int i = 0; i < nlocal; i++) {
-        if (region->match(particles[i].x) &&
-            s2g[particles[i].ispecies] >= 0) bin_one(particles[i].x[index]);
-      }
-    } else if (regionflag) {
-      for (int i = 0; i < nlocal; i++) {
-        if (region->match(particles[i].x)) bin_one(particles[i].x[index]);
-      }
-    } else if (mixflag) {
-      int *s2g = particle->mixture[imix]->species2group;
-      for (int i = 0; i < nlocal; i++) {
-        if (s2g[particles[i].ispecies] >= 0) bin_one(particles[i].x[index]);
-      }
-    } else {
-      for (int i = 0; i < nlocal; i++)
-        bin_one(particles[i].x[index]);
-    }
-
-  } else if (attribute == V) {
-    if (regionflag && mixflag) {
-      int *s2g = particle->mixture[imix]->species2group;
-      for (int i = 0; i < nlocal; i++) {
-        if (region->match(particles[i].x) &&
-            s2g[particles[i].ispecies] < 0) bin_one(particles[i].v[index]);
-      }
-    } else if (regionflag) {
-      for (int i = 0; i < nlocal; i++) {
-        if (region->match(particles[i].x)) bin_one(particles[i].v[index]);
-      }
-    } else if (mixflag) {
-      int *s2g = particle->mixture[imix]->species2group;
-      for (int i = 0; i < nlocal; i++) {
-        if (s2g[particles[i].ispecies] >= 0) bin_one(particles[i].v[index]);
-      }
-    } else {
-      for (int i = 0; i < nlocal; i++)
-        bin_one(particles[i].v[index]);
-    }
-  }
+  inwhich[ninput] = flag;
+  inindex[ninput] = index;
+  invalues[ninput] = values;
+  instride[ninput] = stride;
+  ninput++;
 }
 
 /* ----------------------------------------------------------------------
-   bin a per-particle vector of values with stride
+   bin all per-particle inputs in one pass over particles
+   only particles in region and mixture are binned, if specified,
+     tested once per particle for all inputs
+   weights, if set, have stridewt
 ------------------------------------------------------------------------- */
 
-void FixAveHisto::bin_particles(double *values, int stride)
+void FixAveHisto::bin_particles()
 {
   Particle::OnePart *particles = particle->particles;
   int nlocal = particle->nlocal;
 
-  Region *region;
+  Region *region = NULL;
   if (regionflag) region = domain->regions[iregion];
-
-  int m = 0;
-
-  if (regionflag && mixflag) {
-    int *s2g = particle->mixture[imix]->species2group;
-    for (int i = 0; i < nlocal; i++) {
-      if (region->match(particles[i].x) && 
-          s2g[particles[i].ispecies] >= 0) bin_one(values[m]);
-      m += stride;
-    }
-  } else if (regionflag) {
-    for (int i = 0; i < nlocal; i++) {
-      if (region->match(particles[i].x)) bin_one(values[m]);
-      m += stride;
-    }
-  } else if (mixflag) {
-    int *s2g = particle->mixture[imix]->species2group;
-    for (int i = 0; i < nlocal; i++) {
-      if (s2g[particles[i].ispecies] < 0) bin_one(values[m]);
-      m += stride;
-    }
-  } else {
-    for (int i = 0; i < nlocal; i++) {
-      bin_one(values[m]);
-      m += stride;
+  int *s2g = NULL;
+  if (mixflag) s2g = particle->mixture[imix]->species2group;
+
+  int i,m;
+  double value,wt;
+
+  for (i = 0; i < nlocal; i++) {
+    if (regionflag && !region->match(particles[i].x)) continue;
+    if (mixflag && s2g[particles[i].ispecies] < 0) continue;
+    if (weights) wt = weights[i*stridewt];
+    else wt = weight;
+
+    for (m = 0; m < ninput; m++) {
+      if (inwhich[m] == X) value = particles[i].x[inindex[m]];
+      else if (inwhich[m] == V) value = particles[i].v[inindex[m]];
+      else value = invalues[m][i*instride[m]];
+      bin_add(value,wt);
     }
   }
+
+  ninput = 0;
 }
 
 /* ----------------------------------------------------------------------
-   bin a per-grid vector of values with stride
+   bin all per-grid inputs in one pass over grid cells
+   only grid cells in group are binned, if specified
+   weights, if set, have stridewt
 ------------------------------------------------------------------------- */
 
-void FixAveHisto::bin_grid_cells(double *values, int stride)
+void FixAveHisto::bin_grid_cells()
 {
   Grid::ChildInfo *cinfo = grid->cinfo;
   int nglocal = grid->nlocal;
 
-  int m = 0;
+  int i,m;
+  double wt;
 
-  if (groupflag) {
-    for (int i = 0; i < nglocal; i++) {
-      if (cinfo[i].mask & groupbit) bin_one(values[m]);
-      m += stride;
-    }
-  } else {
-    for (int i = 0; i < nglocal; i++) {
-      bin_one(values[m]);
-      m += stride;
-    }
+  for (i = 0; i < nglocal; i++) {
+    if (groupflag && !(cinfo[i].mask & groupbit)) continue;
+    if (weights) wt = weights[i*stridewt];
+    else wt = weight;
+
+    for (m = 0; m < ninput; m++)
+      bin_add(invalues[m][i*instride[m]],wt);
   }
+
+  ninput = 0;
 }
 
 /* ----------------------------------------------------------------------
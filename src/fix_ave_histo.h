@@ -38,10 +38,13 @@ class FixAveHisto : public Fix {
   double compute_array(int,int);
 
  protected:
+  enum{IGNORE,END,EXTRA};     // beyond settings
+
   int me,nvalues;
   int nrepeat,nfreq,irepeat;
   bigint nvalid;
   int *which,*argindex,*value2index;
+  int *ctimer;                // Timer region of each compute within this fix
   char **ids;
   FILE *fp;
   double lo,hi,binsize,bininv;
@@ -58,9 +61,17 @@ class FixAveHisto : public Fix {
   double **bin_list;
   double *coord;
 
-  double *vector;
+  double **vector;
   int maxvector;
 
+  // per-particle or per-grid inputs binned together in one pass
+
+  int ninput;                // # of inputs
+  int *inwhich;              // X or V attribute, else values
+  int *inindex;              // 0,1,2 for X or V attribute
+  double **invalues;         // values of other inputs
+  int *instride;             // stride of values
+
   int ave,nwindow,startstep,mode;
   char *title1,*title2,*title3;
   int iwindow,window_limit;
@@ -70,16 +81,45 @@ class FixAveHisto : public Fix {
   int weightflag;
   double weight;
   double *weights;
+  int stridewt;
   double *vectorwt;
   int maxvectorwt;
 
   // methods
 
-  virtual void bin_one(double);
-  virtual void bin_vector(int, double *, int);
-  virtual void bin_particles(int, int);
-  virtual void bin_particles(double *, int);
-  virtual void bin_grid_cells(double *, int);
+  void bin_one(double);
+  void bin_vector(int, double *, int);
+  void add_input(int, int, double *, int);
+  void bin_particles();
+  void bin_grid_cells();
+
+  // bin a single value with weight
+  // inlined since called once per particle or grid cell for each input
+
+  inline void bin_add(double value, double wt)
+  {
+    stats[2] = MIN(stats[2],value);
+    stats[3] = MAX(stats[3],value);
+
+    if (value < lo) {
+      if (beyond == IGNORE) {
+        stats[1] += wt;
+        return;
+      } else bin[0] += wt;
+    } else if (value > hi) {
+      if (beyond == IGNORE) {
+        stats[1] += wt;
+        return;
+      } else bin[nbins-1] += wt;
+    } else {
+      int ibin = static_cast<int> ((value-lo)*bininv);
+      ibin = MIN(ibin,nbins-1);
+      if (beyond == EXTRA) ibin++;
+      bin[ibin] += wt;
+    }
+
+    stats[0] += wt;
+  }
 
   virtual void calculate_weights() {}
 
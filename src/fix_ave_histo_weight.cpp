@@ -25,6 +25,7 @@
 #include "compute.h"
 #include "input.h"
 #include "variable.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -33,7 +34,6 @@ using namespace SPARTA_NS;
 enum{X,V,F,COMPUTE,FIX,VARIABLE};
 enum{SCALAR,VECTOR,WINDOW};
 enum{GLOBAL,PERPARTICLE,PERGRID};
-enum{IGNORE,END,EXTRA};
 
 #define INVOKED_SCALAR 1
 #define INVOKED_VECTOR 2
@@ -124,13 +124,17 @@ void FixAveHistoWeight::calculate_weights()
     if (kind == GLOBAL && mode == SCALAR) {
       if (j == 0) {
         if (!(compute->invoked_flag & INVOKED_SCALAR)) {
+          timer->start(ctimer[i]);
           compute->compute_scalar();
+          timer->stop(ctimer[i]);
           compute->invoked_flag |= INVOKED_SCALAR;
         }
         weight = compute->scalar;
       } else {
         if (!(compute->invoked_flag & INVOKED_VECTOR)) {
+          timer->start(ctimer[i]);
           compute->compute_vector();
+          timer->stop(ctimer[i]);
           compute->invoked_flag |= INVOKED_VECTOR;
         }
         weight = compute->vector[j-1];
@@ -139,14 +143,18 @@ void FixAveHistoWeight::calculate_weights()
     } else if (kind == GLOBAL && mode == VECTOR) {
       if (j == 0) {
         if (!(compute->invoked_flag & INVOKED_VECTOR)) {
+          timer->start(ctimer[i]);
           compute->compute_vector();
+          timer->stop(ctimer[i]);
           compute->invoked_flag |= INVOKED_VECTOR;
         }
         weights = compute->vector;
         stridewt = 1;
       } else {
         if (!(compute->invoked_flag & INVOKED_ARRAY)) {
+          timer->start(ctimer[i]);
           compute->compute_array();
+          timer->stop(ctimer[i]);
           compute->invoked_flag |= INVOKED_ARRAY;
         }
         if (compute->array) weights = &compute->array[0][j-1];
@@ -155,7 +163,9 @@ void FixAveHistoWeight::calculate_weights()
 
     } else if (kind == PERPARTICLE) {
       if (!(compute->invoked_flag & INVOKED_PER_PARTICLE)) {
+        timer->start(ctimer[i]);
         compute->compute_per_particle();
+        timer->stop(ctimer[i]);
         compute->invoked_flag |= INVOKED_PER_PARTICLE;
       }
       if (j == 0) {
@@ -168,7 +178,9 @@ void FixAveHistoWeight::calculate_weights()
 
     } else if (kind == PERGRID) {
       if (!(compute->invoked_flag & INVOKED_PER_GRID)) {
+        timer->start(ctimer[i]);
         compute->compute_per_grid();
+        timer->stop(ctimer[i]);
         compute->invoked_flag |= INVOKED_PER_GRID;
       }
       if (j == 0) {
@@ -254,206 +266,3 @@ void FixAveHistoWeight::calculate_weights()
     error->all(FLERR,"Fix ave/histo/weight option not yet supported");
   }
 }
-
-/* ----------------------------------------------------------------------
-   bin a single value with weight
-------------------------------------------------------------------------- */
-
-void FixAveHistoWeight::bin_one_weight(double value, double wt)
-{
-  stats[2] = MIN(stats[2],value);
-  stats[3] = MAX(stats[3],value);
-
-  if (value < lo) {
-    if (beyond == IGNORE) {
-      stats[1] += wt;
-      return;
-    } else bin[0] += wt;
-  } else if (value > hi) {
-    if (beyond == IGNORE) {
-      stats[1] += wt;
-      return;
-    } else bin[nbins-1] += wt;
-  } else {
-    int ibin = static_cast<int> ((value-lo)*bininv);
-    ibin = MIN(ibin,nbins-1);
-    if (beyond == EXTRA) ibin++;
-    bin[ibin] += wt;
-  }
-
-  stats[0] += wt;
-}
-
-/* ----------------------------------------------------------------------
-   bin a single value with weight
-------------------------------------------------------------------------- */
-
-void FixAveHistoWeight::bin_one(double value)
-{
-  bin_one_weight(value,weight);
-}
-
-/* ----------------------------------------------------------------------
-   bin a vector of values with weights
-   values and weights each have a stride
-------------------------------------------------------------------------- */
-
-void FixAveHistoWeight::bin_vector(int n, double *values, int stride)
-{
-  int m = 0;
-  int mwt = 0;
-  for (int i = 0; i < n; i++) {
-    bin_one_weight(values[m],weights[mwt]);
-    m += stride;
-    mwt += stridewt;
-  }
-}
-
-/* ----------------------------------------------------------------------
-   bin a per-particle attribute with weights
-   index is 0,1,2 if attribute is X or V
-   weights have a stridewt
-------------------------------------------------------------------------- */
-
-void FixAveHistoWeight::bin_particles(int attribute, int index)
-{
-  Particle::OnePart *particles = particle->particles;
-  int *s2g = particle->mixture[imix]->species2group;
-  int nlocal = particle->nlocal;
-
-  Region *region;
-  if (regionflag) region = domain->regions[iregion];
-
-  int mwt = 0;
-
-  if (attribute == X) {
-    if (regionflag && mixflag) {
-      for (int i = 0; i < nlocal; i++) {
-        if (region->match(particles[i].x) &&
-            s2g[particles[i].ispecies] < 0)
-          bin_one_weight(particles[i].x[index],weights[mwt]);
-        mwt += stridewt;
-      }
-    } else if (regionflag) {
-      for (int i = 0; i < nlocal; i++) {
-        if (region->match(particles[i].x)) 
-          bin_one_weight(particles[i].x[index],weights[mwt]);
-        mwt += stridewt;
-      }
-    } else if (mixflag) {
-      for (int i = 0; i < nlocal; i++) {
-        if (s2g[particles[i].ispecies] >= 0) 
-          bin_one_weight(particles[i].x[index],weights[mwt]);
-        mwt += stridewt;
-      }
-    } else {
-      for (int i = 0; i < nlocal; i++) {
-        bin_one_weight(particles[i].x[index],weights[mwt]);
-        mwt += stridewt;
-      }
-    }
-
-  } else if (attribute == V) {
-    if (regionflag && mixflag) {
-      for (int i = 0; i < nlocal; i++) {
-        if (region->match(particles[i].x) &&
-            s2g[particles[i].ispecies] < 0)
-          bin_one_weight(particles[i].v[index],weights[mwt]);
-        mwt += stridewt;
-      }
-    } else if (regionflag) {
-      for (int i = 0; i < nlocal; i++) {
-        if (region->match(particles[i].x)) 
-          bin_one_weight(particles[i].v[index],weights[mwt]);
-        mwt += stridewt;
-      }
-    } else if (mixflag) {
-      for (int i = 0; i < nlocal; i++) {
-        if (s2g[particles[i].ispecies] >= 0) 
-          bin_one_weight(particles[i].v[index],weights[mwt]);
-        mwt += stridewt;
-      }
-    } else {
-      for (int i = 0; i < nlocal; i++) {
-        bin_one_weight(particles[i].v[index],weights[mwt]);
-        mwt += stridewt;
-      }
-    }
-  }
-}
-
-/* ----------------------------------------------------------------------
-   bin a per-particle vector of values with weights
-   values and weights each have a stride
-------------------------------------------------------------------------- */
-
-void FixAveHistoWeight::bin_particles(double *values, int stride)
-{
-  Particle::OnePart *particles = particle->particles;
-  int *s2g = particle->mixture[imix]->species2group;
-  int nlocal = particle->nlocal;
-
-  Region *region;
-  if (regionflag) region = domain->regions[iregion];
-
-  int m = 0;
-  int mwt = 0;
-
-  if (regionflag && mixflag) {
-    for (int i = 0; i < nlocal; i++) {
-      if (region->match(particles[i].x) && 
-          s2g[particles[i].ispecies] >= 0) 
-        bin_one_weight(values[m],weights[mwt]);
-      m += stride;
-      mwt += stridewt;
-    }
-  } else if (regionflag) {
-    for (int i = 0; i < nlocal; i++) {
-      if (region->match(particles[i].x)) 
-        bin_one_weight(values[m],weights[mwt]);
-      m += stride;
-      mwt += stridewt;
-    }
-  } else if (mixflag) {
-    for (int i = 0; i < nlocal; i++) {
-      if (s2g[particles[i].ispecies] < 0)
-        bin_one_weight(values[m],weights[mwt]);
-      m += stride;
-      mwt += stridewt;
-    }
-  } else {
-    for (int i = 0; i < nlocal; i++) {
-      bin_one_weight(values[m],weights[mwt]);
-      m += stride;
-      mwt += stridewt;
-    }
-  }
-}
-
-/* ----------------------------------------------------------------------
-   bin a per-grid vector of values with weights
-------------------------------------------------------------------------- */
-
-void FixAveHistoWeight::bin_grid_cells(double *values, int stride)
-{
-  Grid::ChildInfo *cinfo = grid->cinfo;
-  int nglocal = grid->nlocal;
-
-  int m = 0;
-  int mwt = 0;
-
-  if (groupflag) {
-    for (int i = 0; i < nglocal; i++) {
-      if (cinfo[i].mask & groupbit) 
-        bin_one_weight(values[m],weights[mwt]);
-      m += stride;
-      mwt += stridewt;
-    }
-  } else {
-    for (int i = 0; i < nglocal; i++) {
-      bin_one_weight(values[m],weights[mwt]);
-      m += stride;
-      mwt += stridewt;
-    }
-  }
-}
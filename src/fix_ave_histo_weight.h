@@ -32,20 +32,6 @@ class FixAveHistoWeight : public FixAveHisto {
   ~FixAveHistoWeight();
 
  private:
-  int stridewt;
-
-  // local method
-
-  void bin_one_weight(double, double);
-
-  // override these methods from ave/histo to use weights
-
-  void bin_one(double);
-  void bin_vector(int, double *, int);
-  void bin_particles(int, int);
-  void bin_particles(double *, int);
-  void bin_grid_cells(double *, int);
-
   void calculate_weights();
 };
 
@@ -25,6 +25,7 @@
 #include "compute.h"
 #include "input.h"
 #include "variable.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -86,6 +87,7 @@ FixAveSurf::FixAveSurf(SPARTA *sparta, int narg, char **arg) :
   which = new int[nvalues];
   argindex = new int[nvalues];
   value2index = new int[nvalues];
+  ctimer = new int[nvalues];
   ids = new char*[nvalues];
 
   for (int i = 0; i < nvalues; i++) {
@@ -270,6 +272,7 @@ FixAveSurf::~FixAveSurf()
   delete [] which;
   delete [] argindex;
   delete [] value2index;
+  delete [] ctimer;
   for (int i = 0; i < nvalues; i++) delete [] ids[i];
   delete [] ids;
 
@@ -314,6 +317,7 @@ void FixAveSurf::init()
       if (icompute < 0)
 	error->all(FLERR,"Compute ID for fix ave/surf does not exist");
       value2index[m] = icompute;
+      ctimer[m] = compute_region(ids[m]);
       
     } else if (which[m] == FIX) {
       int ifix = modify->find_fix(ids[m]);
@@ -386,7 +390,9 @@ void FixAveSurf::end_of_step()
     if (which[m] == COMPUTE) {
       Compute *compute = modify->compute[n];
       if (!(compute->invoked_flag & INVOKED_PER_SURF)) {
+        timer->start(ctimer[m]);
         compute->compute_per_surf();
+        timer->stop(ctimer[m]);
         compute->invoked_flag |= INVOKED_PER_SURF;
       }
       int *loc2glob_compute;
@@ -41,6 +41,7 @@ class FixAveSurf : public Fix {
   int nrepeat,irepeat,nsample,ave;
   bigint nvalid;
   int *which,*argindex,*value2index;
+  int *ctimer;                // Timer region of each compute within this fix
   char **ids;
 
   int nsurf;               // # of global surfs, lines or triangles
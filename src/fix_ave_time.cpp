@@ -21,6 +21,7 @@
 #include "compute.h"
 #include "input.h"
 #include "variable.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -85,6 +86,7 @@ FixAveTime::FixAveTime(SPARTA *sparta, int narg, char **arg) :
   which = new int[nvalues];
   argindex = new int[nvalues];
   value2index = new int[nvalues];
+  ctimer = new int[nvalues];
   offcol = new int[nvalues];
   ids = new char*[nvalues];
 
@@ -319,6 +321,7 @@ FixAveTime::~FixAveTime()
   memory->destroy(which);
   memory->destroy(argindex);
   memory->destroy(value2index);
+  delete [] ctimer;
   memory->destroy(offcol);
   for (int i = 0; i < nvalues; i++) delete [] ids[i];
   memory->sfree(ids);
@@ -354,6 +357,7 @@ void FixAveTime::init()
       if (icompute < 0)
 	error->all(FLERR,"Compute ID for fix ave/time does not exist");
       value2index[i] = icompute;
+      ctimer[i] = compute_region(ids[i]);
 
     } else if (which[i] == FIX) {
       int ifix = modify->find_fix(ids[i]);
@@ -419,13 +423,17 @@ void FixAveTime::invoke_scalar(bigint ntimestep)
       
       if (argindex[i] == 0) {
 	if (!(compute->invoked_flag & INVOKED_SCALAR)) {
+	  timer->start(ctimer[i]);
 	  compute->compute_scalar();
+	  timer->stop(ctimer[i]);
 	  compute->invoked_flag |= INVOKED_SCALAR;
 	}
 	scalar = compute->scalar;
       } else {
 	if (!(compute->invoked_flag & INVOKED_VECTOR)) {
+	  timer->start(ctimer[i]);
 	  compute->compute_vector();
+	  timer->stop(ctimer[i]);
 	  compute->invoked_flag |= INVOKED_VECTOR;
 	}
 	scalar = compute->vector[argindex[i]-1];
@@ -541,7 +549,9 @@ void FixAveTime::invoke_vector(bigint ntimestep)
       
       if (argindex[j] == 0) {
 	if (!(compute->invoked_flag & INVOKED_VECTOR)) {
+	  timer->start(ctimer[j]);
 	  compute->compute_vector();
+	  timer->stop(ctimer[j]);
 	  compute->invoked_flag |= INVOKED_VECTOR;
 	}
 	double *cvector = compute->vector;
@@ -550,7 +560,9 @@ void FixAveTime::invoke_vector(bigint ntimestep)
 	
       } else {
 	if (!(compute->invoked_flag & INVOKED_ARRAY)) {
+	  timer->start(ctimer[j]);
 	  compute->compute_array();
+	  timer->stop(ctimer[j]);
 	  compute->invoked_flag |= INVOKED_ARRAY;
 	}
 	double **carray = compute->array;
@@ -43,6 +43,7 @@ class FixAveTime : public Fix {
   int nrepeat,nfreq,irepeat;
   bigint nvalid;
   int *which,*argindex,*value2index,*offcol;
+  int *ctimer;                // Timer region of each compute within this fix
   char **ids;
   FILE *fp;
   int nrows;
@@ -19,9 +19,12 @@
 #include "domain.h"
 #include "region.h"
 #include "grid.h"
+#include "particle.h"
 #include "comm.h"
 #include "random_mars.h"
 #include "random_park.h"
+#include "random_philox.h"
+#include "math_random.h"
 #include "math_const.h"
 #include "memory.h"
 #include "error.h"
@@ -50,6 +53,8 @@ FixEmit::FixEmit(SPARTA *sparta, int narg, char **arg) :
   random = new RanPark(update->ranmaster->uniform());
   double seed = update->ranmaster->uniform();
   random->reset(seed,me,100);
+  rngcell = 0;
+  rstream = NULL;
 
   // local storage of emit data structures
 
@@ -58,6 +63,14 @@ FixEmit::FixEmit(SPARTA *sparta, int narg, char **arg) :
   clist = clistnum = clistfirst = NULL;
   nlist = nlistmax = 0;
 
+  maxblock = 0;
+  spblock = NULL;
+  vnblock = vtblock = NULL;
+
+  nactive = maxactive = maxactivecell = 0;
+  activecell = activelist = NULL;
+  cellmom = NULL;
+
   // counters common to all emit styles for output from fix
 
   nsingle = ntotal = 0;
@@ -70,11 +83,18 @@ FixEmit::~FixEmit()
   if (copymode) return;
 
   delete random;
+  delete rstream;
 
   memory->destroy(c2list);
   memory->destroy(clist);
   memory->destroy(clistnum);
   memory->destroy(clistfirst);
+  memory->destroy(spblock);
+  memory->destroy(vnblock);
+  memory->destroy(vtblock);
+  memory->destroy(activecell);
+  memory->destroy(activelist);
+  memory->destroy(cellmom);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -390,6 +410,156 @@ void FixEmit::grow_list()
   memory->grow(clistfirst,nlistmax,"emit:clistfirst");
 }
 
+/* ----------------------------------------------------------------------
+   reset list of active cells = cells with subsonic tasks
+   called by child classes when active_current = 0,
+     followed by active_add() for each task's particle cell
+------------------------------------------------------------------------- */
+
+void FixEmit::active_clear()
+{
+  if (grid->nlocal > maxactivecell) {
+    memory->destroy(activecell);
+    maxactivecell = grid->nlocal;
+    memory->create(activecell,maxactivecell,"emit:activecell");
+  }
+  for (int i = 0; i < maxactivecell; i++) activecell[i] = -1;
+  nactive = 0;
+}
+
+/* ----------------------------------------------------------------------
+   add owned cell icell to active list if not already in it
+   one cell can be the particle cell of several tasks
+------------------------------------------------------------------------- */
+
+void FixEmit::active_add(int icell)
+{
+  if (activecell[icell] >= 0) return;
+
+  if (nactive == maxactive) {
+    maxactive += DELTAGRID;
+    memory->grow(activelist,maxactive,"emit:activelist");
+    memory->grow(cellmom,maxactive,7,"emit:cellmom");
+  }
+  activecell[icell] = nactive;
+  activelist[nactive++] = icell;
+}
+
+/* ----------------------------------------------------------------------
+   tally particle moments of active cells into cellmom
+   if particles are sorted, walk the per-cell lists of active cells only
+   else one pass over particles, no linked lists or particle->next needed
+   reverse loop adds each cell's particles in same order as its sort list
+------------------------------------------------------------------------- */
+
+void FixEmit::subsonic_moments()
+{
+  int i,icell,ispecies,iactive;
+  double mass;
+  double *v,*mom;
+
+  Particle::OnePart *particles = particle->particles;
+  Particle::Species *species = particle->species;
+
+  if (nactive) memset(&cellmom[0][0],0,nactive*7*sizeof(double));
+
+  if (particle->sorted) {
+    Grid::ChildInfo *cinfo = grid->cinfo;
+    int *next = particle->next;
+
+    for (iactive = 0; iactive < nactive; iactive++) {
+      mom = cellmom[iactive];
+      for (i = cinfo[activelist[iactive]].first; i >= 0; i = next[i]) {
+        ispecies = particles[i].ispecies;
+        mass = species[ispecies].mass;
+        v = particles[i].v;
+        mom[0] += 1.0;
+        mom[1] += mass*v[0];
+        mom[2] += mass*v[1];
+        mom[3] += mass*v[2];
+        mom[4] += mass * (v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
+        mom[5] += mass;
+        mom[6] += 1.0 + 2.0 / (3.0 + species[ispecies].rotdof);
+      }
+    }
+
+  } else {
+    for (i = particle->nlocal-1; i >= 0; i--) {
+      icell = particles[i].icell;
+      iactive = activecell[icell];
+      if (iactive < 0) continue;
+      mom = cellmom[iactive];
+      ispecies = particles[i].ispecies;
+      mass = species[ispecies].mass;
+      v = particles[i].v;
+      mom[0] += 1.0;
+      mom[1] += mass*v[0];
+      mom[2] += mass*v[1];
+      mom[3] += mass*v[2];
+      mom[4] += mass * (v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
+      mom[5] += mass;
+      mom[6] += 1.0 + 2.0 / (3.0 + species[ispecies].rotdof);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   insure species and velocity blocks are long enough for N particles
+------------------------------------------------------------------------- */
+
+void FixEmit::grow_block(int n)
+{
+  maxblock = n;
+  memory->destroy(spblock);
+  memory->destroy(vnblock);
+  memory->destroy(vtblock);
+  memory->create(spblock,maxblock,"emit:spblock");
+  memory->create(vnblock,maxblock,"emit:vnblock");
+  memory->create(vtblock,2*maxblock,"emit:vtblock");
+}
+
+/* ----------------------------------------------------------------------
+   sample species and thermal velocities of N particles inserted by a task
+   isp >= 0: all particles are mixture species isp
+   isp < 0: species of each particle is sampled from alias table prob/alias
+     for the nsp species of the mixture
+   vscale = per-species thermal velocity scale
+   indot = stream velocity component along inward normal
+   fill spblock with mixture species of each particle,
+     vnblock with thermal velocity along normal, into box when added to indot
+     vtblock with 2 tangential thermal velocities per particle
+------------------------------------------------------------------------- */
+
+void FixEmit::sample_block(int n, int isp, int nsp, double *prob, int *alias,
+                           double *vscale, double indot)
+{
+  int m;
+
+  if (n > maxblock) grow_block(n);
+
+  if (isp >= 0) {
+    for (m = 0; m < n; m++) spblock[m] = isp;
+    MathRandom::flux_normal(random,indot/vscale[isp],n,vnblock);
+    for (m = 0; m < n; m++) vnblock[m] = vnblock[m]*vscale[isp];
+  } else {
+    MathRandom::uniform(random,n,vnblock);
+    for (m = 0; m < n; m++)
+      spblock[m] = MathRandom::alias(nsp,prob,alias,vnblock[m]);
+    for (m = 0; m < n; m++) {
+      isp = spblock[m];
+      vnblock[m] = MathRandom::flux_normal(random,indot/vscale[isp]) *
+        vscale[isp];
+    }
+  }
+
+  MathRandom::gaussian(random,2*n,vtblock);
+  for (m = 0; m < n; m++) {
+    isp = spblock[m];
+    vtblock[2*m] = MY_ISQRT2*vscale[isp]*vtblock[2*m];
+    vtblock[2*m+1] = MY_ISQRT2*vscale[isp]*vtblock[2*m+1];
+  }
+}
+
 /* ----------------------------------------------------------------------
    calculate flux of particles of a species with vscale/fraction
      entering a grid cell
@@ -469,11 +639,34 @@ void FixEmit::options(int narg, char **arg)
         error->all(FLERR,"Fix emit region does not exist");
       region = domain->regions[iregion];
       iarg += 2;
+    } else if (strcmp(arg[iarg],"rng") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix emit command");
+      if (strcmp(arg[iarg+1],"proc") == 0) rngcell = 0;
+      else if (strcmp(arg[iarg+1],"cell") == 0) rngcell = 1;
+      else error->all(FLERR,"Illegal fix emit command");
+      if (rngcell && !rstream) {
+        int seed = static_cast<int> (update->ranmaster->uniform()*MAXSMALLINT);
+        rstream = new RanPhilox(seed,0);
+      }
+      iarg += 2;
 
     } else iarg += option(narg-iarg,&arg[iarg]);
   }
 }
 
+/* ----------------------------------------------------------------------
+   reseed RNG for one insertion task in grid cell icell
+   index distinguishes multiple tasks in same cell, e.g. face or surf index
+   seed comes from counter-based RNG keyed by timestep, cell ID, index,
+     so RNs used by a task are independent of proc count and task order
+------------------------------------------------------------------------- */
+
+void FixEmit::stream_rng(int icell, int index)
+{
+  rstream->reset(update->ntimestep,grid->cells[icell].id,index);
+  random->reset(rstream->uniform(),0,0);
+}
+
 /* ----------------------------------------------------------------------
    process unknown keyword
 ------------------------------------------------------------------------- */
@@ -497,3 +690,19 @@ double FixEmit::compute_vector(int i)
   MPI_Allreduce(&one,&all,1,MPI_DOUBLE,MPI_SUM,world);
   return all;
 }
+
+/* ----------------------------------------------------------------------
+   re-derive emission RNGs from master RNG after it is re-seeded
+------------------------------------------------------------------------- */
+
+void FixEmit::reseed()
+{
+  double seed = update->ranmaster->uniform();
+  random->reset(seed,comm->me,100);
+
+  if (rstream) {
+    delete rstream;
+    int rseed = static_cast<int> (update->ranmaster->uniform()*MAXSMALLINT);
+    rstream = new RanPhilox(rseed,0);
+  }
+}
@@ -26,6 +26,7 @@ class FixEmit : public Fix {
   int setmask();
   virtual void init();
   void start_of_step();
+  void reseed();
   double compute_vector(int);
 
   void add_grid_one(int, int);
@@ -38,8 +39,15 @@ class FixEmit : public Fix {
   int perspecies;
   class Region *region;
   class RanPark *random;
+  int rngcell;                 // 1 if RNG is reseeded per insertion task
+  class RanPhilox *rstream;    // counter-based RNG for per-task seeds
   int nsingle,ntotal;
 
+  int maxblock;        // max # of particles in sampled blocks
+  int *spblock;        // block of mixture species indices
+  double *vnblock;     // block of normal thermal velocities
+  double *vtblock;     // block of tangential thermal velocities, 2 per particle
+
   int nglocal;         // copy of cell->nlocal
   int nglocalmax;      // max size of c2list
   int *c2list;         // index into clist for each owned cell
@@ -57,15 +65,31 @@ class FixEmit : public Fix {
   int active_current;  // set to 0 if grid cell data struct changes
                        // triggers rebuild of active cell list in child classes
 
+  // particle moments of grid cells with subsonic tasks
+
+  int nactive;         // # of active cells = cells with subsonic tasks
+  int maxactive;       // max # of active cells in activelist,cellmom
+  int maxactivecell;   // length of activecell
+  int *activecell;     // index of each owned cell in activelist, -1 if none
+  int *activelist;     // local index of each active cell
+  double **cellmom;    // per active cell: count, mass*v[3], mass*vsq,
+                       //   mass, gamma = 1 + 2/(3+rotdof) summed over particles
+
   virtual int create_task(int) = 0;
   virtual void perform_task() = 0;
   virtual int pack_task(int, char *, int) = 0;
   virtual int unpack_task(char *, int) = 0;
   virtual void copy_task(int, int, int, int) = 0;
 
+  void stream_rng(int, int);
   void grow_percell(int);
   void grow_list();
+  void grow_block(int);
+  void sample_block(int, int, int, double *, int *, double *, double);
   double mol_inflow(double, double, double);
+  void active_clear();
+  void active_add(int);
+  void subsonic_moments();
   int subsonic_temperature_check(int, double);
   void options(int, char **);
   virtual int option(int, char **);
@@ -27,6 +27,7 @@
 #include "geometry.h"
 #include "input.h"
 #include "random_park.h"
+#include "math_random.h"
 #include "math_const.h"
 #include "memory.h"
 #include "error.h"
@@ -103,9 +104,6 @@ FixEmitFace::FixEmitFace(SPARTA *sparta, int narg, char **arg) :
 
   tasks = NULL;
   ntask = ntaskmax = 0;
-
-  maxactive = 0;
-  activecell = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -121,7 +119,6 @@ FixEmitFace::~FixEmitFace()
     }
     memory->sfree(tasks);
   }
-  memory->destroy(activecell);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -454,8 +451,8 @@ void FixEmitFace::perform_task()
 void FixEmitFace::perform_task_onepass()
 {
   int pcell,ninsert,nactual,isp,ispecies,ndim,pdim,qdim,id;
-  double indot,scosine,rn,ntarget,vr;
-  double beta_un,normalized_distbn_fn,theta,erot,evib;
+  double indot,ntarget;
+  double erot,evib;
   double temp_thermal,temp_rot,temp_vib;
   double x[3],v[3];
   double *lo,*hi,*normal,*vstream,*vscale;
@@ -463,6 +460,8 @@ void FixEmitFace::perform_task_onepass()
 
   dt = update->dt;
   int *species = particle->mixture[imix]->species;
+  double *aliasprob = particle->mixture[imix]->aliasprob;
+  int *aliasindex = particle->mixture[imix]->aliasindex;
 
   // if subsonic, re-compute particle inflow counts for each task
   // also computes current per-task temp_thermal and vstream
@@ -477,17 +476,16 @@ void FixEmitFace::perform_task_onepass()
   //       first stage: normal dimension (ndim)
   //       second stage: parallel dimensions (pdim,qdim)
 
-  // double while loop until randomized particle velocity meets 2 criteria
-  // inner do-while loop:
-  //   v = vstream-component + vthermal is into simulation box
-  //   see Bird 1994, p 425
-  // outer do-while loop:
-  //   shift Maxwellian distribution by stream velocity component
-  //   see Bird 1994, p 259, eq 12.5
+  // normal velocity = vstream-component + vthermal is into simulation box
+  //   from flux-weighted Maxwellian shifted by stream velocity component
+  //   see Bird 1994, p 425 and p 259, eq 12.5
+  // tangential velocity = vstream-component + gaussian vthermal
+  // species of mixed-species insertion sampled via Mixture alias table
 
   int nfix_add_particle = modify->n_add_particle;
 
   for (int i = 0; i < ntask; i++) {
+    if (rngcell) stream_rng(tasks[i].icell,2*tasks[i].iface);
     pcell = tasks[i].pcell;
     ndim = tasks[i].ndim;
     pdim = tasks[i].pdim;
@@ -511,7 +509,12 @@ void FixEmitFace::perform_task_onepass()
         ispecies = species[isp];
 	ntarget = tasks[i].ntargetsp[isp]+random->uniform();
 	ninsert = static_cast<int> (ntarget);
-        scosine = indot / vscale[isp];
+
+        // thermal velocities sampled in blocks
+        // reserve room for all inserted particles up front
+
+        sample_block(ninsert,isp,nspecies,NULL,NULL,vscale,indot);
+        particle->grow(ninsert);
 
         nactual = 0;
 	for (int m = 0; m < ninsert; m++) {
@@ -522,21 +525,9 @@ void FixEmitFace::perform_task_onepass()
 
           if (region && !region->match(x)) continue;
 
-	  do {
-	    do beta_un = (6.0*random->uniform() - 3.0);
-	    while (beta_un + scosine < 0.0);
-	    normalized_distbn_fn = 2.0 * (beta_un + scosine) / 
-	      (scosine + sqrt(scosine*scosine + 2.0)) *
-	      exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) - 
-		  beta_un*beta_un);
-	  } while (normalized_distbn_fn < random->uniform());
-	  
-          v[ndim] = beta_un*vscale[isp]*normal[ndim] + vstream[ndim];
-
-          theta = MY_2PI * random->uniform();
-          vr = vscale[isp] * sqrt(-log(random->uniform()));
-          v[pdim] = vr * sin(theta) + vstream[pdim];
-          v[qdim] = vr * cos(theta) + vstream[qdim];
+          v[ndim] = vnblock[m]*normal[ndim] + vstream[ndim];
+          v[pdim] = vtblock[2*m] + vstream[pdim];
+          v[qdim] = vtblock[2*m+1] + vstream[qdim];
           erot = particle->erot(ispecies,temp_rot,random);
           evib = particle->evib(ispecies,temp_vib,random);
           id = MAXSMALLINT*random->uniform();
@@ -565,13 +556,15 @@ void FixEmitFace::perform_task_onepass()
 	if (i >= nthresh) ninsert++;
       }
 
+      // species and thermal velocities sampled in blocks
+      // reserve room for all inserted particles up front
+
+      sample_block(ninsert,-1,nspecies,aliasprob,aliasindex,vscale,indot);
+      particle->grow(ninsert);
+
       nactual = 0;
       for (int m = 0; m < ninsert; m++) {
-	rn = random->uniform();
-	isp = 0;
-	while (cummulative[isp] < rn) isp++;
-        ispecies = species[isp];
-        scosine = indot / vscale[isp];
+        ispecies = species[spblock[m]];
 
 	x[0] = lo[0] + random->uniform() * (hi[0]-lo[0]);
 	x[1] = lo[1] + random->uniform() * (hi[1]-lo[1]);
@@ -580,22 +573,9 @@ void FixEmitFace::perform_task_onepass()
 
         if (region && !region->match(x)) continue;
 
-	do {
-	  do {
-	    beta_un = (6.0*random->uniform() - 3.0);
-	  } while (beta_un + scosine < 0.0);
-	  normalized_distbn_fn = 2.0 * (beta_un + scosine) / 
-	    (scosine + sqrt(scosine*scosine + 2.0)) *
-	    exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) - 
-		beta_un*beta_un);
-	} while (normalized_distbn_fn < random->uniform());
-	
-        v[ndim] = beta_un*vscale[isp]*normal[ndim] + vstream[ndim];
-
-        theta = MY_2PI * random->uniform();
-        vr = vscale[isp] * sqrt(-log(random->uniform()));
-        v[pdim] = vr * sin(theta) + vstream[pdim];
-        v[qdim] = vr * cos(theta) + vstream[qdim];
+        v[ndim] = vnblock[m]*normal[ndim] + vstream[ndim];
+        v[pdim] = vtblock[2*m] + vstream[pdim];
+        v[qdim] = vtblock[2*m+1] + vstream[qdim];
         erot = particle->erot(ispecies,temp_rot,random);
         evib = particle->evib(ispecies,temp_vib,random);
         id = MAXSMALLINT*random->uniform();
@@ -663,6 +643,7 @@ void FixEmitFace::perform_task_twopass()
   memory->create(ninsert_values, ntask, ninsert_dim1, "fix_emit_face:ninsert");
 
   for (int i = 0; i < ntask; i++) {
+    if (rngcell) stream_rng(tasks[i].icell,2*tasks[i].iface);
     if (perspecies) {
       for (isp = 0; isp < nspecies; isp++) {
         ntarget = tasks[i].ntargetsp[isp]+random->uniform();
@@ -681,7 +662,17 @@ void FixEmitFace::perform_task_twopass()
     }
   }
 
+  // reserve room for all particles inserted by all tasks
+
+  bigint nreserve = 0;
+  for (int i = 0; i < ntask; i++)
+    for (int j = 0; j < ninsert_dim1; j++) nreserve += ninsert_values[i][j];
+  if (nreserve > MAXSMALLINT)
+    error->one(FLERR,"Per-processor particle count is too big");
+  particle->grow(nreserve);
+
   for (int i = 0; i < ntask; i++) {
+    if (rngcell) stream_rng(tasks[i].icell,2*tasks[i].iface+1);
     pcell = tasks[i].pcell;
     ndim = tasks[i].ndim;
     pdim = tasks[i].pdim;
@@ -846,10 +837,17 @@ int FixEmitFace::split(int icell, int iface)
 void FixEmitFace::subsonic_inflow()
 {
   // for grid cells that are part of tasks:
+  // tally particle moments, rebuilding active cell list if needed
   // calculate local nrho, vstream, and thermal temperature
-  // if needed sort particles for grid cells with tasks
+  // active_current flag set by parent class
+  // use task pcell, not icell
 
-  if (!particle->sorted) subsonic_sort();
+  if (!active_current) {
+    active_clear();
+    for (int i = 0; i < ntask; i++) active_add(tasks[i].pcell);
+    active_current = 1;
+  }
+  subsonic_moments();
   subsonic_grid();
 
   // recalculate particle insertion counts for each task
@@ -891,62 +889,6 @@ void FixEmitFace::subsonic_inflow()
   }
 }
 
-/* ----------------------------------------------------------------------
-   identify particles in grid cells associated with a task
-   store count and linked list, same as for particle sorting
-------------------------------------------------------------------------- */
-
-void FixEmitFace::subsonic_sort()
-{
-  int i,icell;
-
-  // initialize particle sort lists for grid cells assigned to tasks
-  // use task pcell, not icell
-
-  Grid::ChildInfo *cinfo = grid->cinfo;
-
-  for (i = 0; i < ntask; i++) {
-    icell = tasks[i].pcell;
-    cinfo[icell].first = -1;
-    cinfo[icell].count = 0;
-  }
-
-  // reallocate particle next list if necessary
-
-  particle->sort_allocate();
-
-  // update list of active grid cells if necessary
-  // active cells = those assigned to tasks
-  // active_current flag set by parent class
-
-  if (!active_current) {
-    if (grid->nlocal > maxactive) {
-      memory->destroy(activecell);
-      maxactive = grid->nlocal;
-      memory->create(activecell,maxactive,"emit/face:active");
-    }
-    memset(activecell,0,maxactive*sizeof(int));
-    for (i = 0; i < ntask; i++) activecell[tasks[i].pcell] = 1;
-    active_current = 1;
-  }
-
-  // loop over particles to store linked lists for active cells
-  // not using reverse loop like Particle::sort(),
-  //   since this should only be created/used occasionally
-
-  Particle::OnePart *particles = particle->particles;
-  int *next = particle->next;
-  int nlocal = particle->nlocal;
-
-  for (i = 0; i < nlocal; i++) {
-    icell = particles[i].icell;
-    if (!activecell[icell]) continue;
-    next[i] = cinfo[icell].first;
-    cinfo[icell].first = i;
-    cinfo[icell].count++;
-  }
-}
-
 /* ----------------------------------------------------------------------
    compute number density, thermal temperature, stream velocity
    only for grid cells associated with a task
@@ -955,16 +897,13 @@ void FixEmitFace::subsonic_sort()
 
 void FixEmitFace::subsonic_grid()
 {
-  int m,ip,np,icell,ispecies,ndim;
-  double mass,masstot,gamma,ke,sign;
+  int m,np,icell,ispecies,ndim;
+  double masstot,gamma,ke,sign;
   double nrho_cell,massrho_cell,temp_thermal_cell,press_cell;
   double mass_cell,gamma_cell,soundspeed_cell;
-  double mv[4];
-  double *v,*vstream,*vscale;
+  double *mv,*mom,*vstream,*vscale;
 
   Grid::ChildInfo *cinfo = grid->cinfo;
-  Particle::OnePart *particles = particle->particles;
-  int *next = particle->next;
   Particle::Species *species = particle->species;
   double boltz = update->boltz;
 
@@ -973,28 +912,16 @@ void FixEmitFace::subsonic_grid()
 
   for (int i = 0; i < ntask; i++) {
     icell = tasks[i].pcell;
-    np = cinfo[icell].count;
+    mom = cellmom[activecell[icell]];
+    np = static_cast<int> (mom[0]);
 
-    // accumulate needed per-particle quantities
+    // per-particle quantities tallied by subsonic_moments()
     // mv = mass*velocity terms, masstot = total mass
     // gamma = rotational/tranlational DOFs
 
-    mv[0] = mv[1] = mv[2] = mv[3] = 0.0;
-    masstot = gamma = 0.0;
-
-    ip = cinfo[icell].first;
-    while (ip >= 0) {
-      ispecies = particles[ip].ispecies;
-      mass = species[ispecies].mass;
-      v = particles[ip].v;
-      mv[0] += mass*v[0];
-      mv[1] += mass*v[1];
-      mv[2] += mass*v[2];
-      mv[3] += mass * (v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
-      masstot += mass;
-      gamma += 1.0 + 2.0 / (3.0 + species[ispecies].rotdof);
-      ip = next[ip];
-    }
+    mv = &mom[1];
+    masstot = mom[5];
+    gamma = mom[6];
 
     // compute/store nrho, 3 temps, vstream for task
     // also vscale for PONLY
@@ -81,11 +81,6 @@ class FixEmitFace : public FixEmit {
   Task *tasks;           // list of particle insertion tasks
   int ntaskmax;          // max # of tasks allocated
 
-  // active grid cells assigned to tasks, used by subsonic sorting
-
-  int maxactive;
-  int *activecell;
-
   // protected methods
 
   int create_task(int);
@@ -96,7 +91,6 @@ class FixEmitFace : public FixEmit {
   int split(int, int);
 
   void subsonic_inflow();
-  void subsonic_sort();
   void subsonic_grid();
 
   virtual int pack_task(int, char *, int);
@@ -28,6 +28,7 @@
 #include "modify.h"
 #include "geometry.h"
 #include "random_park.h"
+#include "math_random.h"
 #include "math_const.h"
 #include "memory.h"
 #include "error.h"
@@ -120,8 +121,8 @@ FixEmitFaceFile::FixEmitFaceFile(SPARTA *sparta, int narg, char **arg) :
   tasks = NULL;
   ntask = ntaskmax = 0;
 
-  maxactive = 0;
-  activecell = NULL;
+  aliasprob = NULL;
+  aliasindex = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -140,7 +141,9 @@ FixEmitFaceFile::~FixEmitFaceFile()
     delete [] tasks[i].cummulative;
   }
   memory->sfree(tasks);
-  memory->destroy(activecell);
+
+  memory->destroy(aliasprob);
+  memory->destroy(aliasindex);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -227,6 +230,16 @@ void FixEmitFaceFile::init()
     }
   }
 
+  // if used, reallocate alias table for per-task species fractions
+  // b/c nspecies count of mixture may have changed
+
+  if (!perspecies) {
+    memory->destroy(aliasprob);
+    memory->destroy(aliasindex);
+    memory->create(aliasprob,nspecies,"emit/face/file:aliasprob");
+    memory->create(aliasindex,nspecies,"emit/face/file:aliasindex");
+  }
+
   // per-species vectors for mesh setting of species fractions
   // initialize to mixture settings
 
@@ -349,10 +362,10 @@ void FixEmitFaceFile::perform_task()
 {
   int pcell,ninsert,nactual,isp,ispecies,id;
   double temp_thermal,temp_rot,temp_vib;
-  double indot,scosine,rn,ntarget,vr;
-  double beta_un,normalized_distbn_fn,theta,erot,evib;
+  double indot,ntarget;
+  double erot,evib;
   double x[3],v[3];
-  double *lo,*hi,*vstream,*cummulative,*vscale;
+  double *lo,*hi,*vstream,*vscale;
   Particle::OnePart *p;
 
   double dt = update->dt;
@@ -371,17 +384,16 @@ void FixEmitFaceFile::perform_task()
   //       first stage: normal dimension (ndim)
   //       second stage: parallel dimensions (pdim1,pdim2)
 
-  // double while loop until randomized particle velocity meets 2 criteria
-  // inner do-while loop:
-  //   v = vstream-component + vthermal is into simulation box
-  //   see Bird 1994, p 425
-  // outer do-while loop:
-  //   shift Maxwellian distribution by stream velocity component
-  //   see Bird 1994, p 259, eq 12.5
+  // normal velocity = vstream-component + vthermal is into simulation box
+  //   from flux-weighted Maxwellian shifted by stream velocity component
+  //   see Bird 1994, p 425 and p 259, eq 12.5
+  // tangential velocity = vstream-component + gaussian vthermal
+  // species of mixed-species insertion sampled via per-task alias table
 
   int nfix_add_particle = modify->n_add_particle;
 
   for (int i = 0; i < ntask; i++) {
+    if (rngcell) stream_rng(tasks[i].icell,iface);
     pcell = tasks[i].pcell;
     lo = tasks[i].lo;
     hi = tasks[i].hi;
@@ -399,7 +411,12 @@ void FixEmitFaceFile::perform_task()
         ispecies = species[isp];
 	ntarget = tasks[i].ntargetsp[isp]+random->uniform();
 	ninsert = static_cast<int> (ntarget);
-        scosine = indot / vscale[isp];
+
+        // thermal velocities sampled in blocks
+        // reserve room for all inserted particles up front
+
+        sample_block(ninsert,isp,nspecies,NULL,NULL,vscale,indot);
+        particle->grow(ninsert);
 
         nactual = 0;
 	for (int m = 0; m < ninsert; m++) {
@@ -410,21 +427,9 @@ void FixEmitFaceFile::perform_task()
 
           if (region && !region->match(x)) continue;
 
-	  do {
-	    do beta_un = (6.0*random->uniform() - 3.0);
-	    while (beta_un + scosine < 0.0);
-	    normalized_distbn_fn = 2.0 * (beta_un + scosine) / 
-	      (scosine + sqrt(scosine*scosine + 2.0)) *
-	      exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) - 
-		  beta_un*beta_un);
-	  } while (normalized_distbn_fn < random->uniform());
-	  
-          v[ndim] = beta_un*vscale[isp]*normal[ndim] + vstream[ndim];
-
-          theta = MY_PI * random->uniform();
-          vr = vscale[isp] * sqrt(-log(random->uniform()));
-          v[pdim] = vr * sin(theta) + vstream[pdim];
-          v[qdim] = vr * cos(theta) + vstream[qdim];
+          v[ndim] = vnblock[m]*normal[ndim] + vstream[ndim];
+          v[pdim] = vtblock[2*m] + vstream[pdim];
+          v[qdim] = vtblock[2*m+1] + vstream[qdim];
           erot = particle->erot(ispecies,temp_rot,random);
           evib = particle->evib(ispecies,temp_vib,random);
           id = MAXSMALLINT*random->uniform();
@@ -445,17 +450,19 @@ void FixEmitFaceFile::perform_task()
       }
 
     } else {
-      cummulative = tasks[i].cummulative;
+      MathRandom::alias_setup(nspecies,tasks[i].fraction,aliasprob,aliasindex);
       ntarget = tasks[i].ntarget+random->uniform();
       ninsert = static_cast<int> (ntarget);
 
+      // species and thermal velocities sampled in blocks
+      // reserve room for all inserted particles up front
+
+      sample_block(ninsert,-1,nspecies,aliasprob,aliasindex,vscale,indot);
+      particle->grow(ninsert);
+
       nactual = 0;
       for (int m = 0; m < ninsert; m++) {
-	rn = random->uniform();
-	isp = 0;
-	while (cummulative[isp] < rn) isp++;
-        ispecies = species[isp];
-        scosine = indot / vscale[isp];
+        ispecies = species[spblock[m]];
 
 	x[0] = lo[0] + random->uniform() * (hi[0]-lo[0]);
 	x[1] = lo[1] + random->uniform() * (hi[1]-lo[1]);
@@ -464,21 +471,9 @@ void FixEmitFaceFile::perform_task()
 
         if (region && !region->match(x)) continue;
 
-	do {
-	  do beta_un = (6.0*random->uniform() - 3.0);
-	  while (beta_un + scosine < 0.0);
-	  normalized_distbn_fn = 2.0 * (beta_un + scosine) / 
-	    (scosine + sqrt(scosine*scosine + 2.0)) *
-	    exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) - 
-		beta_un*beta_un);
-	} while (normalized_distbn_fn < random->uniform());
-	
-        v[ndim] = beta_un*vscale[isp]*normal[ndim] + vstream[ndim];
-
-        theta = MY_PI * random->uniform();
-        vr = vscale[isp] * sqrt(-log(random->uniform()));
-        v[pdim] = vr * sin(theta) + vstream[pdim];
-        v[qdim] = vr * cos(theta) + vstream[qdim];
+        v[ndim] = vnblock[m]*normal[ndim] + vstream[ndim];
+        v[pdim] = vtblock[2*m] + vstream[pdim];
+        v[qdim] = vtblock[2*m+1] + vstream[qdim];
         erot = particle->erot(ispecies,temp_rot,random);
         evib = particle->evib(ispecies,temp_vib,random);
         id = MAXSMALLINT*random->uniform();
@@ -1037,10 +1032,17 @@ int FixEmitFaceFile::split(int icell)
 void FixEmitFaceFile::subsonic_inflow()
 {
   // for grid cells that are part of tasks:
+  // tally particle moments, rebuilding active cell list if needed
   // calculate local nrho, vstream, and thermal temperature
-  // if needed sort particles for grid cells with tasks
+  // active_current flag set by parent class
+  // use task pcell, not icell
 
-  if (!particle->sorted) subsonic_sort();
+  if (!active_current) {
+    active_clear();
+    for (int i = 0; i < ntask; i++) active_add(tasks[i].pcell);
+    active_current = 1;
+  }
+  subsonic_moments();
   subsonic_grid();
 
   // recalculate particle insertion counts for each task
@@ -1082,62 +1084,6 @@ void FixEmitFaceFile::subsonic_inflow()
   }
 }
 
-/* ----------------------------------------------------------------------
-   identify particles in grid cells associated with a task
-   store count and linked list, same as for particle sorting
-------------------------------------------------------------------------- */
-
-void FixEmitFaceFile::subsonic_sort()
-{
-  int i,icell;
-
-  // initialize particle sort lists for grid cells assigned to tasks
-  // use task pcell, not icell
-
-  Grid::ChildInfo *cinfo = grid->cinfo;
-
-  for (i = 0; i < ntask; i++) {
-    icell = tasks[i].pcell;
-    cinfo[icell].first = -1;
-    cinfo[icell].count = 0;
-  }
-
-  // reallocate particle next list if necessary
-
-  particle->sort_allocate();
-
-  // update list of active grid cells if necessary
-  // active cells = those assigned to tasks
-  // active_current flag set by parent class
-
-  if (!active_current) {
-    if (grid->nlocal > maxactive) {
-      memory->destroy(activecell);
-      maxactive = grid->nlocal;
-      memory->create(activecell,maxactive,"emit/face:active");
-    }
-    memset(activecell,0,maxactive*sizeof(int));
-    for (i = 0; i < ntask; i++) activecell[tasks[i].pcell] = 1;
-    active_current = 1;
-  }
-
-  // loop over particles to store linked lists for active cells
-  // not using reverse loop like Particle::sort(),
-  //   since this should only be created/used occasionally
-
-  Particle::OnePart *particles = particle->particles;
-  int *next = particle->next;
-  int nlocal = particle->nlocal;
-
-  for (i = 0; i < nlocal; i++) {
-    icell = particles[i].icell;
-    if (!activecell[icell]) continue;
-    next[i] = cinfo[icell].first;
-    cinfo[icell].first = i;
-    cinfo[icell].count++;
-  }
-}
-
 /* ----------------------------------------------------------------------
    compute number density, thermal temperature, stream velocity
    only for grid cells associated with a task
@@ -1146,16 +1092,13 @@ void FixEmitFaceFile::subsonic_sort()
 
 void FixEmitFaceFile::subsonic_grid()
 {
-  int m,ip,np,icell,ispecies;
-  double mass,masstot,gamma,ke,sign;
+  int m,np,icell,ispecies;
+  double masstot,gamma,ke,sign;
   double nrho_cell,massrho_cell,temp_thermal_cell,press_cell;
   double mass_cell,gamma_cell,soundspeed_cell;
-  double mv[4];
-  double *v,*vstream,*vscale;
+  double *mv,*mom,*vstream,*vscale;
 
   Grid::ChildInfo *cinfo = grid->cinfo;
-  Particle::OnePart *particles = particle->particles;
-  int *next = particle->next;
   Particle::Species *species = particle->species;
   double boltz = update->boltz;
 
@@ -1164,28 +1107,16 @@ void FixEmitFaceFile::subsonic_grid()
 
   for (int i = 0; i < ntask; i++) {
     icell = tasks[i].pcell;
-    np = cinfo[icell].count;
+    mom = cellmom[activecell[icell]];
+    np = static_cast<int> (mom[0]);
 
-    // accumulate needed per-particle quantities
+    // per-particle quantities tallied by subsonic_moments()
     // mv = mass*velocity terms, masstot = total mass
     // gamma = rotational/tranlational DOFs
 
-    mv[0] = mv[1] = mv[2] = mv[3] = 0.0;
-    masstot = gamma = 0.0;
-
-    ip = cinfo[icell].first;
-    while (ip >= 0) {
-      ispecies = particles[ip].ispecies;
-      mass = species[ispecies].mass;
-      v = particles[ip].v;
-      mv[0] += mass*v[0];
-      mv[1] += mass*v[1];
-      mv[2] += mass*v[2];
-      mv[3] += mass * (v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
-      masstot += mass;
-      gamma += 1.0 + 2.0 / (3.0 + species[ispecies].rotdof);
-      ip = next[ip];
-    }
+    mv = &mom[1];
+    masstot = mom[5];
+    gamma = mom[6];
 
     // compute/store nrho, 3 temps, vstream for task
     // also vscale for PONLY
@@ -102,16 +102,16 @@ class FixEmitFaceFile : public FixEmit {
   Task *tasks;           // list of particle insertion tasks
   int ntaskmax;          // max # of tasks allocated
 
-  // active grid cells assigned to tasks, used by subsonic sorting
-
-  int maxactive;
-  int *activecell;
-
   // per-species vectors for species fractions on mesh
 
   int *fflag;
   double *fuser;
 
+  // alias table for per-task species fractions, set each task
+
+  double *aliasprob;
+  int *aliasindex;
+
   // private methods
 
   void read_file(char *, char *);
@@ -124,7 +124,6 @@ class FixEmitFaceFile : public FixEmit {
   int split(int);
 
   void subsonic_inflow();
-  void subsonic_sort();
   void subsonic_grid();
 
   int create_task(int);
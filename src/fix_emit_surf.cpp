@@ -27,6 +27,7 @@
 #include "input.h"
 #include "comm.h"
 #include "random_park.h"
+#include "math_random.h"
 #include "math_extra.h"
 #include "math_const.h"
 #include "memory.h"
@@ -79,9 +80,6 @@ FixEmitSurf::FixEmitSurf(SPARTA *sparta, int narg, char **arg) :
   
   tasks = NULL;
   ntask = ntaskmax = 0;
-  
-  maxactive = 0;
-  activecell = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -95,7 +93,6 @@ FixEmitSurf::~FixEmitSurf()
     delete [] tasks[i].fracarea;
   }
   memory->sfree(tasks);
-  memory->destroy(activecell);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -110,7 +107,6 @@ void FixEmitSurf::init()
   
   nspecies = particle->mixture[imix]->nspecies;
   fraction = particle->mixture[imix]->fraction;
-  cummulative = particle->mixture[imix]->cummulative;
   
   pts = surf->pts;
   lines = surf->lines;
@@ -412,8 +408,8 @@ int FixEmitSurf::create_task(int icell)
 void FixEmitSurf::perform_task()
 {
   int i,m,n,pcell,isurf,ninsert,nactual,isp,ispecies,ntri,id;
-  double indot,scosine,rn,ntarget,vr,alpha,beta;
-  double beta_un,normalized_distbn_fn,theta,erot,evib;
+  double indot,rn,ntarget,alpha,beta;
+  double erot,evib;
   double vnmag,vamag,vbmag;
   double *normal,*p1,*p2,*p3,*atan,*btan,*vstream,*vscale;
   double x[3],v[3],e1[3],e2[3];
@@ -421,6 +417,8 @@ void FixEmitSurf::perform_task()
   
   double dt = update->dt;
   int *species = particle->mixture[imix]->species;
+  double *aliasprob = particle->mixture[imix]->aliasprob;
+  int *aliasindex = particle->mixture[imix]->aliasindex;
 
   // if subsonic, re-compute particle inflow counts for each task
   // also computes current per-task temp_thermal and vstream
@@ -436,13 +434,11 @@ void FixEmitSurf::perform_task()
   //       first stage: normal dimension (normal)
   //       second stage: parallel dimensions (tan1,tan2)
   
-  // double while loop until randomized particle velocity meets 2 criteria
-  // inner do-while loop:
-  //   v = vstream-component + vthermal is into simulation box
-  //   see Bird 1994, p 425
-  // outer do-while loop:
-  //   shift Maxwellian distribution by stream velocity component
-  //   see Bird 1994, p 259, eq 12.5
+  // normal velocity = vstream-component + vthermal is into simulation box
+  //   from flux-weighted Maxwellian shifted by stream velocity component
+  //   see Bird 1994, p 425 and p 259, eq 12.5
+  // tangential velocity = vstream-component + gaussian vthermal
+  // species of mixed-species insertion sampled via Mixture alias table
   
   int nfix_add_particle = modify->n_add_particle;
   indot = magvstream;
@@ -450,6 +446,7 @@ void FixEmitSurf::perform_task()
   for (i = 0; i < ntask; i++) {
     pcell = tasks[i].pcell;
     isurf = tasks[i].isurf;
+    if (rngcell) stream_rng(tasks[i].icell,isurf);
     if (dimension == 2) normal = lines[isurf].norm;
     else normal = tris[isurf].norm;
     atan = tasks[i].tan1;
@@ -471,7 +468,12 @@ void FixEmitSurf::perform_task()
         ispecies = species[isp];
         ntarget = tasks[i].ntargetsp[isp]+random->uniform();
         ninsert = static_cast<int> (ntarget);
-        scosine = indot / vscale[isp];
+
+        // thermal velocities sampled in blocks
+        // reserve room for all inserted particles up front
+
+        sample_block(ninsert,isp,nspecies,NULL,NULL,vscale,indot);
+        particle->grow(ninsert);
         
         nactual = 0;
         for (m = 0; m < ninsert; m++) {
@@ -505,26 +507,12 @@ void FixEmitSurf::perform_task()
           
           if (region && !region->match(x)) continue;
           
-          do {
-            do beta_un = (6.0*random->uniform() - 3.0);
-            while (beta_un + scosine < 0.0);
-            normalized_distbn_fn = 2.0 * (beta_un + scosine) / 
-              (scosine + sqrt(scosine*scosine + 2.0)) *
-              exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) - 
-                  beta_un*beta_un);
-          } while (normalized_distbn_fn < random->uniform());
-          
-          if (normalflag) vnmag = beta_un*vscale[isp] + magvstream;
-          else vnmag = beta_un*vscale[isp] + indot;
-          
-          theta = MY_2PI * random->uniform();
-          vr = vscale[isp] * sqrt(-log(random->uniform()));
-          if (normalflag) {
-            vamag = vr * sin(theta);
-            vbmag = vr * cos(theta);
-          } else {
-            vamag = vr * sin(theta) + MathExtra::dot3(vstream,atan);
-            vbmag = vr * cos(theta) + MathExtra::dot3(vstream,btan);
+          vnmag = vnblock[m] + indot;
+          vamag = vtblock[2*m];
+          vbmag = vtblock[2*m+1];
+          if (!normalflag) {
+            vamag += MathExtra::dot3(vstream,atan);
+            vbmag += MathExtra::dot3(vstream,btan);
           }
           
           v[0] = vnmag*normal[0] + vamag*atan[0] + vbmag*btan[0];
@@ -558,14 +546,16 @@ void FixEmitSurf::perform_task()
         ninsert = npertask;
         if (i >= nthresh) ninsert++;
       }
+
+      // species and thermal velocities sampled in blocks
+      // reserve room for all inserted particles up front
+
+      sample_block(ninsert,-1,nspecies,aliasprob,aliasindex,vscale,indot);
+      particle->grow(ninsert);
       
       nactual = 0;
       for (int m = 0; m < ninsert; m++) {
-        rn = random->uniform();
-        isp = 0;
-        while (cummulative[isp] < rn) isp++;
-        ispecies = species[isp];
-        scosine = indot / vscale[isp];
+        ispecies = species[spblock[m]];
         
         if (dimension == 2) {
           rn = random->uniform();
@@ -597,27 +587,12 @@ void FixEmitSurf::perform_task()
         
         if (region && !region->match(x)) continue;
         
-        do {
-          do {
-            beta_un = (6.0*random->uniform() - 3.0);
-          } while (beta_un + scosine < 0.0);
-          normalized_distbn_fn = 2.0 * (beta_un + scosine) / 
-            (scosine + sqrt(scosine*scosine + 2.0)) *
-            exp(0.5 + (0.5*scosine)*(scosine-sqrt(scosine*scosine + 2.0)) - 
-                beta_un*beta_un);
-        } while (normalized_distbn_fn < random->uniform());
-        
-        if (normalflag) vnmag = beta_un*vscale[isp] + magvstream;
-        else vnmag = beta_un*vscale[isp] + indot;
-        
-        theta = MY_2PI * random->uniform();
-        vr = vscale[isp] * sqrt(-log(random->uniform()));
-        if (normalflag) {
-          vamag = vr * sin(theta);
-          vbmag = vr * cos(theta);
-        } else {
-          vamag = vr * sin(theta) + MathExtra::dot3(vstream,atan);
-          vbmag = vr * cos(theta) + MathExtra::dot3(vstream,btan);
+        vnmag = vnblock[m] + indot;
+        vamag = vtblock[2*m];
+        vbmag = vtblock[2*m+1];
+        if (!normalflag) {
+          vamag += MathExtra::dot3(vstream,atan);
+          vbmag += MathExtra::dot3(vstream,btan);
         }
         
         v[0] = vnmag*normal[0] + vamag*atan[0] + vbmag*btan[0];
@@ -652,10 +627,17 @@ void FixEmitSurf::perform_task()
 void FixEmitSurf::subsonic_inflow()
 {
   // for grid cells that are part of tasks:
+  // tally particle moments, rebuilding active cell list if needed
   // calculate local nrho, vstream, and thermal temperature
-  // if needed sort particles for grid cells with tasks
-  
-  if (!particle->sorted) subsonic_sort();
+  // active_current flag set by parent class
+  // use task pcell, not icell
+
+  if (!active_current) {
+    active_clear();
+    for (int i = 0; i < ntask; i++) active_add(tasks[i].pcell);
+    active_current = 1;
+  }
+  subsonic_moments();
   subsonic_grid();
   
   // recalculate particle insertion counts for each task
@@ -712,62 +694,6 @@ void FixEmitSurf::subsonic_inflow()
   }
 }
 
-/* ----------------------------------------------------------------------
-   identify particles in grid cells associated with a task
-   store count and linked list, same as for particle sorting
-------------------------------------------------------------------------- */
-
-void FixEmitSurf::subsonic_sort()
-{
-  int i,icell;
-  
-  // initialize particle sort lists for grid cells assigned to tasks
-  // use task pcell, not icell
-  
-  Grid::ChildInfo *cinfo = grid->cinfo;
-  
-  for (i = 0; i < ntask; i++) {
-    icell = tasks[i].pcell;
-    cinfo[icell].first = -1;
-    cinfo[icell].count = 0;
-  }
-
-  // reallocate particle next list if necessary
-  
-  particle->sort_allocate();
-  
-  // update list of active grid cells if necessary
-  // active cells = those assigned to tasks
-  // active_current flag set by parent class
-  
-  if (!active_current) {
-    if (grid->nlocal > maxactive) {
-      memory->destroy(activecell);
-      maxactive = grid->nlocal;
-      memory->create(activecell,maxactive,"emit/face:active");
-    }
-    memset(activecell,0,maxactive*sizeof(int));
-    for (i = 0; i < ntask; i++) activecell[tasks[i].pcell] = 1;
-    active_current = 1;
-  }
-  
-  // loop over particles to store linked lists for active cells
-  // not using reverse loop like Particle::sort(),
-  //   since this should only be created/used occasionally
-  
-  Particle::OnePart *particles = particle->particles;
-  int *next = particle->next;
-  int nlocal = particle->nlocal;
-  
-  for (i = 0; i < nlocal; i++) {
-    icell = particles[i].icell;
-    if (!activecell[icell]) continue;
-    next[i] = cinfo[icell].first;
-    cinfo[icell].first = i;
-    cinfo[icell].count++;
-  }
-}
-
 /* ----------------------------------------------------------------------
    compute number density, thermal temperature, stream velocity
    only for grid cells associated with a task
@@ -776,16 +702,13 @@ void FixEmitSurf::subsonic_sort()
 
 void FixEmitSurf::subsonic_grid()
 {
-  int m,ip,np,icell,ispecies;
-  double mass,masstot,gamma,ke;
+  int m,np,icell,ispecies;
+  double masstot,gamma,ke;
   double nrho_cell,massrho_cell,temp_thermal_cell,press_cell;
   double mass_cell,gamma_cell,soundspeed_cell,vsmag;
-  double mv[4];
-  double *v,*vstream,*vscale,*normal;
+  double *mv,*mom,*vstream,*vscale,*normal;
   
   Grid::ChildInfo *cinfo = grid->cinfo;
-  Particle::OnePart *particles = particle->particles;
-  int *next = particle->next;
   Particle::Species *species = particle->species;
   double boltz = update->boltz;
   
@@ -794,29 +717,16 @@ void FixEmitSurf::subsonic_grid()
 
   for (int i = 0; i < ntask; i++) {
     icell = tasks[i].pcell;
-    np = cinfo[icell].count;
+    mom = cellmom[activecell[icell]];
+    np = static_cast<int> (mom[0]);
     
-    // accumulate needed per-particle quantities
+    // per-particle quantities tallied by subsonic_moments()
     // mv = mass*velocity terms, masstot = total mass
     // gamma = rotational/tranlational DOFs
-    
-    mv[0] = mv[1] = mv[2] = mv[3] = 0.0;
-    masstot = gamma = 0.0;
-    
-    ip = cinfo[icell].first;
 
-    while (ip >= 0) {
-      ispecies = particles[ip].ispecies;
-      mass = species[ispecies].mass;
-      v = particles[ip].v;
-      mv[0] += mass*v[0];
-      mv[1] += mass*v[1];
-      mv[2] += mass*v[2];
-      mv[3] += mass * (v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
-      masstot += mass;
-      gamma += 1.0 + 2.0 / (3.0 + species[ispecies].rotdof);
-      ip = next[ip];
-    }
+    mv = &mom[1];
+    masstot = mom[5];
+    gamma = mom[6];
 
     // compute/store nrho, 3 temps, vstream for task
     // also vscale for PONLY
@@ -46,7 +46,7 @@ class FixEmitSurf : public FixEmit {
   int dimension,nspecies;
   double fnum,dt;
   double nrho,temp_thermal,temp_rot,temp_vib;
-  double *fraction,*cummulative;
+  double *fraction;
 
   Surf::Point *pts;
   Surf::Line *lines;
@@ -88,18 +88,12 @@ class FixEmitSurf : public FixEmit {
   double magvstream;       // magnitude of mixture vstream
   double norm_vstream[3];  // direction of mixture vstream
 
-  // active grid cells assigned to tasks, used by subsonic sorting
-
-  int maxactive;
-  int *activecell;
-
   // private methods
 
   int create_task(int);
   void perform_task();
 
   void subsonic_inflow();
-  void subsonic_sort();
   void subsonic_grid();
 
   int pack_task(int, char *, int);
@@ -257,7 +257,7 @@ class Grid : protected Pointers {
 
   // grid_id.cpp
 
-  int id_find_child(int, double *);
+  int id_find_child(int, double *, cellint *idfound = NULL);
   int id_find_parent(cellint, cellint &);
   cellint id_str2num(char *);
   void id_num2str(cellint, char *);
@@ -25,10 +25,11 @@ using namespace SPARTA_NS;
    pt can be on any boundary of parent cell
    if I don't store child cell as owned or ghost, return -1 for unknown
    else return local index of child cell
+   if idfound is set, also return ID of child cell, even if unknown
    NOTE: replace recursive with while loop
 ------------------------------------------------------------------------- */
 
-int Grid::id_find_child(int iparent, double *x)
+int Grid::id_find_child(int iparent, double *x, cellint *idfound)
 {
   ParentCell *p = &pcells[iparent];
   double *lo = p->lo;
@@ -45,11 +46,12 @@ int Grid::id_find_child(int iparent, double *x)
 
   cellint ichild = iz*nx*ny + iy*nx + ix + 1;
   cellint idchild = p->id | (ichild << p->nbits);
+  if (idfound) *idfound = idchild;
 
   if (hash->find(idchild) == hash->end()) return -1;
   int index = (*hash)[idchild];
   if (index > 0) return index-1;
-  return id_find_child(-index-1,x);
+  return id_find_child(-index-1,x,idfound);
 }
 
 /* ----------------------------------------------------------------------
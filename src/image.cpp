@@ -46,6 +46,10 @@
 #include "version.h"
 #endif
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 using namespace SPARTA_NS;
 using namespace MathConst;
 
@@ -59,6 +63,19 @@ enum{CONTINUOUS,DISCRETE,SEQUENTIAL};
 enum{ABSOLUTE,FRACTIONAL};
 enum{NO,YES};
 
+/* ----------------------------------------------------------------------
+   index of calling thread, 0 if not threaded
+------------------------------------------------------------------------- */
+
+static inline int thread_index()
+{
+#if defined(_OPENMP)
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
 /* ---------------------------------------------------------------------- */
 
 Image::Image(SPARTA *sparta, int nmap_caller) : Pointers(sparta)
@@ -66,6 +83,11 @@ Image::Image(SPARTA *sparta, int nmap_caller) : Pointers(sparta)
   MPI_Comm_rank(world,&me);
   MPI_Comm_size(world,&nprocs);
 
+  nthreads = 1;
+#if defined(_OPENMP)
+  nthreads = omp_get_max_threads();
+#endif
+
   // defaults for 3d viz
 
   width = height = 512;
@@ -122,6 +144,13 @@ Image::Image(SPARTA *sparta, int nmap_caller) : Pointers(sparta)
   backLightColor[2] = 0.9;
 
   random = NULL;
+
+  depthBuffer = surfaceBuffer = NULL;
+  imageBuffer = rgbcopy = NULL;
+  raster = NULL;
+  recvcounts = displs = NULL;
+  sendbuf = recvbuf = NULL;
+  maxsend = maxrecv = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -138,10 +167,22 @@ Image::~Image()
   memory->destroy(depthBuffer);
   memory->destroy(surfaceBuffer);
   memory->destroy(imageBuffer);
-  memory->destroy(depthcopy);
-  memory->destroy(surfacecopy);
   memory->destroy(rgbcopy);
 
+  if (raster) {
+    for (int i = 1; i < nthreads; i++) {
+      memory->destroy(raster[i].depth);
+      memory->destroy(raster[i].surface);
+      memory->destroy(raster[i].rgb);
+    }
+    delete [] raster;
+  }
+
+  memory->destroy(recvcounts);
+  memory->destroy(displs);
+  memory->destroy(sendbuf);
+  memory->destroy(recvbuf);
+
   if (random) delete random; 
 }
 
@@ -156,9 +197,57 @@ void Image::buffers()
   memory->create(depthBuffer,npixels,"image:depthBuffer");
   memory->create(surfaceBuffer,2*npixels,"image:surfaceBuffer");
   memory->create(imageBuffer,3*npixels,"image:imageBuffer");
-  memory->create(depthcopy,npixels,"image:depthcopy");
-  memory->create(surfacecopy,2*npixels,"image:surfacecopy");
   memory->create(rgbcopy,3*npixels,"image:rgbcopy");
+
+  // thread 0 rasterizes into image buffers, other threads into their own
+  // depth of extra threads is reset to -1 as they are merged
+
+  raster = new Raster[nthreads];
+  raster[0].depth = depthBuffer;
+  raster[0].surface = surfaceBuffer;
+  raster[0].rgb = imageBuffer;
+
+  for (int i = 1; i < nthreads; i++) {
+    memory->create(raster[i].depth,npixels,"image:depth");
+    memory->create(raster[i].surface,2*npixels,"image:surface");
+    memory->create(raster[i].rgb,3*npixels,"image:rgb");
+    for (int j = 0; j < npixels; j++) raster[i].depth[j] = -1;
+  }
+
+  for (int i = 0; i < nthreads; i++) {
+    raster[i].xlo = raster[i].ylo = 0;
+    raster[i].xhi = raster[i].yhi = -1;
+  }
+
+  // binary-swap compositing is done by a power-of-2 # of active procs
+  // first 2*nextra procs are paired, odd proc of each pair folds into even
+  // active procs are thus ordered the same as procs
+
+  nactive = 1;
+  while (2*nactive <= nprocs) nactive *= 2;
+  int nextra = nprocs - nactive;
+
+  if (me < 2*nextra) iactive = (me % 2) ? -1 : me/2;
+  else iactive = me - nextra;
+
+  rowlo = 0;
+  rowhi = -1;
+  if (iactive >= 0) active_rows(iactive,rowlo,rowhi);
+
+  // counts and displacements in pixels of rows each proc owns at the end
+
+  memory->create(recvcounts,nprocs,"image:recvcounts");
+  memory->create(displs,nprocs,"image:displs");
+
+  int lo,hi;
+  for (int iproc = 0; iproc < nprocs; iproc++) {
+    recvcounts[iproc] = displs[iproc] = 0;
+    if (iproc < 2*nextra && iproc % 2) continue;
+    if (iproc < 2*nextra) active_rows(iproc/2,lo,hi);
+    else active_rows(iproc-nextra,lo,hi);
+    recvcounts[iproc] = (hi-lo+1) * width;
+    displs[iproc] = lo * width;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -295,75 +384,331 @@ void Image::clear()
       imageBuffer[iy * width * 3 + ix * 3 + 2] = blue;
       depthBuffer[iy * width + ix] = -1;
     }
+
+  raster[0].xlo = raster[0].ylo = 0;
+  raster[0].xhi = raster[0].yhi = -1;
 }
 
 /* ----------------------------------------------------------------------
    merge image from each processor into one composite image
    done pixel by pixel, respecting depth buffer
-   hi procs send to lo procs, cascading down logarithmically
+   first merge images drawn by my threads
+   then sort-last binary-swap compositing:
+     procs beyond a power of 2 fold their image into a neighbor proc,
+     at each stage active procs pair up and split their current rows,
+     sending the half they give up, clipped to their drawn bounding box
+   each active proc ends up owning 1/P of the rows of the final image
+   gather final image to proc 0
 ------------------------------------------------------------------------- */
 
 void Image::merge()
 {
-  MPI_Request requests[3];
-  MPI_Status statuses[3];
-
-  int nhalf = 1;
-  while (nhalf < nprocs) nhalf *= 2;
-  nhalf /= 2;
-
-  while (nhalf) {
-    if (me < nhalf && me+nhalf < nprocs) {
-      MPI_Irecv(rgbcopy,npixels*3,MPI_BYTE,me+nhalf,0,world,&requests[0]);
-      MPI_Irecv(depthcopy,npixels,MPI_DOUBLE,me+nhalf,0,world,&requests[1]);
-      if (ssao)
-	MPI_Irecv(surfacecopy,npixels*2,MPI_DOUBLE,
-		  me+nhalf,0,world,&requests[2]);
-      if (ssao) MPI_Waitall(3,requests,statuses);
-      else MPI_Waitall(2,requests,statuses);
-
-      for (int i = 0; i < npixels; i++) {
-        if (depthBuffer[i] < 0 || (depthcopy[i] >= 0 && 
-				   depthcopy[i] < depthBuffer[i])) {
-          depthBuffer[i] = depthcopy[i];
-          imageBuffer[i*3+0] = rgbcopy[i*3+0];
-          imageBuffer[i*3+1] = rgbcopy[i*3+1];
-          imageBuffer[i*3+2] = rgbcopy[i*3+2];
-          if (ssao) {
-            surfaceBuffer[i*2+0] = surfacecopy[i*2+0];
-            surfaceBuffer[i*2+1] = surfacecopy[i*2+1];
-          }
-        }
-      }
+  int rect[5];
+  MPI_Status status;
+
+  if (nthreads > 1) merge_threads();
+
+  // fold odd procs of first 2*nextra procs into even procs
+  // even proc is lower, so it wins ties in depth
+
+  int nextra = nprocs - nactive;
 
-    } else if (me >= nhalf && me < 2*nhalf) {
-      MPI_Send(imageBuffer,npixels*3,MPI_BYTE,me-nhalf,0,world);
-      MPI_Send(depthBuffer,npixels,MPI_DOUBLE,me-nhalf,0,world);
-      if (ssao) MPI_Send(surfaceBuffer,npixels*2,MPI_DOUBLE,me-nhalf,0,world);
+  if (me < 2*nextra) {
+    if (me % 2) {
+      pack(0,height-1,rect);
+      MPI_Send(rect,5,MPI_INT,me-1,0,world);
+      if (rect[4]) MPI_Send(sendbuf,rect[4],MPI_BYTE,me-1,0,world);
+    } else {
+      MPI_Recv(rect,5,MPI_INT,me+1,0,world,&status);
+      grow_recv(rect[4]);
+      if (rect[4])
+        MPI_Recv(recvbuf,rect[4],MPI_BYTE,me+1,0,world,&status);
+      composite(rect,recvbuf,0);
     }
+  }
+
+  // binary swap among active procs
+  // partners at each stage own the same rows, lower partner keeps lower half
+  // data of lower partner comes from lower procs, so it wins ties in depth,
+  //   which matches order in which a single proc would draw
+
+  if (iactive >= 0) {
+    int lo = 0;
+    int hi = height-1;
+    int ipartner,partner,mid,keeplo,keephi,sendlo,sendhi;
+    int recvrect[5];
+
+    for (int k = 1; k < nactive; k *= 2) {
+      ipartner = iactive ^ k;
+      if (ipartner < nextra) partner = 2*ipartner;
+      else partner = ipartner + nextra;
+
+      mid = (lo+hi+1)/2;
+      if (iactive & k) {
+        keeplo = mid; keephi = hi;
+        sendlo = lo; sendhi = mid-1;
+      } else {
+        keeplo = lo; keephi = mid-1;
+        sendlo = mid; sendhi = hi;
+      }
+
+      pack(sendlo,sendhi,rect);
+      MPI_Sendrecv(rect,5,MPI_INT,partner,0,
+                   recvrect,5,MPI_INT,partner,0,world,&status);
+      grow_recv(recvrect[4]);
+      MPI_Sendrecv(sendbuf,rect[4],MPI_BYTE,partner,0,
+                   recvbuf,recvrect[4],MPI_BYTE,partner,0,world,&status);
+
+      Raster *r = &raster[0];
+      r->ylo = MAX(r->ylo,keeplo);
+      r->yhi = MIN(r->yhi,keephi);
+      if (r->ylo > r->yhi) {
+        r->xlo = r->ylo = 0;
+        r->xhi = r->yhi = -1;
+      }
+
+      composite(recvrect,recvbuf,ipartner < iactive);
 
-    nhalf /= 2;
+      lo = keeplo;
+      hi = keephi;
+    }
   }
 
   // extra SSAO enhancement
-  // bcast full image to all procs
+  // gather full image on all procs
   // each works on subset of pixels
   // gather result back to proc 0
 
+  int nrows = (rowhi-rowlo+1) * width;
+
   if (ssao) {
-    MPI_Bcast(imageBuffer,npixels*3,MPI_BYTE,0,world);
-    MPI_Bcast(surfaceBuffer,npixels*2,MPI_DOUBLE,0,world);
-    MPI_Bcast(depthBuffer,npixels,MPI_DOUBLE,0,world);
+    MPI_Datatype rgbtype,surftype;
+    MPI_Type_contiguous(3,MPI_BYTE,&rgbtype);
+    MPI_Type_commit(&rgbtype);
+    MPI_Type_contiguous(2,MPI_DOUBLE,&surftype);
+    MPI_Type_commit(&surftype);
+
+    MPI_Allgatherv(MPI_IN_PLACE,nrows,rgbtype,
+                   imageBuffer,recvcounts,displs,rgbtype,world);
+    MPI_Allgatherv(MPI_IN_PLACE,nrows,surftype,
+                   surfaceBuffer,recvcounts,displs,surftype,world);
+    MPI_Allgatherv(MPI_IN_PLACE,nrows,MPI_DOUBLE,
+                   depthBuffer,recvcounts,displs,MPI_DOUBLE,world);
+
+    MPI_Type_free(&rgbtype);
+    MPI_Type_free(&surftype);
+
     compute_SSAO();
+    if (me == 0) memcpy(rgbcopy,imageBuffer,3*npixels);
     int pixelPart = height/nprocs * width*3;
     MPI_Gather(imageBuffer+me*pixelPart,pixelPart,MPI_BYTE,
                rgbcopy,pixelPart,MPI_BYTE,0,world);
-    writeBuffer = rgbcopy;
   } else {
-    writeBuffer = imageBuffer;
+    MPI_Datatype rgbtype;
+    MPI_Type_contiguous(3,MPI_BYTE,&rgbtype);
+    MPI_Type_commit(&rgbtype);
+    MPI_Gatherv(&imageBuffer[3*rowlo*width],nrows,rgbtype,
+                rgbcopy,recvcounts,displs,rgbtype,0,world);
+    MPI_Type_free(&rgbtype);
+  }
+
+  writeBuffer = rgbcopy;
+}
+
+/* ----------------------------------------------------------------------
+   merge images drawn by threads 1 to N-1 into image of thread 0
+   lower threads win ties in depth, they drew earlier objects
+   reset depth of merged threads within their bounding box
+------------------------------------------------------------------------- */
+
+void Image::merge_threads()
+{
+  int ix,iy,i;
+  double depth;
+
+  Raster *r0 = &raster[0];
+
+  for (int ithread = 1; ithread < nthreads; ithread++) {
+    Raster *r = &raster[ithread];
+    if (r->xlo > r->xhi) continue;
+
+    for (iy = r->ylo; iy <= r->yhi; iy++)
+      for (ix = r->xlo; ix <= r->xhi; ix++) {
+        i = iy*width + ix;
+        depth = r->depth[i];
+        if (depth < 0) continue;
+        if (r0->depth[i] < 0 || depth < r0->depth[i]) {
+          r0->depth[i] = depth;
+          r0->surface[2*i] = r->surface[2*i];
+          r0->surface[2*i+1] = r->surface[2*i+1];
+          r0->rgb[3*i] = r->rgb[3*i];
+          r0->rgb[3*i+1] = r->rgb[3*i+1];
+          r0->rgb[3*i+2] = r->rgb[3*i+2];
+        }
+        r->depth[i] = -1;
+      }
+
+    if (r0->xlo > r0->xhi) {
+      r0->xlo = r->xlo; r0->xhi = r->xhi;
+      r0->ylo = r->ylo; r0->yhi = r->yhi;
+    } else {
+      r0->xlo = MIN(r0->xlo,r->xlo); r0->xhi = MAX(r0->xhi,r->xhi);
+      r0->ylo = MIN(r0->ylo,r->ylo); r0->yhi = MAX(r0->yhi,r->yhi);
+    }
+
+    r->xlo = r->ylo = 0;
+    r->xhi = r->yhi = -1;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   pack my pixels in rows lo to hi, clipped to my bounding box, into sendbuf
+   rect = xlo,xhi,ylo,yhi of packed pixels, and # of packed bytes
+   pixels are packed as depths, then surfaces if SSAO, then RGB values
+------------------------------------------------------------------------- */
+
+void Image::pack(int lo, int hi, int *rect)
+{
+  Raster *r = &raster[0];
+
+  rect[0] = r->xlo;
+  rect[1] = r->xhi;
+  rect[2] = MAX(r->ylo,lo);
+  rect[3] = MIN(r->yhi,hi);
+  rect[4] = 0;
+
+  if (rect[0] > rect[1] || rect[2] > rect[3]) {
+    rect[0] = rect[2] = 0;
+    rect[1] = rect[3] = -1;
+    return;
+  }
+
+  int nx = rect[1] - rect[0] + 1;
+  int n = nx * (rect[3] - rect[2] + 1);
+  int ndouble = ssao ? 3*n : n;
+  int nbytes = ndouble*sizeof(double) + 3*n;
+
+  if (nbytes > maxsend) {
+    maxsend = nbytes;
+    memory->destroy(sendbuf);
+    memory->create(sendbuf,maxsend,"image:sendbuf");
+  }
+
+  double *dbuf = (double *) sendbuf;
+  char *cbuf = &sendbuf[ndouble*sizeof(double)];
+  int iy,m;
+
+  m = 0;
+  for (iy = rect[2]; iy <= rect[3]; iy++) {
+    memcpy(&dbuf[m],&depthBuffer[iy*width+rect[0]],nx*sizeof(double));
+    m += nx;
+  }
+  if (ssao) {
+    for (iy = rect[2]; iy <= rect[3]; iy++) {
+      memcpy(&dbuf[m],&surfaceBuffer[2*(iy*width+rect[0])],
+             2*nx*sizeof(double));
+      m += 2*nx;
+    }
+  }
+  m = 0;
+  for (iy = rect[2]; iy <= rect[3]; iy++) {
+    memcpy(&cbuf[m],&imageBuffer[3*(iy*width+rect[0])],3*nx);
+    m += 3*nx;
+  }
+
+  rect[4] = nbytes;
+}
+
+/* ----------------------------------------------------------------------
+   insure recvbuf can hold nbytes
+------------------------------------------------------------------------- */
+
+void Image::grow_recv(int nbytes)
+{
+  if (nbytes <= maxrecv) return;
+  maxrecv = nbytes;
+  memory->destroy(recvbuf);
+  memory->create(recvbuf,maxrecv,"image:recvbuf");
+}
+
+/* ----------------------------------------------------------------------
+   composite pixels packed by another proc into my image
+   rect = bounds of packed pixels
+   lowtie = 1 if other proc wins ties in depth, else 0
+   expand my bounding box to include rect
+------------------------------------------------------------------------- */
+
+void Image::composite(int *rect, char *buf, int lowtie)
+{
+  if (rect[0] > rect[1] || rect[2] > rect[3]) return;
+
+  int nx = rect[1] - rect[0] + 1;
+  int n = nx * (rect[3] - rect[2] + 1);
+  int ndouble = ssao ? 3*n : n;
+
+  double *dbuf = (double *) buf;
+  double *sbuf = &dbuf[n];
+  char *cbuf = &buf[ndouble*sizeof(double)];
+
+  int ix,iy,i,m;
+  double depth,mine;
+
+  m = 0;
+  for (iy = rect[2]; iy <= rect[3]; iy++)
+    for (ix = rect[0]; ix <= rect[1]; ix++, m++) {
+      depth = dbuf[m];
+      if (depth < 0) continue;
+      i = iy*width + ix;
+      mine = depthBuffer[i];
+      if (mine < 0 || depth < mine || (lowtie && depth == mine)) {
+        depthBuffer[i] = depth;
+        imageBuffer[3*i] = cbuf[3*m];
+        imageBuffer[3*i+1] = cbuf[3*m+1];
+        imageBuffer[3*i+2] = cbuf[3*m+2];
+        if (ssao) {
+          surfaceBuffer[2*i] = sbuf[2*m];
+          surfaceBuffer[2*i+1] = sbuf[2*m+1];
+        }
+      }
+    }
+
+  Raster *r = &raster[0];
+  if (r->xlo > r->xhi) {
+    r->xlo = rect[0]; r->xhi = rect[1];
+    r->ylo = rect[2]; r->yhi = rect[3];
+  } else {
+    r->xlo = MIN(r->xlo,rect[0]); r->xhi = MAX(r->xhi,rect[1]);
+    r->ylo = MIN(r->ylo,rect[2]); r->yhi = MAX(r->yhi,rect[3]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   rows lo to hi of final image owned by active proc index after compositing
+   same halving of rows as binary swap in merge()
+------------------------------------------------------------------------- */
+
+void Image::active_rows(int index, int &lo, int &hi)
+{
+  lo = 0;
+  hi = height-1;
+
+  int mid;
+  for (int k = 1; k < nactive; k *= 2) {
+    mid = (lo+hi+1)/2;
+    if (index & k) lo = mid;
+    else hi = mid-1;
   }
 }
 
+/* ----------------------------------------------------------------------
+   raster that calling thread draws into
+------------------------------------------------------------------------- */
+
+Image::Raster *Image::thread_raster()
+{
+  return &raster[thread_index()];
+}
+
 /* ----------------------------------------------------------------------
    draw a line as a cylinder
 ------------------------------------------------------------------------- */
@@ -424,6 +769,7 @@ void Image::draw_axes(double (*axes)[3], double diameter)
 
 void Image::draw_sphere(double *x, double *surfaceColor, double diameter)
 {
+  Raster *r = thread_raster();
   int ix,iy;
   double projRad;
   double xlocal[3],surface[3];
@@ -474,7 +820,7 @@ void Image::draw_sphere(double *x, double *surfaceColor, double diameter)
       surface[1] /= radius;
       surface[2] /= radius;
 
-      draw_pixel (ix, iy, depth, surface, surfaceColor);
+      draw_pixel(r, ix, iy, depth, surface, surfaceColor);
     }
   }
 }
@@ -486,6 +832,7 @@ void Image::draw_sphere(double *x, double *surfaceColor, double diameter)
 
 void Image::draw_brick(double *x, double *surfaceColor, double *diameter)
 {
+  Raster *r = thread_raster();
   double xlocal[3],surface[3],normal[3];
   double t,tdir[3];
   double depth;
@@ -565,19 +912,19 @@ void Image::draw_brick(double *x, double *surfaceColor, double *diameter)
 	  case 0:
 	    if (yin & zin) {
 	      depth = dist - t;
-	      draw_pixel (ix, iy, depth, normal, surfaceColor);
+	      draw_pixel(r, ix, iy, depth, normal, surfaceColor);
 	    }
 	    break;
 	  case 1:
 	    if (xin & zin) {
 	      depth = dist - t;
-	      draw_pixel (ix, iy, depth, normal, surfaceColor);
+	      draw_pixel(r, ix, iy, depth, normal, surfaceColor);
 	    }
 	    break;
 	  case 2:
 	    if (xin & yin) {
 	      depth = dist - t;
-	      draw_pixel (ix, iy, depth, normal, surfaceColor);
+	      draw_pixel(r, ix, iy, depth, normal, surfaceColor);
 	    }
 	    break;
           }
@@ -599,6 +946,7 @@ void Image::draw_brick(double *x, double *surfaceColor, double *diameter)
 void Image::draw_cylinder(double *x, double *y,
 			  double *surfaceColor, double diameter, int sflag)
 {
+  Raster *r = thread_raster();
   double surface[3], normal[3];
   double mid[3],xaxis[3],yaxis[3],zaxis[3];
   double camLDir[3], camLRight[3], camLUp[3];
@@ -717,7 +1065,7 @@ void Image::draw_cylinder(double *x, double *y,
       surface[2] = MathExtra::dot3 (normal, camLDir);
 
       double depth = dist - t;
-      draw_pixel (ix, iy, depth, surface, surfaceColor);
+      draw_pixel(r, ix, iy, depth, surface, surfaceColor);
     }
   }
 }
@@ -728,6 +1076,7 @@ void Image::draw_cylinder(double *x, double *y,
 
 void Image::draw_triangle(double *x, double *y, double *z, double *surfaceColor)
 {
+  Raster *rst = thread_raster();
   double d1[3], d1len, d2[3], d2len, normal[3], invndotd;
   double xlocal[3], ylocal[3], zlocal[3];
   double surface[3];
@@ -850,25 +1199,38 @@ void Image::draw_triangle(double *x, double *y, double *z, double *surfaceColor)
       cNormal[2] = MathExtra::dot3(camDir, normal);
 
       depth = dist - t;
-      draw_pixel(ix,iy,depth,cNormal,surfaceColor);
+      draw_pixel(rst,ix,iy,depth,cNormal,surfaceColor);
     }
   }
 }
 
 /* ---------------------------------------------------------------------- */
 
-void Image::draw_pixel(int ix, int iy, double depth, 
+void Image::draw_pixel(Raster *r, int ix, int iy, double depth, 
 			   double *surface, double *surfaceColor)
 {
   double diffuseKey,diffuseFill,diffuseBack,specularKey;
+  double *depthBuffer = r->depth;
   if (depth < 0 || (depthBuffer[ix + iy*width] >= 0 && 
 		    depth >= depthBuffer[ix + iy*width])) return;
   depthBuffer[ix + iy*width] = depth;
+
+  // expand bounding box of drawn pixels
+
+  if (r->xlo > r->xhi) {
+    r->xlo = r->xhi = ix;
+    r->ylo = r->yhi = iy;
+  } else {
+    if (ix < r->xlo) r->xlo = ix;
+    else if (ix > r->xhi) r->xhi = ix;
+    if (iy < r->ylo) r->ylo = iy;
+    else if (iy > r->yhi) r->yhi = iy;
+  }
       
   // store only the tangent relative to the camera normal (0,0,-1)
 
-  surfaceBuffer[0 + ix * 2 + iy*width * 2] = surface[1];
-  surfaceBuffer[1 + ix * 2 + iy*width * 2] = -surface[0];
+  r->surface[0 + ix * 2 + iy*width * 2] = surface[1];
+  r->surface[1 + ix * 2 + iy*width * 2] = -surface[0];
       
   diffuseKey = saturate(MathExtra::dot3(surface, keyLightDir));
   diffuseFill = saturate(MathExtra::dot3(surface, fillLightDir));
@@ -901,9 +1263,9 @@ void Image::draw_pixel(int ix, int iy, double depth,
   c[1] = saturate(c[1]);
   c[2] = saturate(c[2]);
       
-  imageBuffer[0 + ix*3 + iy*width*3] = static_cast<int>(c[0] * 255.0);
-  imageBuffer[1 + ix*3 + iy*width*3] = static_cast<int>(c[1] * 255.0);
-  imageBuffer[2 + ix*3 + iy*width*3] = static_cast<int>(c[2] * 255.0);
+  r->rgb[0 + ix*3 + iy*width*3] = static_cast<int>(c[0] * 255.0);
+  r->rgb[1 + ix*3 + iy*width*3] = static_cast<int>(c[1] * 255.0);
+  r->rgb[2 + ix*3 + iy*width*3] = static_cast<int>(c[2] * 255.0);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -1730,6 +2092,8 @@ ColorMap::ColorMap(SPARTA *sparta, Image *caller) : Pointers(sparta)
   mentry[0].color = image->color2rgb("blue");
   mentry[1].single = MAXVALUE;
   mentry[1].color = image->color2rgb("red");
+
+  interpolate = new double[3*image->nthreads];
 }
 
 /* ---------------------------------------------------------------------- */
@@ -1737,6 +2101,7 @@ ColorMap::ColorMap(SPARTA *sparta, Image *caller) : Pointers(sparta)
 ColorMap::~ColorMap()
 {
   delete [] mentry;
+  delete [] interpolate;
 }
 
 /* ----------------------------------------------------------------------
@@ -1913,17 +2278,18 @@ double *ColorMap::value2color(double value)
   }
 
   if (mstyle == CONTINUOUS) {
+    double *rgb = &interpolate[3*thread_index()];
     for (int i = 0; i < nentry-1; i++)
       if (value >= mentry[i].svalue && value <= mentry[i+1].svalue) {
         double fraction = (value-mentry[i].svalue) /
           (mentry[i+1].svalue-mentry[i].svalue);
-        interpolate[0] = mentry[i].color[0] +
+        rgb[0] = mentry[i].color[0] +
           fraction*(mentry[i+1].color[0]-mentry[i].color[0]);
-        interpolate[1] = mentry[i].color[1] +
+        rgb[1] = mentry[i].color[1] +
           fraction*(mentry[i+1].color[1]-mentry[i].color[1]);
-        interpolate[2] = mentry[i].color[2] +
+        rgb[2] = mentry[i].color[2] +
           fraction*(mentry[i+1].color[2]-mentry[i].color[2]);
-        return interpolate;
+        return rgb;
       }
   } else if (mstyle == DISCRETE) {
     for (int i = 0; i < nentry; i++)
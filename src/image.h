@@ -67,6 +67,8 @@ class Image : protected Pointers {
   double *color2rgb(const char *, int index=0);
   int default_colors();
 
+  int nthreads;                 // # of threads that can rasterize at once
+
  private:
   int me,nprocs;
   int npixels;
@@ -75,9 +77,30 @@ class Image : protected Pointers {
   int nmap;
 
   double *depthBuffer,*surfaceBuffer;
-  double *depthcopy,*surfacecopy;
   char *imageBuffer,*rgbcopy,*writeBuffer;
 
+  // per-thread rasters, thread 0 draws into depth/surface/imageBuffer
+  // other threads draw into their own buffers, merged into thread 0's
+
+  struct Raster {
+    double *depth;              // depth buffer, -1 = no pixel drawn
+    double *surface;            // 2 surface tangent values per pixel
+    char *rgb;                  // 3 color values per pixel
+    int xlo,xhi,ylo,yhi;        // bounding box of drawn pixels (inclusive)
+                                // empty if xlo > xhi
+  };
+
+  Raster *raster;
+
+  // binary-swap compositing
+
+  int nactive;                  // # of procs that composite = power of 2
+  int iactive;                  // my index in active procs, -1 if not active
+  int rowlo,rowhi;              // rows of final image I own after compositing
+  int *recvcounts,*displs;      // Gatherv params for final image on proc 0
+  char *sendbuf,*recvbuf;       // packed pixel data exchanged between procs
+  int maxsend,maxrecv;          // allocated size of sendbuf,recvbuf
+
   // constant view params
 
   double FOV;
@@ -134,7 +157,13 @@ class Image : protected Pointers {
 
   // internal methods
 
-  void draw_pixel(int, int, double, double *, double*);
+  void draw_pixel(Raster *, int, int, double, double *, double*);
+  Raster *thread_raster();
+  void merge_threads();
+  void pack(int, int, int *);
+  void grow_recv(int);
+  void composite(int *, char *, int);
+  void active_rows(int, int &, int &);
   void compute_SSAO();
 
   // inline functions
@@ -171,7 +200,8 @@ class ColorMap : protected Pointers {
   double mlovalue,mhivalue;        // user bounds if NUMERIC
   double locurrent,hicurrent;      // current bounds for this snapshot
   double mbinsize,mbinsizeinv;     // bin size for sequential color map
-  double interpolate[3];           // local storage for returned RGB color
+  double *interpolate;             // local storage for returned RGB color
+                                   // 3 values per thread
 
   struct MapEntry {
     int single,lo,hi;              // NUMERIC or MINVALUE or MAXVALUE
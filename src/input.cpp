@@ -39,6 +39,7 @@
 #include "random_mars.h"
 #include "stats.h"
 #include "dump.h"
+#include "timer.h"
 #include "math_extra.h"
 #include "accelerator_kokkos.h"
 #include "error.h"
@@ -233,6 +234,45 @@ void Input::file(const char *filename)
   file();
 }
 
+/* ----------------------------------------------------------------------
+   process all input from filename, then return to the calling command
+   the current input file stack is set aside while filename is processed
+   caller must copy its own args first, since they are overwritten
+------------------------------------------------------------------------- */
+
+void Input::file_nested(const char *filename)
+{
+  FILE *saved_infile = infile;
+  FILE **saved_infiles = infiles;
+  int saved_nfile = nfile;
+  int saved_maxfile = maxfile;
+
+  infiles = NULL;
+  maxfile = 0;
+  nfile = 0;
+
+  if (me == 0) {
+    infile = fopen(filename,"r");
+    if (infile == NULL) {
+      char str[128];
+      sprintf(str,"Cannot open input script %s",filename);
+      error->one(FLERR,str);
+    }
+    maxfile = 1;
+    infiles = (FILE **) memory->smalloc(sizeof(FILE *),"input:infiles");
+    infiles[0] = infile;
+    nfile = 1;
+  }
+
+  file();
+
+  memory->sfree(infiles);
+  infile = saved_infile;
+  infiles = saved_infiles;
+  nfile = saved_nfile;
+  maxfile = saved_maxfile;
+}
+
 /* ----------------------------------------------------------------------
    copy command in single to line, parse and execute it
    return command name to caller
@@ -678,6 +718,7 @@ int Input::execute_command()
   else if (!strcmp(command,"global")) global();
   else if (!strcmp(command,"group")) group();
   else if (!strcmp(command,"package")) package();
+  else if (!strcmp(command,"memory")) memory_command();
   else if (!strcmp(command,"mixture")) mixture();
   else if (!strcmp(command,"react")) react_command();
   else if (!strcmp(command,"react_modify")) react_modify();
@@ -692,6 +733,8 @@ int Input::execute_command()
   else if (!strcmp(command,"surf_collide")) surf_collide();
   else if (!strcmp(command,"surf_modify")) surf_modify();
   else if (!strcmp(command,"surf_react")) surf_react();
+  else if (!strcmp(command,"timer")) timer_command();
+  else if (!strcmp(command,"trace")) trace_command();
   else if (!strcmp(command,"timestep")) timestep();
   else if (!strcmp(command,"uncompute")) uncompute();
   else if (!strcmp(command,"undump")) undump();
@@ -1298,6 +1341,17 @@ void Input::group()
 
 /* ---------------------------------------------------------------------- */
 
+void Input::memory_command()
+{
+  if (narg > 1) error->all(FLERR,"Illegal memory command");
+  int n = 10;
+  if (narg == 1) n = atoi(arg[0]);
+  if (n <= 0) error->all(FLERR,"Illegal memory command");
+  memory->report(n);
+}
+
+/* ---------------------------------------------------------------------- */
+
 void Input::mixture()
 {
   particle->add_mixture(narg,arg);
@@ -1447,6 +1501,23 @@ void Input::timestep()
 
 /* ---------------------------------------------------------------------- */
 
+void Input::timer_command()
+{
+  timer->modify_params(narg,arg);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Input::trace_command()
+{
+  delete timer->trace;
+  timer->trace = NULL;
+  if (narg == 1 && strcmp(arg[0],"off") == 0) return;
+  timer->trace = new Trace(sparta,narg,arg);
+}
+
+/* ---------------------------------------------------------------------- */
+
 void Input::uncompute()
 {
   if (narg != 1) error->all(FLERR,"Illegal uncompute command");
@@ -30,6 +30,7 @@ class Input : protected Pointers {
   ~Input();
   void file();                   // process all input
   void file(const char *);       // process an input script
+  void file_nested(const char *);  // process an input script, then return
   char *one(const char *);       // process a single command
   void substitute(char *&, char *&, int &, int &, int);  
                                  // substitute for variables in a string
@@ -89,6 +90,7 @@ class Input : protected Pointers {
   void fix();
   void global();
   void group();
+  void memory_command();
   void mixture();
   void package();
   void react_command();
@@ -104,6 +106,8 @@ class Input : protected Pointers {
   void surf_collide();
   void surf_modify();
   void surf_react();
+  void timer_command();
+  void trace_command();
   void timestep();
   void uncompute();
   void undump();
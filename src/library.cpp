@@ -19,6 +19,7 @@
 #include "mpi.h"
 #include "string.h"
 #include "stdlib.h"
+#include "stddef.h"
 #include "library.h"
 #include "sparta.h"
 #include "input.h"
@@ -27,9 +28,27 @@
 #include "modify.h"
 #include "compute.h"
 #include "variable.h"
+#include "grid.h"
+#include "surf.h"
+#include "fix.h"
+#include "memory.h"
+
+#ifdef SPARTA_MAP
+#include <map>
+#elif SPARTA_UNORDERED_MAP
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif
 
 using namespace SPARTA_NS;
 
+enum{INT,DOUBLE};                      // several files
+enum{VIEW_INT,VIEW_DOUBLE,VIEW_INT64}; // same as sparta_view type
+enum{PARTICLE,GRID,SURF};              // same as sparta_view kind
+
+static int extract_view(SPARTA *, int, char *, sparta_view *, int);
+
 /* ----------------------------------------------------------------------
    create an instance of SPARTA and return pointer to it
    pass in command-line args and MPI communicator to run on
@@ -273,3 +292,403 @@ void *sparta_extract_variable(void *ptr, char *name)
 
   return NULL;
 }
+
+/* ----------------------------------------------------------------------
+   extract a zero-copy view of per-particle data I own
+   name = id, species, cell, x, v, erot, evib, weight,
+     or name of a custom per-particle attribute
+   cell = index of local grid cell the particle is in
+   returns 0 and fills view, or -1 if name is not recognized
+   rows are in the order particles are stored on this proc, which changes
+     whenever particles move between cells or procs,
+     use an "id" view to identify them
+   IMPORTANT: view data is only valid until SPARTA reallocates the
+     underlying array, e.g. when particles are added during a run,
+     check with sparta_view_valid() before reusing a view
+------------------------------------------------------------------------- */
+
+int sparta_extract_particle(void *ptr, char *name, sparta_view *view)
+{
+  return extract_view((SPARTA *) ptr,PARTICLE,name,view,1);
+}
+
+/* ----------------------------------------------------------------------
+   extract a zero-copy view of per-grid data for child cells I own
+   name = id, nsplit, nsurf, lo, hi, volume, count,
+     c_ID, c_ID[N], f_ID, f_ID[N] for a per-grid compute or fix
+   rows include split cells and their sub cells, which share the
+     split cell's ID, use an "nsplit" view to tell them apart
+   for c_ID or f_ID of an array, the view has all columns,
+     for c_ID[N] or f_ID[N] it has column N
+   a compute is invoked if it is not current, as in sparta_extract_compute()
+   a compute whose values require post-processing, e.g. compute grid,
+     shares one output vector for all its columns,
+     so c_ID[N] is overwritten by the next extraction of another column
+   returns 0 and fills view, or -1 if name is not recognized
+------------------------------------------------------------------------- */
+
+int sparta_extract_grid(void *ptr, char *name, sparta_view *view)
+{
+  return extract_view((SPARTA *) ptr,GRID,name,view,1);
+}
+
+/* ----------------------------------------------------------------------
+   extract a zero-copy view of per-surf data for surf elements I own
+   name = index, c_ID, c_ID[N], f_ID, f_ID[N] for a per-surf compute or fix
+   index = global index of each surf, its ID is index+1
+   returns 0 and fills view, or -1 if name is not recognized
+     or the compute or fix does not store per-surf values,
+     e.g. compute surf only tallies values for fix ave/surf to store
+------------------------------------------------------------------------- */
+
+int sparta_extract_surf(void *ptr, char *name, sparta_view *view)
+{
+  return extract_view((SPARTA *) ptr,SURF,name,view,1);
+}
+
+/* ----------------------------------------------------------------------
+   check if a view still describes the data it was extracted for
+   returns 1 if its data pointer and shape are unchanged, else 0
+   if no SPARTA memory has been reallocated or freed since the view was
+     extracted or last checked, only the row count is checked
+   does not invoke computes, extract the view again to refresh values
+------------------------------------------------------------------------- */
+
+int sparta_view_valid(void *ptr, sparta_view *view)
+{
+  SPARTA *sparta = (SPARTA *) ptr;
+
+  if (view->version == sparta->memory->version()) {
+    int nrows;
+    if (view->kind == PARTICLE) nrows = sparta->particle->nlocal;
+    else if (view->kind == GRID) nrows = sparta->grid->nlocal;
+    else nrows = sparta->surf->nlocal;
+    if (nrows == view->nrows) return 1;
+    return 0;
+  }
+
+  sparta_view now;
+  if (extract_view(sparta,view->kind,view->name,&now,0)) return 0;
+  if (now.data != view->data || now.nrows != view->nrows ||
+      now.ncols != view->ncols || now.stride != view->stride) return 0;
+  view->version = now.version;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   gather the rows of a view from all procs to proc 0
+   must be called by all procs with a view of the same name
+   on proc 0, data is set to a buffer allocated by this function,
+     with all rows from proc 0, then proc 1, etc, each row ncols values
+     of the view's type, caller must free it with sparta_free()
+   on other procs, data is set to NULL
+   returns total # of rows, or -1 if the gathered data would exceed 2^31 bytes
+   gather an "id" view the same way to identify the rows
+------------------------------------------------------------------------- */
+
+int sparta_gather(void *ptr, sparta_view *view, void **data)
+{
+  SPARTA *sparta = (SPARTA *) ptr;
+  MPI_Comm world = sparta->world;
+  int me,nprocs;
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+  *data = NULL;
+
+  int size = sizeof(int);
+  if (view->type == VIEW_DOUBLE) size = sizeof(double);
+  else if (view->type == VIEW_INT64) size = sizeof(int64_t);
+  int rowbytes = view->ncols * size;
+
+  bigint nbytes = (bigint) view->nrows * rowbytes;
+  bigint nbytesall;
+  MPI_Allreduce(&nbytes,&nbytesall,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  if (nbytesall > MAXSMALLINT) return -1;
+
+  // pack my rows contiguously, dropping the view's stride
+
+  char *sendbuf = (char *) malloc(nbytes > 0 ? nbytes : 1);
+  char *src = (char *) view->data;
+  for (int i = 0; i < view->nrows; i++)
+    memcpy(&sendbuf[i*rowbytes],&src[(bigint) i*view->stride],rowbytes);
+
+  int nsend = nbytes;
+  int *recvcounts = NULL;
+  int *displs = NULL;
+  char *recvbuf = NULL;
+  if (me == 0) {
+    recvcounts = new int[nprocs];
+    displs = new int[nprocs];
+    recvbuf = (char *) malloc(nbytesall > 0 ? nbytesall : 1);
+  }
+  MPI_Gather(&nsend,1,MPI_INT,recvcounts,1,MPI_INT,0,world);
+  if (me == 0) {
+    displs[0] = 0;
+    for (int iproc = 1; iproc < nprocs; iproc++)
+      displs[iproc] = displs[iproc-1] + recvcounts[iproc-1];
+  }
+  MPI_Gatherv(sendbuf,nsend,MPI_CHAR,recvbuf,recvcounts,displs,MPI_CHAR,
+              0,world);
+
+  free(sendbuf);
+  delete [] recvcounts;
+  delete [] displs;
+
+  *data = (void *) recvbuf;
+  return nbytesall / rowbytes;
+}
+
+/* ----------------------------------------------------------------------
+   set values in the rows of a view that match a list of IDs
+   must be called by all procs, each with the same list
+   n = # of IDs
+   ids = particle IDs (int), grid cell IDs (cellint, which is a 64-bit int
+     if SPARTA was built with -DSPARTA_BIGBIG, else int), or surf IDs (int)
+   data = n rows of ncols values of the view's type, one row per ID
+   an ID matching no owned row is ignored, a grid cell ID sets the
+     split cell and all its sub cells
+   returns total # of rows set on all procs
+------------------------------------------------------------------------- */
+
+int sparta_scatter(void *ptr, sparta_view *view, int n, void *ids, void *data)
+{
+  SPARTA *sparta = (SPARTA *) ptr;
+
+  int size = sizeof(int);
+  if (view->type == VIEW_DOUBLE) size = sizeof(double);
+  else if (view->type == VIEW_INT64) size = sizeof(int64_t);
+  int rowbytes = view->ncols * size;
+
+  // hash the IDs to their index in list
+
+#ifdef SPARTA_MAP
+  std::map<bigint,int> hash;
+#elif SPARTA_UNORDERED_MAP
+  std::unordered_map<bigint,int> hash;
+#else
+  std::tr1::unordered_map<bigint,int> hash;
+#endif
+
+  for (int i = 0; i < n; i++) {
+    if (view->kind == GRID) hash[((cellint *) ids)[i]] = i;
+    else hash[((int *) ids)[i]] = i;
+  }
+
+  Particle::OnePart *particles = sparta->particle->particles;
+  Grid::ChildCell *cells = sparta->grid->cells;
+  int *mysurfs = sparta->surf->mysurfs;
+  char *dest = (char *) view->data;
+  char *src = (char *) data;
+
+  bigint id;
+  int nset = 0;
+  for (int i = 0; i < view->nrows; i++) {
+    if (view->kind == PARTICLE) id = particles[i].id;
+    else if (view->kind == GRID) id = cells[i].id;
+    else id = mysurfs[i] + 1;
+    if (hash.find(id) == hash.end()) continue;
+    memcpy(&dest[(bigint) i*view->stride],&src[(bigint) hash[id]*rowbytes],
+           rowbytes);
+    nset++;
+  }
+
+  int nsetall;
+  MPI_Allreduce(&nset,&nsetall,1,MPI_INT,MPI_SUM,sparta->world);
+  return nsetall;
+}
+
+/* ----------------------------------------------------------------------
+   fill view with the location and shape of named per-particle,
+     per-grid or per-surf data
+   invoke = 1 to invoke a compute that is not current
+   return 0 if successful, -1 if name is not recognized
+------------------------------------------------------------------------- */
+
+static int extract_view(SPARTA *sparta, int kind, char *name,
+                        sparta_view *view, int invoke)
+{
+  if (strlen(name) >= sizeof(view->name)) return -1;
+  strcpy(view->name,name);
+  view->kind = kind;
+  view->version = sparta->memory->version();
+  view->ncols = 1;
+
+  if (kind == PARTICLE) {
+    Particle *particle = sparta->particle;
+    Particle::OnePart *p = particle->particles;
+    view->nrows = particle->nlocal;
+    view->stride = sizeof(Particle::OnePart);
+    view->type = VIEW_INT;
+    view->data = NULL;
+
+    size_t offset;
+    if (strcmp(name,"id") == 0) offset = offsetof(Particle::OnePart,id);
+    else if (strcmp(name,"species") == 0)
+      offset = offsetof(Particle::OnePart,ispecies);
+    else if (strcmp(name,"cell") == 0)
+      offset = offsetof(Particle::OnePart,icell);
+    else {
+      view->type = VIEW_DOUBLE;
+      if (strcmp(name,"x") == 0) {
+        offset = offsetof(Particle::OnePart,x);
+        view->ncols = 3;
+      } else if (strcmp(name,"v") == 0) {
+        offset = offsetof(Particle::OnePart,v);
+        view->ncols = 3;
+      } else if (strcmp(name,"erot") == 0)
+        offset = offsetof(Particle::OnePart,erot);
+      else if (strcmp(name,"evib") == 0)
+        offset = offsetof(Particle::OnePart,evib);
+      else if (strcmp(name,"weight") == 0)
+        offset = offsetof(Particle::OnePart,weight);
+      else {
+
+        // custom attribute, stored in its own vector or array
+
+        int index = particle->find_custom(name);
+        if (index < 0) return -1;
+        int type = particle->etype[index];
+        int size = particle->esize[index];
+        int w = particle->ewhich[index];
+        view->type = (type == INT) ? VIEW_INT : VIEW_DOUBLE;
+        view->ncols = (size == 0) ? 1 : size;
+        view->stride = view->ncols *
+          ((type == INT) ? sizeof(int) : sizeof(double));
+        if (type == INT && size == 0) view->data = particle->eivec[w];
+        else if (type == INT && particle->eiarray[w])
+          view->data = particle->eiarray[w][0];
+        else if (type == DOUBLE && size == 0)
+          view->data = particle->edvec[w];
+        else if (type == DOUBLE && particle->edarray[w])
+          view->data = particle->edarray[w][0];
+        if (view->nrows == 0) view->data = NULL;
+        return 0;
+      }
+    }
+    if (p && view->nrows) view->data = (void *) ((char *) p + offset);
+    return 0;
+  }
+
+  Grid *grid = sparta->grid;
+  Surf *surf = sparta->surf;
+  view->nrows = (kind == GRID) ? grid->nlocal : surf->nlocal;
+  view->data = NULL;
+
+  if (kind == GRID && strncmp(name,"c_",2) && strncmp(name,"f_",2)) {
+    Grid::ChildCell *c = grid->cells;
+    Grid::ChildInfo *ci = grid->cinfo;
+    view->stride = sizeof(Grid::ChildCell);
+    view->type = VIEW_INT;
+    void *data;
+    if (strcmp(name,"id") == 0) {
+      if (sizeof(cellint) == sizeof(int64_t)) view->type = VIEW_INT64;
+      data = &c->id;
+    } else if (strcmp(name,"nsplit") == 0) data = &c->nsplit;
+    else if (strcmp(name,"nsurf") == 0) data = &c->nsurf;
+    else if (strcmp(name,"lo") == 0 || strcmp(name,"hi") == 0) {
+      view->type = VIEW_DOUBLE;
+      view->ncols = 3;
+      data = (strcmp(name,"lo") == 0) ? c->lo : c->hi;
+    } else if (strcmp(name,"volume") == 0 || strcmp(name,"count") == 0) {
+      view->stride = sizeof(Grid::ChildInfo);
+      if (strcmp(name,"count") == 0) data = &ci->count;
+      else {
+        view->type = VIEW_DOUBLE;
+        data = &ci->volume;
+      }
+    } else return -1;
+    if (view->nrows) view->data = data;
+    return 0;
+  }
+
+  if (kind == SURF && strcmp(name,"index") == 0) {
+    view->type = VIEW_INT;
+    view->stride = sizeof(int);
+    if (view->nrows) view->data = surf->mysurfs;
+    return 0;
+  }
+
+  // c_ID, c_ID[N], f_ID, f_ID[N]
+
+  if (strncmp(name,"c_",2) && strncmp(name,"f_",2)) return -1;
+
+  char id[64];
+  strcpy(id,&name[2]);
+  int index = 0;
+  char *ptr = strchr(id,'[');
+  if (ptr) {
+    if (id[strlen(id)-1] != ']') return -1;
+    index = atoi(ptr+1);
+    if (index <= 0) return -1;
+    *ptr = '\0';
+  }
+
+  int ncols,post;
+  double *vector;
+  double **array;
+
+  if (name[0] == 'c') {
+    int icompute = sparta->modify->find_compute(id);
+    if (icompute < 0) return -1;
+    Compute *compute = sparta->modify->compute[icompute];
+    if (kind == GRID) {
+      if (!compute->per_grid_flag) return -1;
+      if (invoke && compute->invoked_per_grid != sparta->update->ntimestep)
+        compute->compute_per_grid();
+      ncols = compute->size_per_grid_cols;
+      post = compute->post_process_grid_flag;
+      vector = compute->vector_grid;
+      array = compute->array_grid;
+    } else {
+      if (!compute->per_surf_flag || compute->surf_tally_flag) return -1;
+      if (invoke && compute->invoked_per_surf != sparta->update->ntimestep)
+        compute->compute_per_surf();
+      ncols = compute->size_per_surf_cols;
+      post = 0;
+      vector = compute->vector_surf;
+      array = compute->array_surf;
+    }
+
+    // values of a post-processed compute are produced one column
+    //   at a time in vector_grid
+
+    if (post) {
+      if (index > ncols || (ncols && index == 0)) return -1;
+      if (invoke) compute->post_process_grid(index,-1,1,NULL,NULL,NULL,1);
+      vector = compute->vector_grid;
+      ncols = index = 0;
+    }
+
+  } else {
+    int ifix = sparta->modify->find_fix(id);
+    if (ifix < 0) return -1;
+    Fix *fix = sparta->modify->fix[ifix];
+    if (kind == GRID) {
+      if (!fix->per_grid_flag) return -1;
+      ncols = fix->size_per_grid_cols;
+      vector = fix->vector_grid;
+      array = fix->array_grid;
+    } else {
+      if (!fix->per_surf_flag) return -1;
+      ncols = fix->size_per_surf_cols;
+      vector = fix->vector_surf;
+      array = fix->array_surf;
+    }
+  }
+
+  view->type = VIEW_DOUBLE;
+  if (ncols == 0) {
+    if (index) return -1;
+    if (vector == NULL && view->nrows) return -1;
+    view->stride = sizeof(double);
+    if (view->nrows) view->data = vector;
+  } else {
+    if (index > ncols) return -1;
+    if (array == NULL && view->nrows) return -1;
+    view->stride = ncols * sizeof(double);
+    if (index == 0) view->ncols = ncols;
+    if (view->nrows) view->data = &array[0][index ? index-1 : 0];
+  }
+
+  return 0;
+}
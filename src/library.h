@@ -25,6 +25,21 @@
 extern "C" {
 #endif
 
+/* zero-copy view of per-particle, per-grid or per-surf data on one proc
+   row i of column j is at (char *) data + i*stride + j*sizeof(value)
+   filled by sparta_extract_particle/grid/surf() */
+
+struct sparta_view {
+  void *data;          /* 1st value of 1st row, NULL if no rows */
+  int type;            /* 0 = int, 1 = double, 2 = 64-bit int */
+  int nrows;           /* # of owned particles, grid cells or surfs */
+  int ncols;           /* # of values per row, 1 for a vector */
+  int stride;          /* bytes between 1st values of successive rows */
+  int kind;            /* 0/1/2 = particle/grid/surf */
+  int version;         /* memory version when data was set */
+  char name[64];       /* name the view was extracted with */
+};
+
 void sparta_open(int, char **, MPI_Comm, void **);
 void sparta_open_no_mpi(int, char **, void **);
 void sparta_close(void *);
@@ -36,6 +51,13 @@ void *sparta_extract_global(void *, char *);
 void *sparta_extract_compute(void *, char *, int, int);
 void *sparta_extract_variable(void *, char *);
 
+int sparta_extract_particle(void *, char *, struct sparta_view *);
+int sparta_extract_grid(void *, char *, struct sparta_view *);
+int sparta_extract_surf(void *, char *, struct sparta_view *);
+int sparta_view_valid(void *, struct sparta_view *);
+int sparta_gather(void *, struct sparta_view *, void **);
+int sparta_scatter(void *, struct sparta_view *, int, void *, void *);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,6 +26,7 @@ namespace MathConst {
   static const double MY_PI3 = 1.04719755119659774615; // pi/3
   static const double MY_PI4 = 0.78539816339744830962; // pi/4
   static const double MY_PIS = 1.77245385090551602729; // sqrt(pi)
+  static const double MY_ISQRT2 = 0.70710678118654752440; // 1/sqrt(2)
 }
 
 }
@@ -0,0 +1,219 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "math_random.h"
+#include "random_park.h"
+#include "math_const.h"
+
+using namespace SPARTA_NS;
+using namespace MathConst;
+
+namespace MathRandom {
+
+/* ----------------------------------------------------------------------
+   fill vec with N uniform RNs in (0,1)
+------------------------------------------------------------------------- */
+
+void uniform(RanPark *random, int n, double *vec)
+{
+  for (int i = 0; i < n; i++) vec[i] = random->uniform();
+}
+
+/* ----------------------------------------------------------------------
+   fill vec with N gaussian RNs with zero mean and unit variance
+   Box-Muller in non-rejection form
+   RNs are drawn first, so transform loop has no branches and vectorizes
+------------------------------------------------------------------------- */
+
+void gaussian(RanPark *random, int n, double *vec)
+{
+  uniform(random,n,vec);
+
+  double r,theta;
+  for (int i = 0; i+1 < n; i += 2) {
+    r = sqrt(-2.0*log(vec[i]));
+    theta = MY_2PI*vec[i+1];
+    vec[i] = r*cos(theta);
+    vec[i+1] = r*sin(theta);
+  }
+
+  if (n % 2) vec[n-1] = random->gaussian();
+}
+
+/* ----------------------------------------------------------------------
+   fill vec with N exponential RNs with unit mean
+------------------------------------------------------------------------- */
+
+void exponential(RanPark *random, int n, double *vec)
+{
+  uniform(random,n,vec);
+  for (int i = 0; i < n; i++) vec[i] = -log(vec[i]);
+}
+
+/* ----------------------------------------------------------------------
+   gamma RN with shape a and unit scale, density ~ x^(a-1) exp(-x)
+   Marsaglia and Tsang, ACM TOMS, 26, 363 (2000)
+   acceptance rate > 95% for all a >= 1
+   a < 1 uses gamma(a+1) * U^(1/a)
+------------------------------------------------------------------------- */
+
+double gamma(RanPark *random, double a)
+{
+  if (a < 1.0) 
+    return gamma(random,a+1.0) * pow(random->uniform(),1.0/a);
+
+  double d = a - 1.0/3.0;
+  double c = 1.0/sqrt(9.0*d);
+  double x,v,u;
+
+  while (1) {
+    do {
+      x = random->gaussian();
+      v = 1.0 + c*x;
+    } while (v <= 0.0);
+    v = v*v*v;
+    u = random->uniform();
+    if (u < 1.0 - 0.0331*x*x*x*x) break;
+    if (log(u) < 0.5*x*x + d*(1.0 - v + log(v))) break;
+  }
+
+  return d*v;
+}
+
+/* ----------------------------------------------------------------------
+   beta RN with shape a,b, density ~ x^(a-1) (1-x)^(b-1)
+------------------------------------------------------------------------- */
+
+double beta(RanPark *random, double a, double b)
+{
+  double x = gamma(random,a);
+  double y = gamma(random,b);
+  return x / (x+y);
+}
+
+/* ----------------------------------------------------------------------
+   fill vec with N beta RNs with shape a,b
+------------------------------------------------------------------------- */
+
+void beta(RanPark *random, double a, double b, int n, double *vec)
+{
+  for (int i = 0; i < n; i++) vec[i] = beta(random,a,b);
+}
+
+/* ----------------------------------------------------------------------
+   normal velocity component of particles crossing a surface
+     from a Maxwellian with stream velocity component s along inward normal
+   all velocities in units of most probable speed
+   return beta = thermal component, with beta + s > 0
+   u = beta + s has density g(u) ~ u exp(-(u-s)^2) for u > 0
+   exact sampling, unlike uniform proposal on [-3,3] in Bird 1994, p 259
+   s <= 0: Rayleigh proposal 2u exp(-u^2), accept with exp(2us)
+   s > 0: proposal h(u) = (|u-s| + s) exp(-(u-s)^2) >= g(u),
+     sampled as mixture of |t| exp(-t^2) and s exp(-t^2) for t = u-s > -s,
+     accept with u/(|u-s|+s), always accepted for u >= s
+   acceptance rate is 1 for s = 0 or large s, >= 0.7 for s > 0
+------------------------------------------------------------------------- */
+
+double flux_normal(RanPark *random, double s)
+{
+  double u,t;
+
+  if (s <= 0.0) {
+    do u = sqrt(-log(random->uniform()));
+    while (random->uniform() > exp(2.0*u*s));
+    return u - s;
+  }
+
+  double es2 = exp(-s*s);
+  double a1 = 1.0 - 0.5*es2;
+  double a2 = s * 0.5*MY_PIS * (1.0 + erf(s));
+  double p1 = a1 / (a1+a2);
+  double p1pos = 0.5 / (a1+a2);
+
+  while (1) {
+    double rn = random->uniform();
+    if (rn < p1pos) t = sqrt(-log(random->uniform()));
+    else if (rn < p1) t = -sqrt(-log(1.0 - random->uniform()*(1.0-es2)));
+    else {
+      do t = MY_ISQRT2 * random->gaussian();
+      while (t <= -s);
+    }
+    if (t >= 0.0) return t;
+    u = t + s;
+    if (random->uniform()*(s-t) < u) return t;
+  }
+
+  return 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   fill vec with N flux-weighted normal velocity components for stream s
+------------------------------------------------------------------------- */
+
+void flux_normal(RanPark *random, double s, int n, double *vec)
+{
+  for (int i = 0; i < n; i++) vec[i] = flux_normal(random,s);
+}
+
+/* ----------------------------------------------------------------------
+   build Walker alias table for N outcomes with relative weights f
+   outcome i is chosen with prob[i], else alias[i], for bin i picked uniformly
+   uses Vose's method: bins below average weight are paired with ones above
+   zero-weight outcomes are never returned
+------------------------------------------------------------------------- */
+
+void alias_setup(int n, double *f, double *prob, int *alias)
+{
+  if (n <= 0) return;
+
+  double sum = 0.0;
+  for (int i = 0; i < n; i++) sum += f[i];
+
+  // prob = weights scaled to average 1
+  // small/large = stacks of bins below/above 1, at front/back of list
+
+  int *list = new int[n];
+  int nsmall = 0;
+  int nlarge = 0;
+
+  for (int i = 0; i < n; i++) {
+    prob[i] = f[i]*n/sum;
+    alias[i] = i;
+    if (prob[i] < 1.0) list[nsmall++] = i;
+    else list[n-1-nlarge++] = i;
+  }
+
+  int ismall,ilarge;
+
+  while (nsmall && nlarge) {
+    ismall = list[--nsmall];
+    ilarge = list[n-nlarge];
+    alias[ismall] = ilarge;
+    prob[ilarge] = (prob[ilarge] + prob[ismall]) - 1.0;
+    if (prob[ilarge] < 1.0) {
+      nlarge--;
+      list[nsmall++] = ilarge;
+    }
+  }
+
+  // leftover bins are full to within round-off
+
+  for (int i = 0; i < nsmall; i++) prob[list[i]] = 1.0;
+  for (int i = 0; i < nlarge; i++) prob[list[n-1-i]] = 1.0;
+
+  delete [] list;
+}
+
+}
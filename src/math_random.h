@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifndef SPARTA_MATH_RANDOM_H
+#define SPARTA_MATH_RANDOM_H
+
+namespace SPARTA_NS {
+  class RanPark;
+}
+
+namespace MathRandom {
+
+  // blocks of RNs from basic distributions
+
+  void uniform(SPARTA_NS::RanPark *, int n, double *vec);
+  void gaussian(SPARTA_NS::RanPark *, int n, double *vec);
+  void exponential(SPARTA_NS::RanPark *, int n, double *vec);
+
+  // gamma and beta distributions
+  // used for Larsen-Borgnakke internal energy sampling
+
+  double gamma(SPARTA_NS::RanPark *, double a);
+  double beta(SPARTA_NS::RanPark *, double a, double b);
+  void beta(SPARTA_NS::RanPark *, double a, double b, int n, double *vec);
+
+  // normal velocity component of flux-weighted Maxwellian
+  // in units of most probable speed, shifted by stream component s
+
+  double flux_normal(SPARTA_NS::RanPark *, double s);
+  void flux_normal(SPARTA_NS::RanPark *, double s, int n, double *vec);
+
+  // Walker alias table for O(1) sampling of N discrete outcomes
+
+  void alias_setup(int n, double *f, double *prob, int *alias);
+
+  // return outcome 0 to N-1 for uniform RN 0 <= rn < 1
+
+  inline int alias(int n, double *prob, int *alias, double rn)
+  {
+    double u = rn*n;
+    int i = static_cast<int> (u);
+    if (i >= n) i = n-1;
+    if (u-i < prob[i]) return i;
+    return alias[i];
+  }
+}
+
+#endif
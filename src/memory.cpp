@@ -13,6 +13,7 @@
 ------------------------------------------------------------------------- */
 
 #include "spatype.h"
+#include "mpi.h"
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
@@ -21,9 +22,37 @@
 
 using namespace SPARTA_NS;
 
+// every block is preceded by a header with its size and tag
+// HEADER keeps the 16-byte alignment malloc() returns
+
+#define HEADER 16
+#define MAXPREFIX 64
+#define MBYTES (1024.0*1024.0)
+
+struct Header {
+  bigint nbytes;
+  int tag;
+};
+
+/* ---------------------------------------------------------------------- */
+
+Memory::Memory(SPARTA *sparta) : Pointers(sparta)
+{
+  names.tags = prefixes.tags = NULL;
+  names.ntag = names.maxtag = prefixes.ntag = prefixes.maxtag = 0;
+  names.hash = prefixes.hash = NULL;
+  names.nhash = prefixes.nhash = 0;
+  current = peak = 0;
+  nrelease = 0;
+}
+
 /* ---------------------------------------------------------------------- */
 
-Memory::Memory(SPARTA *sparta) : Pointers(sparta) {}
+Memory::~Memory()
+{
+  free_table(&names);
+  free_table(&prefixes);
+}
 
 /* ----------------------------------------------------------------------
    safe malloc 
@@ -33,18 +62,24 @@ void *Memory::smalloc(bigint nbytes, const char *name)
 {
   if (nbytes == 0) return NULL;
 
-  void *ptr = malloc(nbytes);
-  if (ptr == NULL) {
+  char *base = (char *) malloc(nbytes+HEADER);
+  if (base == NULL) {
     char str[128];
-    sprintf(str,"Failed to allocate " BIGINT_FORMAT " bytes for array %s",
-	    nbytes,name);
+    sprintf(str,"Failed to allocate " BIGINT_FORMAT " bytes for array %s, "
+            BIGINT_FORMAT " bytes in use",nbytes,name,current);
     error->one(FLERR,str);
   }
-  return ptr;
+
+  Header *header = (Header *) base;
+  header->nbytes = nbytes;
+  header->tag = find_tag(name);
+  add_bytes(header->tag,nbytes);
+  return base + HEADER;
 }
 
 /* ----------------------------------------------------------------------
    safe realloc 
+   bytes are moved to the tag of the new name
 ------------------------------------------------------------------------- */
 
 void *Memory::srealloc(void *ptr, bigint nbytes, const char *name)
@@ -53,15 +88,27 @@ void *Memory::srealloc(void *ptr, bigint nbytes, const char *name)
     destroy(ptr);
     return NULL;
   }
+  if (ptr == NULL) return smalloc(nbytes,name);
+
+  char *base = (char *) ptr - HEADER;
+  Header *header = (Header *) base;
+  int oldtag = header->tag;
+  bigint oldbytes = header->nbytes;
 
-  ptr = realloc(ptr,nbytes);
-  if (ptr == NULL) {
+  base = (char *) realloc(base,nbytes+HEADER);
+  if (base == NULL) {
     char str[128];
-    sprintf(str,"Failed to reallocate " BIGINT_FORMAT " bytes for array %s",
-	    nbytes,name);
+    sprintf(str,"Failed to reallocate " BIGINT_FORMAT " bytes for array %s, "
+            BIGINT_FORMAT " bytes in use",nbytes,name,current);
     error->one(FLERR,str);
   }
-  return ptr;
+
+  header = (Header *) base;
+  add_bytes(oldtag,-oldbytes);
+  header->nbytes = nbytes;
+  header->tag = find_tag(name);
+  add_bytes(header->tag,nbytes);
+  return base + HEADER;
 }
 
 /* ----------------------------------------------------------------------
@@ -71,7 +118,296 @@ void *Memory::srealloc(void *ptr, bigint nbytes, const char *name)
 void Memory::sfree(void *ptr)
 {
   if (ptr == NULL) return;
-  free(ptr);
+  char *base = (char *) ptr - HEADER;
+  Header *header = (Header *) base;
+  add_bytes(header->tag,-header->nbytes);
+  free(base);
+}
+
+/* ----------------------------------------------------------------------
+   print top N tags and subsystems by peak bytes on any proc,
+     and per-proc peak and current totals
+   called by all procs
+------------------------------------------------------------------------- */
+
+void Memory::report(int n)
+{
+  int me,nprocs;
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  double mine[2],minall[2],maxall[2],sumall[2];
+  mine[0] = peak/MBYTES;
+  mine[1] = current/MBYTES;
+  MPI_Allreduce(mine,minall,2,MPI_DOUBLE,MPI_MIN,world);
+  MPI_Allreduce(mine,maxall,2,MPI_DOUBLE,MPI_MAX,world);
+  MPI_Allreduce(mine,sumall,2,MPI_DOUBLE,MPI_SUM,world);
+
+  TagTable allnames,allprefixes;
+  allnames.tags = allprefixes.tags = NULL;
+  allnames.ntag = allnames.maxtag = allprefixes.ntag = allprefixes.maxtag = 0;
+  allnames.hash = allprefixes.hash = NULL;
+  allnames.nhash = allprefixes.nhash = 0;
+
+  gather_tags(&prefixes,&allprefixes);
+  gather_tags(&names,&allnames);
+
+  if (me == 0) {
+    double ave = sumall[0]/nprocs;
+    double imbalance = 0.0;
+    if (ave > 0.0) imbalance = (maxall[0]/ave - 1.0) * 100.0;
+
+    char str[256];
+    sprintf(str,"Memory usage per proc in Mbytes from allocations:\n"
+            "  peak    (ave,min,max) = %g %g %g, imbalance = %g%%\n"
+            "  current (ave,min,max) = %g %g %g\n",
+            ave,minall[0],maxall[0],imbalance,
+            sumall[1]/nprocs,minall[1],maxall[1]);
+    if (screen) fputs(str,screen);
+    if (logfile) fputs(str,logfile);
+
+    print_tags(&allprefixes,"subsystem",n,nprocs);
+    print_tags(&allnames,"array",n,nprocs);
+  }
+
+  free_table(&allnames);
+  free_table(&allprefixes);
+}
+
+/* ----------------------------------------------------------------------
+   return index of tag for name, add it and its prefix if new
+------------------------------------------------------------------------- */
+
+int Memory::find_tag(const char *name)
+{
+  int itag;
+
+#if defined(_OPENMP)
+#pragma omp critical (memory_tag)
+#endif
+  {
+    int ntag = names.ntag;
+    itag = lookup(&names,name);
+    if (names.ntag > ntag) {
+      char prefix[MAXPREFIX];
+      int i = 0;
+      while (name[i] && name[i] != ':' && i < MAXPREFIX-1) {
+        prefix[i] = name[i];
+        i++;
+      }
+      prefix[i] = '\0';
+      names.tags[itag].prefix = lookup(&prefixes,prefix);
+    }
+  }
+
+  return itag;
+}
+
+/* ----------------------------------------------------------------------
+   add N bytes to a tag, its prefix and proc total, N < 0 to subtract
+   subtracting means a block is being reallocated or freed
+------------------------------------------------------------------------- */
+
+void Memory::add_bytes(int itag, bigint n)
+{
+#if defined(_OPENMP)
+#pragma omp critical (memory_tag)
+#endif
+  {
+    Tag *tag = &names.tags[itag];
+    tag->current += n;
+    if (tag->current > tag->peak) tag->peak = tag->current;
+    tag = &prefixes.tags[tag->prefix];
+    tag->current += n;
+    if (tag->current > tag->peak) tag->peak = tag->current;
+    current += n;
+    if (current > peak) peak = current;
+    if (n < 0) nrelease++;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return index of name in table, add it with zero bytes if new
+   table uses malloc/realloc directly so it is not itself tracked
+------------------------------------------------------------------------- */
+
+int Memory::lookup(TagTable *table, const char *name)
+{
+  // FNV-1a hash of name
+
+  unsigned int h = 2166136261u;
+  for (const char *c = name; *c; c++) {
+    h ^= (unsigned char) *c;
+    h *= 16777619u;
+  }
+
+  int i;
+  if (table->nhash) {
+    i = h & (table->nhash-1);
+    while (table->hash[i] >= 0) {
+      if (strcmp(table->tags[table->hash[i]].name,name) == 0)
+        return table->hash[i];
+      i = (i+1) & (table->nhash-1);
+    }
+  }
+
+  // keep hash at most half full, rehash all names when it grows
+
+  if (2*(table->ntag+1) > table->nhash) {
+    table->nhash = table->nhash ? 2*table->nhash : 64;
+    table->hash = (int *) realloc(table->hash,table->nhash*sizeof(int));
+    if (table->hash == NULL) error->one(FLERR,"Failed to grow memory tags");
+    for (i = 0; i < table->nhash; i++) table->hash[i] = -1;
+    for (int m = 0; m < table->ntag; m++) {
+      unsigned int hm = 2166136261u;
+      for (const char *c = table->tags[m].name; *c; c++) {
+        hm ^= (unsigned char) *c;
+        hm *= 16777619u;
+      }
+      i = hm & (table->nhash-1);
+      while (table->hash[i] >= 0) i = (i+1) & (table->nhash-1);
+      table->hash[i] = m;
+    }
+  }
+
+  if (table->ntag == table->maxtag) {
+    table->maxtag = table->maxtag ? 2*table->maxtag : 64;
+    table->tags = (Tag *) realloc(table->tags,table->maxtag*sizeof(Tag));
+    if (table->tags == NULL) error->one(FLERR,"Failed to grow memory tags");
+  }
+
+  int itag = table->ntag++;
+  Tag *tag = &table->tags[itag];
+  tag->name = (char *) malloc(strlen(name)+1);
+  if (tag->name == NULL) error->one(FLERR,"Failed to grow memory tags");
+  strcpy(tag->name,name);
+  tag->current = tag->peak = 0;
+  tag->maxcurrent = tag->maxpeak = 0;
+  tag->prefix = -1;
+
+  i = h & (table->nhash-1);
+  while (table->hash[i] >= 0) i = (i+1) & (table->nhash-1);
+  table->hash[i] = itag;
+
+  return itag;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Memory::free_table(TagTable *table)
+{
+  for (int i = 0; i < table->ntag; i++) free(table->tags[i].name);
+  free(table->tags);
+  free(table->hash);
+  table->tags = NULL;
+  table->hash = NULL;
+  table->ntag = table->maxtag = table->nhash = 0;
+}
+
+/* ----------------------------------------------------------------------
+   merge tags of all procs by name into table all on proc 0
+   all current/peak = sum over procs, maxcurrent/maxpeak = max over procs
+   proc 0 pings each proc in turn, so it stores only one proc's tags at once
+------------------------------------------------------------------------- */
+
+void Memory::gather_tags(TagTable *table, TagTable *all)
+{
+  int me,nprocs;
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  // pack my tags as current, peak, name with trailing NULL
+
+  int nbytes = 0;
+  for (int i = 0; i < table->ntag; i++)
+    nbytes += 2*sizeof(bigint) + strlen(table->tags[i].name) + 1;
+  int maxbytes;
+  MPI_Allreduce(&nbytes,&maxbytes,1,MPI_INT,MPI_MAX,world);
+
+  char *buf = (char *) malloc(maxbytes+1);
+  if (buf == NULL) error->one(FLERR,"Failed to grow memory tags");
+
+  int n = 0;
+  for (int i = 0; i < table->ntag; i++) {
+    Tag *tag = &table->tags[i];
+    memcpy(&buf[n],&tag->current,sizeof(bigint));
+    n += sizeof(bigint);
+    memcpy(&buf[n],&tag->peak,sizeof(bigint));
+    n += sizeof(bigint);
+    strcpy(&buf[n],tag->name);
+    n += strlen(tag->name) + 1;
+  }
+
+  int tmp;
+  MPI_Status status;
+  MPI_Request request;
+
+  if (me == 0) {
+    bigint cur,pk;
+    for (int iproc = 0; iproc < nprocs; iproc++) {
+      if (iproc) {
+        MPI_Irecv(buf,maxbytes,MPI_CHAR,iproc,0,world,&request);
+        MPI_Send(&tmp,0,MPI_INT,iproc,0,world);
+        MPI_Wait(&request,&status);
+        MPI_Get_count(&status,MPI_CHAR,&nbytes);
+      }
+
+      n = 0;
+      while (n < nbytes) {
+        memcpy(&cur,&buf[n],sizeof(bigint));
+        n += sizeof(bigint);
+        memcpy(&pk,&buf[n],sizeof(bigint));
+        n += sizeof(bigint);
+        int itag = lookup(all,&buf[n]);
+        Tag *tag = &all->tags[itag];
+        n += strlen(&buf[n]) + 1;
+        tag->current += cur;
+        tag->peak += pk;
+        if (cur > tag->maxcurrent) tag->maxcurrent = cur;
+        if (pk > tag->maxpeak) tag->maxpeak = pk;
+      }
+    }
+  } else {
+    MPI_Recv(&tmp,0,MPI_INT,0,0,world,&status);
+    MPI_Rsend(buf,nbytes,MPI_CHAR,0,0,world);
+  }
+
+  free(buf);
+}
+
+/* ----------------------------------------------------------------------
+   print N tags with largest peak on any proc, largest first
+------------------------------------------------------------------------- */
+
+void Memory::print_tags(TagTable *table, const char *kind, int n, int nprocs)
+{
+  char str[256];
+  sprintf(str,"Top %s allocations in Mbytes: "
+          "max-peak ave-current max-current\n",kind);
+  if (screen) fputs(str,screen);
+  if (logfile) fputs(str,logfile);
+
+  // selection of next largest, N is small
+
+  int *done = (int *) calloc(table->ntag+1,sizeof(int));
+  for (int m = 0; m < n; m++) {
+    int imax = -1;
+    for (int i = 0; i < table->ntag; i++) {
+      if (done[i]) continue;
+      if (imax < 0 || table->tags[i].maxpeak > table->tags[imax].maxpeak)
+        imax = i;
+    }
+    if (imax < 0 || table->tags[imax].maxpeak == 0) break;
+    done[imax] = 1;
+
+    Tag *tag = &table->tags[imax];
+    sprintf(str,"  %-32.32s %10.4g %10.4g %10.4g\n",tag->name,
+            tag->maxpeak/MBYTES,tag->current/MBYTES/nprocs,
+            tag->maxcurrent/MBYTES);
+    if (screen) fputs(str,screen);
+    if (logfile) fputs(str,logfile);
+  }
+  free(done);
 }
 
 /* ----------------------------------------------------------------------
@@ -22,12 +22,51 @@ namespace SPARTA_NS {
 class Memory : protected Pointers {
  public:
   Memory(class SPARTA *);
+  ~Memory();
 
   void *smalloc(bigint n, const char *);
   void *srealloc(void *, bigint n, const char *);
   void sfree(void *);
   void fail(const char *);
 
+  bigint current_bytes() {return current;}
+  bigint peak_bytes() {return peak;}
+  int version() {return nrelease;}
+  void report(int);
+
+ private:
+
+  // bytes allocated under each name and under each subsystem prefix
+  // prefix = part of name before 1st colon, e.g. "particle"
+
+  struct Tag {
+    char *name;
+    bigint current,peak;       // bytes now and at most, on this proc
+    bigint maxcurrent,maxpeak; // max over procs, only used by report()
+    int prefix;                // index of prefix tag, -1 for a prefix
+  };
+
+  struct TagTable {
+    Tag *tags;
+    int ntag,maxtag;
+    int *hash;                 // open-addressed indices into tags, -1 = empty
+    int nhash;
+  };
+
+  TagTable names,prefixes;
+  bigint current,peak;         // total bytes now and at most, on this proc
+  int nrelease;                // # of reallocs and frees, pointers obtained
+                               //   before the last one may be invalid
+
+  int find_tag(const char *);
+  void add_bytes(int, bigint);
+  int lookup(TagTable *, const char *);
+  void free_table(TagTable *);
+  void gather_tags(TagTable *, TagTable *);
+  void print_tags(TagTable *, const char *, int, int);
+
+ public:
+
 /* ----------------------------------------------------------------------
    create/grow/destroy vecs and multidim arrays with contiguous memory blocks
    only use with primitive data types, e.g. 1d vec of ints, 2d array of doubles
@@ -483,16 +522,21 @@ class Memory : protected Pointers {
 
 /* ERROR/WARNING messages:
 
-E: Failed to allocate %ld bytes for array %s
+E: Failed to allocate %ld bytes for array %s, %ld bytes in use
 
 The SPARTA simulation has run out of memory.  You need to run a
 smaller simulation or on more processors.
 
-E: Failed to reallocate %ld bytes for array %s
+E: Failed to reallocate %ld bytes for array %s, %ld bytes in use
 
 The SPARTA simulation has run out of memory.  You need to run a
 smaller simulation or on more processors.
 
+E: Failed to grow memory tags
+
+The table of names that allocations are accounted under could not be
+allocated.  The SPARTA simulation has run out of memory.
+
 E: Cannot create/grow a vector/array of pointers for %s
 
 SPARTA code is making an illegal call to the templated memory
@@ -20,6 +20,7 @@
 #include "update.h"
 #include "particle.h"
 #include "comm.h"
+#include "math_random.h"
 #include "memory.h"
 #include "error.h"
 
@@ -63,6 +64,8 @@ Mixture::Mixture(SPARTA *sparta, char *userid) : Pointers(sparta)
   fraction_user = NULL;
   fraction_flag = NULL;
   cummulative = NULL;
+  aliasprob = NULL;
+  aliasindex = NULL;
 
   ngroup = maxgroup = 0;
   groups = NULL;
@@ -90,6 +93,8 @@ Mixture::~Mixture()
   memory->destroy(fraction_user);
   memory->destroy(fraction_flag);
   memory->destroy(cummulative);
+  memory->destroy(aliasprob);
+  memory->destroy(aliasindex);
 
   delete_groups();
   memory->sfree(groups);
@@ -225,6 +230,10 @@ void Mixture::init()
     error->all(FLERR,str);
   }
 
+  // alias table for sampling a species by fraction with one RN
+
+  MathRandom::alias_setup(nspecies,fraction,aliasprob,aliasindex);
+
   // vscale = factor to scale Gaussian unit variance by
   //          to get thermal distribution of velocities
   // per-species value since includes species mass
@@ -569,6 +578,8 @@ void Mixture::allocate()
   memory->grow(fraction_flag,maxspecies,"mixture:fraction_flag");
   memory->grow(fraction_user,maxspecies,"mixture:fraction_user");
   memory->grow(cummulative,maxspecies,"mixture:cummulative");
+  memory->grow(aliasprob,maxspecies,"mixture:aliasprob");
+  memory->grow(aliasindex,maxspecies,"mixture:aliasindex");
   memory->grow(mix2group,maxspecies,"mixture:cummulative");
   memory->grow(vscale,maxspecies,"mixture:vscale");
   memory->grow(active,maxspecies,"mixture:active");
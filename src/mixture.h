@@ -56,6 +56,8 @@ class Mixture : protected Pointers {
   // set by init()
 
   double *cummulative;        // cummulative fraction for each species
+  double *aliasprob;          // Walker alias table for sampling species
+  int *aliasindex;            //   by fraction, see MathRandom::alias()
   int *groupsize;             // # of species in each group
   int **groupspecies;         // list of particle species indices in each group
   int *species2group;         // s2g[i] = group that particle species I is in
@@ -19,8 +19,10 @@
 #include "update.h"
 #include "compute.h"
 #include "fix.h"
+#include "tally_grid.h"
 #include "style_compute.h"
 #include "style_fix.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -53,6 +55,8 @@ Modify::Modify(SPARTA *sparta) : Pointers(sparta)
 
   ncompute = maxcompute = 0;
   compute = NULL;
+
+  tallygrid = new TallyGrid(sparta);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -70,6 +74,7 @@ Modify::~Modify()
 
   for (int i = 0; i < ncompute; i++) delete compute[i];
   memory->sfree(compute);
+  delete tallygrid;
 
   delete [] list_start_of_step;
   delete [] list_end_of_step;
@@ -138,8 +143,13 @@ void Modify::setup()
 
 void Modify::start_of_step()
 {
-  for (int i = 0; i < n_start_of_step; i++)
-    fix[list_start_of_step[i]]->start_of_step();
+  Fix *f;
+  for (int i = 0; i < n_start_of_step; i++) {
+    f = fix[list_start_of_step[i]];
+    timer->start(f->itimer);
+    f->start_of_step();
+    timer->stop(f->itimer);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -149,9 +159,14 @@ void Modify::start_of_step()
 
 void Modify::end_of_step()
 {
+  Fix *f;
   for (int i = 0; i < n_end_of_step; i++)
-    if (update->ntimestep % end_of_step_every[i] == 0)
-      fix[list_end_of_step[i]]->end_of_step();
+    if (update->ntimestep % end_of_step_every[i] == 0) {
+      f = fix[list_end_of_step[i]];
+      timer->start(f->itimer);
+      f->end_of_step();
+      timer->stop(f->itimer);
+    }
 }
 
 /* ----------------------------------------------------------------------
@@ -457,6 +472,10 @@ void Modify::clearstep_compute()
 {
   for (int icompute = 0; icompute < ncompute; icompute++)
     compute[icompute]->invoked_flag = 0;
+
+  // particles may have changed since shared grid moments were tallied
+
+  tallygrid->invalidate();
 }
 
 /* ----------------------------------------------------------------------
@@ -584,5 +603,6 @@ bigint Modify::memory_usage()
   bigint bytes = 0;
   for (int i = 0; i < nfix; i++) bytes += fix[i]->memory_usage();
   for (int i = 0; i < ncompute; i++) bytes += compute[i]->memory_usage();
+  bytes += tallygrid->memory_usage();
   return bytes;
 }
@@ -32,6 +32,8 @@ class Modify : protected Pointers {
   int ncompute,maxcompute;   // list of computes
   class Compute **compute;
 
+  class TallyGrid *tallygrid;  // per-cell moments shared by grid computes
+
   Modify(class SPARTA *);
   ~Modify();
   void init();
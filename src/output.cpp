@@ -29,6 +29,7 @@
 #include "stats.h"
 #include "dump.h"
 #include "write_restart.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -272,7 +273,9 @@ void Output::write(bigint ntimestep)
         if (dump[idump]->clearstep || every_dump[idump] == 0)
           modify->clearstep_compute();
         if (last_dump[idump] != ntimestep) {
+          timer->start(dump[idump]->itimer);
           dump[idump]->write();
+          timer->stop(dump[idump]->itimer);
           last_dump[idump] = ntimestep;
         }
         if (every_dump[idump]) next_dump[idump] += every_dump[idump];
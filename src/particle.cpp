@@ -25,6 +25,7 @@
 #include "collide.h"
 #include "random_mars.h"
 #include "random_park.h"
+#include "math_random.h"
 #include "memory.h"
 #include "error.h"
 
@@ -64,6 +65,11 @@ Particle::Particle(SPARTA *sparta) : Pointers(sparta)
   maxsort = 0;
   next = NULL;
 
+  ngsort = 0;
+  gsortfirst = gsortlist = NULL;
+  gsort_species2group = NULL;
+  maxgsortcell = maxgsortlist = 0;
+
   // create two default mixtures
 
   nmixture = maxmixture = 0;
@@ -149,6 +155,10 @@ void Particle::init()
 {
   for (int i = 0; i < nmixture; i++) mixture[i]->init();
 
+  // group sort is re-enabled by Collide::init() if needed
+
+  ngsort = 0;
+
   // RNG for particle weighting
 
   if (!wrandom) {
@@ -181,6 +191,20 @@ void Particle::init()
   // }
 }
 
+/* ----------------------------------------------------------------------
+   re-derive weighting RNG from master RNG after it is re-seeded
+   always re-create it, so master RNG is advanced the same way
+     whether or not init() already created it
+------------------------------------------------------------------------- */
+
+void Particle::reseed()
+{
+  delete wrandom;
+  wrandom = new RanPark(update->ranmaster->uniform());
+  double seed = update->ranmaster->uniform();
+  wrandom->reset(seed,me,100);
+}
+
 /* ----------------------------------------------------------------------
    compress particle list to remove particles with indices in mlist
    mlist indices MUST be in ascending order
@@ -363,6 +387,13 @@ void Particle::sort()
     //first[i] = -1;
   }
 
+  // if requested, also bucket particles by group
+
+  if (ngsort) {
+    sort_with_groups();
+    return;
+  }
+
   // reverse loop over partlcles to store linked lists in forward order
   // icell = global cell the particle is in
 
@@ -382,6 +413,73 @@ void Particle::sort()
   }
 }
 
+/* ----------------------------------------------------------------------
+   same as sort(), but also bucket particles by (cell,group)
+   counting sort: count per bucket in same loop that builds linked lists,
+     prefix sum to bucket end, reverse loop fills buckets from end
+   result: particles of group G in cell I are contiguous in gsortlist
+     from gsortfirst[I*ngsort+G] to gsortfirst[I*ngsort+G+1]-1,
+     in same order as they appear in cell's linked list
+------------------------------------------------------------------------- */
+
+void Particle::sort_with_groups()
+{
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  int nglocal = grid->nlocal;
+
+  int nbucket = nglocal*ngsort;
+  if (nbucket+1 > maxgsortcell) {
+    maxgsortcell = nbucket+1;
+    memory->destroy(gsortfirst);
+    memory->create(gsortfirst,maxgsortcell,"particle:gsortfirst");
+  }
+  if (nlocal > maxgsortlist) {
+    maxgsortlist = maxlocal;
+    memory->destroy(gsortlist);
+    memory->create(gsortlist,maxgsortlist,"particle:gsortlist");
+  }
+
+  for (int m = 0; m < nbucket; m++) gsortfirst[m] = 0;
+
+  int icell,ibucket;
+  int *species2group = gsort_species2group;
+
+  for (int i = nlocal-1; i >= 0; i--) {
+    icell = particles[i].icell;
+    next[i] = cinfo[icell].first;
+    cinfo[icell].first = i;
+    cinfo[icell].count++;
+    gsortfirst[icell*ngsort + species2group[particles[i].ispecies]]++;
+  }
+
+  for (int m = 1; m < nbucket; m++) gsortfirst[m] += gsortfirst[m-1];
+  gsortfirst[nbucket] = nlocal;
+
+  for (int i = nlocal-1; i >= 0; i--) {
+    ibucket = particles[i].icell*ngsort + 
+      species2group[particles[i].ispecies];
+    gsortlist[--gsortfirst[ibucket]] = i;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   enable/disable bucketing of particles by group in sort()
+   n = # of groups, 0 to disable
+   species2group = group index for each species, copied
+   called by Collide::init() for multi-group collisions
+------------------------------------------------------------------------- */
+
+void Particle::sort_groups(int n, int *species2group)
+{
+  ngsort = n;
+  if (!ngsort) return;
+
+  memory->destroy(gsort_species2group);
+  memory->create(gsort_species2group,nspecies,"particle:gsort_species2group");
+  for (int i = 0; i < nspecies; i++) 
+    gsort_species2group[i] = species2group[i];
+}
+
 /* ----------------------------------------------------------------------
    reallocate next list if necessary
    called before partial sort by FixEmit classes in subsonic case
@@ -620,6 +718,10 @@ void Particle::add_species(int narg, char **arg)
 
   if (narg < 2) error->all(FLERR,"Illegal species command");
 
+  // species to group mapping for group sort is now stale
+
+  ngsort = 0;
+
   if (me == 0) {
     fp = fopen(arg[0],"r");
     if (fp == NULL) {
@@ -768,7 +870,7 @@ int Particle::find_mixture(char *id)
 
 double Particle::erot(int isp, double temp_thermal, RanPark *erandom)
 {
- double eng,a,erm,b;
+ double eng;
 
  if (!collide || collide->rotstyle == NONE) return 0.0;
  if (species[isp].rotdof < 2) return 0.0;
@@ -776,14 +878,10 @@ double Particle::erot(int isp, double temp_thermal, RanPark *erandom)
  if (species[isp].rotdof == 2)
    eng = -log(erandom->uniform()) * update->boltz * temp_thermal;
  else {
-   a = 0.5*particle->species[isp].rotdof-1.0;
-   while (1) {
-     // energy cut-off at 10 kT
-     erm = 10.0*erandom->uniform();
-     b = pow(erm/a,a) * exp(a-erm);
-     if (b > erandom->uniform()) break;
-   }
-   eng = erm * update->boltz * temp_thermal;
+   // energy/kT is gamma distributed with shape = rotdof/2
+
+   eng = MathRandom::gamma(erandom,0.5*species[isp].rotdof) * 
+     update->boltz * temp_thermal;
  }
 
  return eng;
@@ -796,7 +894,7 @@ double Particle::erot(int isp, double temp_thermal, RanPark *erandom)
 
 double Particle::evib(int isp, double temp_thermal, RanPark *erandom)
 {
-  double eng,a,erm,b;
+  double eng;
 
   int vibstyle = NONE;
   if (collide) vibstyle = collide->vibstyle;
@@ -811,14 +909,10 @@ double Particle::evib(int isp, double temp_thermal, RanPark *erandom)
     if (species[isp].vibdof == 2)
       eng = -log(erandom->uniform()) * update->boltz * temp_thermal;
     else if (species[isp].vibdof > 2) {
-      a = 0.5*particle->species[isp].vibdof-1.;
-      while (1) {
-        // energy cut-off at 10 kT
-        erm = 10.0*erandom->uniform();
-        b = pow(erm/a,a) * exp(a-erm);
-        if (b > erandom->uniform()) break;
-      }
-      eng = erm * update->boltz * temp_thermal;
+      // energy/kT is gamma distributed with shape = vibdof/2
+
+      eng = MathRandom::gamma(erandom,0.5*species[isp].vibdof) * 
+        update->boltz * temp_thermal;
     }
   }
 
@@ -1533,5 +1627,7 @@ bigint Particle::memory_usage()
     bytes += (bigint) maxlocal * sizeof(double);
   for (int i = 0; i < ncustom_darray; i++)
     bytes += (bigint) maxlocal*edcol[i] * sizeof(double);
+  bytes += (bigint) maxgsortcell * sizeof(int);
+  bytes += (bigint) maxgsortlist * sizeof(int);
   return bytes;
 }
@@ -83,6 +83,14 @@ class Particle : protected Pointers {
 
   int *next;                // index of next particle in each grid cell
 
+  // optional bucketing of particles by (cell,group) in sort()
+  // enabled by Collide for multi-group collisions
+
+  int ngsort;               // # of groups to sort by, 0 if not enabled
+  int *gsortfirst;          // index into gsortlist of 1st particle
+                            //   for each (cell,group), Nglocal*ngsort+1 long
+  int *gsortlist;           // particle indices ordered by cell, then group
+
   // extra custom vectors/arrays for per-particle data
   // ncustom > 0 if there are any extra arrays
   // custom attributes are created by various commands
@@ -111,11 +119,13 @@ class Particle : protected Pointers {
   Particle(class SPARTA *);
   virtual ~Particle();
   void init();
+  void reseed();
   virtual void compress_migrate(int, int *);
   void compress_rebalance();
   void compress_reactions(int, int *);
   void sort();
   void sort_allocate();
+  void sort_groups(int, int *);
   void remove_all_from_cell(int);
   virtual void grow(int);
   virtual void grow_species();
@@ -159,6 +169,9 @@ class Particle : protected Pointers {
   int maxgrid;              // max # of indices first can hold
   int maxsort;              // max # of particles next can hold
   int maxspecies;           // max size of species list
+  int *gsort_species2group; // species to group mapping for group sort
+  int maxgsortcell;         // max # of (cell,group) buckets gsortfirst holds
+  int maxgsortlist;         // max # of particles gsortlist can hold
 
   Species *filespecies;     // list of species read from file
   int nfilespecies;         // # of species read from file
@@ -191,6 +204,7 @@ class Particle : protected Pointers {
 
   // private methods
 
+  void sort_with_groups();
   void read_species_file();
   int wordcount(char *, char **);
 };
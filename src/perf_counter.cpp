@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#include "spatype.h"
+#include "mpi.h"
+#include "string.h"
+#include "perf_counter.h"
+#include "error.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+using namespace SPARTA_NS;
+
+/* ----------------------------------------------------------------------
+   open one group of per-process hardware counters, led by CPU cycles
+   user-space only, so they work with perf_event_paranoid = 2
+   counters that cannot be opened are left out of the group
+------------------------------------------------------------------------- */
+
+PerfCounter::PerfCounter(SPARTA *sparta) : Pointers(sparta)
+{
+  nopen = 0;
+  for (int i = 0; i < PERF_N; i++) {
+    fd[i] = -1;
+    slot[i] = -1;
+    active[i] = 0;
+    previous[i] = current[i] = 0;
+  }
+  init();
+
+#ifdef __linux__
+  unsigned long long config[PERF_N];
+  config[PERF_CYCLES] = PERF_COUNT_HW_CPU_CYCLES;
+  config[PERF_INSTRUCTIONS] = PERF_COUNT_HW_INSTRUCTIONS;
+  config[PERF_LLC_MISSES] = PERF_COUNT_HW_CACHE_MISSES;
+  config[PERF_BRANCH_MISSES] = PERF_COUNT_HW_BRANCH_MISSES;
+  config[PERF_STALLED] = PERF_COUNT_HW_STALLED_CYCLES_BACKEND;
+
+  struct perf_event_attr attr;
+  for (int i = 0; i < PERF_N; i++) {
+    memset(&attr,0,sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP |
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    if (i == PERF_CYCLES) attr.disabled = 1;
+
+    int leader = fd[PERF_CYCLES];
+    if (i != PERF_CYCLES && leader < 0) break;
+    fd[i] = syscall(__NR_perf_event_open,&attr,0,-1,leader,0);
+    if (fd[i] >= 0) slot[i] = nopen++;
+  }
+
+  if (fd[PERF_CYCLES] >= 0) {
+    ioctl(fd[PERF_CYCLES],PERF_EVENT_IOC_RESET,PERF_IOC_FLAG_GROUP);
+    ioctl(fd[PERF_CYCLES],PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+  }
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+
+PerfCounter::~PerfCounter()
+{
+#ifdef __linux__
+  for (int i = PERF_N-1; i >= 0; i--)
+    if (fd[i] >= 0) close(fd[i]);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   set which counters are active, must be counting on every proc
+   so that counts summed across procs are meaningful
+   return 0 if no counters are active
+------------------------------------------------------------------------- */
+
+int PerfCounter::available()
+{
+  int me;
+  MPI_Comm_rank(world,&me);
+
+  int flag[PERF_N];
+  for (int i = 0; i < PERF_N; i++) flag[i] = (fd[i] >= 0);
+  MPI_Allreduce(flag,active,PERF_N,MPI_INT,MPI_MIN,world);
+
+  if (!active[PERF_CYCLES]) {
+    if (me == 0)
+      error->warning(FLERR,"Hardware performance counters are not available");
+    return 0;
+  }
+
+  int all = 1;
+  for (int i = 0; i < PERF_N; i++) if (!active[i]) all = 0;
+  if (!all && me == 0)
+    error->warning(FLERR,"Some hardware performance counters "
+                   "are not available");
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PerfCounter::init()
+{
+  for (int iphase = 0; iphase < TIME_N; iphase++)
+    for (int i = 0; i < PERF_N; i++) count[iphase][i] = 0;
+}
+
+/* ----------------------------------------------------------------------
+   counts from here to next stamp() are charged to the phase stamped
+------------------------------------------------------------------------- */
+
+void PerfCounter::start()
+{
+  read_counters(previous);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PerfCounter::stamp(int which)
+{
+  read_counters(current);
+  for (int i = 0; i < PERF_N; i++) {
+    count[which][i] += current[i] - previous[i];
+    previous[i] = current[i];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   total of counter over all procs
+   which = phase, or TIME_LOOP for sum over all phases
+------------------------------------------------------------------------- */
+
+bigint PerfCounter::total(int which, int icounter)
+{
+  bigint one = 0;
+  if (which == TIME_LOOP)
+    for (int iphase = 1; iphase < TIME_N; iphase++)
+      one += count[iphase][icounter];
+  else one = count[which][icounter];
+
+  bigint all;
+  MPI_Allreduce(&one,&all,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  return all;
+}
+
+/* ----------------------------------------------------------------------
+   read all counters in one system call
+   scale for time the group was not scheduled on the PMU,
+     when the kernel multiplexes more counters than the hardware has
+------------------------------------------------------------------------- */
+
+void PerfCounter::read_counters(bigint *values)
+{
+  for (int i = 0; i < PERF_N; i++) values[i] = 0;
+
+#ifdef __linux__
+  if (nopen == 0) return;
+
+  // nr, time_enabled, time_running, then one value per counter
+
+  unsigned long long buf[3+PERF_N];
+  if (read(fd[PERF_CYCLES],buf,sizeof(buf)) < 0) return;
+
+  double scale = 1.0;
+  if (buf[2] > 0 && buf[2] < buf[1]) scale = (double) buf[1] / buf[2];
+  for (int i = 0; i < PERF_N; i++)
+    if (slot[i] >= 0) values[i] = (bigint) (scale * buf[3+slot[i]]);
+#endif
+}
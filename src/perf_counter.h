@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifndef SPARTA_PERF_COUNTER_H
+#define SPARTA_PERF_COUNTER_H
+
+#include "pointers.h"
+#include "timer.h"
+
+namespace SPARTA_NS {
+
+enum{PERF_CYCLES,PERF_INSTRUCTIONS,PERF_LLC_MISSES,PERF_BRANCH_MISSES,
+     PERF_STALLED,PERF_N};
+
+class PerfCounter : protected Pointers {
+ public:
+  int active[PERF_N];             // 1 if counter is counting on all procs
+  bigint count[TIME_N][PERF_N];   // counts in each phase since init()
+
+  PerfCounter(class SPARTA *);
+  ~PerfCounter();
+  int available();
+  void init();
+  void start();
+  void stamp(int);
+  bigint total(int, int);
+
+ private:
+  int fd[PERF_N];                 // file descriptor of each counter, -1 if none
+  int slot[PERF_N];               // position of counter in group read
+  int nopen;                      // # of counters in group
+  bigint previous[PERF_N];        // counter values at last start/stamp
+  bigint current[PERF_N];
+
+  void read_counters(bigint *);
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+W: Hardware performance counters are not available
+
+The perf_event_open() system call could not open a CPU cycles counter
+on some proc, e.g. because the kernel or a container does not allow
+it, so no counts will be reported.  On Linux, check the setting of
+/proc/sys/kernel/perf_event_paranoid.
+
+W: Some hardware performance counters are not available
+
+At least one of the instruction, LLC miss, branch miss or stalled
+cycle counters could not be opened on some proc.  It will not be
+reported.
+
+*/
@@ -51,6 +51,7 @@ RanPark::RanPark(double rseed)
    assume 0.0 <= rseed < 1.0 and offset is an int >= 0
    fmod() insures no overflow when static cast to int
    warmup the new RNG if requested
+   discard any saved 2nd gaussian RN from the old seed
    typically used to setup one RN generator per proc or site or particle
 ------------------------------------------------------------------------ */
 
@@ -59,6 +60,7 @@ void RanPark::reset(double rseed, int offset, int warmup)
   seed = static_cast<int> (fmod(rseed*IM+offset,IM));
   if (seed < 0) seed = -seed;
   if (seed == 0) seed = 1;
+  save = 0;
   for (int i = 0; i < warmup; i++) uniform();
 }
 
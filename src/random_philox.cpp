@@ -0,0 +1,190 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "random_philox.h"
+#include "math_const.h"
+
+using namespace SPARTA_NS;
+using namespace MathConst;
+
+// Philox4x32-10 constants, Salmon et al, SC11 (2011)
+
+#define PHILOX_M0 0xD2511F53U
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U
+#define PHILOX_W1 0xBB67AE85U
+#define NROUND 10
+
+// fold upper 32 bits of IDs into key
+
+#define HASH0 0x85EBCA6BU
+#define HASH1 0xC2B2AE35U
+#define HASH2 0x27D4EB2FU
+
+#define TWO_M53 (1.0/9007199254740992.0)
+
+/* ---------------------------------------------------------------------- 
+   Philox counter-based RNG
+   seed must be same on all procs, purpose distinguishes streams
+     of different models that use the same seed
+   values depend only on seed, purpose and IDs passed to reset(),
+     not on how many values were previously drawn or on which proc
+------------------------------------------------------------------------ */
+
+RanPhilox::RanPhilox(int iseed, int ipurpose)
+{
+  seed = static_cast<uint32_t> (iseed);
+  purpose = static_cast<uint32_t> (ipurpose);
+  reset(0,0,0);
+}
+
+/* ---------------------------------------------------------------------- 
+   select the stream for a timestep and up to 2 IDs
+   typically id1 = grid cell ID, id2 = particle ID or face/surf index
+   restarts the counter within the stream
+------------------------------------------------------------------------ */
+
+void RanPhilox::reset(bigint step, bigint id1, bigint id2)
+{
+  uint64_t ustep = static_cast<uint64_t> (step);
+  uint64_t uid1 = static_cast<uint64_t> (id1);
+  uint64_t uid2 = static_cast<uint64_t> (id2);
+
+  key[0] = seed;
+  key[1] = purpose ^ (static_cast<uint32_t> (ustep >> 32) * HASH0) ^
+    (static_cast<uint32_t> (uid1 >> 32) * HASH1) ^
+    (static_cast<uint32_t> (uid2 >> 32) * HASH2);
+
+  ctr[0] = 0;
+  ctr[1] = static_cast<uint32_t> (uid2);
+  ctr[2] = static_cast<uint32_t> (uid1);
+  ctr[3] = static_cast<uint32_t> (ustep);
+
+  nout = 0;
+  save = 0;
+}
+
+/* ----------------------------------------------------------------------
+   uniform RN in (0,1)
+------------------------------------------------------------------------- */
+
+double RanPhilox::uniform()
+{
+  if (nout == 0) block();
+  int m = 2 - nout;
+  nout--;
+  uint64_t bits = (static_cast<uint64_t> (out[2*m]) << 32) | out[2*m+1];
+  return ((bits >> 11) + 0.5) * TWO_M53;
+}
+
+/* ----------------------------------------------------------------------
+   gaussian RN with zero mean and unit variance
+------------------------------------------------------------------------- */
+
+double RanPhilox::gaussian()
+{
+  double first;
+
+  if (!save) {
+    double r = sqrt(-2.0*log(uniform()));
+    double theta = MY_2PI*uniform();
+    first = r*cos(theta);
+    second = r*sin(theta);
+    save = 1;
+  } else {
+    first = second;
+    save = 0;
+  }
+  return first;
+}
+
+/* ----------------------------------------------------------------------
+   fill vector of length N with uniform RNs in (0,1)
+   whole blocks are converted without per-value bookkeeping
+------------------------------------------------------------------------- */
+
+void RanPhilox::uniform(int n, double *vec)
+{
+  int i = 0;
+  while (i < n && nout) vec[i++] = uniform();
+
+  uint64_t bits;
+  for (; i+1 < n; i += 2) {
+    block();
+    bits = (static_cast<uint64_t> (out[0]) << 32) | out[1];
+    vec[i] = ((bits >> 11) + 0.5) * TWO_M53;
+    bits = (static_cast<uint64_t> (out[2]) << 32) | out[3];
+    vec[i+1] = ((bits >> 11) + 0.5) * TWO_M53;
+  }
+  nout = 0;
+
+  if (i < n) vec[i] = uniform();
+}
+
+/* ----------------------------------------------------------------------
+   fill vector of length N with gaussian RNs
+   Box-Muller in non-rejection form so loop has no branches
+------------------------------------------------------------------------- */
+
+void RanPhilox::gaussian(int n, double *vec)
+{
+  uniform(n,vec);
+
+  double r,theta;
+  for (int i = 0; i+1 < n; i += 2) {
+    r = sqrt(-2.0*log(vec[i]));
+    theta = MY_2PI*vec[i+1];
+    vec[i] = r*cos(theta);
+    vec[i+1] = r*sin(theta);
+  }
+
+  if (n % 2) vec[n-1] = sqrt(-2.0*log(vec[n-1])) * cos(MY_2PI*uniform());
+  save = 0;
+}
+
+/* ----------------------------------------------------------------------
+   generate one block of 128 random bits from current key and counter
+   then increment counter
+------------------------------------------------------------------------- */
+
+void RanPhilox::block()
+{
+  uint32_t c0 = ctr[0];
+  uint32_t c1 = ctr[1];
+  uint32_t c2 = ctr[2];
+  uint32_t c3 = ctr[3];
+  uint32_t k0 = key[0];
+  uint32_t k1 = key[1];
+  uint64_t prod0,prod1;
+
+  for (int i = 0; i < NROUND; i++) {
+    prod0 = static_cast<uint64_t> (PHILOX_M0) * c0;
+    prod1 = static_cast<uint64_t> (PHILOX_M1) * c2;
+    c0 = static_cast<uint32_t> (prod1 >> 32) ^ c1 ^ k0;
+    c2 = static_cast<uint32_t> (prod0 >> 32) ^ c3 ^ k1;
+    c1 = static_cast<uint32_t> (prod1);
+    c3 = static_cast<uint32_t> (prod0);
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+
+  ctr[0]++;
+  nout = 2;
+}
@@ -0,0 +1,47 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifndef SPARTA_RAN_PHILOX_H
+#define SPARTA_RAN_PHILOX_H
+
+#include "stdint.h"
+#include "spatype.h"
+
+namespace SPARTA_NS {
+
+class RanPhilox {
+ public:
+  RanPhilox(int, int);
+  ~RanPhilox() {}
+  void reset(bigint, bigint, bigint);
+  double uniform();
+  double gaussian();
+  void uniform(int, double *);
+  void gaussian(int, double *);
+
+ private:
+  uint32_t seed,purpose;   // fixed part of key
+  uint32_t key[2];         // key for current stream
+  uint32_t ctr[4];         // counter for current stream
+  uint32_t out[4];         // random bits from last generated block
+  int nout;                // # of unused doubles in out
+  int save;
+  double second;
+
+  void block();
+};
+
+}
+
+#endif
@@ -72,3 +72,22 @@ void React::modify_params(int narg, char **arg)
     } else error->all(FLERR,"Illegal react_modify command");
   }
 }
+
+/* ----------------------------------------------------------------------
+   reseed RNG, called by Collide when RNGs are reseeded per grid cell
+------------------------------------------------------------------------- */
+
+void React::reset_random(double rseed)
+{
+  random->reset(rseed,0,0);
+}
+
+/* ----------------------------------------------------------------------
+   re-derive reaction RNG from master RNG after it is re-seeded
+------------------------------------------------------------------------- */
+
+void React::reseed()
+{
+  double seed = update->ranmaster->uniform();
+  random->reset(seed,comm->me,100);
+}
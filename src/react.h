@@ -41,6 +41,8 @@ class React : protected Pointers {
                       double, double, double, double &, int &) = 0;
 
   void modify_params(int, char **);
+  void reset_random(double);
+  void reseed();
 
  protected:
   class RanPark *random;
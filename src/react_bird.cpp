@@ -41,6 +41,7 @@ enum{ARRHENIUS,QUANTUM};                               // other react files
 
 #define MAXLINE 1024
 #define DELTALIST 16
+#define BIG 1.0e20
 
 /* ---------------------------------------------------------------------- */
 
@@ -57,6 +58,9 @@ ReactBird::ReactBird(SPARTA *sparta, int narg, char **arg) :
   reactions = NULL;
   list_ij = NULL;
   sp2recomb_ij = NULL;
+  kernel_ij = NULL;
+  rprob = NULL;
+  maxreact = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -79,6 +83,8 @@ ReactBird::~ReactBird()
   memory->destroy(reactions);
   memory->destroy(list_ij);
   memory->destroy(sp2recomb_ij);
+  memory->destroy(kernel_ij);
+  memory->destroy(rprob);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -273,6 +279,11 @@ void ReactBird::init()
     }
   }
 
+  // per-pair activation energy cutoffs and rate kernels
+  // built after TCE coeffs are finalized
+
+  build_kernels();
+
   // set recombflag = 0/1 if any recombination reactions are defined & active
   // check for user disabling them is at top of this method
 
@@ -386,6 +397,61 @@ void ReactBird::init()
     }
 }
 
+/* ----------------------------------------------------------------------
+   setup per-pair tables used by attempt() methods
+   emin,rotmax = cutoff so a collision below any reaction threshold
+     can exit without looping over the reactions
+   kernel = per-reaction TCE rate coeffs gathered into contiguous vectors
+     so all reactions of an IJ pair can be evaluated in one pass
+------------------------------------------------------------------------- */
+
+void ReactBird::build_kernels()
+{
+  int nspecies = particle->nspecies;
+
+  int ntotal = 0;
+  maxreact = 0;
+  for (int i = 0; i < nspecies; i++)
+    for (int j = 0; j < nspecies; j++) {
+      ntotal += reactions[i][j].n;
+      maxreact = MAX(maxreact,reactions[i][j].n);
+    }
+
+  memory->destroy(kernel_ij);
+  memory->create(kernel_ij,NKERNEL*ntotal,"react/bird:kernel_ij");
+  memory->destroy(rprob);
+  memory->create(rprob,maxreact,"react/bird:rprob");
+
+  int offset = 0;
+  for (int i = 0; i < nspecies; i++)
+    for (int j = 0; j < nspecies; j++) {
+      ReactionIJ *rij = &reactions[i][j];
+      int n = rij->n;
+      int *list = rij->list;
+      double *kernel = rij->kernel = &kernel_ij[offset];
+      offset += NKERNEL*n;
+
+      rij->emin = BIG;
+      rij->rotmax = 0.0;
+
+      for (int m = 0; m < n; m++) {
+        OneReaction *r = &rlist[list[m]];
+        rij->emin = MIN(rij->emin,r->coeff[1]);
+        rij->rotmax = MAX(rij->rotmax,r->coeff[0]);
+
+        // recombination rate is function of ecc, not ecc - Ea
+
+        kernel[KROT*n+m] = r->coeff[0];
+        kernel[KACTIVE*n+m] = r->coeff[1];
+        kernel[KSHIFT*n+m] = r->coeff[1];
+        if (r->type == RECOMBINATION) kernel[KSHIFT*n+m] = 0.0;
+        kernel[KPRE*n+m] = r->coeff[2];
+        kernel[KEXP1*n+m] = r->coeff[3];
+        kernel[KEXP2*n+m] = r->coeff[5];
+      }
+    }
+}
+
 /* ----------------------------------------------------------------------
    return 1 if any recombination reactions are defined for species pair ISP,JSP
    else return 0
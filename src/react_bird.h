@@ -63,8 +63,21 @@ class ReactBird : public React {
                      //   just a ptr into sub-section of long sp2recomb_ij
                      //   vector for all pairs which have recomb reactions
     int n;           // # of reactions in list
+    double emin;     // min activation energy of any reaction in list,
+                     //   collision with less energy cannot react
+    double rotmax;   // max rotational energy weight of any reaction in list
+    double *kernel;  // NKERNEL*N precomputed rate coeffs for reactions
+                     //   in list, stored as NKERNEL contiguous N-vectors,
+                     //   just a ptr into sub-section of long kernel_ij vector
   };
 
+  // layout of precomputed rate coeffs in ReactionIJ kernel
+  //   ROT = rotational energy weight, ACTIVE = activation energy,
+  //   SHIFT = energy offset for rate power law, PRE = prefactor,
+  //   EXP1,EXP2 = exponents of energy excess and of 1-Ea/Ecc
+
+  enum{KROT,KACTIVE,KSHIFT,KPRE,KEXP1,KEXP2,NKERNEL};
+
   ReactionIJ **reactions;     // reaction info for all IJ pairs of species
   int *list_ij;               // chunks of rlist indices,
                               //   one chunk per IJ pair,
@@ -77,7 +90,13 @@ class ReactBird : public React {
                               //   stored in contiguous vector
                               //   length of each chunk is # of species
                               // pointed into by reactions[i][k].sp2recomb
+  double *kernel_ij;          // chunks of precomputed rate coeffs,
+                              //   one chunk per IJ pair,
+                              //   pointed into by reactions[i][k].kernel
+  double *rprob;              // per-reaction probabilities for one IJ pair
+  int maxreact;               // max # of reactions for any IJ pair
 
+  void build_kernels();
   void readfile(char *);
   int readone(char *, char *, int &, int &);
   void check_duplicate();
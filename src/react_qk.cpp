@@ -82,6 +82,13 @@ int ReactQK::attempt(Particle::OnePart *ip, Particle::OnePart *jp,
   double react_prob = 0.0;
   double random_prob = random->uniform(); 
 
+  // early exit if collision energy is below all activation energies
+
+  ecc = pre_etrans;
+  if (pre_ave_rotdof > 0.1) 
+    ecc += pre_erot*reactions[isp][jsp].rotmax/pre_ave_rotdof;
+  if (ecc <= reactions[isp][jsp].emin) return 0;
+
   // loop over possible reactions for these 2 species
 
   for (int i = 0; i < n; i++) {
@@ -52,7 +52,7 @@ int ReactTCE::attempt(Particle::OnePart *ip, Particle::OnePart *jp,
                       double pre_etrans, double pre_erot, double pre_evib,
                       double &post_etotal, int &kspecies)
 {
-  double pre_etotal,ecc,e_excess;
+  double ecc,e_excess;
   OneReaction *r;
 
   Particle::Species *species = particle->species;
@@ -61,40 +61,61 @@ int ReactTCE::attempt(Particle::OnePart *ip, Particle::OnePart *jp,
 
   double pre_ave_rotdof = (species[isp].rotdof + species[jsp].rotdof)/2.0;
 
-  int n = reactions[isp][jsp].n;
+  ReactionIJ *rij = &reactions[isp][jsp];
+  int n = rij->n;
   if (n == 0) return 0;
-  int *list = reactions[isp][jsp].list;
+  int *list = rij->list;
 
   // probablity to compare to reaction probability
 
-  double react_prob = 0.0;
   double random_prob = random->uniform(); 
 
-  // loop over possible reactions for these 2 species
+  // early exit if collision energy is below all activation energies
+  // largest rotational weight gives largest ecc of any reaction
+
+  int rotflag = 0;
+  if (pre_ave_rotdof > 0.1) rotflag = 1;
+
+  ecc = pre_etrans;
+  if (rotflag) ecc += pre_erot*rij->rotmax/pre_ave_rotdof;
+  if (ecc <= rij->emin) return 0;
+
+  double pre_etotal = pre_etrans + pre_erot + pre_evib;
+
+  // evaluate probability of all possible reactions for these 2 species
+  // energetically impossible reactions have zero probability
+
+  double *kernel = rij->kernel;
+  double *rot = &kernel[KROT*n];
+  double *eactive = &kernel[KACTIVE*n];
+  double *eshift = &kernel[KSHIFT*n];
+  double *pre = &kernel[KPRE*n];
+  double *exp1 = &kernel[KEXP1*n];
+  double *exp2 = &kernel[KEXP2*n];
 
   for (int i = 0; i < n; i++) {
-    r = &rlist[list[i]];
+    ecc = pre_etrans;
+    if (rotflag) ecc += pre_erot*rot[i]/pre_ave_rotdof;
+    e_excess = ecc - eactive[i];
+    if (e_excess <= 0.0) rprob[i] = 0.0;
+    else rprob[i] = pre[i] * pow(ecc-eshift[i],exp1[i]) *
+           pow(1.0-eactive[i]/ecc,exp2[i]);
+  }
 
-    // ignore energetically impossible reactions
+  // loop over possible reactions, accumulating their probabilities
 
-    pre_etotal = pre_etrans + pre_erot + pre_evib;
+  double react_prob = 0.0;
 
-    ecc = pre_etrans; 
-    if (pre_ave_rotdof > 0.1) ecc += pre_erot*r->coeff[0]/pre_ave_rotdof;
+  for (int i = 0; i < n; i++) {
+    if (rprob[i] == 0.0) continue;
+    r = &rlist[list[i]];
 
-    e_excess = ecc - r->coeff[1];
-    if (e_excess <= 0.0) continue;
-        
-    // compute probability of reaction
-        
     switch (r->type) {
     case DISSOCIATION:
     case IONIZATION:
     case EXCHANGE:
       {
-        react_prob += r->coeff[2] * 
-          pow(ecc-r->coeff[1],r->coeff[3]) *
-          pow(1.0-r->coeff[1]/ecc,r->coeff[5]);
+        react_prob += rprob[i];
         break;
       }
 
@@ -109,12 +130,10 @@ int ReactTCE::attempt(Particle::OnePart *ip, Particle::OnePart *jp,
         // scale probability by boost factor to restore correct stats
 
         if (recomb_species < 0) continue;
-        int *sp2recomb = reactions[isp][jsp].sp2recomb;
+        int *sp2recomb = rij->sp2recomb;
         if (sp2recomb[recomb_species] != list[i]) continue;
 
-        react_prob += recomb_boost * recomb_density * r->coeff[2] *
-          pow(ecc,r->coeff[3]) *
-          pow(1.0-r->coeff[1]/ecc,r->coeff[5]);
+        react_prob += recomb_boost * recomb_density * rprob[i];
         break;
       }
 
@@ -67,6 +67,11 @@ int ReactTCEQK::attempt(Particle::OnePart *ip, Particle::OnePart *jp,
   if (n == 0) return 0;
   int *list = reactions[isp][jsp].list;
 
+  // early exit if collision energy is below all activation energies
+
+  pre_etotal = pre_etrans + pre_erot + pre_evib;
+  if (pre_etotal <= reactions[isp][jsp].emin) return 0;
+
   // loop over possible reactions for these 2 species
 
   for (int i = 0; i < n; i++) {
@@ -74,8 +79,6 @@ int ReactTCEQK::attempt(Particle::OnePart *ip, Particle::OnePart *jp,
 
     // ignore energetically impossible reactions
 
-    pre_etotal = pre_etrans + pre_erot + pre_evib;
-
     ecc = pre_etotal; 
 
     e_excess = ecc - r->coeff[1];
@@ -29,7 +29,15 @@ using namespace SPARTA_NS;
 enum{UNKNOWN,OUTSIDE,INSIDE,OVERLAP};   // same as Grid
 
 #define MAXLINE 1024        // max line length in dump file
-#define CHUNK 1024
+#define CHUNK 1024          // min # of particles allocated in buf
+#define BLOCK 1048576       // bytes each proc scans per pass for snapshot end
+
+// datum sent to rendezvous proc for each child cell I own
+
+struct CellOwner {
+  cellint id;
+  int proc;
+};
 
 /* ---------------------------------------------------------------------- */
 
@@ -47,37 +55,54 @@ void ReadParticles::command(int narg, char **arg)
   if (narg != 2) error->all(FLERR,"Illegal read_particles command");
 
   // process args
+  // if filename ends in .bin = binary file
 
   char *file = arg[0];
   bigint nrequest = input->bnumeric(FLERR,arg[1]);
 
+  char *suffix = file + strlen(file) - strlen(".bin");
+  binary = 0;
+  if (suffix > file && strcmp(suffix,".bin") == 0) binary = 1;
+
   me = comm->me;
+  nprocs = comm->nprocs;
   nspecies = particle->nspecies;
   line = new char[MAXLINE];
 
+  nfield = 8;
+  nbuf = maxbuf = 0;
+  buf = NULL;
+  nchunk = 0;
+  chunkpos = NULL;
+  chunkcount = NULL;
+
   MPI_Barrier(world);
   double time1 = MPI_Wtime();
 
   // open file on proc 0
 
   if (me == 0) {
-    fp = fopen(file,"r");
+    if (binary) fp = fopen(file,"rb");
+    else fp = fopen(file,"r");
     if (fp == NULL) error->one(FLERR,"Read_particles could not open file");
   }
 
   // scan file for dump snapshot with correct timestamp
   // exit loop when dump timestep >= nrequest
   // np = # of particles in snapshot
+  // filepos = offset of 1st particle line or binary chunk info in snapshot
 
   int eofflag;
   bigint ntimestep = -1;
 
   if (me == 0) {
     while (1) {
-      eofflag = read_time(ntimestep);
+      if (binary) eofflag = read_time_binary(ntimestep);
+      else eofflag = read_time(ntimestep);
       if (eofflag) break;
       if (ntimestep >= nrequest) break;
-      skip();
+      if (binary) skip_binary();
+      else skip();
       if (ntimestep >= nrequest) break;
     }
   }
@@ -86,31 +111,48 @@ void ReadParticles::command(int narg, char **arg)
   if (ntimestep != nrequest)
     error->all(FLERR,"Read_particles could not find timestep in file");
 
-  int np;
-  if (me == 0) np = read_header();
-  MPI_Bcast(&np,1,MPI_INT,0,world);
+  bigint np,filepos;
+  if (me == 0) {
+    if (binary) np = read_header_binary();
+    else np = read_header();
+    filepos = ftell(fp);
+  }
+  MPI_Bcast(&np,1,MPI_SPARTA_BIGINT,0,world);
+  MPI_Bcast(&filepos,1,MPI_SPARTA_BIGINT,0,world);
+
+  // other procs open file to read their portion of the snapshot
+
+  if (me) {
+    if (binary) fp = fopen(file,"rb");
+    else fp = fopen(file,"r");
+    if (fp == NULL) error->one(FLERR,"Read_particles could not open file");
+  }
 
-  // read, broadcast, and process particles from snapshot in chunks
+  // each proc reads and parses a disjoint portion of the snapshot
   // for now, assume fields are ID,ispecies,x,y,z,vx,vy,vz
 
-  int nfield = 8;
-  double **fields;
-  memory->create(fields,CHUNK,nfield,"read_particles:fields");
+  if (binary) read_binary(np);
+  else read_text(np,filepos);
+
+  bigint nme = nbuf;
+  bigint nall;
+  MPI_Allreduce(&nme,&nall,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  if (nall != np)
+    error->all(FLERR,
+               "Read_particles file has incorrect # of particles in snapshot");
+
+  fclose(fp);
+  delete [] line;
+  delete [] chunkpos;
+  delete [] chunkcount;
+
+  // send each particle to proc that owns its grid cell and store it there
 
   int nlocal_previous = particle->nlocal;
   bigint nglobal_previous = particle->nglobal;
 
-  int nchunk;
-  bigint nread = 0;
-  while (nread < np) {
-    nchunk = MIN(np-nread,CHUNK);
-    if (me == 0) read_particles(nchunk,nfield,fields);
-    MPI_Bcast(&fields[0][0],nchunk*nfield,MPI_DOUBLE,0,world);
-    process_particles(nchunk,nfield,fields);
-    nread += nchunk;
-  }
-
-  memory->destroy(fields);
+  route_particles();
+  memory->destroy(buf);
 
   MPI_Barrier(world);
   double time2 = MPI_Wtime();
@@ -148,74 +190,376 @@ void ReadParticles::command(int narg, char **arg)
     error->all(FLERR,str);
   }
 
-  // close file
+  // added particles are not in per-cell lists
 
-  if (me == 0) fclose(fp);
-  delete [] line;
+  particle->sorted = 0;
 
   // print stats
 
-  bigint nme = particle->nlocal;
+  nme = particle->nlocal;
   MPI_Allreduce(&nme,&particle->nglobal,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
   bigint nactual = particle->nglobal - nglobal_previous;
 
   if (comm->me == 0) {
     if (screen) {
       fprintf(screen,"Read " BIGINT_FORMAT " particles out of " 
-              "%d\n",nactual,np);
+              BIGINT_FORMAT "\n",nactual,np);
       fprintf(screen,"  CPU time = %g secs\n",time2-time1);
     }
     if (logfile) {
       fprintf(logfile,"Read " BIGINT_FORMAT " particles out of " 
-              "%d\n",nactual,np);
+              BIGINT_FORMAT "\n",nactual,np);
       fprintf(logfile,"  CPU time = %g secs\n",time2-time1);
     }
   }
 }
 
 /* ----------------------------------------------------------------------
-   process N particles and their fields read from dump file
-   store the ones in grid cells I own
-   for now, assume fields are id,x,y,z,vx,vy,vz
+   read my portion of a text snapshot into buf
+   snapshot is split into equal byte ranges, one per proc
+   I own lines that start within my byte range
+   start = file offset of 1st particle line
+------------------------------------------------------------------------- */
+
+void ReadParticles::read_text(bigint np, bigint start)
+{
+  // filesize = size of entire file
+
+  bigint filesize;
+  if (me == 0) {
+    fseek(fp,0,SEEK_END);
+    filesize = ftell(fp);
+  }
+  MPI_Bcast(&filesize,1,MPI_SPARTA_BIGINT,0,world);
+
+  // end = offset of 1st line after snapshot
+  // if np = 0, can skip search
+
+  bigint end = start;
+  if (np) end = find_end(start,filesize);
+
+  bigint lo = start + (end-start)*me/nprocs;
+  bigint hi = start + (end-start)*(me+1)/nprocs;
+  if (lo == hi) return;
+
+  // position at start of 1st line beginning at or after lo
+  // if char before lo is not a newline, skip rest of partial line
+
+  fseek(fp,lo-1,SEEK_SET);
+  bigint pos = lo;
+  int c = fgetc(fp);
+  if (c != '\n') {
+    while (1) {
+      if (fgets(line,MAXLINE,fp) == NULL) break;
+      pos += strlen(line);
+      if (line[strlen(line)-1] == '\n') break;
+    }
+  }
+
+  // read and parse lines until one starts at or after hi
+
+  int n;
+
+  while (pos < hi) {
+    if (fgets(line,MAXLINE,fp) == NULL)
+      error->one(FLERR,"Unexpected end of read_particles file");
+    n = strlen(line);
+    pos += n;
+
+    if (nbuf == 0 && input->count_words(line) != nfield)
+      error->one(FLERR,"Bad particle line in read_particles file");
+
+    if (nbuf == maxbuf) grow_buf(nbuf+1);
+    parse_line(&buf[nbuf*nfield]);
+    nbuf++;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   find file offset of 1st line after a text snapshot that starts at start
+   that line starts with "ITEM:", or is end of file
+   procs scan consecutive blocks of the file in parallel,
+     each pass scans the next Nprocs blocks until a proc finds the end
+------------------------------------------------------------------------- */
+
+bigint ReadParticles::find_end(bigint start, bigint filesize)
+{
+  int i,n;
+  bigint lo,found,end;
+
+  char *block = new char[BLOCK+8];
+
+  end = filesize;
+  for (bigint base = start; base < filesize; base += (bigint) nprocs*BLOCK) {
+    found = filesize;
+    lo = base + (bigint) me*BLOCK;
+
+    // read block plus char before and after it
+    // match "ITEM:" preceded by a newline starting anywhere in the block
+
+    if (lo < filesize) {
+      fseek(fp,lo-1,SEEK_SET);
+      n = fread(block,sizeof(char),BLOCK+6,fp);
+      for (i = 0; i < n-5 && i < BLOCK; i++) {
+        if (block[i] != '\n') continue;
+        if (strncmp(&block[i+1],"ITEM:",5) == 0) {
+          found = lo + i;
+          break;
+        }
+      }
+    }
+
+    MPI_Allreduce(&found,&end,1,MPI_SPARTA_BIGINT,MPI_MIN,world);
+    if (end < filesize) break;
+  }
+
+  delete [] block;
+  return end;
+}
+
+/* ----------------------------------------------------------------------
+   read my portion of a binary snapshot into buf
+   particles are split evenly across procs by their index in the snapshot
+   chunkpos,chunkcount = location and size of each per-proc chunk in file
+------------------------------------------------------------------------- */
+
+void ReadParticles::read_binary(bigint np)
+{
+  MPI_Bcast(&nchunk,1,MPI_INT,0,world);
+  if (me) {
+    chunkpos = new bigint[nchunk];
+    chunkcount = new int[nchunk];
+  }
+  MPI_Bcast(chunkpos,nchunk,MPI_SPARTA_BIGINT,0,world);
+  MPI_Bcast(chunkcount,nchunk,MPI_INT,0,world);
+
+  bigint first = np*me/nprocs;
+  bigint last = np*(me+1)/nprocs;
+  if (last > first) grow_buf(last-first);
+
+  // read overlap of each chunk with my first to last particles
+
+  bigint clo,chi,lo,hi;
+  int n;
+
+  clo = 0;
+  for (int i = 0; i < nchunk; i++) {
+    chi = clo + chunkcount[i];
+    lo = MAX(clo,first);
+    hi = MIN(chi,last);
+    if (lo < hi) {
+      n = hi - lo;
+      fseek(fp,chunkpos[i] + (lo-clo)*nfield*sizeof(double),SEEK_SET);
+      if (fread(&buf[nbuf*nfield],sizeof(double),n*nfield,fp) !=
+          (size_t) n*nfield)
+        error->one(FLERR,"Unexpected end of read_particles file");
+      nbuf += n;
+    }
+    clo = chi;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   convert words in line to nfield values
+------------------------------------------------------------------------- */
+
+void ReadParticles::parse_line(double *values)
+{
+  char *word;
+
+  for (int m = 0; m < nfield; m++) {
+    if (m == 0) word = strtok(line," \t\n\r\f");
+    else word = strtok(NULL," \t\n\r\f");
+    if (word == NULL) 
+      error->one(FLERR,"Bad particle line in read_particles file");
+    values[m] = atof(word);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   insure buf can hold N particles
+------------------------------------------------------------------------- */
+
+void ReadParticles::grow_buf(int n)
+{
+  if (n <= maxbuf) return;
+  maxbuf = MAX(n,MAX(2*maxbuf,CHUNK));
+  memory->grow(buf,maxbuf*nfield,"read_particles:buf");
+}
+
+/* ----------------------------------------------------------------------
+   send particles in buf to procs that own their grid cells
+   owner is known if cell is one of my owned or ghost cells
+   else particle is sent to a rendezvous proc for its cell ID,
+     which learns owners of its cell IDs from owning procs
+   discard particles outside simulation box
+   owning procs store received particles
 ------------------------------------------------------------------------- */
 
-void ReadParticles::process_particles(int n, int, double **fields)
+void ReadParticles::route_particles()
 {
-  int id,ispecies,icell;
-  double x[3],v[3];
+  int i,m,icell;
+  cellint id;
+  double *x;
 
   Grid::ChildCell *cells = grid->cells;
   double *boxlo = domain->boxlo;
   double *boxhi = domain->boxhi;
 
-  for (int i = 0; i < n; i++) {
-    x[0] = fields[i][2];
-    x[1] = fields[i][3];
-    x[2] = fields[i][4];
+  // compress buf to particles inside box
+  // proclist = owning proc, or -1 if unknown, in which case
+  //   rlist = rendezvous proc
+
+  int *proclist,*rlist;
+  memory->create(proclist,nbuf,"read_particles:proclist");
+  memory->create(rlist,nbuf,"read_particles:rlist");
 
-    // discard particles outside simulation box
+  int n = 0;
+  int nunknown = 0;
 
+  for (i = 0; i < nbuf; i++) {
+    x = &buf[i*nfield+2];
     if (x[0] < boxlo[0] || x[0] > boxhi[0] ||
         x[1] < boxlo[1] || x[1] > boxhi[1] ||
         x[2] < boxlo[2] || x[2] > boxhi[2]) continue;
 
-    // id_find_child() recurses from root cell to find owning child cell
-    // assumes x is inside or on surface of parent cell
-    // returned icell can be owned or ghost cell
+    icell = grid->id_find_child(0,x,&id);
+    if (icell >= 0) proclist[n] = cells[icell].proc;
+    else {
+      proclist[n] = -1;
+      rlist[nunknown++] = rendezvous(id);
+    }
+    if (n != i) memcpy(&buf[n*nfield],&buf[i*nfield],nfield*sizeof(double));
+    n++;
+  }
+  nbuf = n;
+
+  int nsize = nfield*sizeof(double);
+  char *rbuf;
+  int nrecv;
+
+  // if any proc has particles with unknown owners, use rendezvous procs
+
+  int anyunknown;
+  MPI_Allreduce(&nunknown,&anyunknown,1,MPI_INT,MPI_SUM,world);
+
+  if (anyunknown) {
+
+    // send ID and owner of each child cell I own to its rendezvous proc
+    // sub cells are skipped, they have same ID as their split cell
+
+    int nglocal = grid->nlocal;
+    int nsend = 0;
+    for (icell = 0; icell < nglocal; icell++)
+      if (cells[icell].nsplit >= 1) nsend++;
+
+    CellOwner *sowner = 
+      (CellOwner *) memory->smalloc(nsend*sizeof(CellOwner),
+                                    "read_particles:sowner");
+    int *procsend;
+    memory->create(procsend,nsend,"read_particles:procsend");
+
+    nsend = 0;
+    for (icell = 0; icell < nglocal; icell++) {
+      if (cells[icell].nsplit < 1) continue;
+      sowner[nsend].id = cells[icell].id;
+      sowner[nsend].proc = me;
+      procsend[nsend++] = rendezvous(cells[icell].id);
+    }
+
+    nrecv = comm->irregular_uniform(nsend,procsend,(char *) sowner,
+                                    sizeof(CellOwner),&rbuf);
+
+#ifdef SPARTA_MAP
+    std::map<cellint,int> owner;
+#elif defined SPARTA_UNORDERED_MAP
+    std::unordered_map<cellint,int> owner;
+#else
+    std::tr1::unordered_map<cellint,int> owner;
+#endif
+
+    CellOwner *rowner = (CellOwner *) rbuf;
+    for (i = 0; i < nrecv; i++) owner[rowner[i].id] = rowner[i].proc;
+    memory->sfree(sowner);
+
+    // move particles with unknown owners to end of buf
+    // send them to rendezvous procs
+
+    double *sbuf;
+    memory->create(sbuf,MAX(nunknown,1)*nfield,"read_particles:sbuf");
+
+    m = 0;
+    n = 0;
+    for (i = 0; i < nbuf; i++) {
+      if (proclist[i] < 0) {
+        memcpy(&sbuf[m*nfield],&buf[i*nfield],nsize);
+        m++;
+      } else {
+        if (n != i) {
+          memcpy(&buf[n*nfield],&buf[i*nfield],nsize);
+          proclist[n] = proclist[i];
+        }
+        n++;
+      }
+    }
+    nbuf = n;
+
+    nrecv = comm->irregular_uniform(nunknown,rlist,(char *) sbuf,nsize,&rbuf);
+    memory->destroy(sbuf);
+
+    // append received particles to buf with their owning procs
+    // discard particle if its cell has no owner, should not happen
+
+    grow_buf(nbuf+nrecv);
+    memory->grow(proclist,MAX(nbuf+nrecv,1),"read_particles:proclist");
 
-    icell = grid->id_find_child(0,x);
+    double *rvalues = (double *) rbuf;
+    for (i = 0; i < nrecv; i++) {
+      x = &rvalues[i*nfield+2];
+      grid->id_find_child(0,x,&id);
+      if (owner.find(id) == owner.end()) continue;
+      memcpy(&buf[nbuf*nfield],&rvalues[i*nfield],nsize);
+      proclist[nbuf++] = owner[id];
+    }
+
+    memory->destroy(procsend);
+  }
+
+  // send all particles to owning procs
+
+  nrecv = comm->irregular_uniform(nbuf,proclist,(char *) buf,nsize,&rbuf);
+
+  memory->destroy(proclist);
+  memory->destroy(rlist);
+
+  // store received particles in cells I own
+
+  int pid,ispecies;
+  double *values;
+
+  double *rvalues = (double *) rbuf;
+  for (i = 0; i < nrecv; i++) {
+    values = &rvalues[i*nfield];
+    icell = grid->id_find_child(0,&values[2]);
     if (icell < 0 || cells[icell].proc != me) continue;
-        
-    id = static_cast<int> (fields[i][0]);
-    ispecies = static_cast<int> (fields[i][1]) - 1;
-    v[0] = fields[i][5];
-    v[1] = fields[i][6];
-    v[2] = fields[i][7];
-
-    particle->add_particle(id,ispecies,icell,x,v,0.0,0.0);
+
+    pid = static_cast<int> (values[0]);
+    ispecies = static_cast<int> (values[1]) - 1;
+    particle->add_particle(pid,ispecies,icell,&values[2],&values[5],0.0,0.0);
   }
 }
 
+/* ----------------------------------------------------------------------
+   rendezvous proc for a child cell ID
+------------------------------------------------------------------------- */
+
+int ReadParticles::rendezvous(cellint id)
+{
+  int proc = static_cast<int> (id % nprocs);
+  if (proc < 0) proc += nprocs;
+  return proc;
+}
+
 /* ----------------------------------------------------------------------
    read and return time stamp from dump file
    if first read reaches end-of-file, return 1
@@ -279,49 +623,84 @@ bigint ReadParticles::read_header()
 }
 
 /* ----------------------------------------------------------------------
-   read N particle lines from dump file
-   stores appropriate values in fields array
-   return 0 if success, 1 if error
+   read N lines from dump file
+   only last one is saved in line
    only called by proc 0
 ------------------------------------------------------------------------- */
 
-void ReadParticles::read_particles(int n, int nfield, double **fields)
+void ReadParticles::read_lines(int n)
 {
-  int i,m,nwords;
-  char *eof,*word;
+  char *eof = NULL;
+  if (n <= 0) return;
+  for (int i = 0; i < n; i++) eof = fgets(line,MAXLINE,fp);
+  if (eof == NULL) error->one(FLERR,"Unexpected end of read_particles file");
+}
 
-  for (i = 0; i < n; i++) {
-    eof = fgets(line,MAXLINE,fp);
-    if (eof == NULL) error->one(FLERR,"Unexpected end of read_particles file");
+/* ----------------------------------------------------------------------
+   read and return time stamp from binary dump file
+   if first read reaches end-of-file, return 1
+   only called by proc 0
+------------------------------------------------------------------------- */
 
-    if (i == 0) {
-      nwords = input->count_words(line);
-      if (nwords != nfield)
-        error->one(FLERR,"Bad particle line in read_particles file");
-    }
+int ReadParticles::read_time_binary(bigint &ntimestep)
+{
+  if (fread(&ntimestep,sizeof(bigint),1,fp) != 1) return 1;
+  return 0;
+}
 
-    // tokenize the line and convert words to fields
+/* ----------------------------------------------------------------------
+   skip binary snapshot from timestamp onward
+   only called by proc 0
+------------------------------------------------------------------------- */
 
-    for (m = 0; m < nfield; m++) {
-      if (m == 0) word = strtok(line," \t\n\r\f");
-      else word = strtok(NULL," \t\n\r\f");
-      if (word == NULL) 
-        error->one(FLERR,"Bad particle line in read_particles file");
-      fields[i][m] = atof(word);
-    }
-  }
+void ReadParticles::skip_binary()
+{
+  read_header_binary();
+
+  delete [] chunkpos;
+  delete [] chunkcount;
+  chunkpos = NULL;
+  chunkcount = NULL;
 }
 
 /* ----------------------------------------------------------------------
-   read N lines from dump file
-   only last one is saved in line
+   read remaining binary snapshot header info
+   skip boundary flags and box bounds
+   set chunkpos,chunkcount for each per-proc chunk of particle values,
+     leaves file positioned at end of last chunk
+   return natoms
    only called by proc 0
 ------------------------------------------------------------------------- */
 
-void ReadParticles::read_lines(int n)
+bigint ReadParticles::read_header_binary()
 {
-  char *eof = NULL;
-  if (n <= 0) return;
-  for (int i = 0; i < n; i++) eof = fgets(line,MAXLINE,fp);
-  if (eof == NULL) error->one(FLERR,"Unexpected end of read_particles file");
+  bigint natoms;
+  int bflag[6],size_one;
+  double boxbounds[6];
+
+  if (fread(&natoms,sizeof(bigint),1,fp) != 1 ||
+      fread(bflag,sizeof(int),6,fp) != 6 ||
+      fread(boxbounds,sizeof(double),6,fp) != 6 ||
+      fread(&size_one,sizeof(int),1,fp) != 1 ||
+      fread(&nchunk,sizeof(int),1,fp) != 1)
+    error->one(FLERR,"Unexpected end of read_particles file");
+
+  if (size_one != nfield)
+    error->one(FLERR,"Read_particles file has incorrect # of particle values");
+  if (nchunk < 0)
+    error->one(FLERR,"Read_particles file is incorrectly formatted");
+
+  chunkpos = new bigint[nchunk];
+  chunkcount = new int[nchunk];
+
+  int n;
+  for (int i = 0; i < nchunk; i++) {
+    if (fread(&n,sizeof(int),1,fp) != 1)
+      error->one(FLERR,"Unexpected end of read_particles file");
+    chunkpos[i] = ftell(fp);
+    chunkcount[i] = n/size_one;
+    fseek(fp,(bigint) n*sizeof(double),SEEK_CUR);
+  }
+
+  return natoms;
 }
@@ -33,17 +33,36 @@ class ReadParticles : protected Pointers {
   void command(int, char **);
 
  private:
-  int me,nspecies;
+  int me,nprocs,nspecies;
+  int binary;                  // 1 if binary dump file, 0 if text
   char *line;
   FILE *fp;
 
-  void process_particles(int, int, double **);
+  int nfield;                  // # of values per particle
+  int nbuf,maxbuf;             // # of particles in buf, allocated size
+  double *buf;                 // nfield values per particle I read or own
+
+  int nchunk;                  // # of per-proc chunks in binary snapshot
+  bigint *chunkpos;            // file offset of each binary chunk
+  int *chunkcount;             // # of particles in each binary chunk
 
   int read_time(bigint &);
   void skip();
   bigint read_header();
-  void read_particles(int, int, double **);
   void read_lines(int);
+
+  int read_time_binary(bigint &);
+  void skip_binary();
+  bigint read_header_binary();
+
+  void read_text(bigint, bigint);
+  bigint find_end(bigint, bigint);
+  void read_binary(bigint);
+  void parse_line(double *);
+  void grow_buf(int);
+
+  void route_particles();
+  int rendezvous(cellint);
 };
 
 }
@@ -53,11 +72,7 @@ class ReadParticles : protected Pointers {
 
 /* ERROR/WARNING messages:
 
-E: Cannot create particles before simulation box is defined
-
-Self-explanatory.
-
-E: Cannot create particles before grid is defined
+E: Cannot read particles before grid is defined
 
 Self-explanatory.
 
@@ -67,31 +82,44 @@ Self-explanatory.  Check the input script syntax and compare to the
 documentation for the command.  You can use -echo screen as a
 command-line option when running SPARTA to see the offending line.
 
-E: Create_particles mixture ID does not exist
+E: Read_particles could not open file
+
+The file could not be opened, either by proc 0 when scanning for the
+snapshot, or by other procs when reading their portion of it.
+
+E: Read_particles could not find timestep in file
 
 Self-explanatory.
 
-E: Create_particles species ID does not exist
+E: Read_particles file is incorrectly formatted
+
+The file does not have the format of a text or binary particle dump
+file.  A binary file must have a ".bin" suffix.
+
+E: Unexpected end of read_particles file
 
 Self-explanatory.
 
-E: Create_particles global option not yet implemented
+E: Bad particle line in read_particles file
 
-Self-explantory.
+The line does not have the expected number of values.
 
-E: Created incorrect # of particles: %ld versus %ld
+E: Read_particles file has incorrect # of particle values
 
-The create_particles command did not function
-properly.
+A binary dump snapshot must have 8 values per particle:
+id,type,x,y,z,vx,vy,vz.
 
-E: Create_particles single requires z = 0 for 2d simulation
+E: Read_particles file has incorrect # of particles in snapshot
+
+The number of particle lines or values in the snapshot does not match
+the count in its header.
+
+E: %d read-in particles have invalid species
 
 Self-explanatory.
 
-E: Could not create a single particle
+E: %d read-in particles are inside surface
 
-The specified position was either not inside the simulation domain or
-not inside a grid cell with no intersections with any defined surface
-elements.
+Self-explanatory.
 
 */
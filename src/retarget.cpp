@@ -0,0 +1,274 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "retarget.h"
+#include "update.h"
+#include "particle.h"
+#include "grid.h"
+#include "mixture.h"
+#include "comm.h"
+#include "random_mars.h"
+#include "random_park.h"
+#include "error.h"
+
+using namespace SPARTA_NS;
+
+/* ---------------------------------------------------------------------- */
+
+Retarget::Retarget(SPARTA *sparta) : Pointers(sparta) {}
+
+/* ----------------------------------------------------------------------
+   change freestream of a mixture and remap its existing particles
+   grid, surfs and decomposition are left as is, so the particles
+     can be used as a warm start for a run with the new freestream
+------------------------------------------------------------------------- */
+
+void Retarget::command(int narg, char **arg)
+{
+  if (!grid->exist)
+    error->all(FLERR,"Cannot retarget particles before grid is defined");
+
+  if (narg < 1) error->all(FLERR,"Illegal retarget command");
+
+  int imix = particle->find_mixture(arg[0]);
+  if (imix < 0) error->all(FLERR,"Retarget mixture ID does not exist");
+  Mixture *mixture = particle->mixture[imix];
+
+  // old freestream state of mixture
+
+  mixture->init();
+
+  double nrho_old = mixture->nrho;
+  double vstream_old[3];
+  vstream_old[0] = mixture->vstream[0];
+  vstream_old[1] = mixture->vstream[1];
+  vstream_old[2] = mixture->vstream[2];
+  double temp_old = mixture->temp_thermal;
+  double trot_old = mixture->temp_rot;
+  double tvib_old = mixture->temp_vib;
+  double fnum_old = update->fnum;
+
+  if (temp_old <= 0.0)
+    error->all(FLERR,"Retarget requires a non-zero mixture temperature");
+
+  // new values are stored as user settings of the mixture,
+  // same as if set by the mixture command
+
+  int iarg = 1;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"nrho") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal retarget command");
+      mixture->nrho_flag = 1;
+      mixture->nrho_user = atof(arg[iarg+1]);
+      if (mixture->nrho_user <= 0.0)
+        error->all(FLERR,"Illegal retarget command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"vstream") == 0) {
+      if (iarg+4 > narg) error->all(FLERR,"Illegal retarget command");
+      mixture->vstream_flag = 1;
+      mixture->vstream_user[0] = atof(arg[iarg+1]);
+      mixture->vstream_user[1] = atof(arg[iarg+2]);
+      mixture->vstream_user[2] = atof(arg[iarg+3]);
+      iarg += 4;
+    } else if (strcmp(arg[iarg],"temp") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal retarget command");
+      mixture->temp_thermal_flag = 1;
+      mixture->temp_thermal_user = atof(arg[iarg+1]);
+      if (mixture->temp_thermal_user <= 0.0)
+        error->all(FLERR,"Illegal retarget command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"trot") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal retarget command");
+      mixture->temp_rot_flag = 1;
+      mixture->temp_rot_user = atof(arg[iarg+1]);
+      if (mixture->temp_rot_user <= 0.0)
+        error->all(FLERR,"Illegal retarget command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"tvib") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal retarget command");
+      mixture->temp_vib_flag = 1;
+      mixture->temp_vib_user = atof(arg[iarg+1]);
+      if (mixture->temp_vib_user <= 0.0)
+        error->all(FLERR,"Illegal retarget command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"fnum") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal retarget command");
+      update->fnum = atof(arg[iarg+1]);
+      if (update->fnum <= 0.0) error->all(FLERR,"Illegal retarget command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal retarget command");
+  }
+
+  mixture->init();
+
+  // fnum applies to all particles, but only those in mixture are remapped,
+  //   so particles of other species would change their physical density
+
+  int *s2g = mixture->species2group;
+
+  if (update->fnum != fnum_old) {
+    Particle::OnePart *particles = particle->particles;
+    int nlocal = particle->nlocal;
+    bigint nother = 0;
+    for (int i = 0; i < nlocal; i++)
+      if (s2g[particles[i].ispecies] < 0) nother++;
+    bigint nall;
+    MPI_Allreduce(&nother,&nall,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+    if (nall)
+      error->all(FLERR,"Retarget fnum requires all particles "
+                 "to be in retargeted mixture");
+  }
+
+  double *vstream = mixture->vstream;
+  double vscale = sqrt(mixture->temp_thermal/temp_old);
+  double rscale = mixture->temp_rot/trot_old;
+  double vibscale = mixture->temp_vib/tvib_old;
+
+  // ratio of new to old simulation particle density
+
+  double factor = (mixture->nrho/update->fnum) / (nrho_old/fnum_old);
+
+  // RNG for cloning/deletion
+
+  RanPark *random = new RanPark(update->ranmaster->uniform());
+  double seed = update->ranmaster->uniform();
+  random->reset(seed,comm->me,100);
+
+  // nbefore = current total # of particles
+
+  MPI_Barrier(world);
+  double time1 = MPI_Wtime();
+
+  bigint nbefore;
+  bigint nme = particle->nlocal;
+  MPI_Allreduce(&nme,&nbefore,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+
+  // remap velocity and internal energy of particles in mixture
+  // thermal velocity is scaled about the new stream velocity
+  // then clone or delete randomly based on factor
+
+  Particle::OnePart *particles = particle->particles;
+  int nbytes = sizeof(Particle::OnePart);
+  int ncustom = particle->ncustom;
+
+  int m,ispecies,nclone,flag,bits;
+  double fraction;
+  double c[3];
+  double *v;
+
+  int nlocal = particle->nlocal;
+  int nlocal_original = nlocal;
+  int i = 0;
+
+  while (i < nlocal_original) {
+
+    // skip if particle species not in mixture
+
+    ispecies = particles[i].ispecies;
+    if (s2g[ispecies] < 0) {
+      i++;
+      continue;
+    }
+
+    v = particles[i].v;
+    c[0] = (v[0]-vstream_old[0]) * vscale;
+    c[1] = (v[1]-vstream_old[1]) * vscale;
+    c[2] = (v[2]-vstream_old[2]) * vscale;
+    v[0] = vstream[0] + c[0];
+    v[1] = vstream[1] + c[1];
+    v[2] = vstream[2] + c[2];
+    particles[i].erot *= rscale;
+    particles[i].evib *= vibscale;
+
+    // factor < 1.0 is candidate for deletion
+    // if deleted and particle that takes its place is cloned (Nloc > Norig)
+    //   then skip it via i++, else will examine it on next iteration
+    // particle moved into slot I comes from the unvisited end of the list,
+    //   so it is remapped exactly once on the next iteration
+
+    if (factor < 1.0) {
+      if (random->uniform() > factor) {
+        memcpy(&particles[i],&particles[nlocal-1],nbytes);
+        if (ncustom) particle->copy_custom(i,nlocal-1);
+        if (nlocal > nlocal_original) i++;
+        else nlocal_original--;
+        particle->nlocal--;
+        nlocal--;
+      } else i++;
+      continue;
+    }
+
+    // factor > 1.0 is candidate for cloning
+    // create Nclone new particles each with unique ID
+    // each clone reflects thermal velocity of original in a different
+    //   set of directions, so clones do not move in lockstep
+
+    nclone = static_cast<int> (factor);
+    fraction = factor - nclone;
+    nclone--;
+    if (random->uniform() < fraction) nclone++;
+
+    for (m = 0; m < nclone; m++) {
+      flag = particle->clone_particle(i);
+      if (flag) particles = particle->particles;
+      nlocal++;
+      particles[nlocal-1].id = MAXSMALLINT*random->uniform();
+      bits = m%7 + 1;
+      v = particles[nlocal-1].v;
+      if (bits & 1) v[0] = vstream[0] - c[0];
+      if (bits & 2) v[1] = vstream[1] - c[1];
+      if (bits & 4) v[2] = vstream[2] - c[2];
+    }
+    i++;
+  }
+
+  // particles were added and removed, so per-cell lists are invalid
+
+  particle->sorted = 0;
+
+  // nafter = new total # of particles
+
+  bigint nafter;
+  nme = particle->nlocal;
+  MPI_Allreduce(&nme,&nafter,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+
+  MPI_Barrier(world);
+  double time2 = MPI_Wtime();
+
+  // clean up
+
+  delete random;
+
+  // print stats
+
+  if (comm->me == 0) {
+    if (screen) {
+      fprintf(screen,"Retargeted particles\n");
+      fprintf(screen,"  before = " BIGINT_FORMAT
+              ", after = " BIGINT_FORMAT "\n",
+              nbefore,nafter);
+      fprintf(screen,"  CPU time = %g secs\n",time2-time1);
+    }
+    if (logfile) {
+      fprintf(logfile,"Retargeted particles\n");
+      fprintf(logfile,"  before = " BIGINT_FORMAT
+              ", after = " BIGINT_FORMAT "\n",
+              nbefore,nafter);
+      fprintf(logfile,"  CPU time = %g secs\n",time2-time1);
+    }
+  }
+}
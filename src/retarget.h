@@ -0,0 +1,66 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMMAND_CLASS
+
+CommandStyle(retarget,Retarget)
+
+#else
+
+#ifndef SPARTA_RETARGET_H
+#define SPARTA_RETARGET_H
+
+#include "pointers.h"
+
+namespace SPARTA_NS {
+
+class Retarget : protected Pointers {
+ public:
+  Retarget(class SPARTA *);
+  void command(int, char **);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Cannot retarget particles before grid is defined
+
+Self-explanatory.
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running SPARTA to see the offending line.
+
+E: Retarget mixture ID does not exist
+
+Self-explanatory.
+
+E: Retarget requires a non-zero mixture temperature
+
+The thermal velocities of existing particles are rescaled by the ratio
+of new to old temperature, so the old temperature cannot be 0.0.
+
+E: Retarget fnum requires all particles to be in retargeted mixture
+
+Changing fnum changes the physical density of every particle, but only
+particles of the mixture are cloned or deleted to compensate.  Remove
+particles of other species first, or retarget without fnum.
+
+*/
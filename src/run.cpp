@@ -221,6 +221,10 @@ void Run::command(int narg, char **arg)
         else finish.end(1,time_multiple_runs);
       } else finish.end(0,0.0);
 
+      // a fix halted the run early, skip remaining runs
+
+      if (update->halt) break;
+
       // wrap command invocation with clearstep/addstep
       // since a command may invoke computes via variables
 
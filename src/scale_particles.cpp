@@ -117,6 +117,10 @@ void ScaleParticles::command(int narg, char **arg)
     i++;
   }
 
+  // particles were added and removed, so per-cell lists are invalid
+
+  particle->sorted = 0;
+
   // nafter = new total # of particles
 
   bigint nafter;
@@ -32,7 +32,9 @@
 #include "input.h"
 #include "variable.h"
 #include "output.h"
+#include "comm.h"
 #include "timer.h"
+#include "perf_counter.h"
 #include "memory.h"
 #include "error.h"
 
@@ -105,6 +107,15 @@ Stats::Stats(SPARTA *sparta) : Pointers(sparta)
   format_float_user = NULL;
   format_int_user = NULL;
   format_bigint_user = NULL;
+
+  // batched reductions of Computes
+
+  maxslot = 0;
+  slots = slotsall = NULL;
+
+  MPI_Type_contiguous(sizeof(Compute::Reduce),MPI_CHAR,&reduce_type);
+  MPI_Type_commit(&reduce_type);
+  MPI_Op_create(Compute::reduce_merge,1,&reduce_op);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -114,6 +125,11 @@ Stats::~Stats()
   delete [] line;
   deallocate();
 
+  memory->sfree(slots);
+  memory->sfree(slotsall);
+  MPI_Type_free(&reduce_type);
+  MPI_Op_free(&reduce_op);
+
   // format strings
 
   delete [] format_line_user;
@@ -227,6 +243,65 @@ void Stats::header()
   }
 }
 
+/* ----------------------------------------------------------------------
+   invoke all Computes that can pack their reduction as Reduce slots
+   and merge them across procs with one MPI_Allreduce
+------------------------------------------------------------------------- */
+
+void Stats::reduce_computes()
+{
+  int i,m;
+
+  int nslot = 0;
+  nreduce = 0;
+  for (i = 0; i < ncompute; i++) {
+    if (compute_which[i] == SCALAR) {
+      if (computes[i]->invoked_flag & INVOKED_SCALAR) continue;
+    } else if (compute_which[i] == VECTOR) {
+      if (computes[i]->invoked_flag & INVOKED_VECTOR) continue;
+    } else continue;
+    int n = computes[i]->reduce_size();
+    if (n == 0) continue;
+    reducelist[nreduce++] = i;
+    nslot += n;
+  }
+
+  // nothing gained by batching a single Compute
+
+  if (nreduce < 2) return;
+
+  if (nslot > maxslot) {
+    maxslot = nslot;
+    memory->sfree(slots);
+    memory->sfree(slotsall);
+    slots = memory->smalloc(maxslot*sizeof(Compute::Reduce),"stats:slots");
+    slotsall = memory->smalloc(maxslot*sizeof(Compute::Reduce),
+                               "stats:slotsall");
+  }
+
+  Compute::Reduce *buf = (Compute::Reduce *) slots;
+  Compute::Reduce *bufall = (Compute::Reduce *) slotsall;
+
+  nslot = 0;
+  for (m = 0; m < nreduce; m++) {
+    Compute *c = computes[reducelist[m]];
+    c->reduce_pack(&buf[nslot]);
+    nslot += c->reduce_size();
+  }
+
+  MPI_Allreduce(buf,bufall,nslot,reduce_type,reduce_op,world);
+
+  nslot = 0;
+  for (m = 0; m < nreduce; m++) {
+    i = reducelist[m];
+    Compute *c = computes[i];
+    c->reduce_unpack(&bufall[nslot]);
+    nslot += c->reduce_size();
+    if (compute_which[i] == SCALAR) c->invoked_flag |= INVOKED_SCALAR;
+    else c->invoked_flag |= INVOKED_VECTOR;
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void Stats::compute(int flag)
@@ -236,6 +311,10 @@ void Stats::compute(int flag)
   firststep = flag;
 
   // invoke Compute methods needed for stats keywords
+  // first batch Computes that reduce to a global scalar or vector,
+  //   so their reductions share a single collective
+
+  reduce_computes();
 
   for (i = 0; i < ncompute; i++)
     if (compute_which[i] == SCALAR) {
@@ -402,6 +481,7 @@ void Stats::allocate()
   id_compute = new char*[n];
   compute_which = new int[n];
   computes = new Compute*[n];
+  reducelist = new int[n];
 
   nfix = 0;
   id_fix = new char*[n];
@@ -446,6 +526,7 @@ void Stats::deallocate()
   delete [] id_compute;
   delete [] compute_which;
   delete [] computes;
+  delete [] reducelist;
 
   for (int i = 0; i < nfix; i++) delete [] id_fix[i];
   delete [] id_fix;
@@ -506,6 +587,44 @@ void Stats::set_fields(int narg, char **arg)
       addfield("S/CPU",&Stats::compute_spcpu,FLOAT);
     } else if (strcmp(arg[i],"wall") == 0) {
       addfield("WALL",&Stats::compute_wall,FLOAT);
+    } else if (strcmp(arg[i],"mempeak") == 0) {
+      addfield("MemPeak",&Stats::compute_mempeak,FLOAT);
+    } else if (strcmp(arg[i],"memimbal") == 0) {
+      addfield("MemImbal",&Stats::compute_memimbal,FLOAT);
+    } else if (strcmp(arg[i],"ipc") == 0) {
+      addfield("IPC",&Stats::compute_ipc,FLOAT);
+    } else if (strcmp(arg[i],"ipcmove") == 0) {
+      addfield("IPCmove",&Stats::compute_ipcmove,FLOAT);
+    } else if (strcmp(arg[i],"ipccoll") == 0) {
+      addfield("IPCcoll",&Stats::compute_ipccoll,FLOAT);
+    } else if (strcmp(arg[i],"llcmove") == 0) {
+      addfield("LLCmove",&Stats::compute_llcmove,FLOAT);
+    } else if (strcmp(arg[i],"bcoll") == 0) {
+      addfield("Bcoll",&Stats::compute_bcoll,FLOAT);
+    } else if (strcmp(arg[i],"tmove") == 0) {
+      addfield("TMove",&Stats::compute_tmove,FLOAT);
+    } else if (strcmp(arg[i],"tcoll") == 0) {
+      addfield("TColl",&Stats::compute_tcoll,FLOAT);
+    } else if (strcmp(arg[i],"tsort") == 0) {
+      addfield("TSort",&Stats::compute_tsort,FLOAT);
+    } else if (strcmp(arg[i],"tcomm") == 0) {
+      addfield("TComm",&Stats::compute_tcomm,FLOAT);
+    } else if (strcmp(arg[i],"tmodify") == 0) {
+      addfield("TModify",&Stats::compute_tmodify,FLOAT);
+    } else if (strcmp(arg[i],"toutput") == 0) {
+      addfield("TOutput",&Stats::compute_toutput,FLOAT);
+    } else if (strcmp(arg[i],"imove") == 0) {
+      addfield("IMove",&Stats::compute_imove,FLOAT);
+    } else if (strcmp(arg[i],"icoll") == 0) {
+      addfield("IColl",&Stats::compute_icoll,FLOAT);
+    } else if (strcmp(arg[i],"isort") == 0) {
+      addfield("ISort",&Stats::compute_isort,FLOAT);
+    } else if (strcmp(arg[i],"icomm") == 0) {
+      addfield("IComm",&Stats::compute_icomm,FLOAT);
+    } else if (strcmp(arg[i],"imodify") == 0) {
+      addfield("IModify",&Stats::compute_imodify,FLOAT);
+    } else if (strcmp(arg[i],"ioutput") == 0) {
+      addfield("IOutput",&Stats::compute_ioutput,FLOAT);
 
     } else if (strcmp(arg[i],"np") == 0) {
       addfield("Np",&Stats::compute_np,BIGINT);
@@ -879,6 +998,114 @@ int Stats::evaluate_keyword(char *word, double *answer)
   } else if (strcmp(word,"wall") == 0) {
     compute_wall();
 
+  } else if (strcmp(word,"mempeak") == 0) {
+    compute_mempeak();
+
+  } else if (strcmp(word,"memimbal") == 0) {
+    compute_memimbal();
+
+  } else if (strcmp(word,"ipc") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_ipc();
+
+  } else if (strcmp(word,"ipcmove") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_ipcmove();
+
+  } else if (strcmp(word,"ipccoll") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_ipccoll();
+
+  } else if (strcmp(word,"llcmove") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_llcmove();
+
+  } else if (strcmp(word,"bcoll") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_bcoll();
+
+  } else if (strcmp(word,"tmove") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_tmove();
+
+  } else if (strcmp(word,"tcoll") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_tcoll();
+
+  } else if (strcmp(word,"tsort") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_tsort();
+
+  } else if (strcmp(word,"tcomm") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_tcomm();
+
+  } else if (strcmp(word,"tmodify") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_tmodify();
+
+  } else if (strcmp(word,"toutput") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_toutput();
+
+  } else if (strcmp(word,"imove") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_imove();
+
+  } else if (strcmp(word,"icoll") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_icoll();
+
+  } else if (strcmp(word,"isort") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_isort();
+
+  } else if (strcmp(word,"icomm") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_icomm();
+
+  } else if (strcmp(word,"imodify") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_imodify();
+
+  } else if (strcmp(word,"ioutput") == 0) {
+    if (update->runflag == 0) 
+      error->all(FLERR,
+		 "Variable stats keyword cannot be used between runs");
+    compute_ioutput();
+
   } else if (strcmp(word,"np") == 0) {
     compute_np();
     dvalue = bivalue;
@@ -1100,6 +1327,210 @@ void Stats::compute_wall()
 
 /* ---------------------------------------------------------------------- */
 
+void Stats::compute_tmove()
+{
+  timer_stats(TIME_MOVE,0);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_tcoll()
+{
+  timer_stats(TIME_COLLIDE,0);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_tsort()
+{
+  timer_stats(TIME_SORT,0);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_tcomm()
+{
+  timer_stats(TIME_COMM,0);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_tmodify()
+{
+  timer_stats(TIME_MODIFY,0);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_toutput()
+{
+  timer_stats(TIME_OUTPUT,0);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_imove()
+{
+  timer_stats(TIME_MOVE,1);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_icoll()
+{
+  timer_stats(TIME_COLLIDE,1);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_isort()
+{
+  timer_stats(TIME_SORT,1);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_icomm()
+{
+  timer_stats(TIME_COMM,1);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_imodify()
+{
+  timer_stats(TIME_MODIFY,1);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_ioutput()
+{
+  timer_stats(TIME_OUTPUT,1);
+}
+
+/* ----------------------------------------------------------------------
+   time in a timestep phase so far in this run
+   flag = 0 for average time across procs
+   flag = 1 for % imbalance = max/ave - 1 as percent
+------------------------------------------------------------------------- */
+
+void Stats::timer_stats(int which, int flag)
+{
+  if (firststep == 0) {
+    dvalue = 0.0;
+    return;
+  }
+
+  double time = timer->array[which];
+  double sum,max;
+  MPI_Allreduce(&time,&sum,1,MPI_DOUBLE,MPI_SUM,world);
+  MPI_Allreduce(&time,&max,1,MPI_DOUBLE,MPI_MAX,world);
+  double ave = sum/comm->nprocs;
+
+  if (flag == 0) dvalue = ave;
+  else if (ave > 0.0) dvalue = (max/ave - 1.0) * 100.0;
+  else dvalue = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   hardware counter metrics so far in this run, 0 if counters are off
+   IPC = instructions per cycle over whole loop or in one phase
+   LLCmove = LLC misses in Move phase per particle move
+   Bcoll = LLC bytes in Coll phase per collision, 64-byte lines
+------------------------------------------------------------------------- */
+
+void Stats::compute_ipc()
+{
+  perf_ratio(TIME_LOOP,PERF_INSTRUCTIONS,PERF_CYCLES);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_ipcmove()
+{
+  perf_ratio(TIME_MOVE,PERF_INSTRUCTIONS,PERF_CYCLES);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_ipccoll()
+{
+  perf_ratio(TIME_COLLIDE,PERF_INSTRUCTIONS,PERF_CYCLES);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_llcmove()
+{
+  bigint nmove;
+  MPI_Allreduce(&update->nmove_running,&nmove,1,
+                MPI_SPARTA_BIGINT,MPI_SUM,world);
+  perf_ratio(TIME_MOVE,PERF_LLC_MISSES,-1);
+  if (nmove) dvalue /= nmove;
+  else dvalue = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Stats::compute_bcoll()
+{
+  bigint ncollide;
+  bigint n = 0;
+  if (collide) n = collide->ncollide_running;
+  MPI_Allreduce(&n,&ncollide,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  perf_ratio(TIME_COLLIDE,PERF_LLC_MISSES,-1);
+  if (ncollide) dvalue *= 64.0/ncollide;
+  else dvalue = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   ratio of 2 counters summed over procs in a phase
+   iden = -1 for just the numerator counter
+------------------------------------------------------------------------- */
+
+void Stats::perf_ratio(int which, int inum, int iden)
+{
+  dvalue = 0.0;
+  PerfCounter *perf = timer->perf;
+  if (firststep == 0 || !perf || !perf->active[inum]) return;
+  if (iden >= 0 && !perf->active[iden]) return;
+
+  bigint num = perf->total(which,inum);
+  if (iden < 0) dvalue = num;
+  else {
+    bigint den = perf->total(which,iden);
+    if (den) dvalue = (double) num/den;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   peak Mbytes allocated on any proc so far
+------------------------------------------------------------------------- */
+
+void Stats::compute_mempeak()
+{
+  double mine = memory->peak_bytes() / 1024.0/1024.0;
+  MPI_Allreduce(&mine,&dvalue,1,MPI_DOUBLE,MPI_MAX,world);
+}
+
+/* ----------------------------------------------------------------------
+   % imbalance of peak Mbytes allocated across procs = max/ave - 1
+------------------------------------------------------------------------- */
+
+void Stats::compute_memimbal()
+{
+  double mine = memory->peak_bytes() / 1024.0/1024.0;
+  double sum,max;
+  MPI_Allreduce(&mine,&sum,1,MPI_DOUBLE,MPI_SUM,world);
+  MPI_Allreduce(&mine,&max,1,MPI_DOUBLE,MPI_MAX,world);
+  double ave = sum/comm->nprocs;
+  if (ave > 0.0) dvalue = (max/ave - 1.0) * 100.0;
+  else dvalue = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
 void Stats::compute_np()
 {
   bigint n = particle->nlocal;
@@ -67,6 +67,13 @@ class Stats : protected Pointers {
   int *compute_which;          // 0/1/2 if should call scalar,vector,array
   class Compute **computes;    // list of ptrs to the Compute objects
 
+  int nreduce;                 // # of Computes batched into one reduction
+  int *reducelist;             // indices in computes of batched Computes
+  int maxslot;                 // max # of packed Reduce slots in buffers
+  void *slots,*slotsall;       // packed local and global Compute::Reduce
+  MPI_Datatype reduce_type;    // MPI type and op for Compute::Reduce
+  MPI_Op reduce_op;
+
   int nfix;                    // # of Fix objects called by stats
   char **id_fix;               // their IDs
   class Fix **fixes;           // list of ptrs to the Fix objects
@@ -87,6 +94,7 @@ class Stats : protected Pointers {
 
   void allocate();
   void deallocate();
+  void reduce_computes();
 
   int add_compute(const char *, int);
   int add_fix(const char *);
@@ -115,6 +123,27 @@ class Stats : protected Pointers {
   void compute_tpcpu();
   void compute_spcpu();
   void compute_wall();
+  void compute_tmove();
+  void compute_tcoll();
+  void compute_tsort();
+  void compute_tcomm();
+  void compute_tmodify();
+  void compute_toutput();
+  void compute_imove();
+  void compute_icoll();
+  void compute_isort();
+  void compute_icomm();
+  void compute_imodify();
+  void compute_ioutput();
+  void timer_stats(int, int);
+  void compute_ipc();
+  void compute_ipcmove();
+  void compute_ipccoll();
+  void compute_llcmove();
+  void compute_bcoll();
+  void perf_ratio(int, int, int);
+  void compute_mempeak();
+  void compute_memimbal();
 
   void compute_np();
   void compute_ntouch();
@@ -36,6 +36,7 @@ class SurfCollide : protected Pointers {
                                      double &, int) = 0;
 
   virtual void dynamic() {}
+  virtual void reseed() {}
   void tally_update();
   double compute_vector(int i);
 
@@ -27,6 +27,8 @@
 #include "comm.h"
 #include "random_mars.h"
 #include "random_park.h"
+#include "random_philox.h"
+#include "math_random.h"
 #include "math_const.h"
 #include "math_extra.h"
 #include "error.h"
@@ -59,6 +61,8 @@ SurfCollideDiffuse::SurfCollideDiffuse(SPARTA *sparta, int narg, char **arg) :
   // optional args
 
   tflag = rflag = 0;
+  rngpart = 0;
+  rstream = NULL;
 
   int iarg = 4;
   while (iarg < narg) {
@@ -85,6 +89,13 @@ SurfCollideDiffuse::SurfCollideDiffuse(SPARTA *sparta, int narg, char **arg) :
       if (domain->dimension == 2 && (wx != 0.0 || wy != 0.0))
         error->all(FLERR,"Surf_collide diffuse rotation invalid for 2d");
       iarg += 7;
+    } else if (strcmp(arg[iarg],"rng") == 0) {
+      if (iarg+2 > narg) 
+        error->all(FLERR,"Illegal surf_collide diffuse command");
+      if (strcmp(arg[iarg+1],"proc") == 0) rngpart = 0;
+      else if (strcmp(arg[iarg+1],"particle") == 0) rngpart = 1;
+      else error->all(FLERR,"Illegal surf_collide diffuse command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal surf_collide diffuse command");
   }
 
@@ -97,6 +108,11 @@ SurfCollideDiffuse::SurfCollideDiffuse(SPARTA *sparta, int narg, char **arg) :
   random = new RanPark(update->ranmaster->uniform());
   double seed = update->ranmaster->uniform();
   random->reset(seed,comm->me,100);
+
+  if (rngpart) {
+    int rseed = static_cast<int> (update->ranmaster->uniform()*MAXSMALLINT);
+    rstream = new RanPhilox(rseed,0);
+  }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -107,6 +123,7 @@ SurfCollideDiffuse::~SurfCollideDiffuse()
 
   delete [] tstr;
   delete random;
+  delete rstream;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -137,10 +154,21 @@ void SurfCollideDiffuse::init()
 ------------------------------------------------------------------------- */
 
 Particle::OnePart *SurfCollideDiffuse::
-collide(Particle::OnePart *&ip, double *norm, double &, int isr)
+collide(Particle::OnePart *&ip, double *norm, double &dtremain, int isr)
 {
   nsingle++;
 
+  // if requested, reseed RNG from counter-based RNG
+  // keyed by timestep, particle ID and remaining timestep fraction
+  //   which distinguishes multiple collisions of one particle in a step
+
+  if (rngpart) {
+    bigint dtbits;
+    memcpy(&dtbits,&dtremain,sizeof(bigint));
+    rstream->reset(update->ntimestep,ip->id,dtbits);
+    random->reset(rstream->uniform(),0,0);
+  }
+
   // if surface chemistry defined, attempt reaction
   // reaction = 1 if reaction took place
 
@@ -220,7 +248,7 @@ void SurfCollideDiffuse::diffuse(Particle::OnePart *p, double *norm)
     double *v = p->v;
     double dot = MathExtra::dot3(v,norm);
 
-    double beta_un,normalized_distbn_fn;
+    double beta_un;
 
     tangent1[0] = v[0] - dot*norm[0];
     tangent1[1] = v[1] - dot*norm[1];
@@ -247,15 +275,7 @@ void SurfCollideDiffuse::diffuse(Particle::OnePart *p, double *norm)
      
         if (fabs(dot) > 0.001) {
           dot /= vrm;
-          do {
-            do {
-              beta_un = (6.0*random->uniform() - 3.0);
-            } while (beta_un + dot < 0.0);
-            normalized_distbn_fn = 2.0 * (beta_un + dot) /
-              (dot + sqrt(dot*dot + 2.0)) *
-              exp(0.5 + (0.5*dot)*(dot-sqrt(dot*dot + 2.0)) -
-                  beta_un*beta_un);
-          } while (normalized_distbn_fn < random->uniform());
+          beta_un = MathRandom::flux_normal(random,dot);
           vperp = beta_un*vrm;
         }
 
@@ -296,3 +316,19 @@ void SurfCollideDiffuse::dynamic()
   twall = input->variable->compute_equal(tvar);
   if (twall <= 0.0) error->all(FLERR,"Surf_collide diffuse temp <= 0.0");
 }
+
+/* ----------------------------------------------------------------------
+   re-derive reflection RNGs from master RNG after it is re-seeded
+------------------------------------------------------------------------- */
+
+void SurfCollideDiffuse::reseed()
+{
+  double seed = update->ranmaster->uniform();
+  random->reset(seed,comm->me,100);
+
+  if (rstream) {
+    delete rstream;
+    int rseed = static_cast<int> (update->ranmaster->uniform()*MAXSMALLINT);
+    rstream = new RanPhilox(rseed,0);
+  }
+}
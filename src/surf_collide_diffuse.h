@@ -34,6 +34,7 @@ class SurfCollideDiffuse : public SurfCollide {
   Particle::OnePart *collide(Particle::OnePart *&, double *, double &, int);
 
   void dynamic();
+  void reseed();
 
  protected:
   double twall;              // surface temperature
@@ -48,6 +49,8 @@ class SurfCollideDiffuse : public SurfCollide {
   int tvar;                  // index of equal-style variable
 
   class RanPark *random;     // RNG for particle reflection
+  int rngpart;               // 1 if RNG is reseeded per particle collision
+  class RanPhilox *rstream;  // counter-based RNG for per-collision seeds
 
   void diffuse(Particle::OnePart *, double *);
 };
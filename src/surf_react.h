@@ -32,6 +32,7 @@ class SurfReact : protected Pointers {
   virtual ~SurfReact();
   virtual void init();
   virtual int react(Particle::OnePart *&, double *, Particle::OnePart *&) = 0;
+  virtual void reseed() {}
 
   void tally_update();
   double compute_vector(int i);
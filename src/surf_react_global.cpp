@@ -89,3 +89,13 @@ int SurfReactGlobal::react(Particle::OnePart *&ip, double *,
 
   return 0;
 }
+
+/* ----------------------------------------------------------------------
+   re-derive reaction RNG from re-seeded master RNG
+------------------------------------------------------------------------- */
+
+void SurfReactGlobal::reseed()
+{
+  double seed = update->ranmaster->uniform();
+  random->reset(seed,comm->me,100);
+}
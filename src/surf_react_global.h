@@ -30,6 +30,7 @@ class SurfReactGlobal : public SurfReact {
   SurfReactGlobal(class SPARTA *, int, char **);
   ~SurfReactGlobal();
   int react(Particle::OnePart *&, double *, Particle::OnePart *&);
+  void reseed();
 
  private:
   double prob_create,prob_destroy;
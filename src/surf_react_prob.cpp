@@ -117,3 +117,13 @@ int SurfReactProb::react(Particle::OnePart *&ip, double *,
 
   return 0;
 }
+
+/* ----------------------------------------------------------------------
+   re-derive reaction RNG from re-seeded master RNG
+------------------------------------------------------------------------- */
+
+void SurfReactProb::reseed()
+{
+  double seed = update->ranmaster->uniform();
+  random->reset(seed,comm->me,100);
+}
@@ -31,6 +31,7 @@ class SurfReactProb : public SurfReact {
   ~SurfReactProb();
   void init();
   int react(Particle::OnePart *&, double *, Particle::OnePart *&);
+  void reseed();
 
  private:
   class RanPark *random;     // RNG for reaction probabilities
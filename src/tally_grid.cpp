@@ -0,0 +1,334 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#include "string.h"
+#include "tally_grid.h"
+#include "particle.h"
+#include "mixture.h"
+#include "grid.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace SPARTA_NS;
+
+#define DELTASET 4
+
+// # of velocity moments tallied for each moment order
+// internal energy moments follow them
+
+static const int NVELOCITY[4] = {2,5,12,21};
+
+/* ----------------------------------------------------------------------
+   shared per-cell particle moments for grid computes
+   each compute requests a set of moments for its mixture and grid group
+   requests with same mixture, grid group, and species/group binning
+     share one set, tallied by one pass over particles per invocation
+   a set tallies all moments up to its highest requested velocity order,
+     so each set has one specialized accumulation kernel without branches
+------------------------------------------------------------------------- */
+
+TallyGrid::TallyGrid(SPARTA *sparta) : Pointers(sparta)
+{
+  nset = maxset = 0;
+  sets = NULL;
+
+  stamp = 0;
+  laststep = -1;
+
+  maxcol = 0;
+  cols = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+TallyGrid::~TallyGrid()
+{
+  for (int i = 0; i < nset; i++) memory->destroy(sets[i].tally);
+  memory->sfree(sets);
+  memory->destroy(cols);
+}
+
+/* ----------------------------------------------------------------------
+   request N moments in list for mixture imix and grid group groupbit
+   perspecies = 1 to bin by species of mixture, 0 to bin by mixture group
+   return index of set that will tally them
+------------------------------------------------------------------------- */
+
+int TallyGrid::request(int imix, int groupbit, int perspecies,
+                       int n, int *list)
+{
+  int order = 0;
+  int internal = 0;
+  for (int i = 0; i < n; i++) {
+    if (list[i] >= EROT) internal = 1;
+    else if (list[i] >= MVXXX) order = MAX(order,3);
+    else if (list[i] >= MVXX) order = MAX(order,2);
+    else if (list[i] >= MVX) order = MAX(order,1);
+  }
+
+  int iset;
+  for (iset = 0; iset < nset; iset++)
+    if (sets[iset].imix == imix && sets[iset].groupbit == groupbit &&
+        sets[iset].perspecies == perspecies) break;
+
+  if (iset == nset) {
+    if (nset == maxset) {
+      maxset += DELTASET;
+      sets = (Set *) memory->srealloc(sets,maxset*sizeof(Set),"tally:sets");
+    }
+    memset(&sets[nset],0,sizeof(Set));
+    sets[nset].imix = imix;
+    sets[nset].groupbit = groupbit;
+    sets[nset].perspecies = perspecies;
+    sets[nset].stamp = -1;
+    nset++;
+  }
+
+  // raising order or adding internal moments changes column layout
+  // force re-tally and reallocation on next invocation
+
+  Set *s = &sets[iset];
+  if (order > s->order || internal > s->internal) {
+    s->order = MAX(order,s->order);
+    s->internal = MAX(internal,s->internal);
+    s->nglocal = -1;
+    s->stamp = -1;
+  }
+
+  return iset;
+}
+
+/* ----------------------------------------------------------------------
+   return column in set iset's tally array for moment of group/species ibin
+------------------------------------------------------------------------- */
+
+int TallyGrid::column(int iset, int ibin, int moment)
+{
+  Set *s = &sets[iset];
+  if (moment < EROT) return ibin*s->nper + moment;
+  return ibin*s->nper + NVELOCITY[s->order] + moment-EROT;
+}
+
+/* ----------------------------------------------------------------------
+   mark all tallies stale, e.g. when computes are cleared for a new
+     round of invocations, since particles may have changed
+------------------------------------------------------------------------- */
+
+void TallyGrid::invalidate()
+{
+  stamp++;
+}
+
+/* ----------------------------------------------------------------------
+   return per-cell moments of set iset, tallying them if stale
+------------------------------------------------------------------------- */
+
+double **TallyGrid::compute(int iset)
+{
+  if (update->ntimestep != laststep) {
+    laststep = update->ntimestep;
+    invalidate();
+  }
+
+  Set *s = &sets[iset];
+  if (s->stamp == stamp && s->nglocal == grid->nlocal) return s->tally;
+  s->stamp = stamp;
+
+  grow_set(s);
+  if (s->nglocal && s->ntotal)
+    memset(&s->tally[0][0],0,s->nglocal*s->ntotal*sizeof(double));
+
+  int which = 2*s->order + s->internal;
+  switch (which) {
+  case 0: tally_set<0,0>(s); break;
+  case 1: tally_set<0,1>(s); break;
+  case 2: tally_set<1,0>(s); break;
+  case 3: tally_set<1,1>(s); break;
+  case 4: tally_set<2,0>(s); break;
+  case 5: tally_set<2,1>(s); break;
+  case 6: tally_set<3,0>(s); break;
+  case 7: tally_set<3,1>(s); break;
+  }
+
+  return s->tally;
+}
+
+/* ----------------------------------------------------------------------
+   copy N moments of set iset into columns 0 to N-1 of a compute's array
+   bin,moment = group/species and moment for each column of array
+   array must have grid->nlocal rows
+------------------------------------------------------------------------- */
+
+void TallyGrid::gather(int iset, int n, int *bin, int *moment, double **array)
+{
+  double **tally = compute(iset);
+
+  if (n > maxcol) {
+    maxcol = n;
+    memory->destroy(cols);
+    memory->create(cols,maxcol,"tally:cols");
+  }
+  for (int j = 0; j < n; j++) cols[j] = column(iset,bin[j],moment[j]);
+
+  int nglocal = sets[iset].nglocal;
+  double *vec,*tvec;
+
+  for (int i = 0; i < nglocal; i++) {
+    vec = array[i];
+    tvec = tally[i];
+    for (int j = 0; j < n; j++) vec[j] = tvec[cols[j]];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   reallocate tally of a set if grid cell count or its layout changed
+------------------------------------------------------------------------- */
+
+void TallyGrid::grow_set(Set *s)
+{
+  int nbin;
+  if (s->perspecies) nbin = particle->nspecies;
+  else nbin = particle->mixture[s->imix]->ngroup;
+
+  int nper = NVELOCITY[s->order] + 4*s->internal;
+  int ntotal = nbin*nper;
+
+  if (s->nglocal == grid->nlocal && s->ntotal == ntotal) return;
+
+  s->nper = nper;
+  s->ntotal = ntotal;
+  s->nglocal = grid->nlocal;
+  memory->destroy(s->tally);
+  memory->create(s->tally,s->nglocal,s->ntotal,"tally:tally");
+}
+
+/* ----------------------------------------------------------------------
+   add moments of one particle to vec = moments of its group/species
+   ORDER,INTERNAL are compile-time so each kernel has no branches
+------------------------------------------------------------------------- */
+
+template <int ORDER, int INTERNAL>
+static inline void accumulate(double *vec, Particle::OnePart *p,
+                              Particle::Species *sp)
+{
+  double mass = sp->mass;
+  double *v = p->v;
+
+  vec[TallyGrid::COUNT] += 1.0;
+  vec[TallyGrid::MASS] += mass;
+
+  if (ORDER >= 1) {
+    vec[TallyGrid::MVX] += mass*v[0];
+    vec[TallyGrid::MVY] += mass*v[1];
+    vec[TallyGrid::MVZ] += mass*v[2];
+  }
+
+  if (ORDER >= 2) {
+    vec[TallyGrid::MVXX] += mass*v[0]*v[0];
+    vec[TallyGrid::MVYY] += mass*v[1]*v[1];
+    vec[TallyGrid::MVZZ] += mass*v[2]*v[2];
+    vec[TallyGrid::MVXY] += mass*v[0]*v[1];
+    vec[TallyGrid::MVYZ] += mass*v[1]*v[2];
+    vec[TallyGrid::MVXZ] += mass*v[0]*v[2];
+    vec[TallyGrid::MVSQ] += mass * (v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
+  }
+
+  if (ORDER >= 3) {
+    vec[TallyGrid::MVXXX] += mass*v[0]*v[0]*v[0];
+    vec[TallyGrid::MVYYY] += mass*v[1]*v[1]*v[1];
+    vec[TallyGrid::MVZZZ] += mass*v[2]*v[2]*v[2];
+    vec[TallyGrid::MVXYY] += mass*v[0]*v[1]*v[1];
+    vec[TallyGrid::MVXZZ] += mass*v[0]*v[2]*v[2];
+    vec[TallyGrid::MVYXX] += mass*v[1]*v[0]*v[0];
+    vec[TallyGrid::MVYZZ] += mass*v[1]*v[2]*v[2];
+    vec[TallyGrid::MVZXX] += mass*v[2]*v[0]*v[0];
+    vec[TallyGrid::MVZYY] += mass*v[2]*v[1]*v[1];
+  }
+
+  if (INTERNAL) {
+    double *ivec = &vec[NVELOCITY[ORDER]];
+    ivec[0] += p->erot;
+    ivec[1] += p->evib;
+    ivec[2] += sp->rotdof;
+    ivec[3] += sp->vibdof;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   one pass over particles to tally all moments of a set
+   if particles are sorted, loop over cells in the grid group,
+     so each cell's moments stay in cache and unused cells are skipped
+   else loop over particles in storage order
+   both orders add a cell's particles in ascending index order
+------------------------------------------------------------------------- */
+
+template <int ORDER, int INTERNAL>
+void TallyGrid::tally_set(Set *s)
+{
+  Grid::ChildInfo *cinfo = grid->cinfo;
+  Particle::Species *species = particle->species;
+  Particle::OnePart *particles = particle->particles;
+  int *s2g = particle->mixture[s->imix]->species2group;
+  int *next = particle->next;
+  int nlocal = particle->nlocal;
+  int nglocal = s->nglocal;
+  int groupbit = s->groupbit;
+  int perspecies = s->perspecies;
+  int nper = s->nper;
+  double **tally = s->tally;
+
+  int i,ispecies,ibin,icell;
+  double *vec;
+
+  if (particle->sorted) {
+    for (icell = 0; icell < nglocal; icell++) {
+      if (!(cinfo[icell].mask & groupbit)) continue;
+      vec = tally[icell];
+      for (i = cinfo[icell].first; i >= 0; i = next[i]) {
+        ispecies = particles[i].ispecies;
+        ibin = s2g[ispecies];
+        if (ibin < 0) continue;
+        if (perspecies) ibin = ispecies;
+        accumulate<ORDER,INTERNAL>(&vec[ibin*nper],&particles[i],
+                                   &species[ispecies]);
+      }
+    }
+
+  } else {
+    for (i = 0; i < nlocal; i++) {
+      ispecies = particles[i].ispecies;
+      ibin = s2g[ispecies];
+      if (ibin < 0) continue;
+      icell = particles[i].icell;
+      if (!(cinfo[icell].mask & groupbit)) continue;
+      if (perspecies) ibin = ispecies;
+      accumulate<ORDER,INTERNAL>(&tally[icell][ibin*nper],&particles[i],
+                                 &species[ispecies]);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of all tallies
+------------------------------------------------------------------------- */
+
+bigint TallyGrid::memory_usage()
+{
+  bigint bytes = 0;
+  for (int i = 0; i < nset; i++)
+    if (sets[i].nglocal > 0) 
+      bytes += (bigint) sets[i].nglocal * sets[i].ntotal * sizeof(double);
+  return bytes;
+}
@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifndef SPARTA_TALLY_GRID_H
+#define SPARTA_TALLY_GRID_H
+
+#include "pointers.h"
+
+namespace SPARTA_NS {
+
+class TallyGrid : protected Pointers {
+ public:
+
+  // per-cell particle moments that can be tallied
+  // ordered by velocity moment order, internal energy moments last
+
+  enum{COUNT,MASS,
+       MVX,MVY,MVZ,
+       MVXX,MVYY,MVZZ,MVXY,MVYZ,MVXZ,MVSQ,
+       MVXXX,MVYYY,MVZZZ,MVXYY,MVXZZ,MVYXX,MVYZZ,MVZXX,MVZYY,
+       EROT,EVIB,DOFROT,DOFVIB,NMOMENT};
+
+  TallyGrid(class SPARTA *);
+  ~TallyGrid();
+  int request(int, int, int, int, int *);
+  double **compute(int);
+  int column(int, int, int);
+  void gather(int, int, int *, int *, double **);
+  void invalidate();
+  bigint memory_usage();
+
+ private:
+  struct Set {
+    int imix;            // mixture whose groups the moments are tallied for
+    int groupbit;        // grid group bitmask of tallied cells
+    int perspecies;      // 1 if tallied per species, 0 if per mixture group
+    int order;           // highest velocity moment order tallied, 0 to 3
+    int internal;        // 1 if rot/vib energy and dof are tallied
+    int nper;            // # of moments per group or species
+    int ntotal;          // # of columns in tally
+    int nglocal;         // # of cells tally is allocated for
+    int stamp;           // value of stamp when moments were last tallied
+    double **tally;      // per-cell moments, cells by ntotal
+  };
+
+  int nset,maxset;       // sets of moments requested by computes
+  Set *sets;
+
+  int stamp;             // incremented whenever tallies become stale
+  bigint laststep;       // timestep of last tally
+
+  int maxcol;            // length of cols
+  int *cols;             // scratch list of columns for gather()
+
+  void grow_set(Set *);
+  template <int, int> void tally_set(Set *);
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+*/
@@ -13,49 +13,93 @@
 ------------------------------------------------------------------------- */
 
 #include "mpi.h"
+#include "string.h"
 #include "timer.h"
+#include "perf_counter.h"
 #include "memory.h"
+#include "error.h"
 
 using namespace SPARTA_NS;
 
+#define DELTA 16
+
+static const char *phases[TIME_N] = 
+  {"Loop","Move","Coll","Sort","Comm","Modfy","Outpt"};
+
 /* ---------------------------------------------------------------------- */
 
 Timer::Timer(SPARTA *sparta) : Pointers(sparta)
 {
-  memory->create(array,TIME_N,"array");
+  level = TIMER_NORMAL;
+  sync = 0;
+  running = 0;
+  trace = NULL;
+  perf = NULL;
+
+  nregion = maxregion = 0;
+  rname = NULL;
+  rparent = rlevel = NULL;
+  rcount = NULL;
+  array = rstart = NULL;
+
+  // timestep phases, then fixed sub-regions of phases
+  // fixes and dumps add their own regions when they are created
+  // computes invoked by a fix add a region nested in that fix region
+
+  add_region(phases[TIME_LOOP],-1,TIMER_OFF);
+  for (int i = 1; i < TIME_N; i++) add_region(phases[i],TIME_LOOP,TIMER_OFF);
+
+  move_surf = add_region("Surf collide",TIME_MOVE,TIMER_FULL);
+  comm_pack = add_region("Pack",TIME_COMM,TIMER_NORMAL);
+  comm_exchange = add_region("Exchange",TIME_COMM,TIMER_NORMAL);
+  comm_unpack = add_region("Unpack",TIME_COMM,TIMER_NORMAL);
 }
 
 /* ---------------------------------------------------------------------- */
 
 Timer::~Timer()
 {
+  delete trace;
+  delete perf;
+  for (int i = 0; i < nregion; i++) delete [] rname[i];
+  memory->sfree(rname);
+  memory->destroy(rparent);
+  memory->destroy(rlevel);
+  memory->destroy(rcount);
   memory->destroy(array);
+  memory->destroy(rstart);
 }
 
 /* ---------------------------------------------------------------------- */
 
 void Timer::init()
 {
-  for (int i = 0; i < TIME_N; i++) array[i] = 0.0;
+  for (int i = 0; i < nregion; i++) {
+    array[i] = 0.0;
+    rcount[i] = 0;
+  }
+  if (perf) perf->init();
 }
 
 /* ---------------------------------------------------------------------- */
 
 void Timer::stamp()
 {
-  // uncomment if want synchronized timing
-  // MPI_Barrier(world);
+  if (sync) MPI_Barrier(world);
   previous_time = MPI_Wtime();
+  if (perf) perf->start();
 }
 
 /* ---------------------------------------------------------------------- */
 
 void Timer::stamp(int which)
 {
-  // uncomment if want synchronized timing
-  // MPI_Barrier(world);
+  if (sync) MPI_Barrier(world);
   double current_time = MPI_Wtime();
   array[which] += current_time - previous_time;
+  rcount[which]++;
+  if (trace) trace->add(which,previous_time,current_time);
+  if (perf) perf->stamp(which);
   previous_time = current_time;
 }
 
@@ -65,6 +109,7 @@ void Timer::barrier_start(int which)
 {
   MPI_Barrier(world);
   array[which] = MPI_Wtime();
+  running = 1;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -73,7 +118,12 @@ void Timer::barrier_stop(int which)
 {
   MPI_Barrier(world);
   double current_time = MPI_Wtime();
+  if (trace) trace->add(which,array[which],current_time);
   array[which] = current_time - array[which];
+  rcount[which]++;
+  running = 0;
+
+  if (trace) trace->write();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -83,3 +133,74 @@ double Timer::elapsed(int which)
   double current_time = MPI_Wtime();
   return (current_time - array[which]);
 }
+
+/* ----------------------------------------------------------------------
+   process timer command
+------------------------------------------------------------------------- */
+
+void Timer::modify_params(int narg, char **arg)
+{
+  if (narg < 1) error->all(FLERR,"Illegal timer command");
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"off") == 0) level = TIMER_OFF;
+    else if (strcmp(arg[iarg],"normal") == 0) level = TIMER_NORMAL;
+    else if (strcmp(arg[iarg],"full") == 0) level = TIMER_FULL;
+    else if (strcmp(arg[iarg],"sync") == 0) sync = 1;
+    else if (strcmp(arg[iarg],"nosync") == 0) sync = 0;
+    else if (strcmp(arg[iarg],"perf") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal timer command");
+      delete perf;
+      perf = NULL;
+      if (strcmp(arg[iarg+1],"yes") == 0) {
+        perf = new PerfCounter(sparta);
+        if (!perf->available()) {
+          delete perf;
+          perf = NULL;
+        }
+      } else if (strcmp(arg[iarg+1],"no") != 0)
+        error->all(FLERR,"Illegal timer command");
+      iarg++;
+    } else error->all(FLERR,"Illegal timer command");
+    iarg++;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return index of region with name and parent, add it if new
+   minlevel = timer level at which region is timed
+   all procs must add same regions in same order,
+     so that per-region stats can be reduced across procs
+------------------------------------------------------------------------- */
+
+int Timer::add_region(const char *name, int parent, int minlevel)
+{
+  for (int i = 0; i < nregion; i++)
+    if (rparent[i] == parent && strcmp(rname[i],name) == 0) {
+      rlevel[i] = minlevel;
+      return i;
+    }
+
+  if (nregion == maxregion) {
+    maxregion += DELTA;
+    rname = (char **) 
+      memory->srealloc(rname,maxregion*sizeof(char *),"timer:rname");
+    memory->grow(rparent,maxregion,"timer:rparent");
+    memory->grow(rlevel,maxregion,"timer:rlevel");
+    memory->grow(rcount,maxregion,"timer:rcount");
+    memory->grow(array,maxregion,"timer:array");
+    memory->grow(rstart,maxregion,"timer:rstart");
+  }
+
+  int n = strlen(name) + 1;
+  rname[nregion] = new char[n];
+  strcpy(rname[nregion],name);
+  rparent[nregion] = parent;
+  rlevel[nregion] = minlevel;
+  rcount[nregion] = 0;
+  array[nregion] = 0.0;
+  rstart[nregion] = 0.0;
+
+  return nregion++;
+}
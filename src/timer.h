@@ -15,15 +15,30 @@
 #ifndef SPARTA_TIMER_H
 #define SPARTA_TIMER_H
 
+#include "mpi.h"
 #include "pointers.h"
+#include "trace.h"
 
 namespace SPARTA_NS {
 
 enum{TIME_LOOP,TIME_MOVE,TIME_COLLIDE,TIME_SORT,TIME_COMM,TIME_MODIFY,TIME_OUTPUT,TIME_N};
+enum{TIMER_OFF,TIMER_NORMAL,TIMER_FULL};
 
 class Timer : protected Pointers {
  public:
-  double *array;
+  double *array;           // accumulated time of each region
+                           // 1st TIME_N regions are the timestep phases
+
+  int level;               // OFF,NORMAL,FULL = which regions are timed
+  int sync;                // 1 if barrier before each phase stamp
+
+  // fixed sub-regions of timestep phases
+
+  int comm_pack,comm_exchange,comm_unpack;
+  int move_surf;
+
+  class Trace *trace;      // records region events if trace command used
+  class PerfCounter *perf; // hardware counters per phase if enabled
 
   Timer(class SPARTA *);
   ~Timer();
@@ -34,10 +49,47 @@ class Timer : protected Pointers {
   void barrier_stop(int);
   double elapsed(int);
 
+  void modify_params(int, char **);
+  int add_region(const char *, int, int);
+
+  int nregion;             // # of timed regions
+  char **rname;            // name of each region
+  int *rparent;            // parent region, -1 for TIME_LOOP
+  int *rlevel;             // min level at which region is timed
+  bigint *rcount;          // # of times region was timed
+
+  // nested named region, timed only inside run loop if level allows
+
+  void start(int i) {
+    if (!running || rlevel[i] > level) return;
+    rstart[i] = MPI_Wtime();
+  }
+
+  void stop(int i) {
+    if (!running || rlevel[i] > level) return;
+    double current_time = MPI_Wtime();
+    array[i] += current_time - rstart[i];
+    rcount[i]++;
+    if (trace) trace->add(i,rstart[i],current_time);
+  }
+
  private:
   double previous_time;
+  int running;             // 1 if inside run loop
+  int maxregion;
+  double *rstart;          // start time of each region
 };
 
 }
 
 #endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal timer command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running SPARTA to see the offending line.
+
+*/
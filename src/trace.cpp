@@ -0,0 +1,203 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#include "spatype.h"
+#include "mpi.h"
+#include "stdlib.h"
+#include "string.h"
+#include "trace.h"
+#include "update.h"
+#include "timer.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace SPARTA_NS;
+
+#define MAXEVENT 100000
+#define MIN(A,B) ((A) < (B) ? (A) : (B))
+#define MAXLINE 256
+
+/* ----------------------------------------------------------------------
+   trace file Nevery keyword value ...
+   events are written as Chrome trace-event JSON, one process per rank
+------------------------------------------------------------------------- */
+
+Trace::Trace(SPARTA *sparta, int narg, char **arg) : Pointers(sparta)
+{
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  if (narg < 2) error->all(FLERR,"Illegal trace command");
+  nevery = atoi(arg[1]);
+  if (nevery < 0) error->all(FLERR,"Illegal trace command");
+
+  maxevent = MAXEVENT;
+
+  int iarg = 2;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"buffer") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal trace command");
+      maxevent = atoi(arg[iarg+1]);
+      if (maxevent <= 0) error->all(FLERR,"Illegal trace command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal trace command");
+  }
+
+  events = (Event *) memory->smalloc(maxevent*sizeof(Event),"trace:events");
+  nevent = ifirst = 0;
+  ndropped = 0;
+  sbuf = NULL;
+  maxsbuf = 0;
+
+  // JSON array format, closed by destructor
+  // Perfetto also accepts a file whose closing bracket is missing,
+  //   so a trace from a run that crashed is still readable
+  // name each rank's process so they sort by rank
+
+  fp = NULL;
+  if (me == 0) {
+    fp = fopen(arg[0],"w");
+    if (fp == NULL) {
+      char str[128];
+      sprintf(str,"Cannot open trace file %s",arg[0]);
+      error->one(FLERR,str);
+    }
+    fprintf(fp,"[\n");
+    for (int iproc = 0; iproc < nprocs; iproc++) {
+      if (iproc) fprintf(fp,",\n");
+      fprintf(fp,"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+              "\"args\":{\"name\":\"rank %d\"}},\n",iproc,iproc);
+      fprintf(fp,"{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,"
+              "\"args\":{\"sort_index\":%d}}",iproc,iproc);
+    }
+    fflush(fp);
+  }
+
+  // event times are relative to when all procs leave this barrier
+
+  MPI_Barrier(world);
+  tzero = MPI_Wtime();
+}
+
+/* ---------------------------------------------------------------------- */
+
+Trace::~Trace()
+{
+  if (fp) {
+    fprintf(fp,"\n]\n");
+    fclose(fp);
+  }
+  memory->sfree(events);
+  memory->destroy(sbuf);
+}
+
+/* ----------------------------------------------------------------------
+   add an event for a Timer region that began and ended at wall times
+   when buffer is full, overwrite the oldest event
+------------------------------------------------------------------------- */
+
+void Trace::add(int region, double begin, double end)
+{
+  int i;
+  if (nevent < maxevent) i = (ifirst + nevent++) % maxevent;
+  else {
+    i = ifirst;
+    ifirst = (ifirst+1) % maxevent;
+    ndropped++;
+  }
+
+  events[i].begin = begin;
+  events[i].end = end;
+  events[i].step = update->ntimestep;
+  events[i].region = region;
+}
+
+/* ----------------------------------------------------------------------
+   write events from all procs to file in rank order, then empty buffer
+   called by all procs
+------------------------------------------------------------------------- */
+
+void Trace::write()
+{
+  int nme = format();
+  int nmax;
+  MPI_Allreduce(&nme,&nmax,1,MPI_INT,MPI_MAX,world);
+  if (nmax > maxsbuf) {
+    maxsbuf = nmax;
+    memory->grow(sbuf,maxsbuf,"trace:sbuf");
+  }
+
+  bigint nlost;
+  MPI_Allreduce(&ndropped,&nlost,1,MPI_SPARTA_BIGINT,MPI_SUM,world);
+  if (nlost && me == 0)
+    error->warning(FLERR,"Trace buffer overflowed, oldest events were dropped");
+
+  // proc 0 pings each proc, receives its events, writes them to file
+
+  int tmp,nchars;
+  MPI_Status status;
+  MPI_Request request;
+
+  if (me == 0) {
+    for (int iproc = 0; iproc < nprocs; iproc++) {
+      if (iproc) {
+        MPI_Irecv(sbuf,maxsbuf,MPI_CHAR,iproc,0,world,&request);
+        MPI_Send(&tmp,0,MPI_INT,iproc,0,world);
+        MPI_Wait(&request,&status);
+        MPI_Get_count(&status,MPI_CHAR,&nchars);
+      } else nchars = nme;
+      fwrite(sbuf,sizeof(char),nchars,fp);
+    }
+    fflush(fp);
+  } else {
+    MPI_Recv(&tmp,0,MPI_INT,0,0,world,&status);
+    MPI_Rsend(sbuf,nme,MPI_CHAR,0,0,world);
+  }
+
+  nevent = ifirst = 0;
+  ndropped = 0;
+}
+
+/* ----------------------------------------------------------------------
+   format my events as complete ("X") events, oldest first
+   times are in microseconds since tzero
+   each event needs MAXLINE chars plus length of its region name
+   return # of chars in sbuf
+------------------------------------------------------------------------- */
+
+int Trace::format()
+{
+  int n = 0;
+  int nline,nbytes;
+
+  for (int m = 0; m < nevent; m++) {
+    Event *e = &events[(ifirst+m) % maxevent];
+    nline = MAXLINE + strlen(timer->rname[e->region]);
+
+    if (n + nline > maxsbuf) {
+      maxsbuf = 2*maxsbuf + nline;
+      memory->grow(sbuf,maxsbuf,"trace:sbuf");
+    }
+
+    nbytes = snprintf(&sbuf[n],nline,
+                      ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,"
+                      "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"step\":"
+                      BIGINT_FORMAT "}}",
+                      timer->rname[e->region],me,
+                      (e->begin-tzero)*1.0e6,(e->end-e->begin)*1.0e6,e->step);
+    n += MIN(nbytes,nline-1);
+  }
+
+  return n;
+}
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------
+   SPARTA - Stochastic PArallel Rarefied-gas Time-accurate Analyzer
+   http://sparta.sandia.gov
+   Steve Plimpton, sjplimp@sandia.gov, Michael Gallis, magalli@sandia.gov
+   Sandia National Laboratories
+
+   Copyright (2014) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level SPARTA directory.
+------------------------------------------------------------------------- */
+
+#ifndef SPARTA_TRACE_H
+#define SPARTA_TRACE_H
+
+#include "stdio.h"
+#include "pointers.h"
+
+namespace SPARTA_NS {
+
+class Trace : protected Pointers {
+ public:
+  int nevery;                // write events every this many steps, 0 = never
+
+  Trace(class SPARTA *, int, char **);
+  ~Trace();
+  void add(int, double, double);
+  void write();
+
+ private:
+  int me,nprocs;
+  FILE *fp;
+  double tzero;              // wall time all procs agree is time 0
+
+  struct Event {
+    double begin,end;        // wall time of region begin/end
+    bigint step;             // timestep event occurred on
+    int region;              // index of Timer region
+  };
+
+  Event *events;             // ring buffer of events since last write
+  int maxevent;              // capacity of ring buffer
+  int nevent;                // # of events in ring buffer
+  int ifirst;                // index of oldest event in ring buffer
+  bigint ndropped;           // # of events overwritten since last write
+
+  char *sbuf;                // formatted events
+  int maxsbuf;
+
+  int format();
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal trace command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running SPARTA to see the offending line.
+
+E: Cannot open trace file %s
+
+The specified file cannot be opened.  Check that the path and name are
+correct.
+
+W: Trace buffer overflowed, oldest events were dropped
+
+More events occurred between writes than the ring buffer holds.  Use a
+smaller trace Nevery or a larger buffer size.
+
+*/
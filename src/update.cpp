@@ -70,6 +70,7 @@ Update::Update(SPARTA *sparta) : Pointers(sparta)
   firststep = laststep = 0;
   beginstep = endstep = 0;
   runflag = 0;
+  halt = 0;
 
   unit_style = NULL;
   set_units("si");
@@ -216,6 +217,8 @@ void Update::run(int nsteps)
   int cellweightflag = 0;
   if (grid->cellweightflag) cellweightflag = 1;
 
+  halt = 0;
+
   // loop over timesteps
 
   for (int i = 0; i < nsteps; i++) {
@@ -262,12 +265,28 @@ void Update::run(int nsteps)
       timer->stamp(TIME_MODIFY);
     }
 
+    // a fix may halt the run early, e.g. fix ave/grid on convergence
+    // make this the last step of the run so stats are output on it
+
+    if (halt) {
+      laststep = endstep = ntimestep;
+      this->nsteps = ntimestep - firststep;
+      output->next = output->next_stats = ntimestep;
+    }
+
     // all output
 
     if (ntimestep == output->next) {
       output->write(ntimestep);
       timer->stamp(TIME_OUTPUT);
     }
+
+    // periodic write of trace events, not charged to any phase
+
+    if (timer->trace && timer->trace->nevery && 
+        ntimestep % timer->trace->nevery == 0) timer->trace->write();
+
+    if (halt) break;
   }
 }
 
@@ -784,12 +803,14 @@ template < int DIM, int SURF > void Update::move()
               if (nsurf_tally) 
                 memcpy(&iorig,&particles[i],sizeof(Particle::OnePart));
 
+              timer->start(timer->move_surf);
               if (DIM == 3)
                 jpart = surf->sc[tri->isc]->
                   collide(ipart,tri->norm,dtremain,tri->isr);
               if (DIM != 3)
                 jpart = surf->sc[line->isc]->
                   collide(ipart,line->norm,dtremain,line->isr);
+              timer->stop(timer->move_surf);
 
               if (jpart) {
                 particles = particle->particles;
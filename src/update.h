@@ -28,6 +28,7 @@ class Update : protected Pointers {
   bigint firststep,laststep;      // 1st & last step of this run
   bigint beginstep,endstep;       // 1st and last step of multiple runs
   int first_update;               // 0 before initial update, 1 after
+  int halt;                       // 1 if a fix requested run stop early
   double dt;                      // timestep size
 
   char *unit_style;      // style of units used throughout simulation
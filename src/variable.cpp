@@ -78,6 +78,8 @@ enum{SUM,XMIN,XMAX,AVE,TRAP,SLOPE};
 
 #define BIG 1.0e20
 
+#define VARBLOCK 128       // # of particles or grid cells in a program block
+
 /* ---------------------------------------------------------------------- */
 
 Variable::Variable(SPARTA *sparta) : Pointers(sparta)
@@ -115,6 +117,18 @@ Variable::Variable(SPARTA *sparta) : Pointers(sparta)
   maxvec_storage = 0;
   vec_storage = NULL;
   maxlen_storage = NULL;
+
+  // bytecode program for particle-style and grid-style variables
+
+  ninstr = maxinstr = 0;
+  program = NULL;
+  nreg = maxreg = 0;
+  regs = NULL;
+  nstack = maxstack = 0;
+  stackreg = NULL;
+  nconst = maxconst = 0;
+  constreg = NULL;
+  constvalue = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -146,6 +160,12 @@ Variable::~Variable()
     memory->destroy(vec_storage[i]);
   memory->sfree(vec_storage);
   memory->sfree(maxlen_storage);
+
+  memory->sfree(program);
+  memory->destroy(regs);
+  memory->destroy(stackreg);
+  memory->destroy(constreg);
+  memory->destroy(constvalue);
 }
 
 /* ----------------------------------------------------------------------
@@ -753,7 +773,11 @@ void Variable::compute_particle(int ivar, double *result,
 
   int nlocal = particle->nlocal;
 
-  if (sumflag == 0) {
+  // evaluate compiled program in blocks if possible, else walk tree
+
+  if (compile_tree(tree)) eval_program(nlocal,result,stride,sumflag);
+
+  else if (sumflag == 0) {
     int m = 0;
     for (int i = 0; i < nlocal; i++) {
       result[m] = eval_tree(tree,i);
@@ -795,7 +819,11 @@ void Variable::compute_grid(int ivar, double *result,
 
   int nglocal = grid->nlocal;
 
-  if (sumflag == 0) {
+  // evaluate compiled program in blocks if possible, else walk tree
+
+  if (compile_tree(tree)) eval_program(nglocal,result,stride,sumflag);
+
+  else if (sumflag == 0) {
     int m = 0;
     for (int i = 0; i < nglocal; i++) {
       result[m] = eval_tree(tree,i);
@@ -2627,6 +2655,350 @@ void Variable::free_tree(Tree *tree)
   delete tree;
 }
 
+/* ----------------------------------------------------------------------
+   compile a collapsed particle-style or grid-style parse tree
+     into a register program evaluated in blocks by eval_program()
+   VALUE nodes left by collapse_tree() become constant registers,
+     filled once per evaluation instead of once per particle or grid cell
+   intermediate results use one register per depth of the tree
+   return 1 if compiled, 0 if the tree must be walked by eval_tree()
+------------------------------------------------------------------------- */
+
+int Variable::compile_tree(Tree *tree)
+{
+  if (!compilable(tree,0)) return 0;
+
+  ninstr = nreg = nstack = nconst = 0;
+  int ireg = compile_node(tree,0);
+
+  // DONE marks the register that holds the result
+
+  add_instr(DONE,ireg,ireg,-1,-1,NULL);
+
+  if (nreg > maxreg) {
+    maxreg = nreg;
+    memory->destroy(regs);
+    memory->create(regs,maxreg,VARBLOCK,"variable:regs");
+  }
+
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if all nodes of tree can be evaluated in blocks
+   RANDOM and NORMAL draw in per-particle order, so they cannot
+   time functions only remain in tree if their args vary per particle
+   the right operand of AND and OR is only evaluated by eval_tree()
+     if needed, so it cannot contain ops that flag an error
+   guard = 1 if inside such an operand
+------------------------------------------------------------------------- */
+
+int Variable::compilable(Tree *tree, int guard)
+{
+  int type = tree->type;
+
+  if (type == VALUE || type == ARRAY || type == PARTARRAYDOUBLE ||
+      type == PARTARRAYINT || type == SPECARRAY) return 1;
+
+  if (type == RANDOM || type == NORMAL) return 0;
+  if (type == RAMP || type == STAGGER || type == LOGFREQ || type == STRIDE ||
+      type == VDISPLACE || type == SWIGGLE || type == CWIGGLE) return 0;
+
+  if (guard && (type == DIVIDE || type == MODULO || type == CARAT ||
+                type == SQRT || type == LN || type == LOG ||
+                type == ASIN || type == ACOS)) return 0;
+
+  if (tree->left && !compilable(tree->left,guard)) return 0;
+  if (tree->middle && !compilable(tree->middle,guard)) return 0;
+  if (tree->right &&
+      !compilable(tree->right,guard || type == AND || type == OR)) return 0;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   emit instructions for tree whose result is needed at stack depth
+   return register that holds the result
+------------------------------------------------------------------------- */
+
+int Variable::compile_node(Tree *tree, int depth)
+{
+  int type = tree->type;
+
+  // constant register, hoisted out of block loop
+
+  if (type == VALUE) {
+    if (nconst == maxconst) {
+      maxconst += VARDELTA;
+      memory->grow(constreg,maxconst,"variable:constreg");
+      memory->grow(constvalue,maxconst,"variable:constvalue");
+    }
+    constreg[nconst] = add_register();
+    constvalue[nconst] = tree->value;
+    return constreg[nconst++];
+  }
+
+  // register for this depth of the tree
+
+  if (depth == nstack) {
+    if (nstack == maxstack) {
+      maxstack += VARDELTA;
+      memory->grow(stackreg,maxstack,"variable:stackreg");
+    }
+    stackreg[nstack++] = add_register();
+  }
+  int dest = stackreg[depth];
+
+  if (type == ARRAY || type == PARTARRAYDOUBLE ||
+      type == PARTARRAYINT || type == SPECARRAY)
+    return add_instr(type,dest,-1,-1,-1,tree);
+
+  int left = -1,middle = -1,right = -1;
+  int next = depth;
+  if (tree->left) left = compile_node(tree->left,next++);
+  if (tree->middle) middle = compile_node(tree->middle,next++);
+  if (tree->right) right = compile_node(tree->right,next++);
+
+  return add_instr(type,dest,left,middle,right,NULL);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int Variable::add_register()
+{
+  return nreg++;
+}
+
+/* ----------------------------------------------------------------------
+   append one instruction to program, return its destination register
+------------------------------------------------------------------------- */
+
+int Variable::add_instr(int op, int dest, int left, int middle, int right,
+                        Tree *leaf)
+{
+  if (ninstr == maxinstr) {
+    maxinstr += CHUNK;
+    program = (Instr *)
+      memory->srealloc(program,maxinstr*sizeof(Instr),"variable:program");
+  }
+
+  Instr *instr = &program[ninstr++];
+  instr->op = op;
+  instr->dest = dest;
+  instr->left = left;
+  instr->middle = middle;
+  instr->right = right;
+  instr->leaf = leaf;
+  return dest;
+}
+
+/* ----------------------------------------------------------------------
+   evaluate compiled program for N particles or grid cells
+   each instruction is applied to a block of VARBLOCK values at a time
+   answers are placed every stride locations into result
+   if sumflag, add variable values to existing result
+   ops and error checks match eval_tree() value by value
+------------------------------------------------------------------------- */
+
+void Variable::eval_program(int n, double *result, int stride, int sumflag)
+{
+  int i,j,k,nb;
+  double *d,*a,*b;
+
+  // fill constant registers once
+
+  for (k = 0; k < nconst; k++) {
+    d = regs[constreg[k]];
+    for (j = 0; j < VARBLOCK; j++) d[j] = constvalue[k];
+  }
+
+  Particle::OnePart *particles = particle->particles;
+  double *out = regs[program[ninstr-1].dest];
+
+  for (i = 0; i < n; i += VARBLOCK) {
+    nb = MIN(VARBLOCK,n-i);
+
+    for (k = 0; k < ninstr; k++) {
+      Instr *instr = &program[k];
+      d = regs[instr->dest];
+      a = (instr->left >= 0) ? regs[instr->left] : NULL;
+      b = (instr->right >= 0) ? regs[instr->right] : NULL;
+      Tree *leaf = instr->leaf;
+
+      switch (instr->op) {
+
+      case DONE:
+        break;
+
+      case ARRAY:
+        {
+          double *array = &leaf->array[(bigint) i*leaf->nstride];
+          int nstride = leaf->nstride;
+          for (j = 0; j < nb; j++) d[j] = array[j*nstride];
+        }
+        break;
+      case PARTARRAYDOUBLE:
+        {
+          char *carray = &leaf->carray[(bigint) i*leaf->nstride];
+          int nstride = leaf->nstride;
+          for (j = 0; j < nb; j++) d[j] = *((double *) &carray[j*nstride]);
+        }
+        break;
+      case PARTARRAYINT:
+        {
+          char *carray = &leaf->carray[(bigint) i*leaf->nstride];
+          int nstride = leaf->nstride;
+          for (j = 0; j < nb; j++) d[j] = *((int *) &carray[j*nstride]);
+        }
+        break;
+      case SPECARRAY:
+        {
+          char *carray = leaf->carray;
+          int nstride = leaf->nstride;
+          for (j = 0; j < nb; j++)
+            d[j] = *((double *)
+                     &carray[particles[i+j].ispecies*nstride]);
+        }
+        break;
+
+      case ADD:
+        for (j = 0; j < nb; j++) d[j] = a[j] + b[j];
+        break;
+      case SUBTRACT:
+        for (j = 0; j < nb; j++) d[j] = a[j] - b[j];
+        break;
+      case MULTIPLY:
+        for (j = 0; j < nb; j++) d[j] = a[j] * b[j];
+        break;
+      case DIVIDE:
+        for (j = 0; j < nb; j++) {
+          if (b[j] == 0.0) error->one(FLERR,"Divide by 0 in variable formula");
+          d[j] = a[j] / b[j];
+        }
+        break;
+      case MODULO:
+        for (j = 0; j < nb; j++) {
+          if (b[j] == 0.0) error->one(FLERR,"Modulo 0 in variable formula");
+          d[j] = fmod(a[j],b[j]);
+        }
+        break;
+      case CARAT:
+        for (j = 0; j < nb; j++) {
+          if (b[j] == 0.0) error->one(FLERR,"Power by 0 in variable formula");
+          d[j] = pow(a[j],b[j]);
+        }
+        break;
+      case UNARY:
+        for (j = 0; j < nb; j++) d[j] = -a[j];
+        break;
+
+      case NOT:
+        for (j = 0; j < nb; j++) d[j] = (a[j] == 0.0) ? 1.0 : 0.0;
+        break;
+      case EQ:
+        for (j = 0; j < nb; j++) d[j] = (a[j] == b[j]) ? 1.0 : 0.0;
+        break;
+      case NE:
+        for (j = 0; j < nb; j++) d[j] = (a[j] != b[j]) ? 1.0 : 0.0;
+        break;
+      case LT:
+        for (j = 0; j < nb; j++) d[j] = (a[j] < b[j]) ? 1.0 : 0.0;
+        break;
+      case LE:
+        for (j = 0; j < nb; j++) d[j] = (a[j] <= b[j]) ? 1.0 : 0.0;
+        break;
+      case GT:
+        for (j = 0; j < nb; j++) d[j] = (a[j] > b[j]) ? 1.0 : 0.0;
+        break;
+      case GE:
+        for (j = 0; j < nb; j++) d[j] = (a[j] >= b[j]) ? 1.0 : 0.0;
+        break;
+      case AND:
+        for (j = 0; j < nb; j++)
+          d[j] = (a[j] != 0.0 && b[j] != 0.0) ? 1.0 : 0.0;
+        break;
+      case OR:
+        for (j = 0; j < nb; j++)
+          d[j] = (a[j] != 0.0 || b[j] != 0.0) ? 1.0 : 0.0;
+        break;
+
+      case SQRT:
+        for (j = 0; j < nb; j++) {
+          if (a[j] < 0.0)
+            error->one(FLERR,"Sqrt of negative value in variable formula");
+          d[j] = sqrt(a[j]);
+        }
+        break;
+      case EXP:
+        for (j = 0; j < nb; j++) d[j] = exp(a[j]);
+        break;
+      case LN:
+        for (j = 0; j < nb; j++) {
+          if (a[j] <= 0.0)
+            error->one(FLERR,"Log of zero/negative value in variable formula");
+          d[j] = log(a[j]);
+        }
+        break;
+      case LOG:
+        for (j = 0; j < nb; j++) {
+          if (a[j] <= 0.0)
+            error->one(FLERR,"Log of zero/negative value in variable formula");
+          d[j] = log10(a[j]);
+        }
+        break;
+      case ABS:
+        for (j = 0; j < nb; j++) d[j] = fabs(a[j]);
+        break;
+
+      case SIN:
+        for (j = 0; j < nb; j++) d[j] = sin(a[j]);
+        break;
+      case COS:
+        for (j = 0; j < nb; j++) d[j] = cos(a[j]);
+        break;
+      case TAN:
+        for (j = 0; j < nb; j++) d[j] = tan(a[j]);
+        break;
+      case ASIN:
+        for (j = 0; j < nb; j++) {
+          if (a[j] < -1.0 || a[j] > 1.0)
+            error->one(FLERR,"Arcsin of invalid value in variable formula");
+          d[j] = asin(a[j]);
+        }
+        break;
+      case ACOS:
+        for (j = 0; j < nb; j++) {
+          if (a[j] < -1.0 || a[j] > 1.0)
+            error->one(FLERR,"Arccos of invalid value in variable formula");
+          d[j] = acos(a[j]);
+        }
+        break;
+      case ATAN:
+        for (j = 0; j < nb; j++) d[j] = atan(a[j]);
+        break;
+      case ATAN2:
+        for (j = 0; j < nb; j++) d[j] = atan2(a[j],b[j]);
+        break;
+
+      case CEIL:
+        for (j = 0; j < nb; j++) d[j] = ceil(a[j]);
+        break;
+      case FLOOR:
+        for (j = 0; j < nb; j++) d[j] = floor(a[j]);
+        break;
+      case ROUND:
+        for (j = 0; j < nb; j++) d[j] = MYROUND(a[j]);
+        break;
+      }
+    }
+
+    double *res = &result[(bigint) i*stride];
+    if (sumflag == 0)
+      for (j = 0; j < nb; j++) res[j*stride] = out[j];
+    else
+      for (j = 0; j < nb; j++) res[j*stride] += out[j];
+  }
+}
+
 /* ----------------------------------------------------------------------
    find matching parenthesis in str, allocate contents = str between parens
    i = left paren
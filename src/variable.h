@@ -86,6 +86,24 @@ class Variable : protected Pointers {
     Tree *left,*middle,*right;    // ptrs further down tree
   };
 
+                           // bytecode program compiled from a collapsed tree
+  struct Instr {           // one instruction of the program
+    int op;                // operation, see enum{} in variable.cpp
+    int dest;              // register the result is written to
+    int left,middle,right; // registers of the operands
+    Tree *leaf;            // tree node read by ARRAY-type loads
+  };
+
+  int ninstr,maxinstr;     // # of instructions in program
+  Instr *program;
+  int nreg,maxreg;         // # of registers, each holds one block of values
+  double **regs;
+  int nstack,maxstack;     // registers for intermediate results by depth
+  int *stackreg;
+  int nconst,maxconst;     // constant registers filled once per evaluation
+  int *constreg;
+  double *constvalue;
+
   void remove(int);
   void grow();
   void copy(int, char **, char **);
@@ -93,6 +111,12 @@ class Variable : protected Pointers {
   double collapse_tree(Tree *);
   double eval_tree(Tree *, int);
   void free_tree(Tree *);
+  int compile_tree(Tree *);
+  int compile_node(Tree *, int);
+  int compilable(Tree *, int);
+  int add_register();
+  int add_instr(int, int, int, int, int, Tree *);
+  void eval_program(int, double *, int, int);
   int find_matching_paren(char *, int, char *&);
   int math_function(char *, char *, Tree **, Tree **, int &, double *, int &);
   int special_function(char *, char *, Tree **, Tree **, 